@@ -0,0 +1,256 @@
+#pragma once
+
+#include "AsyncSocket.h"
+#include "BinaryProtocol.h"
+#include "FrameDecoder.h"
+#include "NetworkBuffer.h"
+#include "OutputQueue.h"
+#include "Reactor.h"
+#include "ServerConfig.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace core {
+namespace net {
+
+/**
+ * @brief Configuration for AsyncClient
+ */
+struct ClientConfig {
+    size_t pool_size = 4;                       // Connections opened by connect()
+    size_t max_in_flight = 1024;                // Outstanding requests per connection (power of 2, at most 32768)
+    size_t flush_threshold_bytes = 64 * 1024;   // Queued request bytes that are sent without waiting for poll()
+    uint32_t connect_timeout_ms = 5000;
+    SocketProfile socket_profile = SocketProfile::LATENCY;
+    bool crc32c_checksums = false;              // Flag requests FrameFlags::CRC32C (hardware CRC on SSE4.2)
+};
+
+/**
+ * @brief Response (or failure) delivered to a request's callback
+ */
+struct ClientResponse {
+    bool ok{false};                     // false: the connection was lost before the response arrived
+    protocol::FrameHeader header{};
+    const uint8_t* payload{nullptr};    // Valid for the duration of the callback only
+    size_t payload_length{0};
+};
+
+/**
+ * @brief Pipelining client for the binary frame protocol
+ *
+ * Demonstrates:
+ * - Connection pooling: requests are spread round-robin over a fixed set of connections
+ * - Pipelining: many requests outstanding per connection, matched to responses by a
+ *   16-bit request id carried in the frame header's reserved field (0 = server-initiated)
+ * - Write batching: requests are framed with MessageSerializer into each connection's
+ *   OutputQueue and go out together in one gathered send per poll()
+ * - Frame reassembly across recv() boundaries with a FrameDecoder, payloads handed out in place
+ * - Single-threaded event loop on a Reactor: not thread-safe, use one client per thread
+ *
+ * The server echoes frames unchanged, so the id comes back with the response;
+ * heartbeat PINGs and the going-away STATUS carry id 0 and go to the unsolicited
+ * callback. A connection that receives STATUS_GOING_AWAY takes no new requests.
+ */
+class AsyncClient {
+public:
+    using ResponseCallback = std::function<void(const ClientResponse&)>;
+    using FrameCallback = std::function<void(const protocol::FrameHeader&, const uint8_t*, size_t)>;
+
+    static constexpr size_t MAX_IN_FLIGHT = 32768;    // Half the id space: ids stay unique per connection
+
+    /**
+     * @brief Construct a client (no connections yet)
+     * @param config Pool size, pipelining depth, batching and socket options
+     */
+    explicit AsyncClient(const ClientConfig& config = ClientConfig{});
+
+    /**
+     * @brief Destructor - closes connections; outstanding callbacks are not invoked
+     */
+    ~AsyncClient() noexcept;
+
+    // Delete copy operations
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    // Delete move operations (reactor tokens refer to this instance's pool)
+    AsyncClient(AsyncClient&&) = delete;
+    AsyncClient& operator=(AsyncClient&&) = delete;
+
+    /**
+     * @brief Open the connection pool and wait for the connects to finish
+     * @param address Server IPv4 address
+     * @param port Server port
+     * @return true if at least one connection was established
+     */
+    bool connect(const std::string& address, uint16_t port) noexcept;
+
+    /**
+     * @brief Queue a request frame
+     * The frame is sent on the next poll() or flush(), or at once when the connection's
+     * queue passes flush_threshold_bytes.
+     * @param type Message type
+     * @param payload Payload bytes (copied)
+     * @param length Payload length
+     * @param callback Invoked from poll() with the response or a failure
+     * @return false if no connection can take another request right now (poll() first)
+     */
+    bool send_request(protocol::MessageType type, const uint8_t* payload, uint16_t length,
+                      ResponseCallback callback) noexcept;
+
+    /**
+     * @brief Send queued requests, wait for I/O and dispatch responses
+     * Callbacks run on the calling thread and may send further requests; they must
+     * not call close().
+     * @param timeout_ms Longest wait for the first event (-1 = infinite)
+     * @return Number of responses and failures delivered
+     */
+    size_t poll(int timeout_ms) noexcept;
+
+    /**
+     * @brief Poll until no request is outstanding
+     * @return false if requests were still outstanding after timeout_ms
+     */
+    bool wait_for_responses(uint32_t timeout_ms) noexcept;
+
+    /**
+     * @brief Send queued requests now instead of at the next poll()
+     */
+    void flush() noexcept;
+
+    /**
+     * @brief Close every connection; outstanding requests fail
+     */
+    void close() noexcept;
+
+    /**
+     * @brief Receive frames the server sent on its own (heartbeat PING, STATUS)
+     */
+    void set_unsolicited_callback(FrameCallback callback) noexcept
+    {
+        m_on_unsolicited = std::move(callback);
+    }
+
+    /**
+     * @brief Get number of requests awaiting a response
+     */
+    [[nodiscard]] size_t get_in_flight() const noexcept
+    {
+        return m_in_flight;
+    }
+
+    /**
+     * @brief Get number of established connections
+     */
+    [[nodiscard]] size_t get_connection_count() const noexcept;
+
+    /**
+     * @brief Get number of send syscalls issued (requests / sends = batching factor)
+     */
+    [[nodiscard]] size_t get_send_count() const noexcept
+    {
+        return m_send_count;
+    }
+
+private:
+    static constexpr size_t READ_SIZE = 16 * 1024;             // Space offered to each recv()
+    static constexpr size_t MAX_EVENTS = 256;
+    static constexpr size_t NO_CONNECTION = SIZE_MAX;
+
+    struct Pending {
+        uint16_t id{0};                 // 0 = slot free
+        ResponseCallback callback;
+    };
+
+    struct Connection {
+        std::unique_ptr<AsyncSocket> socket;
+        bool connected{false};
+        bool going_away{false};
+        bool want_writable{false};
+
+        OutputQueue output;
+
+        // recv() writes straight into the decoder's buffer
+        protocol::FrameDecoder decoder;
+
+        // Slot per id modulo the pipelining depth
+        std::vector<Pending> pending;
+        size_t in_flight{0};
+        uint32_t next_sequence{0};
+    };
+
+    /**
+     * @brief Get the id the connection's next request gets
+     */
+    [[nodiscard]] static uint16_t next_id(const Connection& connection) noexcept
+    {
+        return static_cast<uint16_t>(connection.next_sequence % MAX_IN_FLIGHT + 1);
+    }
+
+    /**
+     * @brief Get the pending slot an id maps to
+     */
+    [[nodiscard]] static Pending& slot_of(Connection& connection, uint16_t id) noexcept
+    {
+        return connection.pending[(id - 1u) & (connection.pending.size() - 1)];
+    }
+
+    /**
+     * @brief Pick the next connection that can take a request (round-robin)
+     * @return Pool index, NO_CONNECTION if every connection is full or gone
+     */
+    size_t pick_connection() noexcept;
+
+    /**
+     * @brief Write queued output until done or the socket is full
+     * @return false if the connection failed
+     */
+    bool flush_connection(size_t index) noexcept;
+
+    /**
+     * @brief Read everything available and dispatch complete frames
+     * @return false if the connection failed or the peer closed it
+     */
+    bool read_connection(size_t index, size_t& delivered) noexcept;
+
+    /**
+     * @brief Dispatch complete frames from the input buffer
+     * @return false on a corrupt frame
+     */
+    bool parse_frames(Connection& connection, size_t& delivered) noexcept;
+
+    /**
+     * @brief Route one validated frame to its request's callback
+     */
+    void dispatch(Connection& connection, const protocol::FrameHeader& header,
+                  const uint8_t* payload, size_t& delivered) noexcept;
+
+    /**
+     * @brief Register for WRITABLE only while output is queued
+     */
+    void update_interest(size_t index) noexcept;
+
+    /**
+     * @brief Close a connection and fail its outstanding requests
+     */
+    void fail_connection(size_t index, size_t& delivered) noexcept;
+
+    /**
+     * @brief Wait for the non-blocking connects started by connect()
+     */
+    void await_connects(uint32_t timeout_ms) noexcept;
+
+    ClientConfig m_config;
+    Reactor m_reactor;
+    std::vector<std::unique_ptr<Connection>> m_connections;
+    size_t m_next_connection{0};
+    size_t m_in_flight{0};
+    size_t m_send_count{0};
+    NetworkBuffer m_frame;              // Serialization scratch, reused for every request
+    FrameCallback m_on_unsolicited;
+};
+
+} // namespace net
+} // namespace core
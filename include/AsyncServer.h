@@ -2,11 +2,23 @@
 
 #include "AsyncSocket.h"
 #include "ConnectionHandler.h"
+#include "IoUringEngine.h"
+#include "RateLimiter.h"
+#include "Reactor.h"
+#include "ServerConfig.h"
+#include "SharedBuffer.h"
+#include "SlotTable.h"
 #include "ThreadPool.h"
-#include <map>
+#include "TimerWheel.h"
+#include <functional>
+#include <limits>
+#include <vector>
 #include <memory>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
+#include <utility>
 
 namespace core {
 namespace net {
@@ -15,13 +27,82 @@ namespace net {
  * @brief Async TCP server handling multiple concurrent clients
  * 
  * Demonstrates:
- * - Multi-client TCP server
- * - Async I/O with WinSock events
+ * - Multi-client TCP server, or a Unix domain socket server for co-located clients
+ * - Shared-memory connections (SPSC rings + eventfd doorbells) that bypass the kernel's data path
+ * - Thread-per-core sharding: one SO_REUSEPORT listener, poller and connection set per reactor thread
+ * - Connections in per-shard slot tables, addressed by generational ConnectionIds that
+ *   go stale on close instead of aliasing whoever gets the recycled socket next
+ * - Readiness-driven I/O through Reactor (epoll on Linux)
+ * - Completion-driven I/O through IoUringEngine, selectable at runtime
+ * - Serialize-once broadcast: one refcounted payload fanned out by each shard's own thread
+ * - MSG_ZEROCOPY sends for large payloads above a configurable threshold
+ * - Idle timeouts, handshake deadlines and heartbeat PINGs on a hierarchical timer wheel
+ * - Per-connection backpressure: reads pause while output sits above the high watermark
+ * - Token-bucket input rate limits per connection and per client address, adjustable at runtime
+ * - Graceful drain on stop(): going-away notice, bounded flush, then close; stop_now() for a hard stop
  * - Integration with ThreadPool
  * - Connection lifecycle management
  */
 class AsyncServer {
 public:
+    /**
+     * @brief Answers the connection a frame callback was invoked for
+     * Writes straight through the connection's handler, so it works inside the callback,
+     * where the shard is locked and send_to_client()/close_client() are refused.
+     */
+    class FrameReply {
+    public:
+        FrameReply(ConnectionId connection, ConnectionHandler& handler) noexcept
+            : m_connection(connection)
+            , m_handler(handler)
+        {
+        }
+
+        /**
+         * @brief Get the connection's id
+         */
+        [[nodiscard]] ConnectionId connection() const noexcept
+        {
+            return m_connection;
+        }
+
+        /**
+         * @brief Queue bytes for the connection (flushed once the callback returns)
+         * @return true if queued
+         */
+        bool send(const uint8_t* data, size_t length) noexcept
+        {
+            return m_handler.send_data(data, length);
+        }
+
+        /**
+         * @brief Queue a shared payload for the connection without copying it
+         * @return true if queued
+         */
+        bool send(const SharedBuffer& payload) noexcept
+        {
+            return m_handler.send_shared(payload);
+        }
+
+        /**
+         * @brief Close the connection once the callback returns; later frames are dropped
+         */
+        void close() noexcept
+        {
+            m_handler.mark_closed();
+        }
+
+    private:
+        ConnectionId m_connection;
+        ConnectionHandler& m_handler;
+    };
+
+    using WatermarkCallback = std::function<void(ConnectionId connection, bool above_high_watermark)>;
+    using FrameCallback = std::function<void(FrameReply& reply, const protocol::FrameView& frame)>;
+
+    // Most reactor threads one server runs; the shard index is kept in the ConnectionId's top bits
+    static constexpr size_t MAX_SHARDS = 64;
+
     /**
      * @brief Construct async server
      * @param num_worker_threads Number of worker threads for connection processing
@@ -29,7 +110,13 @@ public:
     explicit AsyncServer(size_t num_worker_threads = 4);
 
     /**
-     * @brief Destructor - stops server and closes connections
+     * @brief Construct async server from a full configuration
+     * @param config Server configuration (engine, pool size, ...)
+     */
+    explicit AsyncServer(const ServerConfig& config);
+
+    /**
+     * @brief Destructor - stops server immediately (stop_now()) and closes connections
      */
     ~AsyncServer() noexcept;
 
@@ -50,17 +137,101 @@ public:
     bool start(const std::string& listen_address, uint16_t port) noexcept;
 
     /**
-     * @brief Stop server and close all connections
+     * @brief Start listening on a Unix domain stream socket instead of TCP
+     * Connections behave exactly like TCP ones (same handlers, framing and limits).
+     * Unix sockets can't be spread with SO_REUSEPORT, so every shard accepts from a
+     * duplicate of one listening socket.
+     * @param path Filesystem path, or "@name" for the abstract namespace (Linux)
+     * @return true if successful
+     */
+    bool start_unix(const std::string& path) noexcept;
+
+    /**
+     * @brief Start serving same-host clients over shared memory
+     * Clients connect with ShmChannel::connect(path). The Unix socket only carries the
+     * handshake (ring region and doorbells, passed with SCM_RIGHTS) and hang-up; all
+     * data moves through the rings. Connections otherwise behave like socket ones.
+     * Runs on the readiness engine; Linux only.
+     * @param path Filesystem path, or "@name" for the abstract namespace
+     * @return true if successful
+     */
+    bool start_shm(const std::string& path) noexcept;
+
+    /**
+     * @brief Stop server gracefully
+     * Every shard stops accepting, sends each client a STATUS frame with
+     * STATUS_GOING_AWAY and stops reading from it. Connections are closed as their
+     * output queues drain; whatever is left after drain_timeout_ms is closed by
+     * stop_now(). Blocks until then unless called on a reactor thread (e.g. from a
+     * callback), where it only starts the drain. Without a running loop the notice
+     * goes out with whatever the sockets take right away.
      */
     void stop() noexcept;
 
+    /**
+     * @brief Stop server immediately
+     * Closes every connection without flushing queued output.
+     */
+    void stop_now() noexcept;
+
     /**
      * @brief Run server main loop (blocking)
-     * Processes client events and handles connections
-     * @param timeout_ms Timeout in milliseconds for event wait (0 = infinite)
+     * Shard 0 runs on the calling thread, the other shards on their own threads;
+     * each waits for ready sockets and dispatches them in batches of up to MAX_EVENTS.
+     * Returns once stop() has been called and every shard loop has exited.
+     * @param timeout_ms Timeout in milliseconds for event wait (INFINITE = no timeout)
      */
     void run(unsigned long timeout_ms = INFINITE) noexcept;
 
+    /**
+     * @brief Observe backpressure on individual connections
+     * Invoked on the owning shard's thread when a connection's queued output crosses
+     * the high watermark (reads paused) and when it drains to the low watermark
+     * (reads resumed). Crossings are queued and reported from the loop with no lock
+     * held, so the callback may call send_to_client() and close_client(); by then the
+     * connection may already be gone. Set before start().
+     */
+    void set_watermark_callback(WatermarkCallback callback) noexcept
+    {
+        m_on_watermark = std::move(callback);
+    }
+
+    /**
+     * @brief Decode protocol frames on every connection
+     * Each connection gets its own FrameDecoder; recv() writes straight into it and
+     * complete frames are handed over in place, valid only during the call. Invoked on
+     * the owning shard's thread with the shard locked: answer through the FrameReply.
+     * send_to_client() and close_client() for connections on the same shard fail there.
+     * Under DISCONNECT a corrupt frame closes the connection. Raw input is still echoed.
+     * Set before start().
+     */
+    void set_frame_callback(FrameCallback callback,
+                            protocol::CorruptionPolicy policy = protocol::CorruptionPolicy::DISCONNECT) noexcept
+    {
+        m_on_frame = std::move(callback);
+        m_frame_policy = policy;
+    }
+
+    /**
+     * @brief Change input rate limits (0 = unlimited); any thread, any time
+     * Applies to existing connections from their next read on.
+     * @param per_connection Limits each connection gets on its own
+     * @param per_address Limits shared by all connections from one IP address
+     */
+    void set_rate_limits(const RateLimits& per_connection, const RateLimits& per_address) noexcept
+    {
+        m_rate_limits.set_connection_limits(per_connection);
+        m_rate_limits.set_address_limits(per_address);
+    }
+
+    /**
+     * @brief Get number of times a connection's reads were paused by a rate limit
+     */
+    [[nodiscard]] size_t get_rate_limited_count() const noexcept
+    {
+        return m_rate_limited_pauses.load(std::memory_order_relaxed);
+    }
+
     /**
      * @brief Check if server is running
      */
@@ -70,68 +241,501 @@ public:
     }
 
     /**
-     * @brief Get number of active connections
+     * @brief Check if a graceful stop() is in progress
+     */
+    [[nodiscard]] bool is_draining() const noexcept
+    {
+        return m_draining.load(std::memory_order_acquire) && is_running();
+    }
+
+    /**
+     * @brief Get the engine actually driving I/O (after any fallback in start())
+     */
+    [[nodiscard]] IoEngine get_io_engine() const noexcept
+    {
+        return (!m_shards.empty() && m_shards.front()->uring) ? IoEngine::IO_URING : IoEngine::READINESS;
+    }
+
+    /**
+     * @brief Get number of reactor threads (shards) started
      */
-    [[nodiscard]] size_t get_connection_count() const noexcept
+    [[nodiscard]] size_t get_shard_count() const noexcept
     {
-        return m_connections.size();
+        return m_shards.size();
+    }
+
+    /**
+     * @brief Get number of active connections across all shards
+     */
+    [[nodiscard]] size_t get_connection_count() const noexcept;
+
+    /**
+     * @brief Get number of active connections owned by one shard
+     */
+    [[nodiscard]] size_t get_connection_count(size_t shard_index) const noexcept;
+
+    /**
+     * @brief Get ids of all current connections
+     */
+    [[nodiscard]] std::vector<ConnectionId> get_connection_ids() const;
+
+    /**
+     * @brief Get number of connections refused because the server was at capacity
+     */
+    [[nodiscard]] size_t get_rejected_connection_count() const noexcept
+    {
+        return m_rejected_connections.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get number of shards whose listener is paused by the overload policy or an accept backoff
+     */
+    [[nodiscard]] size_t get_paused_listener_count() const noexcept
+    {
+        return m_paused_listeners.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get number of times a listener was paused because accept ran out of descriptors
+     */
+    [[nodiscard]] size_t get_accept_backoff_count() const noexcept
+    {
+        return m_accept_backoffs.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get number of MSG_ZEROCOPY sends not reported as copied (so far)
+     */
+    [[nodiscard]] size_t get_zerocopy_send_count() const noexcept
+    {
+        return m_zerocopy_stats.zerocopy_sends.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get number of zero-copy eligible sends that were copied after all
+     * (no optmem for pinning, or the kernel copied, e.g. on loopback); never also
+     * counted by get_zerocopy_send_count()
+     */
+    [[nodiscard]] size_t get_zerocopy_fallback_count() const noexcept
+    {
+        return m_zerocopy_stats.copied_sends.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the port the server is listening on
+     */
+    [[nodiscard]] uint16_t get_listen_port() const noexcept
+    {
+        return m_listen_port;
+    }
+
+    /**
+     * @brief Get the Unix socket path the server is listening on (empty for TCP)
+     */
+    [[nodiscard]] const std::string& get_listen_path() const noexcept
+    {
+        return m_listen_path;
     }
 
     /**
      * @brief Send data to a specific client
-     * @param client_socket Socket handle of client
+     * @param connection Id of the client's connection
      * @param data Data to send
      * @param length Data length
-     * @return true if successful
+     * @return true if successful, false if the connection is gone (stale id)
      */
-    bool send_to_client(SOCKET client_socket, const uint8_t* data, size_t length) noexcept;
+    bool send_to_client(ConnectionId connection, const uint8_t* data, size_t length) noexcept;
 
     /**
      * @brief Broadcast data to all connected clients
+     * The bytes are copied once into a SharedBuffer; see broadcast(const SharedBuffer&).
      * @param data Data to broadcast
      * @param length Data length
      */
     void broadcast(const uint8_t* data, size_t length) noexcept;
 
+    /**
+     * @brief Broadcast a shared payload to all connected clients
+     * Every connection queues a reference to the same bytes. The fan-out runs
+     * asynchronously on each shard's reactor thread, so this returns without
+     * taking any connection lock; clients connected at that point receive it.
+     */
+    void broadcast(const SharedBuffer& payload) noexcept;
+
     /**
      * @brief Close a specific client connection
-     * @param client_socket Socket to close
+     * @param connection Id of the connection (a stale id is ignored)
      */
-    void close_client(SOCKET client_socket) noexcept;
+    void close_client(ConnectionId connection) noexcept;
 
 private:
-    std::unique_ptr<AsyncSocket> m_socket;
+    /**
+     * @brief Connection handler plus the interest set registered with the reactor
+     */
+    struct Connection {
+        std::unique_ptr<ConnectionHandler> handler;
+        SOCKET socket{INVALID_SOCKET};
+        uint32_t interest{Reactor::READABLE};
+        bool read_ready_queued{false};  // Budget ran out; waiting in Shard::read_ready
+
+        // io_uring engine state
+        bool recv_armed{false};
+        bool recv_cancelled{false};     // Backpressure cancelled the multishot recv
+        bool flush_queued{false};
+        bool closing{false};
+        size_t sends_in_flight{0};
+        size_t bytes_in_flight{0};
+
+        // Timers in the shard's wheel (INVALID_TIMER when not armed)
+        TimerWheel::TimerId idle_timer{TimerWheel::INVALID_TIMER};
+        TimerWheel::TimerId handshake_timer{TimerWheel::INVALID_TIMER};
+        TimerWheel::TimerId heartbeat_timer{TimerWheel::INVALID_TIMER};
+        TimerWheel::TimerId rate_limit_timer{TimerWheel::INVALID_TIMER};   // Resumes rate-limited reads
+    };
+
+    enum TimerKind : uint32_t {
+        IDLE_TIMER,
+        HANDSHAKE_TIMER,
+        HEARTBEAT_TIMER,
+        RATE_LIMIT_TIMER,
+        ACCEPT_RETRY_TIMER      // Token is LISTENER_TOKEN: resumes the shard's listener
+    };
+
+    // Shard-local ids (no shard bits) double as reactor, io_uring and timer tokens
+    using ConnectionMap = SlotTable<Connection>;
+
+    /**
+     * @brief One reactor thread's share of the server
+     * Only the owning loop touches the poller; the mutex is held by that loop while it
+     * dispatches a batch and is otherwise taken only by API calls aimed at this shard.
+     */
+    struct Shard {
+        size_t index{0};
+        std::unique_ptr<AsyncSocket> listener;
+        std::unique_ptr<Reactor> reactor;
+        std::unique_ptr<IoUringEngine> uring;
+
+        ConnectionMap connections;
+        std::atomic<size_t> connection_count{0};
+        mutable std::mutex mutex;
+
+        // Set by the overload policy; read by other shards to decide whom to wake
+        std::atomic<bool> listener_paused{false};
+
+        // Armed while the listener rests after accept ran out of descriptors
+        TimerWheel::TimerId accept_retry_timer{TimerWheel::INVALID_TIMER};
+
+        // Edge-triggered sockets that still hold input after their read budget
+        std::vector<ConnectionId> read_ready;
+
+        // io_uring: connections with output waiting for a send chain
+        std::vector<ConnectionId> flush_list;
+        bool in_completions{false};
+
+        // Connection timers; touched only by the owning loop
+        TimerWheel timers;
+
+        // Broadcasts waiting for the loop to fan them out
+        std::mutex inbox_mutex;
+        std::vector<SharedBuffer> broadcast_inbox;
+
+        // Watermark crossings waiting to be reported outside the mutex (guarded by mutex)
+        std::vector<std::pair<ConnectionId, bool>> watermark_events;
+
+        // Graceful stop: notices sent and listener closed / nothing left to wait for
+        bool draining{false};
+        bool drained{false};
+    };
+
+    ServerConfig m_config;
     std::unique_ptr<ThreadPool> m_thread_pool;
-    
-    WSAEVENT m_event_object;
-    std::atomic<bool> m_is_running{false};
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    uint16_t m_listen_port{0};
+    std::string m_listen_path;
+    bool m_shm_transport{false};            // Accepted connections are upgraded to shared memory
+    bool m_cork_flushes{false};             // Accepted TCP connections cork while flushing (THROUGHPUT)
+    WatermarkCallback m_on_watermark;
+    FrameCallback m_on_frame;
+    protocol::CorruptionPolicy m_frame_policy{protocol::CorruptionPolicy::DISCONNECT};
+    SharedBuffer m_ping_frame;              // Serialized once in start() when heartbeats are on
+    SharedBuffer m_going_away_frame;        // Serialized once in start(), sent by stop()
 
-    // Map of socket -> connection handler
-    std::map<SOCKET, std::unique_ptr<ConnectionHandler>> m_connections;
-    mutable std::mutex m_connections_mutex;
+    std::atomic<bool> m_is_running{false};
+    std::atomic<bool> m_draining{false};
+    std::atomic<uint64_t> m_drain_deadline_ms{0};
+    std::atomic<size_t> m_shards_draining{0};   // Shards still flushing; the last one calls stop_now()
+    std::atomic<size_t> m_active_runs{0};       // Threads inside run()
+    std::mutex m_stop_mutex;
+    std::condition_variable m_stopped;
+    std::atomic<size_t> m_paused_listeners{0};
+    std::atomic<size_t> m_rejected_connections{0};
+    std::atomic<size_t> m_accept_backoffs{0};
+    std::atomic<size_t> m_rate_limited_pauses{0};
+    ZeroCopyStats m_zerocopy_stats;
+    RateLimitRegistry m_rate_limits;
 
     static constexpr size_t MAX_EVENTS = 64;
-    static constexpr size_t MAX_CONNECTIONS = 1000;
+    static constexpr uint64_t LISTENER_TOKEN = std::numeric_limits<uint64_t>::max() - 1;
+    static constexpr uint64_t SHM_DOORBELL_TOKEN = uint64_t{1} << 62;     // | local id: shared-memory doorbell
+    static constexpr unsigned SHARD_SHIFT = ConnectionMap::TAG_SHIFT;
 
     /**
-     * @brief Process network events
+     * @brief Opens shard.listener for one shard (shards are started in index order)
      */
-    void process_events() noexcept;
+    using ListenerFactory = std::function<bool(Shard& shard, size_t shard_count)>;
 
     /**
-     * @brief Handle new client connection
+     * @brief Create every shard, each with a listener from open_listener
+     * @param needs_reuse_port Listeners share a port through SO_REUSEPORT; without
+     *        platform support only one shard is started
      */
-    void handle_new_connection() noexcept;
+    bool start_shards(const ListenerFactory& open_listener, bool needs_reuse_port) noexcept;
+
+    /**
+     * @brief Shared body of start_unix() and start_shm()
+     */
+    bool start_local(const std::string& path, bool shm_transport) noexcept;
+
+    /**
+     * @brief Give an accepted socket a shared-memory channel and send the handshake
+     */
+    bool upgrade_to_shm(ConnectionHandler& handler, SOCKET client_socket) noexcept;
+
+    /**
+     * @brief Register an accepted connection's descriptors with the shard's reactor
+     * @return Interest set registered for the socket, 0 on failure
+     */
+    uint32_t register_client(Shard& shard, ConnectionId id, const Connection& connection) noexcept;
+
+    /**
+     * @brief Undo register_client() (readiness engine)
+     */
+    void unregister_client(Shard& shard, const Connection& connection) noexcept;
+
+    /**
+     * @brief Store a new connection in the shard's table and finish its setup
+     * @return Shard-local id, INVALID_CONNECTION_ID if it couldn't be stored
+     */
+    ConnectionId add_connection(Shard& shard, std::unique_ptr<ConnectionHandler> handler,
+                                SOCKET client_socket) noexcept;
+
+    /**
+     * @brief Erase a closed connection and republish the count (readiness engine)
+     */
+    void remove_connection(Shard& shard, ConnectionId id, Connection& connection) noexcept;
+
+    /**
+     * @brief Public id: shard-local id tagged with the shard index
+     */
+    [[nodiscard]] static ConnectionId public_id(const Shard& shard, ConnectionId id) noexcept
+    {
+        return id | (static_cast<ConnectionId>(shard.index) << SHARD_SHIFT);
+    }
+
+    /**
+     * @brief Create listener and poller for one shard
+     */
+    bool start_shard(Shard& shard, const ListenerFactory& open_listener, size_t shard_count) noexcept;
+
+    /**
+     * @brief Wake a shard blocked in its poller
+     */
+    static void wake_shard(Shard& shard) noexcept;
+
+    /**
+     * @brief Find a live connection by public id and lock its shard
+     * @return Connection (shard locked through lock, shard stored in shard_out), nullptr if stale
+     */
+    Connection* find_connection(ConnectionId connection, std::unique_lock<std::mutex>& lock,
+                                Shard*& shard_out) noexcept;
+
+    /**
+     * @brief Keep the lock-free connection count in step with the map (shard mutex held)
+     * Wakes paused listeners once capacity frees up.
+     */
+    void publish_count(Shard& shard) noexcept;
+
+    /**
+     * @brief Check the connection limit across all shards
+     */
+    [[nodiscard]] bool at_capacity() const noexcept
+    {
+        return get_connection_count() >= m_config.max_connections;
+    }
+
+    /**
+     * @brief Stop / restart accepting on a shard's listener (owning loop only)
+     */
+    void pause_listener(Shard& shard) noexcept;
+    void resume_listener_if_possible(Shard& shard) noexcept;
+
+    /**
+     * @brief Pause the listener for accept_retry_ms after accept ran out of descriptors
+     * The connection stays in the backlog, so a level-triggered listener would report it
+     * again on every wakeup; resting gives other connections time to close.
+     */
+    void back_off_accepts(Shard& shard, int error) noexcept;
+
+    /**
+     * @brief Event loop of one shard (readiness or io_uring)
+     */
+    void run_shard(Shard& shard, int wait_ms) noexcept;
+
+    /**
+     * @brief Queue pending broadcasts on every connection of the shard (owning loop only)
+     */
+    void drain_broadcasts(Shard& shard) noexcept;
+
+    /**
+     * @brief Arm the configured timers for a new connection (owning loop only)
+     */
+    void arm_timers(Shard& shard, ConnectionId id, Connection& connection) noexcept;
+
+    /**
+     * @brief Push back the idle deadline and clear the handshake deadline after input
+     */
+    void note_activity(Shard& shard, Connection& connection) noexcept;
+
+    /**
+     * @brief Schedule the resume timer of a connection the rate limiter just paused (owning loop only)
+     */
+    void watch_rate_limit(Shard& shard, ConnectionId id, Connection& connection) noexcept;
+
+    /**
+     * @brief Disarm a connection's timers before it is erased (owning loop only)
+     */
+    static void cancel_timers(Shard& shard, Connection& connection) noexcept;
+
+    /**
+     * @brief Poller timeout honouring the caller's timeout, the next timer and the drain deadline
+     */
+    int next_wait_ms(const Shard& shard, int wait_ms) const noexcept;
+
+    /**
+     * @brief Advance a graceful stop on one shard (owning loop, once per pass)
+     * @return true once the shard has nothing left to flush or the deadline has passed
+     */
+    bool drain_shard(Shard& shard) noexcept;
+
+    /**
+     * @brief Close the listener and send every connection the going-away notice (shard mutex held)
+     */
+    void begin_drain(Shard& shard) noexcept;
+
+    /**
+     * @brief Close connections whose output has drained (shard mutex held)
+     */
+    void close_flushed(Shard& shard) noexcept;
+
+    /**
+     * @brief Fire due timers (shard mutex held)
+     */
+    void expire_timers(Shard& shard) noexcept;
+    void handle_timer(Shard& shard, const TimerWheel::Expiry& expiry) noexcept;
+
+    /**
+     * @brief Process a batch of ready sockets
+     * @param events Ready events returned by the reactor
+     * @param count Number of events
+     */
+    void process_events(Shard& shard, const Reactor::Event* events, size_t count) noexcept;
+
+    /**
+     * @brief Interest modifiers every client socket is registered with
+     */
+    [[nodiscard]] uint32_t registration_flags() const noexcept;
+
+    /**
+     * @brief Re-register reactor interest to match connection state
+     * Must be called with the shard mutex held
+     */
+    void update_interest(Shard& shard, ConnectionId id, Connection& connection) noexcept;
+
+    /**
+     * @brief Drain the listen backlog (up to max_accepts_per_wakeup sockets)
+     */
+    void handle_new_connection(Shard& shard) noexcept;
+
+    /**
+     * @brief Create a handler with the server's default callbacks
+     */
+    std::unique_ptr<ConnectionHandler> make_handler(SOCKET client_socket, const PeerAddress& peer) noexcept;
+
+    /**
+     * @brief Queue a stored connection's watermark crossings for the user callback
+     */
+    void watch_watermarks(Shard& shard, ConnectionId id, ConnectionHandler& handler) noexcept;
+
+    /**
+     * @brief Report queued watermark crossings (loop thread, shard mutex not held)
+     */
+    void dispatch_watermarks(Shard& shard) noexcept;
+
+    /**
+     * @brief Attach a frame decoder routed to the user's frame callback, if one is set
+     * @return false if the decoder couldn't be allocated
+     */
+    bool watch_frames(const Shard& shard, ConnectionId id, ConnectionHandler& handler) noexcept;
+
+    /**
+     * @brief io_uring main loop
+     */
+    void run_uring(Shard& shard, int wait_ms) noexcept;
+
+    /**
+     * @brief Dispatch one io_uring completion (shard mutex held)
+     */
+    void handle_completion(Shard& shard, const IoUringEngine::Completion& completion) noexcept;
+
+    /**
+     * @brief Register a socket accepted by multishot accept (shard mutex held)
+     */
+    void handle_uring_accept(Shard& shard, SOCKET client_socket) noexcept;
+
+    /**
+     * @brief Queue a connection for the next send chain (shard mutex held)
+     */
+    void queue_flush(Shard& shard, ConnectionId id, Connection& connection) noexcept;
+
+    /**
+     * @brief Cancel or re-arm the multishot recv to follow the handler's backpressure state
+     * (owning loop only, shard mutex held)
+     */
+    void update_uring_reads(Shard& shard, ConnectionId id, Connection& connection) noexcept;
+
+    /**
+     * @brief Submit send chains for queued connections
+     */
+    void flush_uring_output(Shard& shard) noexcept;
+
+    /**
+     * @brief Shut a socket down and erase it once the kernel has let go of it
+     * (shard mutex held)
+     */
+    void begin_uring_close(Shard& shard, Connection& connection) noexcept;
+    void reap_if_done(Shard& shard, ConnectionId id, Connection& connection) noexcept;
 
     /**
      * @brief Handle client read event
+     * @param hang_up The event reported CLOSED or FAILED (read through to the EOF or error)
+     */
+    void handle_client_read(Shard& shard, ConnectionId id, bool hang_up = false) noexcept;
+
+    /**
+     * @brief Continue reading sockets whose read budget ran out on the last pass
+     */
+    void resume_budgeted_reads(Shard& shard) noexcept;
+
+    /**
+     * @brief Release zero-copy payloads the kernel reported done
+     * @return true if the error queue held completions (the FAILED event is explained)
      */
-    void handle_client_read(SOCKET client_socket) noexcept;
+    bool handle_client_error_queue(Shard& shard, ConnectionId id) noexcept;
 
     /**
      * @brief Handle client write event
      */
-    void handle_client_write(SOCKET client_socket) noexcept;
+    void handle_client_write(Shard& shard, ConnectionId id) noexcept;
 
     /**
      * @brief Connection closed callback
@@ -1,28 +1,30 @@
 #pragma once
 
-#include <winsock2.h>
-#include <ws2ipdef.h>
+#include "PlatformSocket.h"
+#include "SocketOptions.h"
 #include <string>
 #include <memory>
 #include <functional>
 #include <atomic>
 
-#pragma comment(lib, "ws2_32.lib")
-
 namespace core {
 namespace net {
 
 /**
- * @brief RAII wrapper for async WinSock operations
+ * @brief RAII wrapper for non-blocking socket operations
  * 
  * Demonstrates:
- * - WinSock2 async socket operations
+ * - Portable WinSock2 / BSD socket operations
  * - RAII resource management for sockets
- * - Event-based notification
+ * - Readiness notification through Reactor (or WinSock events)
+ * - TCP or Unix domain stream sockets (filesystem path, or "@name" for Linux's abstract namespace)
+ * - Socket tuning (SocketOptions) applied to listening and connecting sockets
  */
 class AsyncSocket {
 public:
+#ifdef _WIN32
     using EventHandler = std::function<void(WSANETWORKEVENTS)>;
+#endif
 
     /**
      * @brief Construct an async socket
@@ -45,24 +47,74 @@ public:
     AsyncSocket& operator=(AsyncSocket&&) = delete;
 
     /**
-     * @brief Initialize Winsock
+     * @brief Initialize Winsock (no-op on POSIX)
      * @return true if successful
      */
     static bool initialize_winsock() noexcept;
 
     /**
-     * @brief Cleanup Winsock
+     * @brief Cleanup Winsock (no-op on POSIX)
      */
     static void cleanup_winsock() noexcept;
 
+    /**
+     * @brief Set options for the sockets created from now on
+     * Listeners get them before bind()/listen(); accepted sockets inherit them
+     * (set explicitly where the platform doesn't pass them on).
+     */
+    void set_options(const SocketOptions& options) noexcept
+    {
+        m_options = options;
+    }
+
+    /**
+     * @brief Get options applied to created sockets
+     */
+    [[nodiscard]] const SocketOptions& get_options() const noexcept
+    {
+        return m_options;
+    }
+
     /**
      * @brief Create a listening socket
      * @param listen_address Address to listen on
      * @param port Port to listen on
      * @param backlog Connection backlog
+     * @param reuse_port Set SO_REUSEPORT so several sockets can share the port (kernel load-balances accepts)
+     * @return true if successful
+     */
+    bool create_listening_socket(const std::string& listen_address, uint16_t port, int backlog = SOMAXCONN,
+                                 bool reuse_port = false) noexcept;
+
+    /**
+     * @brief Create a listening Unix domain stream socket
+     * A leftover socket file nobody is listening on is replaced; the file is removed again
+     * when this socket is destroyed. Abstract names ("@name") leave nothing on disk.
+     * @param path Filesystem path, or "@name" for the abstract namespace (Linux)
+     * @param backlog Connection backlog
+     * @return true if successful
+     */
+    bool create_unix_listening_socket(const std::string& path, int backlog = SOMAXCONN) noexcept;
+
+    /**
+     * @brief Share another socket's listening queue through a duplicated handle
+     * Lets several pollers accept from a listener that can't use SO_REUSEPORT.
+     * @param listen_socket Listening socket owned by someone else
      * @return true if successful
      */
-    bool create_listening_socket(const std::string& listen_address, uint16_t port, int backlog = 5) noexcept;
+    bool adopt_listening_socket(SOCKET listen_socket) noexcept;
+
+    /**
+     * @brief Check if the platform can load-balance one port across listening sockets
+     */
+    [[nodiscard]] static constexpr bool supports_reuse_port() noexcept
+    {
+#if defined(SO_REUSEPORT) && !defined(_WIN32)
+        return true;
+#else
+        return false;
+#endif
+    }
 
     /**
      * @brief Accept incoming connection
@@ -72,6 +124,17 @@ public:
      */
     [[nodiscard]] SOCKET accept_connection(std::string& client_addr, uint16_t& client_port) noexcept;
 
+    /**
+     * @brief Accept incoming connection without formatting its address
+     * Uses accept4(SOCK_NONBLOCK | SOCK_CLOEXEC) where available, so the socket
+     * comes back ready for the reactor in one syscall.
+     * @param peer Output: raw client address
+     * @return SOCKET handle for accepted connection, INVALID_SOCKET on error or
+     *         when the backlog is drained (check is_would_block(last_socket_error()));
+     *         running out of descriptors (is_resource_exhausted()) is left for the caller to report
+     */
+    [[nodiscard]] SOCKET accept_connection(PeerAddress& peer) noexcept;
+
     /**
      * @brief Connect to remote server
      * @param remote_address Remote server address
@@ -80,6 +143,14 @@ public:
      */
     bool connect(const std::string& remote_address, uint16_t remote_port) noexcept;
 
+    /**
+     * @brief Connect to a Unix domain stream socket
+     * @param path Filesystem path, or "@name" for the abstract namespace (Linux)
+     * @return true if successful (the connection may still be in progress)
+     */
+    bool connect_unix(const std::string& path) noexcept;
+
+#ifdef _WIN32
     /**
      * @brief Set socket to async mode with event notifications
      * @param hEventObject Windows event object for notifications
@@ -87,6 +158,7 @@ public:
      * @return true if successful
      */
     bool set_async_mode(WSAEVENT hEventObject, long lNetworkEvents) noexcept;
+#endif
 
     /**
      * @brief Send data on socket
@@ -120,6 +192,11 @@ public:
         return m_socket;
     }
 
+    /**
+     * @brief Get locally bound port (resolves port 0 to the ephemeral port)
+     */
+    [[nodiscard]] uint16_t get_local_port() const noexcept;
+
     /**
      * @brief Check if socket is valid
      */
@@ -137,6 +214,9 @@ private:
     SOCKET m_socket;
     std::string m_address;
     uint16_t m_port;
+    std::string m_bound_path;      // Socket file to remove on close (filesystem Unix listeners only)
+    SocketOptions m_options;
+    bool m_is_tcp{false};
     static std::atomic<int> s_winsock_count;
 
     [[nodiscard]] std::string get_address_from_socket(SOCKET s) const noexcept;
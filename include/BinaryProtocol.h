@@ -23,7 +23,8 @@ namespace protocol {
  * ???????????????????????????????????????????
  * ? Payload (Variable)                      ?
  * ???????????????????????????????????????????
- * ? Checksum (4 bytes): CRC32               ?
+ * ? Checksum (4 bytes): CRC32 (CRC32C if    ?
+ * ?   flag 0x08 is set)                     ?
  * ???????????????????????????????????????????
  */
 
@@ -54,7 +55,8 @@ enum class FrameFlags : uint8_t {
     NONE = 0x00,
     ACK_REQUIRED = 0x01,
     COMPRESSED = 0x02,
-    ENCRYPTED = 0x04
+    ENCRYPTED = 0x04,
+    CRC32C = 0x08           // Checksum is CRC32C (Castagnoli) instead of CRC32
 };
 
 /**
@@ -66,7 +68,7 @@ struct FrameHeader {
     uint8_t message_type;       // Message type ID
     uint8_t flags;              // Frame flags
     uint16_t payload_length;    // Length of payload
-    uint16_t reserved;          // Reserved for future use
+    uint16_t reserved;          // Reserved; AsyncClient puts its request id here (0 = none)
 
     /**
      * @brief Validate header consistency
@@ -101,6 +103,11 @@ struct FrameHeader {
 
 /**
  * @brief CRC32 calculation for checksums
+ *
+ * calculate() picks an implementation once, on first use:
+ * - carry-less multiply folding (PCLMULQDQ) on x86-64 CPUs that have it, for 64+ bytes
+ * - slicing-by-16 otherwise: 16 compile-time tables, 16 bytes per step
+ * All paths produce the standard (zlib/IEEE 802.3) CRC32.
  */
 namespace crc32 {
     /**
@@ -110,6 +117,72 @@ namespace crc32 {
      * @return CRC32 checksum
      */
     [[nodiscard]] uint32_t calculate(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Calculate CRC32 with the portable slicing-by-16 tables
+     */
+    [[nodiscard]] uint32_t calculate_portable(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Check if the CPU supports the carry-less multiply path
+     */
+    [[nodiscard]] bool has_hardware_support() noexcept;
+
+    /**
+     * @brief Calculate CRC32 by carry-less multiply folding
+     * Only call when has_hardware_support() is true.
+     */
+    [[nodiscard]] uint32_t calculate_hardware(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Get the name of the implementation calculate() uses
+     */
+    [[nodiscard]] const char* implementation_name() noexcept;
+}
+
+/**
+ * @brief CRC32C (Castagnoli) calculation for frames flagged FrameFlags::CRC32C
+ *
+ * calculate() uses the SSE4.2 crc32 instruction where available, running three
+ * independent streams to hide its latency; slicing-by-16 tables otherwise.
+ */
+namespace crc32c {
+    /**
+     * @brief Calculate CRC32C checksum
+     * @param data Data buffer
+     * @param length Data length
+     * @return CRC32C checksum
+     */
+    [[nodiscard]] uint32_t calculate(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Calculate CRC32C with the portable slicing-by-16 tables
+     */
+    [[nodiscard]] uint32_t calculate_portable(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Check if the CPU has the SSE4.2 crc32 instruction
+     */
+    [[nodiscard]] bool has_hardware_support() noexcept;
+
+    /**
+     * @brief Calculate CRC32C with the SSE4.2 crc32 instruction
+     * Only call when has_hardware_support() is true.
+     */
+    [[nodiscard]] uint32_t calculate_hardware(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Get the name of the implementation calculate() uses
+     */
+    [[nodiscard]] const char* implementation_name() noexcept;
+}
+
+/**
+ * @brief Checksum a frame payload with the algorithm the header's flags select
+ */
+[[nodiscard]] inline uint32_t frame_checksum(const FrameHeader& header, const uint8_t* payload, size_t length) noexcept {
+    return header.has_flag(FrameFlags::CRC32C) ? crc32c::calculate(payload, length)
+                                               : crc32::calculate(payload, length);
 }
 
 } // namespace protocol
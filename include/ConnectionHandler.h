@@ -1,28 +1,61 @@
 #pragma once
 
-#include <winsock2.h>
+#include "PlatformSocket.h"
 #include <memory>
 #include <string>
 #include <functional>
 #include <atomic>
-#include "BufferWrapper.h"
+#include <deque>
+#include <utility>
+#include <vector>
+#include "FrameDecoder.h"
+#include "OutputQueue.h"
+#include "RateLimiter.h"
+#include "ShmTransport.h"
 
 namespace core {
 namespace net {
 
+/**
+ * @brief Zero-copy send counters shared by the connections of a server
+ * Each eligible send lands in exactly one counter. A MSG_ZEROCOPY send is counted as
+ * zero-copy when issued and moved to copied_sends if the kernel later reports a copy.
+ */
+struct ZeroCopyStats {
+    std::atomic<size_t> zerocopy_sends{0};  // Sends transmitted from pinned pages
+    std::atomic<size_t> copied_sends{0};    // Eligible sends that ended up copied after all
+};
+
+/**
+ * @brief Byte counters shared by a group of connections
+ * Updated with relaxed atomics on every transfer, so readers can sum them at any time.
+ */
+struct TrafficStats {
+    std::atomic<size_t> bytes_received{0};
+    std::atomic<size_t> bytes_sent{0};
+};
+
 /**
  * @brief Handles a single client connection
  * 
  * Demonstrates:
  * - Per-connection state management
  * - RAII for connection resources
- * - Async read/write operations
+ * - Async read/write operations, reads drained until EAGAIN into an adaptively sized buffer
  * - Callback-based event handling
+ * - Backpressure: output high/low watermarks gate reads
+ * - Token-bucket rate limits checked as input is delivered; over the limit reads pause,
+ *   so TCP flow control pushes back on the client instead of the server buffering
+ * - MSG_ZEROCOPY for large shared payloads, pinned until the error queue reports completion
+ * - Optional shared-memory transport: the same stream carried over a ShmChannel
+ * - Optional frame decoding: input reassembled into protocol frames across reads
  */
 class ConnectionHandler {
 public:
     using DataReceivedCallback = std::function<void(const uint8_t*, size_t)>;
     using ConnectionClosedCallback = std::function<void()>;
+    using WatermarkCallback = std::function<void(bool above_high_watermark)>;
+    using FrameCallback = std::function<void(const protocol::FrameView&)>;
 
     /**
      * @brief Construct a connection handler
@@ -32,6 +65,15 @@ public:
      */
     ConnectionHandler(SOCKET client_socket, const std::string& client_address, uint16_t client_port);
 
+    /**
+     * @brief Construct a connection handler from a raw peer address
+     * The address is only formatted if get_client_address()/get_client_port() is called;
+     * an empty peer is resolved with getpeername() at that point.
+     * @param client_socket Connected client socket
+     * @param peer Client address as returned by accept
+     */
+    ConnectionHandler(SOCKET client_socket, const PeerAddress& peer);
+
     /**
      * @brief Destructor - closes connection
      */
@@ -53,6 +95,27 @@ public:
         m_on_data_received = callback;
     }
 
+    /**
+     * @brief Decode input into frames and pass each complete frame to callback
+     * Frames split across reads are reassembled; the payload view is valid for the
+     * duration of the callback only. A corrupt frame closes the connection under
+     * CorruptionPolicy::DISCONNECT and is skipped under RESYNC. Works alongside the
+     * data received callback, which still sees the raw bytes.
+     * @param callback Frame handler (nullptr stops decoding and drops buffered bytes)
+     * @param policy Reaction to a frame that fails validation
+     * @return false if the decoder couldn't be allocated
+     */
+    bool set_frame_callback(FrameCallback callback,
+                            protocol::CorruptionPolicy policy = protocol::CorruptionPolicy::DISCONNECT) noexcept;
+
+    /**
+     * @brief Get the frame decoder (nullptr unless a frame callback is set)
+     */
+    [[nodiscard]] const protocol::FrameDecoder* get_frame_decoder() const noexcept
+    {
+        return m_decoder.get();
+    }
+
     /**
      * @brief Set callback for connection closed
      */
@@ -62,30 +125,237 @@ public:
     }
 
     /**
-     * @brief Handle read event - attempt to receive data
-     * @return true if data was received, false if connection closed or no data available
+     * @brief Set callback for output watermark crossings
+     * Called with true when queued output rises above the high watermark and
+     * with false once it drains back to the low watermark.
      */
-    bool handle_read_event() noexcept;
+    void set_watermark_callback(WatermarkCallback callback) noexcept
+    {
+        m_on_watermark = callback;
+    }
+
+    /**
+     * @brief Also count this connection's bytes in shared counters
+     * @param stats Counters to add to (nullptr detaches); must outlive the handler
+     */
+    void set_traffic_stats(TrafficStats* stats) noexcept
+    {
+        m_traffic_stats = stats;
+    }
+
+    /**
+     * @brief Bound queued output: reads pause above high, resume at or below low
+     * @param low_watermark Resume threshold in bytes
+     * @param high_watermark Pause threshold in bytes (SIZE_MAX disables)
+     */
+    void set_output_watermarks(size_t low_watermark, size_t high_watermark) noexcept;
+
+    /**
+     * @brief Check if the owner should stop reading (output above the high watermark or rate limited)
+     */
+    [[nodiscard]] bool is_read_paused() const noexcept
+    {
+        return m_above_high_watermark || m_rate_limited;
+    }
+
+    /**
+     * @brief Enforce message/byte rate limits on input
+     * Without a frame decoder every delivery of received bytes counts as one message; with one,
+     * each decoded frame does, and frames past the limit stay buffered in the decoder. Once a
+     * bucket runs dry reads pause; the owner calls resume_if_rate_allows() after get_rate_limit_delay_ms().
+     * @param limiter Limiter for this connection (nullptr removes limits)
+     */
+    void set_rate_limiter(std::unique_ptr<RateLimiter> limiter) noexcept;
 
     /**
-     * @brief Handle write event - attempt to send buffered data
-     * @return true if data was sent, false if would block
+     * @brief Check if reads are paused by the rate limiter
+     */
+    [[nodiscard]] bool is_rate_limited() const noexcept
+    {
+        return m_rate_limited;
+    }
+
+    /**
+     * @brief Get milliseconds until the rate limiter may let reads resume (rounded up)
+     */
+    [[nodiscard]] uint32_t get_rate_limit_delay_ms() const noexcept;
+
+    /**
+     * @brief Lift the rate-limit pause if the buckets have refilled
+     * Frames left buffered in the decoder are dispatched right away, which may queue output,
+     * close the connection or use the buckets up again.
+     * @return true if no longer rate limited
+     */
+    bool resume_if_rate_allows() noexcept;
+
+    /**
+     * @brief Handle read event - receive until the socket is drained
+     * Stops early when the budget is spent, reads get paused or the connection closes.
+     * The read buffer grows while recv() fills it and shrinks back after a run of small reads.
+     * @param budget Most bytes to read in this call (fairness across connections)
+     * @param hang_up The readiness event reported CLOSED or FAILED: read on until recv()
+     *        returns 0 or an error instead of stopping at a short read
+     * @return true if the budget ran out with input possibly still waiting in the socket
+     */
+    bool handle_read_event(size_t budget = SIZE_MAX, bool hang_up = false) noexcept;
+
+    /**
+     * @brief Get current read buffer capacity (0 until the first read)
+     */
+    [[nodiscard]] size_t get_read_buffer_size() const noexcept
+    {
+        return m_read_buffer.size();
+    }
+
+    /**
+     * @brief Handle write event - flush queued output with gathered sends
+     * Keeps sending up to MAX_IO_SLICES segments per syscall until the queue is
+     * empty or the socket buffer is full.
+     * @return true if output is still pending, false if drained, blocked on nothing or failed
      */
     bool handle_write_event() noexcept;
 
     /**
      * @brief Send data to client
+     * Whatever the socket doesn't take immediately is queued; there is no size limit.
      * @param data Data to send
      * @param length Data length
      * @return true if queued/sent, false if error
      */
     bool send_data(const uint8_t* data, size_t length) noexcept;
 
+    /**
+     * @brief Send a shared payload to client
+     * Same as send_data() except the queue keeps a reference instead of a copy.
+     * @return true if queued/sent, false if error
+     */
+    bool send_shared(const SharedBuffer& buffer) noexcept;
+
+    /**
+     * @brief Send payloads of at least threshold bytes with MSG_ZEROCOPY (Linux)
+     * Large send_data() payloads are queued as shared buffers so they qualify too.
+     * Each payload stays referenced until reap_zerocopy_completions() sees the kernel
+     * release it. Smaller writes keep the copying path.
+     * @param threshold Minimum payload size; 0 disables zero-copy
+     * @param stats Optional counters shared across connections
+     * @return false if the socket doesn't support zero-copy (copying path stays in use)
+     */
+    bool enable_zerocopy(size_t threshold, ZeroCopyStats* stats) noexcept;
+
+    /**
+     * @brief Hold TCP_CORK while handle_write_event() writes
+     * The kernel then sends only full segments and pushes the tail when the flush ends,
+     * instead of one partial segment per send. TCP sockets on the readiness path only.
+     */
+    void set_cork_flushes(bool enabled) noexcept
+    {
+        m_cork_flushes = enabled;
+    }
+
+    /**
+     * @brief Drain zero-copy completions from the socket error queue
+     * @return true if at least one notification was consumed
+     */
+    bool reap_zerocopy_completions() noexcept;
+
+    /**
+     * @brief Get number of zero-copy sends the kernel hasn't released yet
+     */
+    [[nodiscard]] size_t get_zerocopy_in_flight() const noexcept
+    {
+        return m_zerocopy_in_flight.size();
+    }
+
+    /**
+     * @brief Hand socket I/O to a completion engine (io_uring)
+     * In completion mode send_data() only queues, the engine collects output
+     * through gather_output()/consume_output() and pushes input through
+     * deliver_received(), and no read buffer is allocated.
+     */
+    void set_completion_mode(bool enabled) noexcept
+    {
+        m_completion_mode = enabled;
+    }
+
+    /**
+     * @brief Check if socket I/O is driven by a completion engine
+     */
+    [[nodiscard]] bool is_completion_mode() const noexcept
+    {
+        return m_completion_mode;
+    }
+
+    /**
+     * @brief Carry this connection's bytes over shared memory instead of the socket
+     * The socket stays open only to detect the peer going away; reads drain the
+     * channel and writes go straight into it. Call before the first read.
+     * @param channel Channel whose handshake went out on this connection's socket
+     * @return false if no channel was given or the connection is in completion mode
+     */
+    bool attach_shm(std::unique_ptr<ShmChannel> channel) noexcept;
+
+    /**
+     * @brief Check if bytes travel over shared memory
+     */
+    [[nodiscard]] bool is_shm() const noexcept
+    {
+        return m_shm != nullptr;
+    }
+
+    /**
+     * @brief Get the doorbell to poll for shared-memory input (-1 without a channel)
+     */
+    [[nodiscard]] int get_shm_doorbell() const noexcept
+    {
+        return m_shm ? m_shm->doorbell_fd() : -1;
+    }
+
+    /**
+     * @brief Account and dispatch bytes received by the I/O engine
+     * @return true if the connection is still active
+     */
+    bool deliver_received(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Mark connection closed by the peer or an I/O error
+     */
+    void mark_closed() noexcept;
+
+    /**
+     * @brief Describe queued output as slices without copying
+     * @param slices Output array
+     * @param max_slices Capacity of output array
+     * @return Number of slices written
+     */
+    size_t gather_output(IoSlice* slices, size_t max_slices) const noexcept;
+
+    /**
+     * @brief Drop bytes the I/O engine has finished sending
+     */
+    void consume_output(size_t bytes) noexcept;
+
+    /**
+     * @brief Check if queued data is waiting for a write event
+     */
+    [[nodiscard]] bool has_pending_output() const noexcept
+    {
+        return !m_output.empty();
+    }
+
+    /**
+     * @brief Get number of bytes queued for sending
+     */
+    [[nodiscard]] size_t get_pending_output_bytes() const noexcept
+    {
+        return m_output.size();
+    }
+
     /**
      * @brief Get client address
      */
     [[nodiscard]] const std::string& get_client_address() const noexcept
     {
+        resolve_address();
         return m_client_address;
     }
 
@@ -94,6 +364,7 @@ public:
      */
     [[nodiscard]] uint16_t get_client_port() const noexcept
     {
+        resolve_address();
         return m_client_port;
     }
 
@@ -118,7 +389,7 @@ public:
      */
     [[nodiscard]] size_t get_bytes_received() const noexcept
     {
-        return m_bytes_received;
+        return m_bytes_received.load(std::memory_order_relaxed);
     }
 
     /**
@@ -126,7 +397,7 @@ public:
      */
     [[nodiscard]] size_t get_bytes_sent() const noexcept
     {
-        return m_bytes_sent;
+        return m_bytes_sent.load(std::memory_order_relaxed);
     }
 
     /**
@@ -135,22 +406,120 @@ public:
     void close() noexcept;
 
 private:
-    static constexpr size_t BUFFER_SIZE = 4096;
+    static constexpr size_t MIN_READ_BUFFER = 4096;
+    static constexpr size_t MAX_READ_BUFFER = 64 * 1024;
+    static constexpr size_t SHRINK_AFTER_SMALL_READS = 8;   // Reads using at most a quarter of the buffer
+    static constexpr size_t DECODER_READ_SIZE = 16 * 1024;  // Free decoder space asked for per read
+
+    /**
+     * @brief Format the peer address on first request
+     */
+    void resolve_address() const noexcept;
+
+    /**
+     * @brief Get space for the next read: the frame decoder's free space when one is
+     *        attached (frames are reassembled where recv() puts them), else the read buffer
+     * @param capacity Set to the usable length
+     * @return nullptr if memory ran out
+     */
+    uint8_t* prepare_read(size_t& capacity) noexcept;
+
+    /**
+     * @brief Account and dispatch length bytes read into the space from prepare_read()
+     */
+    void complete_read(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Resize the read buffer after a recv() of bytes_read bytes
+     */
+    void adapt_read_buffer(size_t bytes_read) noexcept;
+
+    /**
+     * @brief Account transferred bytes here and in the shared counters
+     */
+    void count_received(size_t bytes) noexcept;
+    void count_sent(size_t bytes) noexcept;
+
+    /**
+     * @brief Count received bytes, charge the rate limiter and run the data callback
+     */
+    void note_received(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Dispatch the complete frames buffered in the frame decoder
+     */
+    void decode_frames() noexcept;
+
+    /**
+     * @brief Update read pausing after the output queue grew or drained
+     */
+    void check_watermarks() noexcept;
+
+    /**
+     * @brief Push newly queued output (or leave it to the completion engine)
+     * @return true unless the connection failed
+     */
+    bool flush_queued_output() noexcept;
+
+    /**
+     * @brief Shared-memory counterpart of handle_read_event()
+     */
+    bool handle_shm_read(size_t budget) noexcept;
+
+    /**
+     * @brief Copy queued output into the channel until it fills
+     * @return true if output remains queued
+     */
+    bool flush_to_shm() noexcept;
 
     SOCKET m_client_socket;
-    std::string m_client_address;
-    uint16_t m_client_port;
+
+    // Formatted lazily from m_peer on first use
+    mutable PeerAddress m_peer;
+    mutable std::string m_client_address;
+    mutable uint16_t m_client_port{0};
+    mutable bool m_address_resolved{false};
     std::atomic<bool> m_is_active{true};
+    bool m_completion_mode{false};
+
+    // Allocated on first readiness-driven read; unused in completion mode
+    std::vector<uint8_t> m_read_buffer;
+    size_t m_small_reads{0};
+    bool m_hung_up{false};          // Sticky: reads resumed after a budget stop must still reach the EOF
+    OutputQueue m_output;
+
+    // Zero-copy sends awaiting completion, keyed by the kernel's per-socket counter
+    size_t m_zerocopy_threshold{0};
+    ZeroCopyStats* m_zerocopy_stats{nullptr};
+    uint32_t m_zerocopy_next_id{0};
+    std::deque<std::pair<uint32_t, SharedBuffer>> m_zerocopy_in_flight;
+
+    bool m_cork_flushes{false};
+
+    // Shared-memory transport; the socket then only signals hang-up
+    std::unique_ptr<ShmChannel> m_shm;
+
+    // Backpressure (disabled by default)
+    size_t m_low_watermark{0};
+    size_t m_high_watermark{SIZE_MAX};
+    bool m_above_high_watermark{false};
+
+    // Rate limiting (none by default)
+    std::unique_ptr<RateLimiter> m_rate_limiter;
+    bool m_rate_limited{false};
 
-    BufferWrapper<uint8_t> m_read_buffer{BUFFER_SIZE};
-    BufferWrapper<uint8_t> m_write_buffer{BUFFER_SIZE};
-    size_t m_write_pos{0};
+    // Written by the I/O thread only, readable from any thread
+    std::atomic<size_t> m_bytes_received{0};
+    std::atomic<size_t> m_bytes_sent{0};
+    TrafficStats* m_traffic_stats{nullptr};
 
-    size_t m_bytes_received{0};
-    size_t m_bytes_sent{0};
+    // Frame reassembly (off unless a frame callback is set)
+    std::unique_ptr<protocol::FrameDecoder> m_decoder;
+    FrameCallback m_on_frame;
 
     DataReceivedCallback m_on_data_received;
     ConnectionClosedCallback m_on_connection_closed;
+    WatermarkCallback m_on_watermark;
 };
 
 } // namespace net
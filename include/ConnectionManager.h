@@ -1,7 +1,8 @@
 #pragma once
 
 #include "ConnectionHandler.h"
-#include <map>
+#include "SlotTable.h"
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -13,16 +14,24 @@ namespace net {
  * @brief Manages all active client connections
  * 
  * Demonstrates:
- * - Thread-safe connection registry
+ * - Thread-safe connection registry split into independently locked shards
+ * - Lock-free statistics: per-shard relaxed atomic counters, summed on demand
+ *   without blocking connection churn or the I/O threads
+ * - Dense slot table addressed by generational ConnectionIds: O(1) lookup, and an id
+ *   kept after close never reaches the next connection on a recycled socket
  * - Connection lifecycle management
  * - Statistics and monitoring
  */
 class ConnectionManager {
 public:
+    static constexpr size_t DEFAULT_SHARD_COUNT = 16;
+    static constexpr size_t MAX_SHARDS = 64;    // Shard index lives in the id's tag bits
+
     /**
      * @brief Construct connection manager
+     * @param shard_count Number of independently locked shards (clamped to 1..MAX_SHARDS)
      */
-    ConnectionManager() = default;
+    explicit ConnectionManager(size_t shard_count = DEFAULT_SHARD_COUNT);
 
     /**
      * @brief Destructor - closes all connections
@@ -39,30 +48,37 @@ public:
 
     /**
      * @brief Add a new connection
-     * @param client_socket Socket handle
+     * Shards are assigned round-robin. The handler reports its traffic into its
+     * shard's counters from then on.
      * @param handler Connection handler
-     * @return true if added, false if socket already exists
+     * @return Id of the connection, INVALID_CONNECTION_ID if handler is null or out of memory
      */
-    bool add_connection(SOCKET client_socket, std::unique_ptr<ConnectionHandler> handler) noexcept;
+    ConnectionId add_connection(std::unique_ptr<ConnectionHandler> handler) noexcept;
 
     /**
      * @brief Remove a connection
-     * @param client_socket Socket to remove
-     * @return true if removed, false if not found
+     * @param connection Id returned by add_connection()
+     * @return true if removed, false if not found (or the id is stale)
      */
-    bool remove_connection(SOCKET client_socket) noexcept;
+    bool remove_connection(ConnectionId connection) noexcept;
 
     /**
      * @brief Get connection handler
-     * @param client_socket Socket to find
-     * @return Pointer to handler, nullptr if not found
+     * The pointer stays valid until the connection is removed.
+     * @param connection Id returned by add_connection()
+     * @return Pointer to handler, nullptr if not found (or the id is stale)
      */
-    [[nodiscard]] ConnectionHandler* get_connection(SOCKET client_socket) noexcept;
+    [[nodiscard]] ConnectionHandler* get_connection(ConnectionId connection) noexcept;
 
     /**
      * @brief Check if connection exists
      */
-    [[nodiscard]] bool has_connection(SOCKET client_socket) const noexcept;
+    [[nodiscard]] bool has_connection(ConnectionId connection) const noexcept;
+
+    /**
+     * @brief Get ids of all active connections
+     */
+    [[nodiscard]] std::vector<ConnectionId> get_all_ids() const noexcept;
 
     /**
      * @brief Get all active sockets
@@ -70,7 +86,7 @@ public:
     [[nodiscard]] std::vector<SOCKET> get_all_sockets() const noexcept;
 
     /**
-     * @brief Get connection count
+     * @brief Get connection count (lock-free)
      */
     [[nodiscard]] size_t get_connection_count() const noexcept;
 
@@ -80,25 +96,58 @@ public:
     void close_all() noexcept;
 
     /**
-     * @brief Get total bytes received across all connections
+     * @brief Get total bytes received across all connections (lock-free)
+     * Bytes of removed connections are no longer included.
      */
     [[nodiscard]] size_t get_total_bytes_received() const noexcept;
 
     /**
-     * @brief Get total bytes sent across all connections
+     * @brief Get total bytes sent across all connections (lock-free)
+     * Bytes of removed connections are no longer included.
      */
     [[nodiscard]] size_t get_total_bytes_sent() const noexcept;
 
     /**
      * @brief Get statistics for a connection
-     * @param client_socket Socket to query
+     * @param connection Id to query
      * @return Pair of (bytes_received, bytes_sent)
      */
-    [[nodiscard]] std::pair<size_t, size_t> get_connection_stats(SOCKET client_socket) const noexcept;
+    [[nodiscard]] std::pair<size_t, size_t> get_connection_stats(ConnectionId connection) const noexcept;
+
+    /**
+     * @brief Get number of shards
+     */
+    [[nodiscard]] size_t get_shard_count() const noexcept
+    {
+        return m_shards.size();
+    }
 
 private:
-    std::map<SOCKET, std::unique_ptr<ConnectionHandler>> m_connections;
-    mutable std::mutex m_mutex;
+    using HandlerTable = SlotTable<std::unique_ptr<ConnectionHandler>>;
+    static constexpr unsigned SHARD_SHIFT = HandlerTable::TAG_SHIFT;
+
+    // Cache-line aligned so counters of neighbouring shards don't share a line
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        HandlerTable connections;
+        TrafficStats traffic;
+        std::atomic<size_t> count{0};
+    };
+
+    /**
+     * @brief Find the shard an id belongs to
+     * @param local Set to the id with the shard tag stripped
+     * @return Shard, nullptr if the tag is out of range
+     */
+    Shard* shard_of(ConnectionId connection, ConnectionId& local) const noexcept;
+
+    /**
+     * @brief Take a handler's bytes back out of its shard's counters before it goes away
+     */
+    static void release_traffic(Shard& shard, const ConnectionHandler& handler) noexcept;
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::atomic<size_t> m_next_shard{0};
 };
 
 } // namespace net
@@ -3,6 +3,14 @@
 #include <cstdint>
 #include <bit>
 
+// glibc's <endian.h> defines BSD-style LITTLE_ENDIAN/BIG_ENDIAN macros that clash
+// with the enumerators below; the __BYTE_ORDER__ builtins are used instead
+#ifdef __linux__
+    #include <endian.h>
+    #undef LITTLE_ENDIAN
+    #undef BIG_ENDIAN
+#endif
+
 namespace core {
 namespace protocol {
 
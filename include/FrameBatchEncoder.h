@@ -0,0 +1,135 @@
+#pragma once
+
+#include "MessageSerializer.h"
+#include "PlatformSocket.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace core {
+namespace protocol {
+
+/**
+ * @brief Encodes many frames into one gather list for a single writev / sendmsg
+ *
+ * Demonstrates:
+ * - Zero-copy payloads: slices point at the caller's bytes, only headers and checksums are written
+ * - Fixed scratch arena sized up front, so slice pointers never move while the batch grows
+ * - Slice merging: a frame's checksum and the next frame's header sit next to each other
+ *   in the arena and go out as one slice, so n frames need about 2n + 1 slices
+ * - Partial sends advance the slice list in place instead of rebuilding it
+ *
+ * Payloads must stay alive and unchanged until the batch has been sent or cleared.
+ */
+class FrameBatchEncoder {
+public:
+    // Default frames per batch; 2 * max_frames + 1 slices must fit in one send
+    static constexpr size_t DEFAULT_MAX_FRAMES = 256;
+
+    /**
+     * @brief Construct an encoder
+     * @param max_frames Frames per batch, capped so the slices fit in net::MAX_IO_SLICES
+     */
+    explicit FrameBatchEncoder(size_t max_frames = DEFAULT_MAX_FRAMES);
+
+    // Delete copy operations
+    FrameBatchEncoder(const FrameBatchEncoder&) = delete;
+    FrameBatchEncoder& operator=(const FrameBatchEncoder&) = delete;
+
+    // Default move operations
+    FrameBatchEncoder(FrameBatchEncoder&&) noexcept = default;
+    FrameBatchEncoder& operator=(FrameBatchEncoder&&) noexcept = default;
+
+    /**
+     * @brief Append one frame
+     * payload_length is taken from the payload; the checksum follows FrameFlags::CRC32C.
+     * @return false if the batch is full, partly sent, or the frame is invalid
+     */
+    bool add(FrameHeader header, std::span<const uint8_t> payload) noexcept;
+
+    /**
+     * @brief Get the slices still to be sent
+     * Valid until the next add(), consume() or clear().
+     */
+    [[nodiscard]] std::span<const net::IoSlice> slices() const noexcept
+    {
+        return std::span<const net::IoSlice>(m_slices.get() + m_first, m_count - m_first);
+    }
+
+    /**
+     * @brief Drop bytes the socket accepted
+     * Once everything is consumed the encoder is empty again.
+     */
+    void consume(size_t bytes) noexcept;
+
+    /**
+     * @brief Drop all frames (keeps the arena)
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief Check if there is nothing left to send
+     */
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_pending == 0;
+    }
+
+    /**
+     * @brief Check if add() would be refused for lack of room
+     */
+    [[nodiscard]] bool full() const noexcept
+    {
+        return m_frames == m_max_frames;
+    }
+
+    /**
+     * @brief Get number of frames in the batch
+     */
+    [[nodiscard]] size_t get_frame_count() const noexcept
+    {
+        return m_frames;
+    }
+
+    /**
+     * @brief Get number of bytes still to be sent
+     */
+    [[nodiscard]] size_t get_pending_bytes() const noexcept
+    {
+        return m_pending;
+    }
+
+    /**
+     * @brief Get maximum number of frames per batch
+     */
+    [[nodiscard]] size_t get_max_frames() const noexcept
+    {
+        return m_max_frames;
+    }
+
+private:
+    // Header plus checksum written to the arena per frame
+    static constexpr size_t ARENA_BYTES_PER_FRAME = FRAME_HEADER_SIZE + sizeof(uint32_t);
+
+    /**
+     * @brief Append arena bytes, extending the last slice when it ends where they start
+     */
+    void push_arena(const uint8_t* data, size_t length) noexcept;
+
+    size_t m_max_frames;
+    std::unique_ptr<uint8_t[]> m_arena;
+    std::unique_ptr<net::IoSlice[]> m_slices;
+
+    size_t m_arena_used{0};
+    size_t m_count{0};              // Slices built
+    size_t m_first{0};              // First slice not yet fully sent
+    bool m_last_is_arena{false};    // Last slice points into the arena (merge candidate)
+
+    size_t m_frames{0};
+    size_t m_pending{0};
+    bool m_sending{false};          // consume() has started on this batch
+};
+
+} // namespace protocol
+} // namespace core
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "MessageSerializer.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace core {
+namespace protocol {
+
+/**
+ * @brief What FrameDecoder does with a frame that fails validation
+ */
+enum class CorruptionPolicy : uint8_t {
+    DISCONNECT,     // Stop decoding; every later next() reports CORRUPT
+    RESYNC          // Skip to the next magic byte and carry on
+};
+
+/**
+ * @brief Incremental frame decoder for one byte stream
+ *
+ * Demonstrates:
+ * - Streaming reassembly: bytes are fed as they arrive, frames come out once complete
+ * - "Need more bytes" kept apart from "corrupt" (bad magic, version or checksum)
+ * - No rescanning: a parsed header is kept until its frame completes, so each
+ *   further read only checks whether the rest has arrived
+ * - In-place delivery: frames come out as FrameViews into the decoder's buffer, no copy per frame
+ * - Direct receive: prepare()/commit() let recv() write straight into the buffer
+ *
+ * Resynchronizing scans forward from the bad frame's first byte for the next magic
+ * byte; the skipped bytes are counted, and the frame found there must validate in full.
+ */
+class FrameDecoder {
+public:
+    /**
+     * @brief Construct a decoder (allocates on the first feed)
+     * @param policy Reaction to a frame that fails validation
+     */
+    explicit FrameDecoder(CorruptionPolicy policy = CorruptionPolicy::DISCONNECT) noexcept
+        : m_policy(policy)
+    {
+    }
+
+    // Delete copy operations
+    FrameDecoder(const FrameDecoder&) = delete;
+    FrameDecoder& operator=(const FrameDecoder&) = delete;
+
+    // Default move operations
+    FrameDecoder(FrameDecoder&&) noexcept = default;
+    FrameDecoder& operator=(FrameDecoder&&) noexcept = default;
+
+    /**
+     * @brief Append received bytes
+     * Invalidates frames returned earlier.
+     * @return false if the buffer couldn't grow
+     */
+    bool feed(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Get space for at least min_bytes at the end of the buffer
+     * Invalidates frames returned earlier. Write into it, then commit() what was written.
+     * @return Start of the free space (get_writable() bytes long), nullptr if the buffer couldn't grow
+     */
+    uint8_t* prepare(size_t min_bytes) noexcept;
+
+    /**
+     * @brief Add bytes written into the space returned by prepare()
+     */
+    void commit(size_t bytes) noexcept
+    {
+        m_end += bytes;
+    }
+
+    /**
+     * @brief Decode the next frame from the buffered bytes
+     * CORRUPT is only returned under CorruptionPolicy::DISCONNECT.
+     * @param frame Set when FRAME is returned; valid until the next feed(), prepare() or reset()
+     */
+    DecodeStatus next(FrameView& frame) noexcept;
+
+    /**
+     * @brief Drop buffered bytes and any corruption state (keeps the allocation)
+     */
+    void reset() noexcept;
+
+    /**
+     * @brief Get free space after the buffered bytes
+     */
+    [[nodiscard]] size_t get_writable() const noexcept
+    {
+        return m_buffer.size() - m_end;
+    }
+
+    /**
+     * @brief Get bytes received but not yet returned as frames
+     */
+    [[nodiscard]] size_t get_buffered() const noexcept
+    {
+        return m_end - m_start;
+    }
+
+    /**
+     * @brief Get number of frames returned
+     */
+    [[nodiscard]] size_t get_frame_count() const noexcept
+    {
+        return m_frames;
+    }
+
+    /**
+     * @brief Get number of corrupt frames seen
+     */
+    [[nodiscard]] size_t get_corrupt_count() const noexcept
+    {
+        return m_corrupt;
+    }
+
+    /**
+     * @brief Get number of bytes discarded while resynchronizing
+     */
+    [[nodiscard]] size_t get_skipped_bytes() const noexcept
+    {
+        return m_skipped;
+    }
+
+    /**
+     * @brief Check if decoding stopped on a corrupt frame (DISCONNECT policy)
+     */
+    [[nodiscard]] bool is_failed() const noexcept
+    {
+        return m_failed;
+    }
+
+private:
+    static constexpr size_t MIN_CAPACITY = 4096;
+
+    /**
+     * @brief Apply the corruption policy to the frame at m_start
+     * @return true if decoding can continue (resynchronized)
+     */
+    bool on_corrupt() noexcept;
+
+    CorruptionPolicy m_policy;
+
+    // Unparsed bytes live in [m_start, m_end)
+    std::vector<uint8_t> m_buffer;
+    size_t m_start{0};
+    size_t m_end{0};
+
+    // Header of the frame at m_start, parsed once while the rest arrives
+    bool m_have_header{false};
+    FrameHeader m_header{};
+    size_t m_frame_size{0};
+
+    bool m_failed{false};
+    size_t m_frames{0};
+    size_t m_corrupt{0};
+    size_t m_skipped{0};
+};
+
+} // namespace protocol
+} // namespace core
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "PlatformSocket.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace core {
+namespace net {
+
+/**
+ * @brief Completion-based socket I/O on Linux io_uring
+ *
+ * Demonstrates:
+ * - Multishot accept: one submission yields a completion per accepted socket
+ * - Multishot recv into a kernel-provided buffer ring (no per-connection read buffers)
+ * - Linked send submissions so queued output leaves in order
+ * - Submit and wait batched into one io_uring_enter() call
+ *
+ * Talks to the kernel through raw syscalls, so no liburing dependency. On other
+ * platforms is_supported() returns false and every operation fails.
+ * Not thread-safe: all calls except wakeup() belong on the thread that owns the ring.
+ */
+class IoUringEngine {
+public:
+    /**
+     * @brief Operation that produced a completion
+     */
+    enum class Operation : uint8_t {
+        ACCEPT = 1,
+        RECV = 2,
+        SEND = 3,
+        CANCEL = 4,
+        WAKEUP = 5
+    };
+
+    /**
+     * @brief A completed operation
+     */
+    struct Completion {
+        Operation operation;
+        uint64_t token;         // Token supplied at submission (lower 56 bits)
+        int32_t result;         // Bytes transferred, accepted socket, or -errno
+        bool more;              // Multishot request is still armed
+        const uint8_t* data;    // Received bytes (RECV with a buffer only)
+        uint16_t buffer_id;     // Must be passed to recycle_buffer() when data != nullptr
+    };
+
+    using CompletionHandler = std::function<void(const Completion&)>;
+
+    // Longest send chain submitted in one go
+    static constexpr size_t MAX_LINKED_SENDS = 64;
+
+    /**
+     * @brief Create the ring and register the provided-buffer ring
+     * @param queue_depth Submission queue entries
+     * @param buffer_count Receive buffers shared by all connections (power of 2)
+     * @param buffer_size Size of each receive buffer
+     */
+    IoUringEngine(unsigned queue_depth, unsigned buffer_count, size_t buffer_size);
+
+    /**
+     * @brief Destructor - unmaps rings and closes the ring descriptor
+     */
+    ~IoUringEngine() noexcept;
+
+    // Delete copy operations
+    IoUringEngine(const IoUringEngine&) = delete;
+    IoUringEngine& operator=(const IoUringEngine&) = delete;
+
+    // Delete move operations (kernel holds addresses of the rings)
+    IoUringEngine(IoUringEngine&&) = delete;
+    IoUringEngine& operator=(IoUringEngine&&) = delete;
+
+    /**
+     * @brief Check whether the running kernel supports this engine
+     */
+    [[nodiscard]] static bool is_supported() noexcept;
+
+    /**
+     * @brief Check if the ring was set up successfully
+     */
+    [[nodiscard]] bool is_valid() const noexcept;
+
+    /**
+     * @brief Arm a multishot accept on a listening socket
+     */
+    bool accept_multishot(SOCKET listen_socket, uint64_t token) noexcept;
+
+    /**
+     * @brief Arm a multishot recv that selects buffers from the buffer ring
+     */
+    bool recv_multishot(SOCKET socket, uint64_t token) noexcept;
+
+    /**
+     * @brief Queue one send per slice, linked so they complete in order
+     * A failed or short send cancels the rest of the chain (-ECANCELED).
+     * @param count Number of slices (at most MAX_LINKED_SENDS)
+     * @return true if the whole chain was queued
+     */
+    bool send_linked(SOCKET socket, uint64_t token, const IoSlice* slices, size_t count) noexcept;
+
+    /**
+     * @brief Cancel every pending request on a socket
+     */
+    bool cancel(SOCKET socket) noexcept;
+
+    /**
+     * @brief Cancel the request submitted with this operation and token
+     * (e.g. stop a multishot recv while leaving sends alone)
+     */
+    bool cancel(Operation operation, uint64_t token) noexcept;
+
+    /**
+     * @brief Submit queued requests and wait for at least one completion
+     * @param timeout_ms Timeout in milliseconds (-1 = infinite)
+     * @return Number of completions ready, -1 on error
+     */
+    int submit_and_wait(int timeout_ms) noexcept;
+
+    /**
+     * @brief Invoke handler for every ready completion
+     * @return Number of completions processed
+     */
+    size_t process_completions(const CompletionHandler& handler) noexcept;
+
+    /**
+     * @brief Return a receive buffer to the kernel
+     */
+    void recycle_buffer(uint16_t buffer_id) noexcept;
+
+    /**
+     * @brief Interrupt a concurrent submit_and_wait() from any thread
+     */
+    void wakeup() noexcept;
+
+    /**
+     * @brief Get size of each receive buffer
+     */
+    [[nodiscard]] size_t buffer_size() const noexcept
+    {
+        return m_buffer_size;
+    }
+
+private:
+    struct Ring;
+    std::unique_ptr<Ring> m_ring;
+    size_t m_buffer_size;
+};
+
+} // namespace net
+} // namespace core
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace core {
+
+/**
+ * @brief Log-linear latency histogram (HdrHistogram layout)
+ *
+ * Demonstrates:
+ * - Constant-time recording into a fixed array: no allocation, no sorting on the hot path
+ * - Bounded relative error: each power of two is split into 64 linear sub-buckets,
+ *   so any reported value is within 1/64 (~1.6%) of the recorded one
+ * - Coordinated-omission correction: a response that took N expected intervals also
+ *   stands for the N-1 requests a stalled closed-loop client never got to send
+ * - Cheap merging, so each load thread records into its own histogram
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    /**
+     * @brief Record a value (nanoseconds)
+     */
+    void record(uint64_t value, uint64_t count = 1) noexcept;
+
+    /**
+     * @brief Record a value plus the samples a stall hid from a fixed-rate sender
+     * For value > expected_interval, also records value - interval, value - 2 * interval, ...
+     * down to expected_interval.
+     * @param expected_interval Interval between requests the sender meant to keep (0 = plain record)
+     */
+    void record_corrected(uint64_t value, uint64_t expected_interval, uint64_t count = 1) noexcept;
+
+    /**
+     * @brief Copy with coordinated-omission correction applied after the fact
+     * For closed-loop runs, where no send schedule exists, the mean latency is the usual choice of interval.
+     */
+    [[nodiscard]] LatencyHistogram corrected(uint64_t expected_interval) const;
+
+    /**
+     * @brief Add another histogram's samples
+     */
+    void merge(const LatencyHistogram& other) noexcept;
+
+    /**
+     * @brief Get value at a percentile
+     * @param percentile 0 to 100
+     * @return Highest value equivalent to the sample at that rank (0 if empty)
+     */
+    [[nodiscard]] uint64_t percentile(double percentile) const noexcept;
+
+    [[nodiscard]] uint64_t get_count() const noexcept
+    {
+        return m_count;
+    }
+
+    [[nodiscard]] uint64_t get_min() const noexcept
+    {
+        return m_count == 0 ? 0 : m_min;
+    }
+
+    [[nodiscard]] uint64_t get_max() const noexcept
+    {
+        return m_max;
+    }
+
+    [[nodiscard]] double get_mean() const noexcept
+    {
+        return m_count == 0 ? 0.0 : m_sum / static_cast<double>(m_count);
+    }
+
+    /**
+     * @brief Drop all samples
+     */
+    void reset() noexcept;
+
+private:
+    static constexpr unsigned SUB_BUCKET_BITS = 7;
+    static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t{1} << SUB_BUCKET_BITS;   // Values below are exact
+    static constexpr uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKET_COUNT + (64 - SUB_BUCKET_BITS) * SUB_BUCKET_HALF;
+
+    [[nodiscard]] static size_t index_of(uint64_t value) noexcept;
+    [[nodiscard]] static uint64_t lowest_of(size_t index) noexcept;
+    [[nodiscard]] static uint64_t highest_of(size_t index) noexcept;
+
+    std::vector<uint64_t> m_counts;
+    uint64_t m_count{0};
+    uint64_t m_min{UINT64_MAX};
+    uint64_t m_max{0};
+    double m_sum{0.0};
+};
+
+} // namespace core
@@ -1,19 +1,48 @@
 #pragma once
 
 #include "BinaryProtocol.h"
+#include "EndianUtils.h"
 #include "NetworkBuffer.h"
+#include <cstring>
 #include <memory>
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace core {
 namespace protocol {
 
+/**
+ * @brief Result of parsing a frame from received bytes
+ */
+enum class DecodeStatus : uint8_t {
+    FRAME,          // A validated frame was returned
+    NEED_MORE,      // The bytes end inside a frame (or are empty)
+    CORRUPT         // Bad magic, version or checksum
+};
+
+/**
+ * @brief Validated frame seen in place, without copying its payload
+ */
+struct FrameView {
+    FrameHeader header{};
+    std::span<const uint8_t> payload;   // Points into the parsed buffer: valid while that buffer is
+
+    /**
+     * @brief Get the frame's size on the wire (header + payload + checksum)
+     */
+    [[nodiscard]] size_t frame_size() const noexcept {
+        return FRAME_HEADER_SIZE + payload.size() + CHECKSUM_SIZE;
+    }
+};
+
 /**
  * @brief Serializes and deserializes binary protocol messages
  * 
  * Demonstrates:
  * - Frame serialization with header + payload + checksum
+ * - Zero-copy parsing: view_frame() validates in place and returns a payload span
+ * - Per-frame checksum choice: CRC32, or CRC32C when FrameFlags::CRC32C is set
  * - Protocol validation
  * - Error handling
  */
@@ -43,8 +72,55 @@ public:
                                     size_t length,
                                     FrameHeader& header) noexcept;
 
+    /**
+     * @brief Load a header with a single unaligned 8-byte read (not validated)
+     * @param data At least FRAME_HEADER_SIZE bytes
+     */
+    [[nodiscard]] static FrameHeader load_header(const uint8_t* data) noexcept {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        word = EndianUtils::from_little_endian(word);
+
+        FrameHeader header;
+        header.magic = static_cast<uint8_t>(word);
+        header.version = static_cast<uint8_t>(word >> 8);
+        header.message_type = static_cast<uint8_t>(word >> 16);
+        header.flags = static_cast<uint8_t>(word >> 24);
+        header.payload_length = static_cast<uint16_t>(word >> 32);
+        header.reserved = static_cast<uint16_t>(word >> 48);
+        return header;
+    }
+
+    /**
+     * @brief Store a header with a single unaligned 8-byte write (not validated)
+     * @param out At least FRAME_HEADER_SIZE bytes
+     */
+    static void store_header(const FrameHeader& header, uint8_t* out) noexcept {
+        uint64_t word = static_cast<uint64_t>(header.magic) |
+                        static_cast<uint64_t>(header.version) << 8 |
+                        static_cast<uint64_t>(header.message_type) << 16 |
+                        static_cast<uint64_t>(header.flags) << 24 |
+                        static_cast<uint64_t>(header.payload_length) << 32 |
+                        static_cast<uint64_t>(header.reserved) << 48;
+        word = EndianUtils::to_little_endian(word);
+        std::memcpy(out, &word, sizeof(word));
+    }
+
+    /**
+     * @brief Parse and validate the frame at the start of data without copying
+     * Nothing is allocated; the view's payload points into data.
+     * @param data Input data
+     * @param length Data length
+     * @param view Output view, set when FRAME is returned
+     * @return FRAME, NEED_MORE if data ends inside the frame, CORRUPT on bad magic, version or checksum
+     */
+    static DecodeStatus view_frame(const uint8_t* data,
+                                   size_t length,
+                                   FrameView& view) noexcept;
+
     /**
      * @brief Deserialize a complete frame
+     * Copies the payload; view_frame() is the allocation-free alternative.
      * @param data Input data
      * @param length Data length
      * @param header Output header
@@ -77,9 +153,10 @@ private:
                                 net::NetworkBuffer& buffer) noexcept;
 
     /**
-     * @brief Serialize payload and checksum
+     * @brief Serialize payload and checksum (CRC32C if the header is flagged so)
      */
-    static bool serialize_payload_and_checksum(const uint8_t* payload,
+    static bool serialize_payload_and_checksum(const FrameHeader& header,
+                                              const uint8_t* payload,
                                               uint16_t payload_length,
                                               net::NetworkBuffer& buffer,
                                               uint32_t& out_checksum) noexcept;
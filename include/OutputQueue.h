@@ -0,0 +1,140 @@
+#pragma once
+
+#include "BufferWrapper.h"
+#include "PlatformSocket.h"
+#include "SharedBuffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace core {
+namespace net {
+
+/**
+ * @brief Unbounded queue of outgoing bytes stored as a chain of segments
+ *
+ * Demonstrates:
+ * - Segmented buffering: appends never move bytes already queued
+ * - Scatter/gather flushing (writev / sendmsg / WSASend) straight from the segments
+ * - Partial sends advance a head offset instead of memmove'ing the remainder
+ * - Small writes coalesce into the tail segment; large payloads get one exact-size segment
+ * - Shared payloads (broadcasts) are queued by reference, never copied
+ *
+ * Bytes already handed to the kernel stay at the same address until consume(),
+ * so a completion engine may keep references to gathered slices in flight.
+ */
+class OutputQueue {
+public:
+    // Capacity of segments created for small writes
+    static constexpr size_t SEGMENT_SIZE = 16 * 1024;
+
+    OutputQueue() = default;
+
+    // Delete copy operations
+    OutputQueue(const OutputQueue&) = delete;
+    OutputQueue& operator=(const OutputQueue&) = delete;
+
+    // Move operations
+    OutputQueue(OutputQueue&&) noexcept = default;
+    OutputQueue& operator=(OutputQueue&&) noexcept = default;
+
+    /**
+     * @brief Copy bytes to the end of the queue
+     * @return true if queued, false if memory could not be allocated
+     */
+    bool append(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Queue a reference to a shared payload without copying it
+     * The reference is dropped once the payload has been consumed.
+     * @return true if queued, false if memory could not be allocated
+     */
+    bool append(const SharedBuffer& buffer) noexcept;
+
+    /**
+     * @brief Describe queued bytes as slices, oldest first, without copying
+     * @param slices Output array
+     * @param max_slices Capacity of output array
+     * @param isolate_shared When non-zero, a shared segment with at least this many
+     *        bytes left is always gathered on its own (for zero-copy sends)
+     * @return Number of slices written
+     */
+    size_t gather(IoSlice* slices, size_t max_slices, size_t isolate_shared = 0) const noexcept;
+
+    /**
+     * @brief Get the shared payload at the head of the queue
+     * @param min_length Minimum number of bytes left in it
+     * @return Payload, nullptr if the head is owned bytes or shorter than min_length
+     */
+    [[nodiscard]] const SharedBuffer* shared_front(size_t min_length) const noexcept;
+
+    /**
+     * @brief Drop bytes from the front after they have been sent
+     */
+    void consume(size_t bytes) noexcept;
+
+    /**
+     * @brief Drop everything
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief Get number of queued bytes
+     */
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief Check if nothing is queued
+     */
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * @brief Get number of segments in the chain
+     */
+    [[nodiscard]] size_t segment_count() const noexcept
+    {
+        return m_segments.size();
+    }
+
+private:
+    struct Segment {
+        std::optional<BufferWrapper<uint8_t>> storage;  // Owned bytes, appendable
+        SharedBuffer shared;                            // Or a read-only shared payload
+        size_t begin{0};
+        size_t end{0};
+
+        explicit Segment(size_t capacity)
+            : storage(std::in_place, capacity)
+        {
+        }
+
+        explicit Segment(const SharedBuffer& buffer)
+            : shared(buffer)
+            , end(buffer.size())
+        {
+        }
+
+        [[nodiscard]] const uint8_t* data() const noexcept
+        {
+            return storage ? storage->data() : shared.data();
+        }
+
+        [[nodiscard]] size_t room() const noexcept
+        {
+            return storage ? storage->size() - end : 0;
+        }
+    };
+
+    std::deque<Segment> m_segments;
+    size_t m_size{0};
+};
+
+} // namespace net
+} // namespace core
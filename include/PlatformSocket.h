@@ -0,0 +1,312 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "ws2_32.lib")
+#else
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <arpa/inet.h>
+    #include <sys/uio.h>
+    #include <climits>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+
+    // WinSock-compatible names so the networking layer reads the same on every platform
+    using SOCKET = int;
+    constexpr SOCKET INVALID_SOCKET = -1;
+    constexpr int SOCKET_ERROR = -1;
+    constexpr int SD_BOTH = SHUT_RDWR;
+    constexpr unsigned long INFINITE = 0xFFFFFFFF;
+#endif
+
+namespace core {
+namespace net {
+
+/**
+ * @brief Thin portability layer over WinSock2 and BSD sockets
+ *
+ * Demonstrates:
+ * - Single source for platform socket differences
+ * - Uniform error classification (would-block vs. real failure)
+ */
+
+// Suppress SIGPIPE on writes to a peer that has gone away (POSIX)
+#if defined(MSG_NOSIGNAL)
+constexpr int SEND_NO_SIGNAL = MSG_NOSIGNAL;
+#else
+constexpr int SEND_NO_SIGNAL = 0;
+#endif
+
+// Transmit straight from user pages; completions arrive on the socket error queue (Linux 4.14+)
+#if defined(__linux__) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+constexpr bool ZEROCOPY_SUPPORTED = true;
+constexpr int SEND_ZEROCOPY = MSG_ZEROCOPY;
+#else
+constexpr bool ZEROCOPY_SUPPORTED = false;
+constexpr int SEND_ZEROCOPY = 0;
+#endif
+
+// Unix domain stream sockets for co-located peers (POSIX; abstract names on Linux only)
+#ifndef _WIN32
+constexpr bool UNIX_SOCKETS_SUPPORTED = true;
+#else
+constexpr bool UNIX_SOCKETS_SUPPORTED = false;
+#endif
+
+/**
+ * @brief Get the last socket error code for the calling thread
+ */
+[[nodiscard]] inline int last_socket_error() noexcept
+{
+#ifdef _WIN32
+    return WSAGetLastError();
+#else
+    return errno;
+#endif
+}
+
+/**
+ * @brief Check whether an error code means "try again later"
+ */
+[[nodiscard]] inline bool is_would_block(int error) noexcept
+{
+#ifdef _WIN32
+    return error == WSAEWOULDBLOCK;
+#else
+    return error == EAGAIN || error == EWOULDBLOCK;
+#endif
+}
+
+/**
+ * @brief Check whether an error code means the process or system ran out of descriptors or memory
+ * accept() fails this way without taking the connection off the backlog, so retrying at once fails again.
+ */
+[[nodiscard]] inline bool is_resource_exhausted(int error) noexcept
+{
+#ifdef _WIN32
+    return error == WSAEMFILE || error == WSAENOBUFS;
+#else
+    return error == EMFILE || error == ENFILE || error == ENOBUFS || error == ENOMEM;
+#endif
+}
+
+/**
+ * @brief Check whether an error code means a non-blocking connect is in progress
+ */
+[[nodiscard]] inline bool is_in_progress(int error) noexcept
+{
+#ifdef _WIN32
+    return error == WSAEWOULDBLOCK;
+#else
+    return error == EINPROGRESS;
+#endif
+}
+
+/**
+ * @brief Close a socket handle
+ */
+inline void close_socket(SOCKET socket) noexcept
+{
+#ifdef _WIN32
+    closesocket(socket);
+#else
+    ::close(socket);
+#endif
+}
+
+/**
+ * @brief Put a socket into non-blocking mode
+ * @return true if successful
+ */
+inline bool set_non_blocking(SOCKET socket) noexcept
+{
+#ifdef _WIN32
+    unsigned long mode = 1;
+    return ioctlsocket(socket, FIONBIO, &mode) != SOCKET_ERROR;
+#else
+    int flags = fcntl(socket, F_GETFL, 0);
+    if (flags < 0) {
+        return false;
+    }
+    return fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+/**
+ * @brief Scatter/gather slice: WSABUF on Windows, iovec elsewhere
+ */
+#ifdef _WIN32
+using IoSlice = WSABUF;
+#else
+using IoSlice = iovec;
+#endif
+
+/**
+ * @brief Build a slice over caller-owned bytes
+ */
+[[nodiscard]] inline IoSlice make_io_slice(const void* data, size_t length) noexcept
+{
+    IoSlice slice;
+#ifdef _WIN32
+    slice.buf = static_cast<CHAR*>(const_cast<void*>(data));
+    slice.len = static_cast<ULONG>(length);
+#else
+    slice.iov_base = const_cast<void*>(data);
+    slice.iov_len = length;
+#endif
+    return slice;
+}
+
+/**
+ * @brief Get slice start
+ */
+[[nodiscard]] inline const uint8_t* io_slice_data(const IoSlice& slice) noexcept
+{
+#ifdef _WIN32
+    return reinterpret_cast<const uint8_t*>(slice.buf);
+#else
+    return static_cast<const uint8_t*>(slice.iov_base);
+#endif
+}
+
+/**
+ * @brief Get slice length
+ */
+[[nodiscard]] inline size_t io_slice_length(const IoSlice& slice) noexcept
+{
+#ifdef _WIN32
+    return slice.len;
+#else
+    return slice.iov_len;
+#endif
+}
+
+/**
+ * @brief Most slices one gathered send accepts
+ */
+#if defined(IOV_MAX)
+constexpr size_t MAX_IO_SLICES = IOV_MAX;
+#else
+constexpr size_t MAX_IO_SLICES = 1024;
+#endif
+
+/**
+ * @brief Send several slices with one syscall (sendmsg / WSASend)
+ * @param flags Extra send flags (e.g. SEND_ZEROCOPY); ignored on Windows
+ * @return Bytes sent, SOCKET_ERROR on error (check last_socket_error())
+ */
+inline int64_t send_slices(SOCKET socket, const IoSlice* slices, size_t count, int flags = 0) noexcept
+{
+#ifdef _WIN32
+    (void)flags;
+    DWORD bytes_sent = 0;
+    if (WSASend(socket, const_cast<IoSlice*>(slices), static_cast<DWORD>(count), &bytes_sent, 0,
+                nullptr, nullptr) == SOCKET_ERROR) {
+        return SOCKET_ERROR;
+    }
+    return static_cast<int64_t>(bytes_sent);
+#else
+    // sendmsg rather than writev: writev can't pass MSG_NOSIGNAL
+    msghdr message{};
+    message.msg_iov = const_cast<IoSlice*>(slices);
+    message.msg_iovlen = static_cast<decltype(message.msg_iovlen)>(count);
+    return ::sendmsg(socket, &message, SEND_NO_SIGNAL | flags);
+#endif
+}
+
+/**
+ * @brief Allow MSG_ZEROCOPY sends on a socket
+ * @return false if the platform or kernel doesn't support it
+ */
+inline bool enable_zerocopy(SOCKET socket) noexcept
+{
+#if defined(__linux__) && defined(SO_ZEROCOPY)
+    int enable = 1;
+    return setsockopt(socket, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0;
+#else
+    (void)socket;
+    return false;
+#endif
+}
+
+/**
+ * @brief Raw peer address captured at accept time, formatted only on demand
+ *
+ * Keeps inet_ntop and string allocation off the accept path; most connections
+ * never need their address as text.
+ */
+struct PeerAddress {
+    sockaddr_storage storage{};
+    socklen_t length{0};
+
+    /**
+     * @brief Check if no address has been captured
+     */
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return length == 0;
+    }
+
+    /**
+     * @brief Format host part as text (IPv4 or IPv6; "unix" for Unix domain peers)
+     */
+    [[nodiscard]] std::string host() const
+    {
+#ifndef _WIN32
+        // Connecting clients are almost always unbound, so there is no path to show
+        if (storage.ss_family == AF_UNIX) {
+            return "unix";
+        }
+#endif
+
+        char buffer[INET6_ADDRSTRLEN] = {};
+        if (storage.ss_family == AF_INET) {
+            const auto* in4 = reinterpret_cast<const sockaddr_in*>(&storage);
+            inet_ntop(AF_INET, &in4->sin_addr, buffer, sizeof(buffer));
+        } else if (storage.ss_family == AF_INET6) {
+            const auto* in6 = reinterpret_cast<const sockaddr_in6*>(&storage);
+            inet_ntop(AF_INET6, &in6->sin6_addr, buffer, sizeof(buffer));
+        }
+        return buffer;
+    }
+
+    /**
+     * @brief Get port in host byte order (0 if not an IP address)
+     */
+    [[nodiscard]] uint16_t port() const noexcept
+    {
+        if (storage.ss_family == AF_INET) {
+            return ntohs(reinterpret_cast<const sockaddr_in*>(&storage)->sin_port);
+        }
+        if (storage.ss_family == AF_INET6) {
+            return ntohs(reinterpret_cast<const sockaddr_in6*>(&storage)->sin6_port);
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Query the remote address of a connected socket
+     */
+    [[nodiscard]] static PeerAddress of_peer(SOCKET socket) noexcept
+    {
+        PeerAddress peer;
+        socklen_t length = sizeof(peer.storage);
+        if (getpeername(socket, reinterpret_cast<sockaddr*>(&peer.storage), &length) == 0) {
+            peer.length = length;
+        }
+        return peer;
+    }
+};
+
+} // namespace net
+} // namespace core
@@ -63,6 +63,14 @@ struct StatusMessage {
     static constexpr MessageType TYPE = MessageType::STATUS;
 };
 
+/**
+ * @brief StatusMessage::status_code values
+ */
+enum StatusCode : uint8_t {
+    STATUS_OK = 0x00,
+    STATUS_GOING_AWAY = 0x01    // Server is shutting down: finish up and reconnect elsewhere
+};
+
 /**
  * @brief Specialized handler for Ping messages
  */
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "PlatformSocket.h"
+#include "ServerConfig.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace core {
+namespace net {
+
+/**
+ * @brief Token bucket in a single atomic word (GCRA form)
+ *
+ * Demonstrates:
+ * - Lock-free token bucket: the state is one "theoretical arrival time"; taking tokens
+ *   pushes it forward with a CAS, refilling is implicit in the clock moving on
+ * - Rate passed per call, so limits can change at runtime without touching buckets
+ * - Safe to share across threads (per-address buckets are used by every shard)
+ */
+class TokenBucket {
+public:
+    static constexpr uint64_t BURST_NS = 1000000000;   // Capacity: one second's worth of tokens
+
+    TokenBucket() = default;
+
+    // Delete copy operations
+    TokenBucket(const TokenBucket&) = delete;
+    TokenBucket& operator=(const TokenBucket&) = delete;
+
+    /**
+     * @brief Check if at least one token is available
+     * @param rate Tokens per second (0 = unlimited)
+     */
+    [[nodiscard]] bool has_tokens(uint64_t rate, uint64_t now_ns) const noexcept
+    {
+        return rate == 0 || m_tat_ns.load(std::memory_order_relaxed) + cost_ns(1, rate) <= now_ns + BURST_NS;
+    }
+
+    /**
+     * @brief Take tokens whatever the balance; overdraft delays has_tokens() until repaid
+     */
+    void take(uint64_t tokens, uint64_t rate, uint64_t now_ns) noexcept;
+
+    /**
+     * @brief Get nanoseconds until has_tokens() turns true (0 if it already is)
+     */
+    [[nodiscard]] uint64_t wait_ns(uint64_t rate, uint64_t now_ns) const noexcept;
+
+private:
+    static uint64_t cost_ns(uint64_t tokens, uint64_t rate) noexcept
+    {
+        return tokens * BURST_NS / rate;
+    }
+
+    std::atomic<uint64_t> m_tat_ns{0};
+};
+
+/**
+ * @brief Aggregate buckets shared by every connection from one client address
+ */
+struct AddressBuckets {
+    TokenBucket messages;
+    TokenBucket bytes;
+};
+
+class RateLimiter;
+
+/**
+ * @brief Runtime-adjustable limits plus the per-address bucket table
+ *
+ * Demonstrates:
+ * - Limits in relaxed atomics: set_*_limits() takes effect on the next message of every connection
+ * - Address buckets shared through refcounts; the table's mutex is only taken when a
+ *   connection first needs its address bucket, never per message
+ */
+class RateLimitRegistry {
+public:
+    RateLimitRegistry() = default;
+
+    // Delete copy operations
+    RateLimitRegistry(const RateLimitRegistry&) = delete;
+    RateLimitRegistry& operator=(const RateLimitRegistry&) = delete;
+
+    /**
+     * @brief Set the limits each connection gets on its own
+     */
+    void set_connection_limits(const RateLimits& limits) noexcept
+    {
+        m_connection_messages.store(limits.messages_per_second, std::memory_order_relaxed);
+        m_connection_bytes.store(limits.bytes_per_second, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Set the limits all connections from one IP address share
+     */
+    void set_address_limits(const RateLimits& limits) noexcept
+    {
+        m_address_messages.store(limits.messages_per_second, std::memory_order_relaxed);
+        m_address_bytes.store(limits.bytes_per_second, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] RateLimits get_connection_limits() const noexcept
+    {
+        return {m_connection_messages.load(std::memory_order_relaxed),
+                m_connection_bytes.load(std::memory_order_relaxed)};
+    }
+
+    [[nodiscard]] RateLimits get_address_limits() const noexcept
+    {
+        return {m_address_messages.load(std::memory_order_relaxed),
+                m_address_bytes.load(std::memory_order_relaxed)};
+    }
+
+    /**
+     * @brief Create the limiter for one connection
+     * @param socket Connected socket (used to look up the peer if peer is empty)
+     * @param peer Peer address as returned by accept, may be empty
+     * @return Limiter, nullptr if out of memory
+     */
+    std::unique_ptr<RateLimiter> make_limiter(SOCKET socket, const PeerAddress& peer) noexcept;
+
+    /**
+     * @brief Get the buckets shared by connections from peer's IP address
+     * @return Buckets, nullptr for non-IP peers (Unix sockets) or if out of memory
+     */
+    std::shared_ptr<AddressBuckets> acquire_address(const PeerAddress& peer) noexcept;
+
+    /**
+     * @brief Get number of addresses with live connections holding their buckets
+     */
+    [[nodiscard]] size_t get_tracked_address_count() const noexcept;
+
+private:
+    static constexpr size_t SWEEP_INTERVAL = 256;   // Acquisitions between purges of dead entries
+
+    std::atomic<uint64_t> m_connection_messages{0};
+    std::atomic<uint64_t> m_connection_bytes{0};
+    std::atomic<uint64_t> m_address_messages{0};
+    std::atomic<uint64_t> m_address_bytes{0};
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::weak_ptr<AddressBuckets>> m_addresses;
+    size_t m_acquisitions{0};
+};
+
+/**
+ * @brief One connection's limiter: its own buckets plus its address's shared ones
+ * Used by the connection's I/O thread only; the shared buckets are lock-free.
+ */
+class RateLimiter {
+public:
+    /**
+     * @brief Construct limiter (see RateLimitRegistry::make_limiter())
+     */
+    RateLimiter(RateLimitRegistry& registry, SOCKET socket, const PeerAddress& peer) noexcept;
+
+    // Delete copy operations
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    /**
+     * @brief Check if another message may be read now
+     */
+    [[nodiscard]] bool admit(uint64_t now_ns) noexcept;
+
+    /**
+     * @brief Account one message of the given size
+     */
+    void charge(size_t bytes, uint64_t now_ns) noexcept
+    {
+        charge(1, bytes, now_ns);
+    }
+
+    /**
+     * @brief Account messages and bytes separately (either may be 0)
+     * Lets a reader that decodes frames charge bytes per read and messages per frame.
+     */
+    void charge(size_t messages, size_t bytes, uint64_t now_ns) noexcept;
+
+    /**
+     * @brief Get nanoseconds until admit() can turn true
+     */
+    [[nodiscard]] uint64_t wait_ns(uint64_t now_ns) noexcept;
+
+    /**
+     * @brief Monotonic clock the limiter works in
+     */
+    static uint64_t now_ns() noexcept;
+
+private:
+    /**
+     * @brief Address buckets, looked up on first use once address limits are set
+     */
+    AddressBuckets* address_buckets(const RateLimits& limits) noexcept;
+
+    RateLimitRegistry& m_registry;
+    SOCKET m_socket;
+    PeerAddress m_peer;
+    TokenBucket m_messages;
+    TokenBucket m_bytes;
+    std::shared_ptr<AddressBuckets> m_address;
+    bool m_address_looked_up{false};
+};
+
+} // namespace net
+} // namespace core
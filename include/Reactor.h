@@ -0,0 +1,156 @@
+#pragma once
+
+#include "PlatformSocket.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+    #include <sys/epoll.h>
+#else
+    #include <mutex>
+    #ifndef _WIN32
+        #include <poll.h>
+    #endif
+#endif
+
+namespace core {
+namespace net {
+
+/**
+ * @brief Readiness-based event demultiplexer
+ *
+ * Demonstrates:
+ * - epoll on Linux: wait cost scales with ready sockets, not registered sockets
+ * - poll/WSAPoll fallback on other platforms
+ * - Optional edge-triggered registration for sockets drained until EAGAIN
+ * - Opaque 64-bit tokens so callers never search for the owner of an event
+ * - Cross-thread wakeup of a blocked wait()
+ */
+class Reactor {
+public:
+    // Interest / readiness bits
+    static constexpr uint32_t READABLE = 0x01;
+    static constexpr uint32_t WRITABLE = 0x02;
+    static constexpr uint32_t CLOSED = 0x04;   // Peer hung up (readiness only)
+    static constexpr uint32_t FAILED = 0x08;   // Socket error pending (readiness only)
+
+    // Interest modifier: report transitions only (EPOLLET); the owner must read until
+    // EAGAIN. Ignored by the poll fallback, which stays level-triggered.
+    static constexpr uint32_t EDGE_TRIGGERED = 0x10;
+
+    /**
+     * @brief A ready socket reported by wait()
+     */
+    struct Event {
+        uint64_t token;     // Token supplied at registration
+        uint32_t events;    // Combination of READABLE | WRITABLE | CLOSED | FAILED
+    };
+
+    /**
+     * @brief Create the poller and its wakeup channel
+     */
+    Reactor();
+
+    /**
+     * @brief Destructor - releases poller and wakeup channel
+     */
+    ~Reactor() noexcept;
+
+    // Delete copy operations
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    // Delete move operations (registered sockets refer to this instance)
+    Reactor(Reactor&&) = delete;
+    Reactor& operator=(Reactor&&) = delete;
+
+    /**
+     * @brief Check if the poller was created successfully
+     */
+    [[nodiscard]] bool is_valid() const noexcept;
+
+    /**
+     * @brief Register a socket
+     * @param socket Socket to watch
+     * @param interest READABLE and/or WRITABLE, optionally EDGE_TRIGGERED
+     * @param token Value reported back in Event::token
+     * @return true if successful
+     */
+    bool add(SOCKET socket, uint32_t interest, uint64_t token) noexcept;
+
+    /**
+     * @brief Change interest set of a registered socket
+     * @param socket Registered socket
+     * @param interest New READABLE/WRITABLE combination
+     * @param token Value reported back in Event::token
+     * @return true if successful
+     */
+    bool modify(SOCKET socket, uint32_t interest, uint64_t token) noexcept;
+
+    /**
+     * @brief Unregister a socket (must be called before the socket is closed)
+     * @return true if successful
+     */
+    bool remove(SOCKET socket) noexcept;
+
+    /**
+     * @brief Wait for ready sockets
+     * @param events Output array
+     * @param max_events Capacity of output array
+     * @param timeout_ms Timeout in milliseconds (-1 = infinite)
+     * @return Number of events written, 0 on timeout or wakeup, -1 on error
+     */
+    int wait(Event* events, size_t max_events, int timeout_ms) noexcept;
+
+    /**
+     * @brief Interrupt a concurrent wait() from any thread
+     */
+    void wakeup() noexcept;
+
+    /**
+     * @brief Get number of registered sockets (excluding the wakeup channel)
+     */
+    [[nodiscard]] size_t registered_count() const noexcept
+    {
+        return m_registered.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr uint64_t WAKEUP_TOKEN = std::numeric_limits<uint64_t>::max();
+
+    std::atomic<size_t> m_registered{0};
+
+#ifdef __linux__
+    int m_epoll_fd{-1};
+    int m_wakeup_fd{-1};
+    std::vector<epoll_event> m_ready;
+
+    void drain_wakeup() noexcept;
+#else
+    // poll()/WSAPoll() fallback: O(registered) per wait, used off Linux only
+#ifdef _WIN32
+    using PollFd = WSAPOLLFD;
+#else
+    using PollFd = pollfd;
+#endif
+    std::vector<PollFd> m_poll_fds;
+    std::vector<uint64_t> m_tokens;
+    std::unordered_map<SOCKET, size_t> m_index;
+    std::vector<PollFd> m_snapshot_fds;
+    std::vector<uint64_t> m_snapshot_tokens;
+    mutable std::mutex m_mutex;
+    std::atomic<bool> m_in_wait{false};
+    SOCKET m_wakeup_socket{INVALID_SOCKET};
+
+    bool update(SOCKET socket, uint32_t interest, uint64_t token, bool is_add) noexcept;
+
+    void drain_wakeup() noexcept;
+#endif
+};
+
+} // namespace net
+} // namespace core
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace core {
+namespace net {
+
+/**
+ * @brief I/O engine driving AsyncServer sockets
+ */
+enum class IoEngine : uint8_t {
+    READINESS,  // Reactor (epoll / poll) + non-blocking recv/send
+    IO_URING    // Completion-based io_uring (Linux only, falls back to READINESS)
+};
+
+/**
+ * @brief Get printable engine name
+ */
+[[nodiscard]] inline const char* to_string(IoEngine engine) noexcept
+{
+    switch (engine) {
+        case IoEngine::READINESS: return "readiness";
+        case IoEngine::IO_URING: return "io_uring";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief What a listener does once the connection limit is reached
+ */
+enum class OverloadPolicy : uint8_t {
+    PAUSE_LISTENER,     // Stop accepting; the kernel backlog absorbs (or refuses) the surge
+    ACCEPT_AND_CLOSE    // Keep draining the backlog and close excess sockets at once
+};
+
+/**
+ * @brief Get printable policy name
+ */
+[[nodiscard]] inline const char* to_string(OverloadPolicy policy) noexcept
+{
+    switch (policy) {
+        case OverloadPolicy::PAUSE_LISTENER: return "pause-listener";
+        case OverloadPolicy::ACCEPT_AND_CLOSE: return "accept-and-close";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Socket option presets for a listener and the connections it accepts
+ */
+enum class SocketProfile : uint8_t {
+    DEFAULT,    // Kernel defaults
+    LATENCY,    // TCP_NODELAY + SO_BUSY_POLL: small responses leave at once, receivers spin briefly
+    THROUGHPUT  // Large SO_SNDBUF/SO_RCVBUF, TCP_CORK held for the length of each flush
+};
+
+/**
+ * @brief Get printable profile name
+ */
+[[nodiscard]] inline const char* to_string(SocketProfile profile) noexcept
+{
+    switch (profile) {
+        case SocketProfile::DEFAULT: return "default";
+        case SocketProfile::LATENCY: return "latency";
+        case SocketProfile::THROUGHPUT: return "throughput";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Token-bucket rates (0 = unlimited)
+ * Buckets hold one second's worth of tokens, so a quiet client may burst that much.
+ */
+struct RateLimits {
+    uint64_t messages_per_second = 0;
+    uint64_t bytes_per_second = 0;
+};
+
+/**
+ * @brief Runtime configuration for AsyncServer
+ *
+ * Demonstrates:
+ * - Aggregate configuration with sensible defaults
+ * - Engine selection at runtime for A/B comparison on the same workload
+ */
+struct ServerConfig {
+    size_t num_worker_threads = 4;
+    size_t num_reactor_threads = 1;        // Shards with their own listener + poller (0 = one per core)
+    IoEngine io_engine = IoEngine::READINESS;
+
+    // Accept path
+    int listen_backlog = 4096;             // Capped by the kernel (net.core.somaxconn)
+    size_t max_connections = 1000;         // Across all shards
+    size_t max_accepts_per_wakeup = 256;   // Bounds one accept burst so established sockets still get served
+    OverloadPolicy overload_policy = OverloadPolicy::PAUSE_LISTENER;
+    uint32_t accept_retry_ms = 100;        // Listener pause after accept runs out of descriptors (EMFILE/ENFILE)
+    SocketProfile socket_profile = SocketProfile::DEFAULT;  // Listener options, inherited by accepted sockets
+
+    // Per-connection backpressure: stop reading above high, resume at or below low
+    size_t output_high_watermark = 1024 * 1024;
+    size_t output_low_watermark = 256 * 1024;
+
+    // Readiness engine read path: drain each socket until EAGAIN, but hand the loop back
+    // after this many bytes so one fast sender can't starve the rest of the shard
+    bool edge_triggered_reads = true;      // EPOLLET registration (ignored by the poll fallback)
+    size_t read_budget_bytes = 256 * 1024;
+
+    // Connection timers, driven by each reactor loop's timer wheel; 0 = off
+    uint32_t idle_timeout_ms = 0;          // Close after this long without receiving anything
+    uint32_t handshake_timeout_ms = 0;     // Close if nothing arrives this long after accept
+    uint32_t heartbeat_interval_ms = 0;    // Send a PING frame this often
+    uint32_t timer_tick_ms = 10;           // Timer resolution
+
+    // Input rate limits, enforced as bytes are delivered (each delivery counts as one message, or
+    // each decoded frame with a frame callback set); over the limit a connection's reads pause. Adjustable later with AsyncServer::set_rate_limits().
+    RateLimits connection_rate_limits;     // Per connection
+    RateLimits address_rate_limits;        // Shared by all connections from one IP address
+
+    // Default echo handler: print a line per read (demo output; turn off when measuring)
+    bool trace_echo = true;
+
+    // Graceful stop(): how long connections get to flush their output after the going-away notice
+    uint32_t drain_timeout_ms = 5000;
+
+    // MSG_ZEROCOPY for payloads of at least this many bytes (readiness engine, Linux); 0 = off.
+    // Pinning pages costs more than copying below roughly 10 KB.
+    size_t zerocopy_threshold = 0;
+
+    // Shared-memory transport (AsyncServer::start_shm): bytes per ring, one ring per direction
+    size_t shm_ring_bytes = 1024 * 1024;
+
+    // io_uring engine
+    unsigned uring_queue_depth = 4096;     // Submission queue entries
+    unsigned uring_buffer_count = 4096;    // Shared receive buffers (power of 2)
+    size_t uring_buffer_size = 4096;       // Bytes per receive buffer
+};
+
+} // namespace net
+} // namespace core
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace core {
+namespace net {
+
+/**
+ * @brief Immutable, reference-counted block of bytes
+ *
+ * Demonstrates:
+ * - Serialize once, share everywhere: copies share one allocation
+ * - Immutability makes sharing across reactor threads safe without locks
+ * - Lifetime ends when the last output queue lets go of its reference
+ *
+ * Used for broadcast fan-out: each connection queues a reference instead of
+ * its own copy of the payload.
+ */
+class SharedBuffer {
+public:
+    /**
+     * @brief Construct an empty buffer
+     */
+    SharedBuffer() noexcept = default;
+
+    /**
+     * @brief Copy bytes into a new shared block
+     * @throws std::bad_alloc if allocation fails
+     */
+    static SharedBuffer copy_of(const uint8_t* data, size_t length)
+    {
+        SharedBuffer buffer;
+        if (length == 0) {
+            return buffer;
+        }
+
+        std::shared_ptr<uint8_t[]> bytes = std::make_shared_for_overwrite<uint8_t[]>(length);
+        std::memcpy(bytes.get(), data, length);
+        buffer.m_bytes = std::move(bytes);
+        buffer.m_size = length;
+        return buffer;
+    }
+
+    /**
+     * @brief Get pointer to the shared bytes
+     */
+    [[nodiscard]] const uint8_t* data() const noexcept
+    {
+        return m_bytes.get();
+    }
+
+    /**
+     * @brief Get number of bytes
+     */
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief Check if buffer holds no bytes
+     */
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * @brief Get number of SharedBuffer objects referencing these bytes
+     */
+    [[nodiscard]] long use_count() const noexcept
+    {
+        return m_bytes.use_count();
+    }
+
+private:
+    std::shared_ptr<const uint8_t[]> m_bytes;
+    size_t m_size{0};
+};
+
+} // namespace net
+} // namespace core
@@ -0,0 +1,348 @@
+#pragma once
+
+#include "AsyncSocket.h"
+#include "PlatformSocket.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace core {
+namespace net {
+
+/**
+ * @brief Single-producer / single-consumer byte ring placed in shared memory
+ *
+ * Demonstrates:
+ * - Lock-free handoff between processes: only the producer moves tail, only the consumer moves head
+ * - Free-running 64-bit positions masked into a power-of-two buffer (no full/empty ambiguity)
+ * - Head, tail and sleep flags on separate cache lines so the two sides don't false-share
+ * - Sleep flags, so the other side is only woken when it has announced it is idle
+ *
+ * A ShmRing is a view: it doesn't own the memory its header and data live in.
+ */
+class ShmRing {
+public:
+    /**
+     * @brief Ring state shared by both processes
+     */
+    struct Header {
+        alignas(64) std::atomic<uint64_t> head;               // Consumer position
+        alignas(64) std::atomic<uint64_t> tail;               // Producer position
+        alignas(64) std::atomic<uint32_t> consumer_waiting;   // Consumer sleeps until rung
+        alignas(64) std::atomic<uint32_t> producer_waiting;   // Producer sleeps until space frees
+        uint64_t capacity;                                    // Power of two
+    };
+
+    // Positions are shared between address spaces: they must never fall back to a lock
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "ShmRing needs lock-free 64-bit atomics");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "ShmRing needs lock-free 32-bit atomics");
+
+    /**
+     * @brief Construct an unattached view
+     */
+    ShmRing() = default;
+
+    /**
+     * @brief Attach to an initialized header and its data area
+     */
+    ShmRing(Header* header, uint8_t* data) noexcept
+        : m_header(header)
+        , m_data(data)
+        , m_mask(header->capacity - 1)
+    {
+    }
+
+    /**
+     * @brief Initialize a header in fresh shared memory
+     * Both sides start out idle, so the first byte written rings the consumer.
+     * @param capacity Data area size, a power of two
+     */
+    static void initialize(Header* header, uint64_t capacity) noexcept;
+
+    /**
+     * @brief Copy as much of data as fits (producer side)
+     * @return Bytes written, 0 if the ring is full or corrupt
+     */
+    size_t write(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Copy out up to length bytes (consumer side)
+     * @return Bytes read, 0 if the ring is empty or corrupt
+     */
+    size_t read(uint8_t* buffer, size_t length) noexcept;
+
+    /**
+     * @brief Get bytes waiting to be read
+     */
+    [[nodiscard]] size_t readable() const noexcept
+    {
+        const uint64_t used = m_header->tail.load(std::memory_order_acquire) -
+                              m_header->head.load(std::memory_order_relaxed);
+        return static_cast<size_t>(std::min(used, m_mask + 1));
+    }
+
+    /**
+     * @brief Get free space
+     */
+    [[nodiscard]] size_t writable() const noexcept
+    {
+        const uint64_t used = m_header->tail.load(std::memory_order_relaxed) -
+                              m_header->head.load(std::memory_order_acquire);
+        return used > m_mask + 1 ? 0 : static_cast<size_t>(m_mask + 1 - used);
+    }
+
+    /**
+     * @brief Get data area size (fixed at attach; the shared header copy isn't trusted)
+     */
+    [[nodiscard]] size_t capacity() const noexcept
+    {
+        return static_cast<size_t>(m_mask + 1);
+    }
+
+    /**
+     * @brief Check if the peer left head/tail more than a ring apart
+     * Sticky: read() and write() move nothing once this is set.
+     */
+    [[nodiscard]] bool is_corrupt() const noexcept
+    {
+        return m_corrupt;
+    }
+
+    /**
+     * @brief Consumer: ask to be woken by the next write
+     * @return false if input arrived meanwhile (the request is withdrawn; don't sleep)
+     */
+    bool prepare_consumer_wait() noexcept;
+
+    /**
+     * @brief Producer: ask to be woken once the consumer frees space
+     * @return false if space freed up meanwhile (the request is withdrawn; don't sleep)
+     */
+    bool prepare_producer_wait() noexcept;
+
+    /**
+     * @brief Producer, after write(): take the consumer's wakeup request, if any
+     */
+    bool take_consumer_wakeup() noexcept;
+
+    /**
+     * @brief Consumer, after read(): take the producer's wakeup request, if any
+     */
+    bool take_producer_wakeup() noexcept;
+
+private:
+    Header* m_header{nullptr};
+    uint8_t* m_data{nullptr};
+    uint64_t m_mask{0};
+    bool m_corrupt{false};
+};
+
+/**
+ * @brief Duplex byte stream between two processes on one host that bypasses the kernel
+ *
+ * Demonstrates:
+ * - One memfd + mmap region holding a ShmRing per direction
+ * - eventfd doorbells, rung only when the peer has announced it is idle
+ * - Handshake over a Unix domain socket, passing the descriptors with SCM_RIGHTS;
+ *   the socket then stays open only so either side notices the other going away
+ * - Socket-like semantics: frames produced by MessageSerializer pass through unchanged
+ *
+ * The server side is created per accepted connection and owned by its ConnectionHandler;
+ * clients get theirs from connect(). Linux only.
+ */
+class ShmChannel {
+public:
+    static constexpr size_t MIN_RING_BYTES = 4096;
+
+    /**
+     * @brief Check if the platform provides memfd and eventfd
+     */
+    [[nodiscard]] static constexpr bool is_supported() noexcept
+    {
+#ifdef __linux__
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Server side: allocate the shared region and doorbells
+     * @param ring_bytes Bytes per direction (rounded up to a power of two)
+     * @return Channel, nullptr on failure
+     */
+    static std::unique_ptr<ShmChannel> create(size_t ring_bytes) noexcept;
+
+    /**
+     * @brief Server side: hand the region and doorbells to the client
+     * @param control Connected Unix domain socket (not owned)
+     * @return true if successful
+     */
+    bool send_handshake(SOCKET control) noexcept;
+
+    /**
+     * @brief Client side: connect to a server started with AsyncServer::start_shm()
+     * @param path Unix socket path, or "@name" for the abstract namespace
+     * @param timeout_ms How long to wait for the handshake
+     * @return Channel, nullptr on failure
+     */
+    static std::unique_ptr<ShmChannel> connect(const std::string& path, int timeout_ms = 1000) noexcept;
+
+    /**
+     * @brief Destructor - unmaps the region and closes the doorbells (and a client's socket)
+     */
+    ~ShmChannel() noexcept;
+
+    // Delete copy operations
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+
+    // Delete move operations (rings point into this instance's mapping)
+    ShmChannel(ShmChannel&&) = delete;
+    ShmChannel& operator=(ShmChannel&&) = delete;
+
+    /**
+     * @brief Write as much of data as fits, ringing the peer if it is idle
+     * @return Bytes written
+     */
+    size_t write(const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Write slices in order until the ring fills, ringing the peer at most once
+     * @return Bytes written
+     */
+    size_t write(const IoSlice* slices, size_t count) noexcept;
+
+    /**
+     * @brief Read up to length bytes, ringing the peer if it waits for space
+     * @return Bytes read, 0 if nothing is waiting
+     */
+    size_t read(uint8_t* buffer, size_t length) noexcept;
+
+    /**
+     * @brief Get bytes waiting to be read
+     */
+    [[nodiscard]] size_t readable() const noexcept
+    {
+        return m_rx.readable();
+    }
+
+    /**
+     * @brief Get free space for writing
+     */
+    [[nodiscard]] size_t writable() const noexcept
+    {
+        return m_tx.writable();
+    }
+
+    /**
+     * @brief Get bytes per direction
+     */
+    [[nodiscard]] size_t ring_capacity() const noexcept
+    {
+        return m_tx.capacity();
+    }
+
+    /**
+     * @brief Check if the peer corrupted a ring's positions (the channel is unusable)
+     */
+    [[nodiscard]] bool is_corrupt() const noexcept
+    {
+        return m_rx.is_corrupt() || m_tx.is_corrupt();
+    }
+
+    /**
+     * @brief Ask for the doorbell on the next incoming byte
+     * @return false if input is already waiting (don't sleep)
+     */
+    bool arm_read_wakeup() noexcept
+    {
+        return m_rx.prepare_consumer_wait();
+    }
+
+    /**
+     * @brief Ask for the doorbell once the peer frees space
+     * @return false if space is already free (don't sleep)
+     */
+    bool arm_write_wakeup() noexcept
+    {
+        return m_tx.prepare_producer_wait();
+    }
+
+    /**
+     * @brief Reset this side's doorbell after a wakeup
+     */
+    void drain_doorbell() noexcept;
+
+    /**
+     * @brief Get this side's doorbell; readable when the peer rang
+     */
+    [[nodiscard]] int doorbell_fd() const noexcept
+    {
+        return m_own_doorbell;
+    }
+
+    /**
+     * @brief Client side: get the Unix socket kept open for liveness
+     */
+    [[nodiscard]] SOCKET control_socket() const noexcept
+    {
+        return m_control ? m_control->get_socket() : INVALID_SOCKET;
+    }
+
+    /**
+     * @brief Block until input is waiting
+     * Spins briefly first: a busy peer answers well before a sleep/wakeup round trip would.
+     * @param timeout_ms Timeout in milliseconds (-1 = infinite)
+     * @return true if input is waiting
+     */
+    bool wait_readable(int timeout_ms) noexcept;
+
+    /**
+     * @brief Block until there is room to write
+     * @param timeout_ms Timeout in milliseconds (-1 = infinite)
+     * @return true if space is free
+     */
+    bool wait_writable(int timeout_ms) noexcept;
+
+private:
+    static constexpr size_t SPIN_ITERATIONS = 2000;
+
+    ShmChannel() = default;
+
+    /**
+     * @brief Map the shared region
+     */
+    bool map_region(int memfd, size_t region_bytes) noexcept;
+
+    /**
+     * @brief Point this side's rings into the mapped region
+     * @param is_server Server reads client-to-server and writes server-to-client
+     */
+    void attach_rings(bool is_server) noexcept;
+
+    /**
+     * @brief Spin, then sleep on the doorbell until input (or space) is available
+     */
+    bool wait_for(bool for_read, int timeout_ms) noexcept;
+
+    /**
+     * @brief Ring the peer's doorbell
+     */
+    void ring_peer() noexcept;
+
+    void* m_region{nullptr};
+    size_t m_region_bytes{0};
+    int m_memfd{-1};                // Server side, until handed over
+    int m_own_doorbell{-1};
+    int m_peer_doorbell{-1};
+    ShmRing m_tx;
+    ShmRing m_rx;
+    std::unique_ptr<AsyncSocket> m_control;     // Client side only
+};
+
+} // namespace net
+} // namespace core
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace core {
+namespace net {
+
+/**
+ * @brief Handle of a connection record: a SlotTable id, possibly tagged by its owner
+ */
+using ConnectionId = uint64_t;
+constexpr ConnectionId INVALID_CONNECTION_ID = 0;
+
+/**
+ * @brief Dense table of records addressed by generational 64-bit ids
+ *
+ * Demonstrates:
+ * - O(1) insert, lookup and erase without hashing or tree walks
+ * - Records packed in one contiguous array (swap-with-last on erase), so iteration is a linear scan
+ * - Generation-tagged ids: an id outlives its record safely, lookups through it just fail,
+ *   even after the slot has been handed to a new record
+ *
+ * Id layout: slot index in bits 0-31, generation (never 0) in bits 32-55. Bits 56-63 are
+ * always zero, free for the owner to tag ids with (e.g. a shard index or a token kind).
+ * References to records stay valid only until the next insert or erase. Not thread-safe.
+ */
+template<typename T>
+class SlotTable {
+public:
+    using Id = uint64_t;
+    static constexpr Id INVALID_ID = 0;
+    static constexpr unsigned GENERATION_BITS = 24;
+    static constexpr unsigned TAG_SHIFT = 32 + GENERATION_BITS;
+    static constexpr Id ID_MASK = (Id{1} << TAG_SHIFT) - 1;
+
+    SlotTable() = default;
+
+    // Delete copy operations
+    SlotTable(const SlotTable&) = delete;
+    SlotTable& operator=(const SlotTable&) = delete;
+
+    // Move operations
+    SlotTable(SlotTable&&) noexcept = default;
+    SlotTable& operator=(SlotTable&&) noexcept = default;
+
+    /**
+     * @brief Construct a record in a free slot
+     * @return Its id, INVALID_ID if memory could not be allocated
+     */
+    template<typename... Args>
+    Id insert(Args&&... args) noexcept
+    {
+        try {
+            // Grow everything up front so a failed allocation leaves the table untouched
+            grow(m_ids);
+            if (m_free.empty()) {
+                grow(m_slots);
+                m_free.reserve(m_slots.capacity());
+            }
+            m_values.emplace_back(std::forward<Args>(args)...);
+        } catch (const std::bad_alloc&) {
+            return INVALID_ID;
+        }
+
+        uint32_t index;
+        if (m_free.empty()) {
+            index = static_cast<uint32_t>(m_slots.size());
+            m_slots.push_back(Slot{});
+        } else {
+            index = m_free.back();
+            m_free.pop_back();
+        }
+
+        Slot& slot = m_slots[index];
+        slot.position = static_cast<uint32_t>(m_values.size() - 1);
+        const Id id = make_id(index, slot.generation);
+        m_ids.push_back(id);
+        return id;
+    }
+
+    /**
+     * @brief Look up a live record
+     * @return Record, nullptr if the id is stale, foreign or INVALID_ID
+     */
+    [[nodiscard]] T* find(Id id) noexcept
+    {
+        const Slot* slot = lookup(id);
+        return slot ? &m_values[slot->position] : nullptr;
+    }
+
+    [[nodiscard]] const T* find(Id id) const noexcept
+    {
+        const Slot* slot = lookup(id);
+        return slot ? &m_values[slot->position] : nullptr;
+    }
+
+    /**
+     * @brief Check if an id refers to a live record
+     */
+    [[nodiscard]] bool contains(Id id) const noexcept
+    {
+        return lookup(id) != nullptr;
+    }
+
+    /**
+     * @brief Destroy a record; its id (and every copy of it) goes stale
+     * @return false if the id was already stale
+     */
+    bool erase(Id id) noexcept
+    {
+        const Slot* found = lookup(id);
+        if (!found) {
+            return false;
+        }
+
+        const uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+        const uint32_t position = found->position;
+        const uint32_t last = static_cast<uint32_t>(m_values.size() - 1);
+
+        // Keep the records dense: the last one moves into the hole
+        if (position != last) {
+            m_values[position] = std::move(m_values[last]);
+            m_ids[position] = m_ids[last];
+            m_slots[m_ids[position] & 0xFFFFFFFFu].position = position;
+        }
+        m_values.pop_back();
+        m_ids.pop_back();
+
+        Slot& slot = m_slots[index];
+        slot.position = FREE;
+        if (++slot.generation == (uint32_t{1} << GENERATION_BITS)) {
+            slot.generation = 1;
+        }
+        m_free.push_back(index);    // Capacity reserved in insert()
+        return true;
+    }
+
+    /**
+     * @brief Call f(id, record) for every record, in storage order
+     * f must not insert or erase.
+     */
+    template<typename F>
+    void for_each(F&& f)
+    {
+        for (size_t i = 0; i < m_values.size(); ++i) {
+            f(m_ids[i], m_values[i]);
+        }
+    }
+
+    template<typename F>
+    void for_each(F&& f) const
+    {
+        for (size_t i = 0; i < m_values.size(); ++i) {
+            f(m_ids[i], m_values[i]);
+        }
+    }
+
+    /**
+     * @brief Get ids of all records, in storage order
+     */
+    [[nodiscard]] const std::vector<Id>& ids() const noexcept
+    {
+        return m_ids;
+    }
+
+    /**
+     * @brief Get number of records
+     */
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return m_values.size();
+    }
+
+    /**
+     * @brief Check if the table holds no records
+     */
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_values.empty();
+    }
+
+    /**
+     * @brief Destroy every record; all outstanding ids go stale
+     */
+    void clear() noexcept
+    {
+        while (!m_ids.empty()) {
+            erase(m_ids.back());
+        }
+    }
+
+private:
+    static constexpr uint32_t FREE = UINT32_MAX;
+
+    struct Slot {
+        uint32_t generation{1};
+        uint32_t position{FREE};    // Index into m_values, FREE when unused
+    };
+
+    template<typename V>
+    static void grow(V& vector)
+    {
+        if (vector.size() == vector.capacity()) {
+            vector.reserve(vector.empty() ? 16 : vector.capacity() * 2);
+        }
+    }
+
+    static Id make_id(uint32_t index, uint32_t generation) noexcept
+    {
+        return (static_cast<Id>(generation) << 32) | index;
+    }
+
+    const Slot* lookup(Id id) const noexcept
+    {
+        const uint64_t index = id & 0xFFFFFFFFu;
+        const uint32_t generation = static_cast<uint32_t>(id >> 32);
+
+        // Tagged ids are foreign: the owner strips its tag before looking up
+        if (index >= m_slots.size() || generation >= (uint32_t{1} << GENERATION_BITS)) {
+            return nullptr;
+        }
+
+        const Slot& slot = m_slots[index];
+        if (slot.generation != generation || slot.position == FREE) {
+            return nullptr;
+        }
+        return &slot;
+    }
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_free;
+    std::vector<T> m_values;
+    std::vector<Id> m_ids;
+};
+
+} // namespace net
+} // namespace core
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "PlatformSocket.h"
+#include "ServerConfig.h"
+
+namespace core {
+namespace net {
+
+/**
+ * @brief Per-socket tuning knobs, usually taken from a SocketProfile
+ *
+ * Demonstrates:
+ * - Named presets over raw setsockopt calls (latency vs. throughput trade-off)
+ * - Options set on the listener before listen(), so accepted sockets inherit them
+ *   and the receive window scale matches the larger buffer
+ * - Best-effort application: an option the platform or privileges don't allow is
+ *   reported and skipped, the socket stays usable
+ */
+struct SocketOptions {
+    bool no_delay = false;          // TCP_NODELAY: disable Nagle's algorithm
+    bool cork_flushes = false;      // Hold TCP_CORK while a flush writes, release it after
+    int send_buffer_bytes = 0;      // SO_SNDBUF (0 = kernel default, autotuned)
+    int receive_buffer_bytes = 0;   // SO_RCVBUF (0 = kernel default, autotuned)
+    int busy_poll_us = 0;           // SO_BUSY_POLL (Linux; raising it needs CAP_NET_ADMIN)
+
+    static constexpr int LATENCY_BUSY_POLL_US = 50;
+    static constexpr int THROUGHPUT_BUFFER_BYTES = 4 * 1024 * 1024;   // Capped by net.core.[rw]mem_max
+
+    /**
+     * @brief Get the options a profile stands for
+     */
+    [[nodiscard]] static SocketOptions for_profile(SocketProfile profile) noexcept;
+
+    /**
+     * @brief Check if nothing would be changed
+     */
+    [[nodiscard]] bool is_default() const noexcept
+    {
+        return !no_delay && !cork_flushes && send_buffer_bytes == 0 && receive_buffer_bytes == 0 &&
+               busy_poll_us == 0;
+    }
+};
+
+/**
+ * @brief Apply options to a socket
+ * @param socket Listening or connected socket
+ * @param options Options to set
+ * @param is_tcp False for Unix domain sockets: only the buffer sizes apply
+ * @return true if every option was set (failures are logged, the rest still applied)
+ */
+bool apply_socket_options(SOCKET socket, const SocketOptions& options, bool is_tcp) noexcept;
+
+/**
+ * @brief Check if the platform can cork a TCP socket (TCP_CORK / TCP_NOPUSH)
+ */
+[[nodiscard]] constexpr bool cork_supported() noexcept
+{
+#if defined(TCP_CORK) || defined(TCP_NOPUSH)
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Cork or uncork a TCP socket
+ * While corked the kernel only sends full segments; uncorking pushes the remainder.
+ * @return false if unsupported or setsockopt failed
+ */
+inline bool set_cork(SOCKET socket, bool enable) noexcept
+{
+#if defined(TCP_CORK) || defined(TCP_NOPUSH)
+#if defined(TCP_CORK)
+    constexpr int option = TCP_CORK;
+#else
+    constexpr int option = TCP_NOPUSH;
+#endif
+    int value = enable ? 1 : 0;
+    return setsockopt(socket, IPPROTO_TCP, option, reinterpret_cast<const char*>(&value), sizeof(value)) == 0;
+#else
+    (void)socket;
+    (void)enable;
+    return false;
+#endif
+}
+
+} // namespace net
+} // namespace core
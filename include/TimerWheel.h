@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace core {
+namespace net {
+
+/**
+ * @brief Hierarchical timing wheel for large numbers of coarse timers
+ *
+ * Demonstrates:
+ * - O(1) schedule, cancel and expiry (four levels of 256 slots, cascaded on wrap)
+ * - Intrusive doubly linked slot lists over a flat node pool: no allocation per timer
+ * - Idle stretches are skipped slot by slot, not tick by tick
+ * - Lazy re-arm: pushing a deadline later only stores it; the timer is re-filed when its
+ *   old slot comes up, so resetting an idle timer on every read costs one write
+ * - Generation-tagged ids, so a stale id can never cancel a recycled timer
+ *
+ * Timers never fire early; they fire on the first advance() at or after their deadline,
+ * rounded up to the tick. Not thread-safe: owned by one reactor loop.
+ */
+class TimerWheel {
+public:
+    using TimerId = uint64_t;
+    static constexpr TimerId INVALID_TIMER = 0;
+
+    /**
+     * @brief A timer that reached its deadline
+     */
+    struct Expiry {
+        TimerId id;
+        uint64_t token;     // Caller's key (e.g. socket)
+        uint32_t tag;       // Caller's timer kind
+    };
+
+    using ExpiryHandler = std::function<void(const Expiry&)>;
+
+    static constexpr size_t LEVELS = 4;
+    static constexpr size_t SLOT_BITS = 8;
+    static constexpr size_t SLOTS = size_t{1} << SLOT_BITS;
+
+    /**
+     * @brief Construct an empty wheel
+     * @param now_ms Current time in milliseconds (any monotonic origin)
+     * @param tick_ms Resolution; deadlines are rounded up to a multiple of it
+     */
+    explicit TimerWheel(uint64_t now_ms = 0, uint32_t tick_ms = 10);
+
+    // Delete copy operations
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Move operations
+    TimerWheel(TimerWheel&&) noexcept = default;
+    TimerWheel& operator=(TimerWheel&&) noexcept = default;
+
+    /**
+     * @brief Arm a timer
+     * @param deadline_ms Absolute deadline in the wheel's time base
+     * @param token Returned in the Expiry
+     * @param tag Returned in the Expiry
+     * @return Timer id, INVALID_TIMER if memory could not be allocated
+     */
+    TimerId schedule(uint64_t deadline_ms, uint64_t token, uint32_t tag = 0) noexcept;
+
+    /**
+     * @brief Move a pending timer's deadline
+     * @return false if the timer already fired or was cancelled
+     */
+    bool reschedule(TimerId id, uint64_t deadline_ms) noexcept;
+
+    /**
+     * @brief Disarm a pending timer
+     * @return false if the timer already fired or was cancelled
+     */
+    bool cancel(TimerId id) noexcept;
+
+    /**
+     * @brief Run every timer whose deadline is at or before now_ms
+     * The handler may schedule, reschedule or cancel timers, including ones due in this call.
+     * @return Number of timers fired
+     */
+    size_t advance(uint64_t now_ms, const ExpiryHandler& on_expired) noexcept;
+
+    /**
+     * @brief How long a poller may sleep before the wheel needs advancing
+     * May return earlier than the next deadline (at a cascade point), never later.
+     * @return Milliseconds, -1 if no timer is pending
+     */
+    [[nodiscard]] int next_timeout_ms(uint64_t now_ms) const noexcept;
+
+    /**
+     * @brief Get number of pending timers
+     */
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief Check if no timer is pending
+     */
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * @brief Get the resolution in milliseconds
+     */
+    [[nodiscard]] uint32_t tick_ms() const noexcept
+    {
+        return m_tick_ms;
+    }
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Node {
+        uint64_t deadline_tick{0};
+        uint64_t token{0};
+        uint32_t tag{0};
+        uint32_t generation{1};
+        uint32_t prev{NIL};
+        uint32_t next{NIL};
+        uint32_t slot{NIL};     // Index into m_slots, NIL when free
+    };
+
+    uint64_t to_tick(uint64_t deadline_ms) const noexcept;
+    Node* lookup(TimerId id) noexcept;
+
+    void link(uint32_t index) noexcept;
+    void unlink(uint32_t index) noexcept;
+    void release(uint32_t index) noexcept;
+    void cascade(size_t level) noexcept;
+
+    /**
+     * @brief First tick at which a slot fires or cascades (UINT64_MAX if none)
+     */
+    uint64_t next_event_tick() const noexcept;
+
+    uint32_t m_tick_ms;
+    uint64_t m_current_tick;
+    size_t m_size{0};
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_free;
+    std::array<uint32_t, LEVELS * SLOTS> m_slots;
+    std::array<size_t, LEVELS> m_level_count;
+};
+
+} // namespace net
+} // namespace core
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "BinaryProtocol.h"
+#include "HandlerRegistry.h"
+#include "NetworkBuffer.h"
+#include "PlatformSocket.h"
+#include "Reactor.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+namespace core {
+namespace net {
+
+/**
+ * @brief UDP endpoint for small, loss-tolerant frames (PING / PONG / STATUS telemetry)
+ *
+ * Demonstrates:
+ * - One complete FrameHeader + payload + CRC32 frame per datagram, no stream reassembly
+ * - Batched I/O: recvmmsg / sendmmsg move up to BATCH_SIZE datagrams per syscall (Linux)
+ * - Same HandlerRegistry dispatch as stream connections
+ * - PINGs answered with PONGs queued and flushed as one batch
+ * - Malformed, truncated or unhandled datagrams counted and dropped, never fatal
+ *
+ * Runs on one thread: either run() with its own Reactor, or process_incoming() and
+ * flush_sends() from an existing loop when get_socket() is readable.
+ */
+class UdpListener {
+public:
+    static constexpr size_t BATCH_SIZE = 32;                    // Datagrams per recvmmsg / sendmmsg
+    static constexpr size_t DEFAULT_MAX_DATAGRAM_BYTES = 2048;  // Telemetry fits one MTU
+    static constexpr size_t MAX_BATCHES_PER_WAKEUP = 8;         // Then flush replies and wait again
+
+    /**
+     * @brief Construct an unbound listener
+     * @param registry Handlers for incoming frames (must outlive the listener)
+     * @param max_datagram_bytes Largest accepted datagram; longer ones are dropped as truncated
+     */
+    explicit UdpListener(protocol::HandlerRegistry& registry,
+                         size_t max_datagram_bytes = DEFAULT_MAX_DATAGRAM_BYTES);
+
+    /**
+     * @brief Destructor - stops and closes the socket
+     */
+    ~UdpListener() noexcept;
+
+    // Delete copy operations
+    UdpListener(const UdpListener&) = delete;
+    UdpListener& operator=(const UdpListener&) = delete;
+
+    // Delete move operations (batch headers point into this instance's buffers)
+    UdpListener(UdpListener&&) = delete;
+    UdpListener& operator=(UdpListener&&) = delete;
+
+    /**
+     * @brief Bind the datagram socket
+     * @param listen_address IPv4 address to bind
+     * @param port Port to bind (0 = ephemeral, see get_local_port())
+     * @return true if successful
+     */
+    bool start(const std::string& listen_address, uint16_t port) noexcept;
+
+    /**
+     * @brief Stop run() (callable from any thread)
+     */
+    void stop() noexcept;
+
+    /**
+     * @brief Receive, dispatch and answer datagrams until stop() (blocking)
+     * @param timeout_ms Timeout in milliseconds for each wait (-1 = infinite)
+     */
+    void run(int timeout_ms = -1) noexcept;
+
+    /**
+     * @brief Receive and dispatch waiting datagrams, up to MAX_BATCHES_PER_WAKEUP batches
+     * Replies are queued; call flush_sends() afterwards.
+     * @return Frames dispatched or answered
+     */
+    size_t process_incoming() noexcept;
+
+    /**
+     * @brief Queue one datagram, flushing first if the send batch is full
+     * @param to Destination address
+     * @param data Complete serialized frame
+     * @param length Frame length (at most max_datagram_bytes)
+     * @return false if the datagram is too large
+     */
+    bool queue_send(const PeerAddress& to, const uint8_t* data, size_t length) noexcept;
+
+    /**
+     * @brief Send every queued datagram
+     * Datagrams the socket buffer can't take are dropped, as the network would
+     * (counted by get_send_dropped_count()).
+     * @return Datagrams sent
+     */
+    size_t flush_sends() noexcept;
+
+    /**
+     * @brief Get the bound socket (for callers driving their own poller)
+     */
+    [[nodiscard]] SOCKET get_socket() const noexcept
+    {
+        return m_socket;
+    }
+
+    /**
+     * @brief Get the bound port (resolves port 0 to the ephemeral port)
+     */
+    [[nodiscard]] uint16_t get_local_port() const noexcept;
+
+    /**
+     * @brief Check if the listener is bound and not stopped
+     */
+    [[nodiscard]] bool is_running() const noexcept
+    {
+        return m_is_running.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Get datagrams received (valid or not)
+     */
+    [[nodiscard]] size_t get_received_count() const noexcept
+    {
+        return m_received.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get frames handed to a handler or answered
+     */
+    [[nodiscard]] size_t get_dispatched_count() const noexcept
+    {
+        return m_dispatched.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get received datagrams dropped: malformed, truncated, unhandled or rejected by a handler
+     */
+    [[nodiscard]] size_t get_dropped_count() const noexcept
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get queued datagrams flush_sends() couldn't send
+     */
+    [[nodiscard]] size_t get_send_dropped_count() const noexcept
+    {
+        return m_send_dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get datagrams sent
+     */
+    [[nodiscard]] size_t get_sent_count() const noexcept
+    {
+        return m_sent.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get receive syscalls made (received / calls = achieved batch size)
+     */
+    [[nodiscard]] size_t get_receive_call_count() const noexcept
+    {
+        return m_receive_calls.load(std::memory_order_relaxed);
+    }
+
+private:
+    /**
+     * @brief Receive up to BATCH_SIZE datagrams into the receive slots
+     * @return Datagrams received, 0 when none are waiting
+     */
+    size_t receive_batch() noexcept;
+
+    /**
+     * @brief Validate one datagram as a frame and dispatch it
+     * @return true if it was dispatched or answered
+     */
+    bool handle_datagram(const uint8_t* data, size_t length, const PeerAddress& from) noexcept;
+
+    /**
+     * @brief Queue a PONG carrying the PING's payload
+     */
+    bool queue_pong(const PeerAddress& to, const uint8_t* payload, uint16_t payload_length) noexcept;
+
+    protocol::HandlerRegistry& m_registry;
+    const size_t m_max_datagram_bytes;
+    SOCKET m_socket{INVALID_SOCKET};
+    Reactor m_reactor;
+    std::atomic<bool> m_is_running{false};
+
+    // Receive slots: BATCH_SIZE buffers of m_max_datagram_bytes
+    std::vector<uint8_t> m_rx_buffer;
+    std::vector<PeerAddress> m_rx_from;
+    std::vector<size_t> m_rx_length;
+    std::vector<bool> m_rx_truncated;
+
+    // Send batch: datagrams packed back to back in m_tx_buffer
+    std::vector<uint8_t> m_tx_buffer;
+    std::vector<PeerAddress> m_tx_to;
+    std::vector<size_t> m_tx_length;
+    size_t m_tx_used{0};
+    NetworkBuffer m_reply;
+
+#ifdef __linux__
+    std::vector<mmsghdr> m_rx_headers;
+    std::vector<iovec> m_rx_slices;
+    std::vector<mmsghdr> m_tx_headers;
+    std::vector<iovec> m_tx_slices;
+#endif
+
+    std::atomic<size_t> m_received{0};
+    std::atomic<size_t> m_dispatched{0};
+    std::atomic<size_t> m_dropped{0};
+    std::atomic<size_t> m_sent{0};
+    std::atomic<size_t> m_send_dropped{0};
+    std::atomic<size_t> m_receive_calls{0};
+};
+
+} // namespace net
+} // namespace core
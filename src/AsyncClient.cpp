@@ -0,0 +1,426 @@
+#include "AsyncClient.h"
+#include "MessageSerializer.h"
+#include "ProtocolMessages.h"
+#include "SocketOptions.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iostream>
+
+namespace core {
+namespace net {
+
+namespace {
+
+size_t round_up_to_power_of_two(size_t value) noexcept
+{
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+AsyncClient::AsyncClient(const ClientConfig& config)
+    : m_config(config)
+    , m_frame(protocol::MIN_FRAME_SIZE + protocol::MAX_PAYLOAD_SIZE)
+{
+    m_config.pool_size = std::max<size_t>(m_config.pool_size, 1);
+    m_config.max_in_flight = round_up_to_power_of_two(std::clamp<size_t>(m_config.max_in_flight, 1, MAX_IN_FLIGHT));
+    AsyncSocket::initialize_winsock();
+}
+
+AsyncClient::~AsyncClient() noexcept
+{
+    for (auto& connection : m_connections) {
+        if (connection->socket) {
+            m_reactor.remove(connection->socket->get_socket());
+        }
+    }
+    m_connections.clear();
+    AsyncSocket::cleanup_winsock();
+}
+
+bool AsyncClient::connect(const std::string& address, uint16_t port) noexcept
+{
+    if (!m_reactor.is_valid()) {
+        std::cerr << "AsyncClient: poller unavailable" << std::endl;
+        return false;
+    }
+
+    close();
+
+    try {
+        m_connections.clear();
+        m_connections.reserve(m_config.pool_size);
+        const SocketOptions options = SocketOptions::for_profile(m_config.socket_profile);
+
+        for (size_t index = 0; index < m_config.pool_size; ++index) {
+            auto connection = std::make_unique<Connection>();
+            connection->pending.resize(m_config.max_in_flight);
+            connection->socket = std::make_unique<AsyncSocket>(address, port);
+            connection->socket->set_options(options);
+
+            // Non-blocking connects: the whole pool handshakes in parallel
+            if (!connection->socket->connect(address, port) ||
+                !m_reactor.add(connection->socket->get_socket(), Reactor::WRITABLE, index)) {
+                connection->socket.reset();
+            }
+            m_connections.push_back(std::move(connection));
+        }
+    } catch (const std::bad_alloc&) {
+        std::cerr << "Out of memory opening connection pool" << std::endl;
+    }
+
+    await_connects(m_config.connect_timeout_ms);
+    m_next_connection = 0;
+    return get_connection_count() > 0;
+}
+
+void AsyncClient::await_connects(uint32_t timeout_ms) noexcept
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    size_t waiting = std::count_if(m_connections.begin(), m_connections.end(),
+                                   [](const auto& connection) { return connection->socket != nullptr; });
+    size_t unused = 0;
+
+    Reactor::Event events[MAX_EVENTS];
+    while (waiting > 0) {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            break;
+        }
+
+        const int count = m_reactor.wait(events, MAX_EVENTS, static_cast<int>(remaining));
+        for (int i = 0; i < count; ++i) {
+            const size_t index = static_cast<size_t>(events[i].token);
+            if (index >= m_connections.size()) {
+                continue;
+            }
+            Connection& connection = *m_connections[index];
+            if (!connection.socket || connection.connected) {
+                continue;
+            }
+
+            --waiting;
+            int error = 0;
+            socklen_t length = sizeof(error);
+            const SOCKET socket = connection.socket->get_socket();
+            if (getsockopt(socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length) != 0 ||
+                error != 0 || !m_reactor.modify(socket, Reactor::READABLE, index)) {
+                std::cerr << "AsyncClient: connect failed: " << error << std::endl;
+                fail_connection(index, unused);
+                continue;
+            }
+            connection.connected = true;
+        }
+    }
+
+    // Whatever is still handshaking at the deadline is given up
+    for (size_t index = 0; index < m_connections.size(); ++index) {
+        if (m_connections[index]->socket && !m_connections[index]->connected) {
+            fail_connection(index, unused);
+        }
+    }
+}
+
+bool AsyncClient::send_request(protocol::MessageType type, const uint8_t* payload, uint16_t length,
+                               ResponseCallback callback) noexcept
+{
+    const size_t index = pick_connection();
+    if (index == NO_CONNECTION) {
+        return false;
+    }
+    Connection* connection = m_connections[index].get();
+
+    const uint16_t id = next_id(*connection);
+    protocol::FrameHeader header{protocol::PROTOCOL_MAGIC, protocol::PROTOCOL_VERSION,
+                                 static_cast<uint8_t>(type), 0, length, id};
+    if (m_config.crc32c_checksums) {
+        header.set_flag(protocol::FrameFlags::CRC32C);
+    }
+    m_frame.reset();
+    if (!protocol::MessageSerializer::serialize_frame(header, payload, length, m_frame) ||
+        !connection->output.append(m_frame.data(), m_frame.write_pos())) {
+        return false;
+    }
+
+    Pending& slot = slot_of(*connection, id);
+    slot.id = id;
+    slot.callback = std::move(callback);
+    ++connection->next_sequence;
+    ++connection->in_flight;
+    ++m_in_flight;
+
+    // Past the threshold, batching gains little and the queue only grows
+    if (connection->output.size() >= m_config.flush_threshold_bytes) {
+        flush_connection(index);    // a failure surfaces in the next poll()
+    }
+    return true;
+}
+
+size_t AsyncClient::pick_connection() noexcept
+{
+    for (size_t attempt = 0; attempt < m_connections.size(); ++attempt) {
+        const size_t index = (m_next_connection + attempt) % m_connections.size();
+        Connection& connection = *m_connections[index];
+
+        // Responses may complete out of order, so the next id's slot can still be busy
+        if (connection.connected && !connection.going_away &&
+            connection.in_flight < connection.pending.size() &&
+            slot_of(connection, next_id(connection)).id == 0) {
+            m_next_connection = index + 1;
+            return index;
+        }
+    }
+    return NO_CONNECTION;
+}
+
+size_t AsyncClient::poll(int timeout_ms) noexcept
+{
+    size_t delivered = 0;
+    flush();
+
+    if (m_reactor.registered_count() == 0) {
+        return delivered;
+    }
+
+    Reactor::Event events[MAX_EVENTS];
+    const int count = m_reactor.wait(events, MAX_EVENTS, timeout_ms);
+
+    for (int i = 0; i < count; ++i) {
+        const size_t index = static_cast<size_t>(events[i].token);
+        if (index >= m_connections.size() || !m_connections[index]->connected) {
+            continue;
+        }
+
+        const uint32_t ready = events[i].events;
+        if ((ready & (Reactor::READABLE | Reactor::CLOSED | Reactor::FAILED)) &&
+            !read_connection(index, delivered)) {
+            fail_connection(index, delivered);
+            continue;
+        }
+        if ((ready & Reactor::WRITABLE) && !flush_connection(index)) {
+            fail_connection(index, delivered);
+        }
+    }
+
+    // Requests the callbacks just queued go out with this poll, not the next
+    for (size_t index = 0; index < m_connections.size(); ++index) {
+        if (m_connections[index]->connected && !m_connections[index]->output.empty() &&
+            !flush_connection(index)) {
+            fail_connection(index, delivered);
+        }
+    }
+    return delivered;
+}
+
+bool AsyncClient::wait_for_responses(uint32_t timeout_ms) noexcept
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (m_in_flight > 0) {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            return false;
+        }
+        poll(static_cast<int>(remaining));
+    }
+    return true;
+}
+
+void AsyncClient::flush() noexcept
+{
+    size_t delivered = 0;
+    for (size_t index = 0; index < m_connections.size(); ++index) {
+        if (m_connections[index]->connected && !m_connections[index]->output.empty() &&
+            !flush_connection(index)) {
+            fail_connection(index, delivered);
+        }
+    }
+}
+
+void AsyncClient::close() noexcept
+{
+    size_t delivered = 0;
+    for (size_t index = 0; index < m_connections.size(); ++index) {
+        fail_connection(index, delivered);
+    }
+}
+
+size_t AsyncClient::get_connection_count() const noexcept
+{
+    return static_cast<size_t>(std::count_if(m_connections.begin(), m_connections.end(),
+                                             [](const auto& connection) { return connection->connected; }));
+}
+
+bool AsyncClient::flush_connection(size_t index) noexcept
+{
+    Connection& connection = *m_connections[index];
+    const SOCKET socket = connection.socket->get_socket();
+    IoSlice slices[MAX_IO_SLICES];
+
+    while (!connection.output.empty()) {
+        const size_t count = connection.output.gather(slices, MAX_IO_SLICES);
+        size_t offered = 0;
+        for (size_t i = 0; i < count; ++i) {
+            offered += io_slice_length(slices[i]);
+        }
+
+        const int64_t bytes_sent = send_slices(socket, slices, count);
+        ++m_send_count;
+        if (bytes_sent == SOCKET_ERROR) {
+            const int error = last_socket_error();
+            if (!is_would_block(error)) {
+                std::cerr << "AsyncClient: send() failed: " << error << std::endl;
+                return false;
+            }
+            break;
+        }
+
+        connection.output.consume(static_cast<size_t>(bytes_sent));
+        if (static_cast<size_t>(bytes_sent) < offered) {
+            break;
+        }
+    }
+
+    update_interest(index);
+    return true;
+}
+
+bool AsyncClient::read_connection(size_t index, size_t& delivered) noexcept
+{
+    Connection& connection = *m_connections[index];
+
+    while (connection.connected) {
+        uint8_t* space = connection.decoder.prepare(READ_SIZE);
+        if (!space) {
+            std::cerr << "Out of memory growing client input buffer" << std::endl;
+            return false;
+        }
+
+        const size_t capacity = connection.decoder.get_writable();
+        const int received = connection.socket->recv_data(connection.socket->get_socket(), space,
+                                                          static_cast<int>(std::min<size_t>(capacity, INT_MAX)));
+        if (received == 0) {
+            return false;   // Server closed the connection
+        }
+        if (received == SOCKET_ERROR) {
+            return is_would_block(last_socket_error());
+        }
+
+        connection.decoder.commit(static_cast<size_t>(received));
+        if (!parse_frames(connection, delivered)) {
+            return false;
+        }
+
+        // A short read means the socket is drained
+        if (static_cast<size_t>(received) < capacity) {
+            return true;
+        }
+    }
+    return true;
+}
+
+bool AsyncClient::parse_frames(Connection& connection, size_t& delivered) noexcept
+{
+    protocol::FrameView frame;
+    while (connection.connected) {
+        const protocol::DecodeStatus status = connection.decoder.next(frame);
+        if (status == protocol::DecodeStatus::NEED_MORE) {
+            break;
+        }
+        if (status == protocol::DecodeStatus::CORRUPT) {
+            std::cerr << "AsyncClient: corrupt frame, dropping connection" << std::endl;
+            return false;
+        }
+        dispatch(connection, frame.header, frame.payload.data(), delivered);
+    }
+    return true;
+}
+
+void AsyncClient::dispatch(Connection& connection, const protocol::FrameHeader& header,
+                           const uint8_t* payload, size_t& delivered) noexcept
+{
+    const uint16_t id = header.reserved;
+
+    if (id == 0) {
+        if (header.message_type == static_cast<uint8_t>(protocol::MessageType::STATUS) &&
+            header.payload_length > 0 && payload[0] == protocol::messages::STATUS_GOING_AWAY) {
+            connection.going_away = true;
+        }
+        if (m_on_unsolicited) {
+            m_on_unsolicited(header, payload, header.payload_length);
+        }
+        return;
+    }
+
+    Pending& slot = slot_of(connection, id);
+    if (slot.id != id) {
+        std::cerr << "AsyncClient: response to unknown request id " << id << std::endl;
+        return;
+    }
+
+    ResponseCallback callback = std::move(slot.callback);
+    slot.id = 0;
+    slot.callback = nullptr;
+    --connection.in_flight;
+    --m_in_flight;
+    ++delivered;
+
+    if (callback) {
+        callback(ClientResponse{true, header, payload, header.payload_length});
+    }
+}
+
+void AsyncClient::update_interest(size_t index) noexcept
+{
+    Connection& connection = *m_connections[index];
+    const bool want_writable = !connection.output.empty();
+    if (want_writable == connection.want_writable) {
+        return;
+    }
+
+    const uint32_t interest = Reactor::READABLE | (want_writable ? Reactor::WRITABLE : 0);
+    if (m_reactor.modify(connection.socket->get_socket(), interest, index)) {
+        connection.want_writable = want_writable;
+    }
+}
+
+void AsyncClient::fail_connection(size_t index, size_t& delivered) noexcept
+{
+    Connection& connection = *m_connections[index];
+    if (connection.socket) {
+        m_reactor.remove(connection.socket->get_socket());
+        connection.socket.reset();
+    }
+
+    connection.connected = false;
+    connection.want_writable = false;
+    connection.output.clear();
+    connection.decoder.reset();
+
+    for (Pending& slot : connection.pending) {
+        if (slot.id == 0) {
+            continue;
+        }
+
+        ResponseCallback callback = std::move(slot.callback);
+        slot.id = 0;
+        slot.callback = nullptr;
+        --connection.in_flight;
+        --m_in_flight;
+        ++delivered;
+
+        if (callback) {
+            callback(ClientResponse{});
+        }
+    }
+}
+
+} // namespace net
+} // namespace core
@@ -1,58 +1,331 @@
 #include "AsyncServer.h"
+#include "MessageSerializer.h"
+#include "ProtocolMessages.h"
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+#include <utility>
 
 namespace core {
 namespace net {
 
+namespace {
+
+uint64_t steady_now_ms() noexcept
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Control frame the server sends on its own (heartbeat PING, going-away STATUS)
+SharedBuffer make_frame(protocol::MessageType type, const uint8_t* payload, uint16_t payload_length)
+{
+    protocol::FrameHeader header{protocol::PROTOCOL_MAGIC, protocol::PROTOCOL_VERSION,
+                                 static_cast<uint8_t>(type), 0, payload_length, 0};
+    NetworkBuffer frame(protocol::MIN_FRAME_SIZE + payload_length);
+    if (!protocol::MessageSerializer::serialize_frame(header, payload, payload_length, frame)) {
+        return SharedBuffer{};
+    }
+    return SharedBuffer::copy_of(frame.data(), frame.write_pos());
+}
+
+// StatusMessage wire layout: status_code, error_code (2 bytes), text
+SharedBuffer make_going_away_frame()
+{
+    const uint8_t payload[] = {protocol::messages::STATUS_GOING_AWAY, 0, 0,
+                               'g', 'o', 'i', 'n', 'g', ' ', 'a', 'w', 'a', 'y'};
+    return make_frame(protocol::MessageType::STATUS, payload, sizeof(payload));
+}
+
+// Server whose shard loop runs on this thread; stop() mustn't wait on itself
+thread_local const AsyncServer* t_loop_server = nullptr;
+
+// Shard whose loop runs on this thread; work queued from elsewhere has to wake it
+thread_local const void* t_loop_shard = nullptr;
+
+// Shard whose mutex this thread holds while a frame callback runs; its lookups would self-deadlock
+thread_local const void* t_callback_shard = nullptr;
+
+ServerConfig config_with_workers(size_t num_worker_threads) noexcept
+{
+    ServerConfig config;
+    config.num_worker_threads = num_worker_threads;
+    return config;
+}
+
+} // namespace
+
 AsyncServer::AsyncServer(size_t num_worker_threads)
-    : m_socket(std::make_unique<AsyncSocket>("127.0.0.1", 0))
-    , m_thread_pool(std::make_unique<ThreadPool>(num_worker_threads))
-    , m_event_object(WSACreateEvent())
+    : AsyncServer(config_with_workers(num_worker_threads))
+{
+}
+
+AsyncServer::AsyncServer(const ServerConfig& config)
+    : m_config(config)
+    , m_thread_pool(std::make_unique<ThreadPool>(config.num_worker_threads))
 {
+    set_rate_limits(config.connection_rate_limits, config.address_rate_limits);
 }
 
 AsyncServer::~AsyncServer() noexcept
 {
-    stop();
+    stop_now();
+}
+
+bool AsyncServer::start(const std::string& listen_address, uint16_t port) noexcept
+{
+    m_listen_port = port;
+    m_listen_path.clear();
+    m_shm_transport = false;
+
+    const SocketOptions options = SocketOptions::for_profile(m_config.socket_profile);
+    m_cork_flushes = options.cork_flushes;
+
+    // Shard 0 resolves port 0; the rest join the same port
+    const bool started = start_shards([this, &listen_address, &options](Shard& shard, size_t shard_count) {
+        shard.listener = std::make_unique<AsyncSocket>(listen_address, m_listen_port);
+        shard.listener->set_options(options);
+        if (!shard.listener->create_listening_socket(listen_address, m_listen_port, m_config.listen_backlog,
+                                                     shard_count > 1)) {
+            return false;
+        }
+        if (shard.index == 0) {
+            m_listen_port = shard.listener->get_local_port();
+        }
+        return true;
+    }, true);
 
-    if (m_event_object != WSA_INVALID_EVENT) {
-        WSACloseEvent(m_event_object);
+    if (started) {
+        std::cout << "AsyncServer (" << to_string(get_io_engine()) << ", " << m_shards.size()
+                  << " reactor thread(s), " << to_string(m_config.socket_profile) << " sockets) listening on "
+                  << listen_address << ":" << m_listen_port << std::endl;
     }
+    return started;
 }
 
-bool AsyncServer::start(const std::string& listen_address, uint16_t port) noexcept
+bool AsyncServer::start_unix(const std::string& path) noexcept
+{
+    return start_local(path, false);
+}
+
+bool AsyncServer::start_shm(const std::string& path) noexcept
+{
+    if (!ShmChannel::is_supported()) {
+        std::cerr << "Shared-memory transport not supported on this platform" << std::endl;
+        return false;
+    }
+    return start_local(path, true);
+}
+
+bool AsyncServer::start_local(const std::string& path, bool shm_transport) noexcept
+{
+    m_listen_port = 0;
+    m_listen_path = path;
+    m_shm_transport = shm_transport;
+    m_cork_flushes = false;
+
+    // Shard 0 binds; the others poll their own duplicate of its socket (and options)
+    const bool started = start_shards([this, &path](Shard& shard, size_t) {
+        shard.listener = std::make_unique<AsyncSocket>(path, 0);
+        if (shard.index == 0) {
+            shard.listener->set_options(SocketOptions::for_profile(m_config.socket_profile));
+            return shard.listener->create_unix_listening_socket(path, m_config.listen_backlog);
+        }
+        return shard.listener->adopt_listening_socket(m_shards.front()->listener->get_socket());
+    }, false);
+
+    if (started) {
+        std::cout << "AsyncServer (" << to_string(get_io_engine()) << ", " << m_shards.size()
+                  << " reactor thread(s)) listening on unix:" << path
+                  << (shm_transport ? " (shared memory)" : "") << std::endl;
+    } else {
+        m_listen_path.clear();
+        m_shm_transport = false;
+    }
+    return started;
+}
+
+bool AsyncServer::start_shards(const ListenerFactory& open_listener, bool needs_reuse_port) noexcept
 {
     if (!AsyncSocket::initialize_winsock()) {
         std::cerr << "Failed to initialize Winsock" << std::endl;
         return false;
     }
 
-    if (!m_socket->create_listening_socket(listen_address, port)) {
+    size_t shard_count = m_config.num_reactor_threads;
+    if (shard_count == 0) {
+        shard_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    shard_count = std::min(shard_count, MAX_SHARDS);
+    if (needs_reuse_port && shard_count > 1 && !AsyncSocket::supports_reuse_port()) {
+        std::cerr << "SO_REUSEPORT unavailable, running a single reactor thread" << std::endl;
+        shard_count = 1;
+    }
+
+    m_shards.clear();
+    m_draining.store(false, std::memory_order_relaxed);
+
+    if (m_config.heartbeat_interval_ms != 0) {
+        const uint8_t no_payload = 0;
+        try {
+            m_ping_frame = make_frame(protocol::MessageType::PING, &no_payload, 0);
+        } catch (const std::bad_alloc&) {
+            m_ping_frame = SharedBuffer{};
+        }
+        if (m_ping_frame.empty()) {
+            std::cerr << "Failed to build heartbeat frame" << std::endl;
+            return false;
+        }
+    }
+
+    // stop() must not fail for want of memory; without the frame clients just see the close
+    try {
+        m_going_away_frame = make_going_away_frame();
+    } catch (const std::bad_alloc&) {
+        m_going_away_frame = SharedBuffer{};
+    }
+
+    for (size_t i = 0; i < shard_count; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->index = i;
+
+        if (!start_shard(*shard, open_listener, shard_count)) {
+            m_shards.clear();
+            AsyncSocket::cleanup_winsock();
+            return false;
+        }
+        m_shards.push_back(std::move(shard));
+    }
+
+    m_is_running.store(true, std::memory_order_release);
+    return true;
+}
+
+bool AsyncServer::start_shard(Shard& shard, const ListenerFactory& open_listener, size_t shard_count) noexcept
+{
+    // Shared-memory doorbells are polled for readiness; the rings need no I/O engine
+    if (m_config.io_engine == IoEngine::IO_URING && m_shm_transport) {
+        if (shard.index == 0) {
+            std::cerr << "Shared-memory transport runs on the readiness engine" << std::endl;
+        }
+    } else if (m_config.io_engine == IoEngine::IO_URING) {
+        if (IoUringEngine::is_supported()) {
+            shard.uring = std::make_unique<IoUringEngine>(m_config.uring_queue_depth,
+                                                          m_config.uring_buffer_count,
+                                                          m_config.uring_buffer_size);
+            if (!shard.uring->is_valid()) {
+                shard.uring.reset();
+            }
+        }
+
+        if (!shard.uring && shard.index == 0) {
+            std::cerr << "io_uring unavailable, falling back to readiness engine" << std::endl;
+        }
+    }
+
+    if (!shard.uring) {
+        shard.reactor = std::make_unique<Reactor>();
+        if (!shard.reactor->is_valid()) {
+            std::cerr << "Failed to create reactor" << std::endl;
+            return false;
+        }
+    }
+
+    if (!open_listener(shard, shard_count)) {
         std::cerr << "Failed to create listening socket" << std::endl;
-        AsyncSocket::cleanup_winsock();
         return false;
     }
 
-    if (!m_socket->set_async_mode(m_event_object, FD_ACCEPT | FD_READ | FD_WRITE | FD_CLOSE)) {
-        std::cerr << "Failed to set async mode" << std::endl;
-        AsyncSocket::cleanup_winsock();
+    shard.timers = TimerWheel(steady_now_ms(), m_config.timer_tick_ms);
+
+    SOCKET listen_socket = shard.listener->get_socket();
+    const bool registered = shard.uring ? shard.uring->accept_multishot(listen_socket, LISTENER_TOKEN)
+                                        : shard.reactor->add(listen_socket, Reactor::READABLE, LISTENER_TOKEN);
+    if (!registered) {
+        std::cerr << "Failed to register listening socket" << std::endl;
         return false;
     }
 
-    m_is_running.store(true, std::memory_order_release);
-    std::cout << "AsyncServer listening on " << listen_address << ":" << port << std::endl;
-
     return true;
 }
 
-void AsyncServer::stop() noexcept
+void AsyncServer::wake_shard(Shard& shard) noexcept
 {
-    m_is_running.store(false, std::memory_order_release);
+    if (shard.uring) {
+        shard.uring->wakeup();
+    } else if (shard.reactor) {
+        shard.reactor->wakeup();
+    }
+}
 
+void AsyncServer::stop() noexcept
+{
+    bool first = false;
     {
-        std::lock_guard<std::mutex> lock(m_connections_mutex);
-        m_connections.clear();
+        std::lock_guard<std::mutex> lock(m_stop_mutex);
+        if (!m_is_running.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        // Published before the flag: loops read them once they see it
+        if (!m_draining.load(std::memory_order_relaxed)) {
+            m_drain_deadline_ms.store(steady_now_ms() + m_config.drain_timeout_ms, std::memory_order_relaxed);
+            m_shards_draining.store(m_shards.size(), std::memory_order_relaxed);
+            m_draining.store(true, std::memory_order_release);
+            first = true;
+        }
+    }
+
+    if (first && m_active_runs.load(std::memory_order_acquire) == 0) {
+        // No loop to flush anything: the notice gets whatever the sockets take right away
+        for (auto& shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            begin_drain(*shard);
+        }
+        stop_now();
+        return;
+    }
+
+    if (first) {
+        for (auto& shard : m_shards) {
+            wake_shard(*shard);
+        }
+    }
+
+    // On a loop thread the drain can't progress while we wait; the last shard finishes it
+    if (t_loop_server == this) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_stop_mutex);
+    m_stopped.wait(lock, [this]() { return !m_is_running.load(std::memory_order_acquire); });
+}
+
+void AsyncServer::stop_now() noexcept
+{
+    if (!m_is_running.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    // Interrupt blocked shard loops so they observe the stop flag
+    for (auto& shard : m_shards) {
+        wake_shard(*shard);
+    }
+
+    for (auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->connections.for_each([&shard, this](ConnectionId, Connection& connection) {
+            if (shard->uring) {
+                // Fails any send still in flight before its buffer goes away
+                shutdown(connection.socket, SD_BOTH);
+            } else {
+                unregister_client(*shard, connection);
+            }
+        });
+        shard->connections.clear();
+        shard->read_ready.clear();
+        shard->flush_list.clear();
+        publish_count(*shard);
     }
 
     if (m_thread_pool) {
@@ -60,6 +333,11 @@ void AsyncServer::stop() noexcept
     }
 
     AsyncSocket::cleanup_winsock();
+
+    {
+        std::lock_guard<std::mutex> lock(m_stop_mutex);
+    }
+    m_stopped.notify_all();
 }
 
 void AsyncServer::run(unsigned long timeout_ms) noexcept
@@ -68,171 +346,1185 @@ void AsyncServer::run(unsigned long timeout_ms) noexcept
         return;
     }
 
-    while (m_is_running) {
-        // Wait for network events
-        DWORD dwRet = WSAWaitForMultipleEvents(1, &m_event_object, FALSE, timeout_ms, FALSE);
+    m_active_runs.fetch_add(1, std::memory_order_acq_rel);
+
+    const int wait_ms = (timeout_ms == INFINITE) ? -1 : static_cast<int>(timeout_ms);
 
-        if (dwRet == WSA_WAIT_TIMEOUT) {
+    // Reactor loops get dedicated threads: parking them on m_thread_pool would
+    // starve the pool of workers for application tasks
+    std::vector<std::thread> shard_threads;
+    shard_threads.reserve(m_shards.size());
+    for (size_t i = 1; i < m_shards.size(); ++i) {
+        shard_threads.emplace_back([this, i, wait_ms]() { run_shard(*m_shards[i], wait_ms); });
+    }
+
+    run_shard(*m_shards.front(), wait_ms);
+
+    for (auto& thread : shard_threads) {
+        thread.join();
+    }
+
+    m_active_runs.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void AsyncServer::run_shard(Shard& shard, int wait_ms) noexcept
+{
+    t_loop_server = this;
+    t_loop_shard = &shard;
+
+    if (shard.uring) {
+        run_uring(shard, wait_ms);
+        t_loop_server = nullptr;
+        t_loop_shard = nullptr;
+        return;
+    }
+
+    Reactor::Event events[MAX_EVENTS];
+
+    while (m_is_running) {
+        if (m_draining.load(std::memory_order_acquire) && !shard.drained && drain_shard(shard)) {
             continue;
         }
 
-        if (dwRet == WSA_WAIT_FAILED) {
-            std::cerr << "WSAWaitForMultipleEvents failed: " << WSAGetLastError() << std::endl;
+        resume_listener_if_possible(shard);
+        drain_broadcasts(shard);
+        dispatch_watermarks(shard);
+
+        // Only ready sockets are returned; idle connections cost nothing here.
+        // Leftover input from the last pass means there is work already: just poll.
+        const int timeout_ms = shard.read_ready.empty() ? next_wait_ms(shard, wait_ms) : 0;
+        int count = shard.reactor->wait(events, MAX_EVENTS, timeout_ms);
+
+        if (count < 0) {
+            std::cerr << "Reactor wait failed: " << last_socket_error() << std::endl;
             continue;
         }
 
-        // Process all events
-        process_events();
+        process_events(shard, events, static_cast<size_t>(count));
+        resume_budgeted_reads(shard);
 
-        // Reset event object for next iteration
-        WSAResetEvent(m_event_object);
+        if (!shard.timers.empty()) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            expire_timers(shard);
+        }
     }
+
+    t_loop_server = nullptr;
+    t_loop_shard = nullptr;
 }
 
-void AsyncServer::process_events() noexcept
+size_t AsyncServer::get_connection_count() const noexcept
 {
-    WSANETWORKEVENTS networkEvents;
+    size_t total = 0;
+    for (const auto& shard : m_shards) {
+        total += shard->connection_count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
 
-    // Check listening socket for new connections
-    {
-        int result = WSAEnumNetworkEvents(m_socket->get_socket(), m_event_object, &networkEvents);
-        if (result != SOCKET_ERROR) {
-            if (networkEvents.lNetworkEvents & FD_ACCEPT) {
-                if (networkEvents.iErrorCode[FD_ACCEPT_BIT] == 0) {
-                    handle_new_connection();
-                }
-            }
+size_t AsyncServer::get_connection_count(size_t shard_index) const noexcept
+{
+    if (shard_index >= m_shards.size()) {
+        return 0;
+    }
+    return m_shards[shard_index]->connection_count.load(std::memory_order_relaxed);
+}
+
+std::vector<ConnectionId> AsyncServer::get_connection_ids() const
+{
+    std::vector<ConnectionId> ids;
+    for (const auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (ConnectionId id : shard->connections.ids()) {
+            ids.push_back(public_id(*shard, id));
         }
     }
+    return ids;
+}
 
-    // Check client sockets for read/write events
-    {
-        std::lock_guard<std::mutex> lock(m_connections_mutex);
-        
-        for (auto it = m_connections.begin(); it != m_connections.end(); ) {
-            SOCKET client_socket = it->first;
-            auto& handler = it->second;
-
-            WSANETWORKEVENTS clientEvents;
-            int result = WSAEnumNetworkEvents(client_socket, WSA_INVALID_EVENT, &clientEvents);
-
-            if (result != SOCKET_ERROR) {
-                if (clientEvents.lNetworkEvents & FD_READ) {
-                    if (clientEvents.iErrorCode[FD_READ_BIT] == 0) {
-                        handle_client_read(client_socket);
-                    }
-                }
-
-                if (clientEvents.lNetworkEvents & FD_WRITE) {
-                    if (clientEvents.iErrorCode[FD_WRITE_BIT] == 0) {
-                        handle_client_write(client_socket);
-                    }
-                }
-
-                if (clientEvents.lNetworkEvents & FD_CLOSE) {
-                    on_connection_closed(client_socket);
-                    it = m_connections.erase(it);
-                    continue;
-                }
-            }
+AsyncServer::Connection* AsyncServer::find_connection(ConnectionId connection, std::unique_lock<std::mutex>& lock,
+                                                      Shard*& shard_out) noexcept
+{
+    // The shard index rides in the id: one lock, one slot lookup
+    const size_t shard_index = static_cast<size_t>(connection >> SHARD_SHIFT);
+    if (shard_index >= m_shards.size()) {
+        return nullptr;
+    }
 
-            if (!handler->is_active()) {
-                it = m_connections.erase(it);
-            } else {
-                ++it;
-            }
-        }
+    Shard& shard = *m_shards[shard_index];
+    if (t_callback_shard == &shard) {
+        std::cerr << "Connection " << connection << " looked up from a frame callback on its shard; "
+                  << "use the FrameReply" << std::endl;
+        return nullptr;
+    }
+
+    std::unique_lock<std::mutex> shard_lock(shard.mutex);
+    Connection* found = shard.connections.find(connection & ConnectionMap::ID_MASK);
+    if (!found || found->closing) {
+        return nullptr;
     }
+
+    lock = std::move(shard_lock);
+    shard_out = &shard;
+    return found;
 }
 
-void AsyncServer::handle_new_connection() noexcept
+void AsyncServer::arm_timers(Shard& shard, ConnectionId id, Connection& connection) noexcept
 {
-    if (m_connections.size() >= MAX_CONNECTIONS) {
-        std::cerr << "Max connections reached" << std::endl;
-        return;
+    const uint64_t now = steady_now_ms();
+    const uint64_t token = id;
+
+    if (m_config.idle_timeout_ms != 0) {
+        connection.idle_timer = shard.timers.schedule(now + m_config.idle_timeout_ms, token, IDLE_TIMER);
+    }
+    if (m_config.handshake_timeout_ms != 0) {
+        connection.handshake_timer = shard.timers.schedule(now + m_config.handshake_timeout_ms, token, HANDSHAKE_TIMER);
+    }
+    if (m_config.heartbeat_interval_ms != 0) {
+        connection.heartbeat_timer = shard.timers.schedule(now + m_config.heartbeat_interval_ms, token, HEARTBEAT_TIMER);
+    }
+}
+
+void AsyncServer::note_activity(Shard& shard, Connection& connection) noexcept
+{
+    if (connection.handshake_timer != TimerWheel::INVALID_TIMER) {
+        shard.timers.cancel(connection.handshake_timer);
+        connection.handshake_timer = TimerWheel::INVALID_TIMER;
     }
 
-    std::string client_address;
-    uint16_t client_port = 0;
+    // Later deadline: the wheel only records it, so this stays cheap on every read
+    if (connection.idle_timer != TimerWheel::INVALID_TIMER) {
+        shard.timers.reschedule(connection.idle_timer, steady_now_ms() + m_config.idle_timeout_ms);
+    }
+}
 
-    SOCKET client_socket = m_socket->accept_connection(client_address, client_port);
-    if (client_socket == INVALID_SOCKET) {
+void AsyncServer::watch_rate_limit(Shard& shard, ConnectionId id, Connection& connection) noexcept
+{
+    if (!connection.handler->is_rate_limited() || connection.rate_limit_timer != TimerWheel::INVALID_TIMER) {
         return;
     }
 
-    std::cout << "New connection from " << client_address << ":" << client_port << std::endl;
+    m_rate_limited_pauses.fetch_add(1, std::memory_order_relaxed);
+    const uint32_t delay_ms = std::max(connection.handler->get_rate_limit_delay_ms(), 1u);
+    connection.rate_limit_timer = shard.timers.schedule(steady_now_ms() + delay_ms, id, RATE_LIMIT_TIMER);
+    if (connection.rate_limit_timer == TimerWheel::INVALID_TIMER) {
+        std::cerr << "Out of memory scheduling rate limit resume for " << connection.socket << std::endl;
+    }
+}
 
-    auto handler = std::make_unique<ConnectionHandler>(client_socket, client_address, client_port);
+void AsyncServer::cancel_timers(Shard& shard, Connection& connection) noexcept
+{
+    for (TimerWheel::TimerId* timer : {&connection.idle_timer, &connection.handshake_timer,
+                                       &connection.heartbeat_timer, &connection.rate_limit_timer}) {
+        if (*timer != TimerWheel::INVALID_TIMER) {
+            shard.timers.cancel(*timer);
+            *timer = TimerWheel::INVALID_TIMER;
+        }
+    }
+}
 
-    // Set up callbacks
-    handler->set_data_received_callback([this, client_socket](const uint8_t* data, size_t length) {
-        std::cout << "Received " << length << " bytes from " << client_socket << std::endl;
-        // Echo the data back
-        send_to_client(client_socket, data, length);
-    });
+int AsyncServer::next_wait_ms(const Shard& shard, int wait_ms) const noexcept
+{
+    const uint64_t now = steady_now_ms();
+    int timer_ms = shard.timers.next_timeout_ms(now);
 
-    handler->set_connection_closed_callback([this, client_socket]() {
-        on_connection_closed(client_socket);
-    });
+    // A draining shard must look again at its deadline even if no socket wakes it
+    if (shard.draining && !shard.drained) {
+        const uint64_t deadline = m_drain_deadline_ms.load(std::memory_order_relaxed);
+        const int drain_ms = deadline > now ? static_cast<int>(std::min<uint64_t>(deadline - now, INT32_MAX)) : 0;
+        timer_ms = timer_ms < 0 ? drain_ms : std::min(timer_ms, drain_ms);
+    }
+
+    if (timer_ms < 0) {
+        return wait_ms;
+    }
+    return wait_ms < 0 ? timer_ms : std::min(wait_ms, timer_ms);
+}
+
+bool AsyncServer::drain_shard(Shard& shard) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.draining) {
+            begin_drain(shard);
+        }
+        close_flushed(shard);
+
+        if (!shard.connections.empty() &&
+            steady_now_ms() < m_drain_deadline_ms.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        shard.drained = true;
+    }
+
+    // Last shard out closes whatever is left everywhere and releases run()
+    if (m_shards_draining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        stop_now();
+    }
+    return true;
+}
+
+void AsyncServer::begin_drain(Shard& shard) noexcept
+{
+    shard.draining = true;
+
+    // Stop accepting: new clients get refused and reconnect elsewhere instead of queueing here
+    if (shard.listener) {
+        if (shard.uring) {
+            shard.uring->cancel(shard.listener->get_socket());
+        } else {
+            shard.reactor->remove(shard.listener->get_socket());
+        }
+        shard.listener.reset();
+    }
+
+    // No more reads: input would only produce more output to wait for
+    for (ConnectionId id : shard.read_ready) {
+        if (Connection* connection = shard.connections.find(id)) {
+            connection->read_ready_queued = false;
+        }
+    }
+    shard.read_ready.clear();
+
+    shard.connections.for_each([this, &shard](ConnectionId id, Connection& connection) {
+        if (connection.closing) {
+            return;
+        }
+
+        cancel_timers(shard, connection);
+        if (!m_going_away_frame.empty()) {
+            connection.handler->send_shared(m_going_away_frame);
+        }
 
-    std::lock_guard<std::mutex> lock(m_connections_mutex);
-    m_connections[client_socket] = std::move(handler);
+        if (shard.uring) {
+            update_uring_reads(shard, id, connection);
+            queue_flush(shard, id, connection);
+        } else {
+            update_interest(shard, id, connection);
+        }
+    });
 }
 
-void AsyncServer::handle_client_read(SOCKET client_socket) noexcept
+void AsyncServer::close_flushed(Shard& shard) noexcept
 {
-    std::lock_guard<std::mutex> lock(m_connections_mutex);
-    
-    auto it = m_connections.find(client_socket);
-    if (it != m_connections.end()) {
-        it->second->handle_read_event();
+    // Backwards: erase swaps the last record into the hole, and that one was already visited
+    const std::vector<ConnectionId>& ids = shard.connections.ids();
+    for (size_t i = ids.size(); i-- > 0;) {
+        const ConnectionId id = ids[i];
+        Connection& connection = *shard.connections.find(id);
+
+        if (connection.closing || connection.sends_in_flight > 0 ||
+            (connection.handler->has_pending_output() && connection.handler->is_active())) {
+            continue;
+        }
+
+        if (shard.uring) {
+            begin_uring_close(shard, connection);
+            reap_if_done(shard, id, connection);
+        } else {
+            remove_connection(shard, id, connection);
+        }
     }
+
+    publish_count(shard);
 }
 
-void AsyncServer::handle_client_write(SOCKET client_socket) noexcept
+void AsyncServer::expire_timers(Shard& shard) noexcept
 {
-    std::lock_guard<std::mutex> lock(m_connections_mutex);
-    
-    auto it = m_connections.find(client_socket);
-    if (it != m_connections.end()) {
-        it->second->handle_write_event();
+    if (shard.timers.empty()) {
+        return;
     }
+
+    shard.timers.advance(steady_now_ms(), [this, &shard](const TimerWheel::Expiry& expiry) {
+        handle_timer(shard, expiry);
+    });
 }
 
-void AsyncServer::on_connection_closed(SOCKET client_socket) noexcept
+void AsyncServer::handle_timer(Shard& shard, const TimerWheel::Expiry& expiry) noexcept
 {
-    std::cout << "Connection closed: " << client_socket << std::endl;
+    if (expiry.tag == ACCEPT_RETRY_TIMER) {
+        if (shard.accept_retry_timer == expiry.id) {
+            shard.accept_retry_timer = TimerWheel::INVALID_TIMER;
+            resume_listener_if_possible(shard);
+        }
+        return;
+    }
+
+    // Timers of a closed connection carry a stale id and find nothing
+    const ConnectionId id = expiry.token;
+    Connection* found = shard.connections.find(id);
+    if (!found) {
+        return;
+    }
+
+    Connection& connection = *found;
+    TimerWheel::TimerId* armed = expiry.tag == IDLE_TIMER        ? &connection.idle_timer
+                               : expiry.tag == HANDSHAKE_TIMER ? &connection.handshake_timer
+                               : expiry.tag == HEARTBEAT_TIMER ? &connection.heartbeat_timer
+                                                               : &connection.rate_limit_timer;
+    if (*armed != expiry.id) {
+        return;
+    }
+    *armed = TimerWheel::INVALID_TIMER;
+
+    if (connection.closing) {
+        return;
+    }
+
+    if (expiry.tag == RATE_LIMIT_TIMER) {
+        // Resuming dispatches frames held back in the decoder: they may reply, close or hit the limit again
+        const bool resumed = connection.handler->resume_if_rate_allows();
+        if (connection.handler->is_active()) {
+            if (!resumed) {
+                watch_rate_limit(shard, id, connection);    // Used up again, or drawn down by the address
+            }
+
+            if (shard.uring) {
+                update_uring_reads(shard, id, connection);
+                queue_flush(shard, id, connection);
+                return;
+            }
+
+            // Input left in the socket raises no new edge: read it on the next pass
+            update_interest(shard, id, connection);
+            if (resumed && !connection.read_ready_queued) {
+                connection.read_ready_queued = true;
+                shard.read_ready.push_back(id);
+            }
+            return;
+        }
+    } else if (expiry.tag == HEARTBEAT_TIMER) {
+        connection.handler->send_shared(m_ping_frame);
+        connection.heartbeat_timer = shard.timers.schedule(steady_now_ms() + m_config.heartbeat_interval_ms,
+                                                           expiry.token, HEARTBEAT_TIMER);
+        if (connection.handler->is_active()) {
+            if (shard.uring) {
+                queue_flush(shard, id, connection);
+            } else {
+                update_interest(shard, id, connection);
+            }
+            return;
+        }
+    } else {
+        std::cout << "Connection " << connection.socket << (expiry.tag == IDLE_TIMER ? " idle" : " silent after accept")
+                  << ", closing" << std::endl;
+    }
+
+    cancel_timers(shard, connection);
+    if (shard.uring) {
+        begin_uring_close(shard, connection);
+        reap_if_done(shard, id, connection);
+    } else {
+        remove_connection(shard, id, connection);
+    }
 }
 
-bool AsyncServer::send_to_client(SOCKET client_socket, const uint8_t* data, size_t length) noexcept
+void AsyncServer::process_events(Shard& shard, const Reactor::Event* events, size_t count) noexcept
 {
-    std::lock_guard<std::mutex> lock(m_connections_mutex);
-    
-    auto it = m_connections.find(client_socket);
-    if (it != m_connections.end()) {
-        return it->second->send_data(data, length);
+    for (size_t i = 0; i < count; ++i) {
+        const Reactor::Event& event = events[i];
+
+        if (event.token == LISTENER_TOKEN) {
+            handle_new_connection(shard);
+            continue;
+        }
+
+        // Shared-memory input (or room freed for output): the rings are drained by the read path
+        if (event.token & SHM_DOORBELL_TOKEN) {
+            handle_client_read(shard, event.token & ~SHM_DOORBELL_TOKEN);
+            continue;
+        }
+
+        const ConnectionId id = event.token;
+
+        // Zero-copy completions also raise FAILED; once they're drained it's not an error
+        bool failed = (event.events & Reactor::FAILED) != 0;
+        if (failed && m_config.zerocopy_threshold != 0) {
+            failed = !handle_client_error_queue(shard, id);
+        }
+
+        // Hang-ups and errors go through the read path so recv() reports them
+        if (failed || (event.events & (Reactor::READABLE | Reactor::CLOSED))) {
+            handle_client_read(shard, id, failed || (event.events & Reactor::CLOSED));
+        }
+
+        if (event.events & Reactor::WRITABLE) {
+            handle_client_write(shard, id);
+        }
     }
+}
 
-    return false;
+uint32_t AsyncServer::registration_flags() const noexcept
+{
+    return m_config.edge_triggered_reads ? Reactor::EDGE_TRIGGERED : 0;
 }
 
-void AsyncServer::broadcast(const uint8_t* data, size_t length) noexcept
+void AsyncServer::update_interest(Shard& shard, ConnectionId id, Connection& connection) noexcept
 {
-    std::lock_guard<std::mutex> lock(m_connections_mutex);
-    
-    for (auto& pair : m_connections) {
-        pair.second->send_data(data, length);
+    // Shared memory: output goes straight into the ring, the socket is watched for hang-up only
+    if (connection.handler->is_shm()) {
+        return;
     }
+
+    // Level-triggered: only ask for WRITABLE while output is queued, or the loop spins.
+    // Above the high watermark the socket isn't polled for reads at all.
+    // Draining: hang-ups are still reported, input is left unread.
+    uint32_t interest = (connection.handler->is_read_paused() || shard.draining) ? 0 : Reactor::READABLE;
+    if (connection.handler->has_pending_output()) {
+        interest |= Reactor::WRITABLE;
+    }
+    interest |= registration_flags();
+
+    if (interest != connection.interest) {
+        if (shard.reactor->modify(connection.socket, interest, id)) {
+            connection.interest = interest;
+        }
+    }
+}
+
+void AsyncServer::publish_count(Shard& shard) noexcept
+{
+    const size_t count = shard.connections.size();
+    const size_t previous = shard.connection_count.exchange(count, std::memory_order_relaxed);
+
+    if (count < previous && m_paused_listeners.load(std::memory_order_relaxed) > 0) {
+        // The owning loop resumes its own listener before it waits again, unless an API thread closed it
+        const bool on_own_loop = t_loop_shard == &shard;
+        for (auto& other : m_shards) {
+            if ((other.get() != &shard || !on_own_loop) && other->listener_paused.load(std::memory_order_relaxed)) {
+                wake_shard(*other);
+            }
+        }
+    }
+}
+
+void AsyncServer::pause_listener(Shard& shard) noexcept
+{
+    if (shard.listener_paused.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // Readiness: drop interest; io_uring: cancel the multishot accept
+    SOCKET listen_socket = shard.listener->get_socket();
+    const bool paused = shard.uring ? shard.uring->cancel(listen_socket)
+                                    : shard.reactor->modify(listen_socket, 0, LISTENER_TOKEN);
+    if (!paused) {
+        return;
+    }
+
+    shard.listener_paused.store(true, std::memory_order_relaxed);
+    m_paused_listeners.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AsyncServer::resume_listener_if_possible(Shard& shard) noexcept
+{
+    if (!shard.listener_paused.load(std::memory_order_relaxed) || shard.draining || at_capacity() ||
+        shard.accept_retry_timer != TimerWheel::INVALID_TIMER) {
+        return;
+    }
+
+    SOCKET listen_socket = shard.listener->get_socket();
+    const bool resumed = shard.uring ? shard.uring->accept_multishot(listen_socket, LISTENER_TOKEN)
+                                     : shard.reactor->modify(listen_socket, Reactor::READABLE, LISTENER_TOKEN);
+    if (!resumed) {
+        return;
+    }
+
+    shard.listener_paused.store(false, std::memory_order_relaxed);
+    m_paused_listeners.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void AsyncServer::back_off_accepts(Shard& shard, int error) noexcept
+{
+    if (shard.accept_retry_timer != TimerWheel::INVALID_TIMER) {
+        return;
+    }
+
+    std::cerr << "accept() out of resources (" << error << "), pausing listener for "
+              << m_config.accept_retry_ms << " ms" << std::endl;
+    m_accept_backoffs.fetch_add(1, std::memory_order_relaxed);
+    pause_listener(shard);
+    shard.accept_retry_timer = shard.timers.schedule(steady_now_ms() + std::max(m_config.accept_retry_ms, 1u),
+                                                     LISTENER_TOKEN, ACCEPT_RETRY_TIMER);
+}
+
+void AsyncServer::handle_new_connection(Shard& shard) noexcept
+{
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // Drain the backlog: one readiness event can stand for many queued connections
+    for (size_t accepted = 0; accepted < m_config.max_accepts_per_wakeup; ++accepted) {
+        if (at_capacity() && m_config.overload_policy == OverloadPolicy::PAUSE_LISTENER) {
+            pause_listener(shard);
+            return;
+        }
+
+        PeerAddress peer;
+        SOCKET client_socket = shard.listener->accept_connection(peer);
+        if (client_socket == INVALID_SOCKET) {
+            const int error = last_socket_error();
+            if (is_resource_exhausted(error)) {
+                back_off_accepts(shard, error);
+            }
+            return; // Backlog drained (or a transient accept error)
+        }
+
+        if (at_capacity()) {
+            // ACCEPT_AND_CLOSE: the client sees an immediate close instead of SYN retries
+            close_socket(client_socket);
+            m_rejected_connections.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        auto handler = make_handler(client_socket, peer);
+        if (m_shm_transport && !upgrade_to_shm(*handler, client_socket)) {
+            continue; // handler destructor closes the socket
+        }
+        if (m_config.zerocopy_threshold != 0 && !handler->is_shm()) {
+            handler->enable_zerocopy(m_config.zerocopy_threshold, &m_zerocopy_stats);
+        }
+
+        const ConnectionId id = add_connection(shard, std::move(handler), client_socket);
+        if (id == INVALID_CONNECTION_ID) {
+            continue;
+        }
+
+        Connection& connection = *shard.connections.find(id);
+        connection.interest = register_client(shard, id, connection);
+        if (connection.interest == 0) {
+            cancel_timers(shard, connection);
+            shard.connections.erase(id);    // handler destructor closes the socket
+            publish_count(shard);
+        }
+    }
+}
+
+ConnectionId AsyncServer::add_connection(Shard& shard, std::unique_ptr<ConnectionHandler> handler,
+                                         SOCKET client_socket) noexcept
+{
+    ConnectionHandler& stored_handler = *handler;
+    const ConnectionId id = shard.connections.insert(Connection{std::move(handler), client_socket});
+    if (id == INVALID_CONNECTION_ID) {
+        std::cerr << "Out of memory storing connection " << client_socket << std::endl;
+        return INVALID_CONNECTION_ID;   // the handler went with the failed insert and closed the socket
+    }
+
+    watch_watermarks(shard, id, stored_handler);
+    if (!watch_frames(shard, id, stored_handler)) {
+        shard.connections.erase(id);    // handler destructor closes the socket
+        return INVALID_CONNECTION_ID;
+    }
+    arm_timers(shard, id, *shard.connections.find(id));
+    publish_count(shard);
+    return id;
+}
+
+void AsyncServer::remove_connection(Shard& shard, ConnectionId id, Connection& connection) noexcept
+{
+    cancel_timers(shard, connection);
+    unregister_client(shard, connection);
+    shard.connections.erase(id);
+    publish_count(shard);
+}
+
+bool AsyncServer::upgrade_to_shm(ConnectionHandler& handler, SOCKET client_socket) noexcept
+{
+    auto channel = ShmChannel::create(m_config.shm_ring_bytes);
+    if (!channel || !channel->send_handshake(client_socket)) {
+        return false;
+    }
+    return handler.attach_shm(std::move(channel));
+}
+
+uint32_t AsyncServer::register_client(Shard& shard, ConnectionId id, const Connection& connection) noexcept
+{
+    const uint32_t interest = Reactor::READABLE | registration_flags();
+
+    if (!shard.reactor->add(connection.socket, interest, id)) {
+        return 0;
+    }
+
+    const ConnectionHandler& handler = *connection.handler;
+    if (handler.is_shm() &&
+        !shard.reactor->add(handler.get_shm_doorbell(), interest, id | SHM_DOORBELL_TOKEN)) {
+        shard.reactor->remove(connection.socket);
+        return 0;
+    }
+    return interest;
+}
+
+void AsyncServer::unregister_client(Shard& shard, const Connection& connection) noexcept
+{
+    shard.reactor->remove(connection.socket);
+
+    // The client holds a copy of the doorbell, so closing ours wouldn't deregister it
+    if (connection.handler && connection.handler->is_shm()) {
+        shard.reactor->remove(connection.handler->get_shm_doorbell());
+    }
+}
+
+std::unique_ptr<ConnectionHandler> AsyncServer::make_handler(SOCKET client_socket, const PeerAddress& peer) noexcept
+{
+    auto handler = std::make_unique<ConnectionHandler>(client_socket, peer);
+    ConnectionHandler* raw_handler = handler.get();
+
+    handler->set_output_watermarks(m_config.output_low_watermark, m_config.output_high_watermark);
+    handler->set_cork_flushes(m_cork_flushes);
+
+    // Always attached, so limits switched on later cover existing connections too
+    handler->set_rate_limiter(m_rate_limits.make_limiter(client_socket, peer));
+
+    // Set up callbacks (invoked on the owning shard's thread with its mutex held)
+    const bool trace = m_config.trace_echo;
+    handler->set_data_received_callback([raw_handler, client_socket, trace](const uint8_t* data, size_t length) {
+        if (trace) {
+            std::cout << "Received " << length << " bytes from " << client_socket << std::endl;
+        }
+        // Echo the data back
+        raw_handler->send_data(data, length);
+    });
+
+    handler->set_connection_closed_callback([this, client_socket]() {
+        on_connection_closed(client_socket);
+    });
+
+    return handler;
+}
+
+void AsyncServer::watch_watermarks(Shard& shard, ConnectionId id, ConnectionHandler& handler) noexcept
+{
+    if (!m_on_watermark) {
+        return;
+    }
+
+    // Crossings happen with the shard locked; the user callback runs once it's released
+    const ConnectionId connection = public_id(shard, id);
+    handler.set_watermark_callback([&shard, connection](bool above_high_watermark) {
+        try {
+            shard.watermark_events.emplace_back(connection, above_high_watermark);
+        } catch (const std::bad_alloc&) {
+            std::cerr << "Out of memory queueing watermark event for " << connection << std::endl;
+            return;
+        }
+
+        // Crossed by send_to_client() on another thread: the loop may be asleep
+        if (t_loop_shard != &shard) {
+            wake_shard(shard);
+        }
+    });
+}
+
+void AsyncServer::dispatch_watermarks(Shard& shard) noexcept
+{
+    if (!m_on_watermark) {
+        return;
+    }
+
+    std::vector<std::pair<ConnectionId, bool>> pending;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.watermark_events.empty()) {
+            return;
+        }
+        pending.swap(shard.watermark_events);
+    }
+
+    for (const auto& [connection, above_high_watermark] : pending) {
+        m_on_watermark(connection, above_high_watermark);
+    }
+
+    // Hand the storage back so steady-state passes don't allocate
+    pending.clear();
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.watermark_events.empty()) {
+        pending.swap(shard.watermark_events);
+    }
+}
+
+bool AsyncServer::watch_frames(const Shard& shard, ConnectionId id, ConnectionHandler& handler) noexcept
+{
+    if (!m_on_frame) {
+        return true;
+    }
+
+    const ConnectionId connection = public_id(shard, id);
+    const void* locked_shard = &shard;
+    return handler.set_frame_callback([this, connection, locked_shard, &handler](const protocol::FrameView& frame) {
+        FrameReply reply(connection, handler);
+        const void* outer = std::exchange(t_callback_shard, locked_shard);
+        m_on_frame(reply, frame);
+        t_callback_shard = outer;
+    }, m_frame_policy);
+}
+
+void AsyncServer::handle_client_read(Shard& shard, ConnectionId id, bool hang_up) noexcept
+{
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    Connection* connection = shard.connections.find(id);
+    if (!connection) {
+        return;
+    }
+
+    const size_t received_before = connection->handler->get_bytes_received();
+    const bool input_left = connection->handler->handle_read_event(m_config.read_budget_bytes, hang_up);
+
+    if (!connection->handler->is_active()) {
+        remove_connection(shard, id, *connection);
+        return;
+    }
+
+    if (connection->handler->get_bytes_received() != received_before) {
+        note_activity(shard, *connection);
+    }
+    watch_rate_limit(shard, id, *connection);
+
+    // Edge-triggered: no new event will come for input already buffered in the socket
+    if (input_left && (m_config.edge_triggered_reads || connection->handler->is_shm()) &&
+        !connection->read_ready_queued) {
+        connection->read_ready_queued = true;
+        shard.read_ready.push_back(id);
+    }
+
+    update_interest(shard, id, *connection);
+}
+
+void AsyncServer::resume_budgeted_reads(Shard& shard) noexcept
+{
+    if (shard.read_ready.empty()) {
+        return;
+    }
+
+    // Swap out first: a socket that exhausts its budget again is queued for the next pass
+    std::vector<ConnectionId> pending;
+    pending.swap(shard.read_ready);
+    for (ConnectionId id : pending) {
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            Connection* connection = shard.connections.find(id);
+            if (!connection) {
+                continue;
+            }
+            connection->read_ready_queued = false;
+        }
+        handle_client_read(shard, id);
+    }
+
+    // Hand the storage back so steady-state passes don't allocate
+    pending.clear();
+    if (shard.read_ready.empty()) {
+        shard.read_ready.swap(pending);
+    }
+}
+
+bool AsyncServer::handle_client_error_queue(Shard& shard, ConnectionId id) noexcept
+{
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    Connection* connection = shard.connections.find(id);
+    return connection && connection->handler->reap_zerocopy_completions();
+}
+
+void AsyncServer::handle_client_write(Shard& shard, ConnectionId id) noexcept
+{
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    Connection* connection = shard.connections.find(id);
+    if (!connection) {
+        return;
+    }
+
+    connection->handler->handle_write_event();
+
+    if (!connection->handler->is_active()) {
+        remove_connection(shard, id, *connection);
+        return;
+    }
+
+    update_interest(shard, id, *connection);
+}
+
+void AsyncServer::on_connection_closed(SOCKET client_socket) noexcept
+{
+    std::cout << "Connection closed: " << client_socket << std::endl;
+}
+
+bool AsyncServer::send_to_client(ConnectionId connection, const uint8_t* data, size_t length) noexcept
+{
+    std::unique_lock<std::mutex> lock;
+    Shard* shard = nullptr;
+    Connection* found = find_connection(connection, lock, shard);
+    if (!found) {
+        return false;
+    }
+
+    const ConnectionId id = connection & ConnectionMap::ID_MASK;
+    bool result = found->handler->send_data(data, length);
+    if (shard->uring) {
+        queue_flush(*shard, id, *found);
+    } else {
+        update_interest(*shard, id, *found);
+    }
+    return result;
+}
+
+void AsyncServer::broadcast(const uint8_t* data, size_t length) noexcept
+{
+    if (!data || length == 0) {
+        return;
+    }
+
+    SharedBuffer payload;
+    try {
+        payload = SharedBuffer::copy_of(data, length);
+    } catch (const std::bad_alloc&) {
+        std::cerr << "Out of memory framing " << length << " byte broadcast" << std::endl;
+        return;
+    }
+
+    broadcast(payload);
+}
+
+void AsyncServer::broadcast(const SharedBuffer& payload) noexcept
+{
+    if (payload.empty()) {
+        return;
+    }
+
+    // Hand the payload to every shard; no connection lock is taken on this thread
+    for (auto& shard : m_shards) {
+        bool first = false;
+        try {
+            std::lock_guard<std::mutex> lock(shard->inbox_mutex);
+            first = shard->broadcast_inbox.empty();
+            shard->broadcast_inbox.push_back(payload);
+        } catch (const std::bad_alloc&) {
+            std::cerr << "Out of memory queueing broadcast for shard " << shard->index << std::endl;
+            continue;
+        }
+
+        if (first) {
+            wake_shard(*shard);
+        }
+    }
+}
+
+void AsyncServer::drain_broadcasts(Shard& shard) noexcept
+{
+    std::vector<SharedBuffer> pending;
+    {
+        std::lock_guard<std::mutex> lock(shard.inbox_mutex);
+        if (shard.broadcast_inbox.empty()) {
+            return;
+        }
+        pending.swap(shard.broadcast_inbox);
+    }
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // Queued from the loop itself: queue_flush() needn't wake it
+    shard.in_completions = true;
+    for (const SharedBuffer& payload : pending) {
+        shard.connections.for_each([&](ConnectionId id, Connection& connection) {
+            if (connection.closing) {
+                return;
+            }
+
+            connection.handler->send_shared(payload);
+            if (shard.uring) {
+                queue_flush(shard, id, connection);
+            } else {
+                update_interest(shard, id, connection);
+            }
+        });
+    }
+    shard.in_completions = false;
+}
+
+void AsyncServer::close_client(ConnectionId connection) noexcept
+{
+    std::unique_lock<std::mutex> lock;
+    Shard* shard = nullptr;
+    Connection* found = find_connection(connection, lock, shard);
+    if (!found) {
+        return;
+    }
+
+    if (shard->uring) {
+        // The ring belongs to the loop thread: shutdown() ends the pending recv with
+        // EOF and the loop tears the connection down from there
+        shutdown(found->socket, SD_BOTH);
+        return;
+    }
+
+    // Timers stay in the loop's wheel: they fire on a stale id and find nothing
+    unregister_client(*shard, *found);
+    found->handler->close();
+    shard->connections.erase(connection & ConnectionMap::ID_MASK);
+    publish_count(*shard);
+}
+
+// ============ io_uring engine ============
+
+void AsyncServer::run_uring(Shard& shard, int wait_ms) noexcept
+{
+    const auto on_completion = [this, &shard](const IoUringEngine::Completion& completion) {
+        handle_completion(shard, completion);
+    };
+
+    while (m_is_running) {
+        if (m_draining.load(std::memory_order_acquire) && !shard.drained && drain_shard(shard)) {
+            continue;
+        }
+
+        resume_listener_if_possible(shard);
+        drain_broadcasts(shard);
+        flush_uring_output(shard);
+        dispatch_watermarks(shard);
+
+        // One syscall submits new work and waits for completions
+        if (shard.uring->submit_and_wait(next_wait_ms(shard, wait_ms)) < 0) {
+            std::cerr << "io_uring wait failed" << std::endl;
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.in_completions = true;
+        shard.uring->process_completions(on_completion);
+        expire_timers(shard);
+        shard.in_completions = false;
+        publish_count(shard);
+    }
+}
+
+void AsyncServer::handle_completion(Shard& shard, const IoUringEngine::Completion& completion) noexcept
+{
+    using Operation = IoUringEngine::Operation;
+
+    if (completion.operation == Operation::CANCEL) {
+        return;
+    }
+
+    if (completion.operation == Operation::ACCEPT) {
+        if (completion.result >= 0) {
+            handle_uring_accept(shard, static_cast<SOCKET>(completion.result));
+        } else if (is_resource_exhausted(-completion.result)) {
+            back_off_accepts(shard, -completion.result);
+        } else if (completion.result != -ECANCELED) {
+            std::cerr << "io_uring accept failed: " << -completion.result << std::endl;
+        }
+
+        // The kernel drops a multishot request on error or overflow; re-arm it
+        // unless the overload policy cancelled it on purpose
+        if (!completion.more && m_is_running && !shard.draining &&
+            !shard.listener_paused.load(std::memory_order_relaxed)) {
+            shard.uring->accept_multishot(shard.listener->get_socket(), LISTENER_TOKEN);
+        }
+        return;
+    }
+
+    const ConnectionId id = completion.token;
+    Connection* found = shard.connections.find(id);
+    if (!found) {
+        if (completion.data) {
+            shard.uring->recycle_buffer(completion.buffer_id);
+        }
+        return;
+    }
+
+    Connection& connection = *found;
+
+    if (completion.operation == Operation::RECV) {
+        if (!completion.more) {
+            connection.recv_armed = false;
+        }
+
+        // Bytes already taken off the socket are delivered even if reads are being paused
+        if (completion.result > 0 && completion.data && !connection.closing) {
+            note_activity(shard, connection);
+            connection.handler->deliver_received(completion.data, static_cast<size_t>(completion.result));
+        }
+        if (completion.data) {
+            shard.uring->recycle_buffer(completion.buffer_id);
+        }
+
+        // Ran out of ring buffers, ended by the kernel or cancelled by backpressure:
+        // update_uring_reads() below re-arms when appropriate
+        const bool keep_reading = completion.result > 0 || completion.result == -ENOBUFS ||
+                                  completion.result == -ECANCELED;
+        if (!connection.closing && !keep_reading) {
+            if (completion.result < 0) {
+                std::cerr << "io_uring recv failed: " << -completion.result << std::endl;
+            }
+            begin_uring_close(shard, connection);
+        }
+    } else if (completion.operation == Operation::SEND) {
+        --connection.sends_in_flight;
+
+        if (completion.result < 0) {
+            if (!connection.closing && completion.result != -ECANCELED) {
+                std::cerr << "io_uring send failed: " << -completion.result << std::endl;
+            }
+            begin_uring_close(shard, connection);
+        } else if (connection.sends_in_flight == 0 && !connection.closing) {
+            // Whole chain is out: release it and start the next one
+            connection.handler->consume_output(connection.bytes_in_flight);
+            connection.bytes_in_flight = 0;
+        }
+    }
+
+    if (!connection.closing && !connection.handler->is_active()) {
+        begin_uring_close(shard, connection);
+    }
+
+    if (connection.closing) {
+        reap_if_done(shard, id, connection);
+        return;
+    }
+
+    watch_rate_limit(shard, id, connection);
+    update_uring_reads(shard, id, connection);
+    queue_flush(shard, id, connection);
+}
+
+void AsyncServer::handle_uring_accept(Shard& shard, SOCKET client_socket) noexcept
+{
+    // Completed before the drain cancelled the accept
+    if (shard.draining) {
+        close_socket(client_socket);
+        return;
+    }
+
+    if (at_capacity()) {
+        close_socket(client_socket);
+        m_rejected_connections.fetch_add(1, std::memory_order_relaxed);
+        if (m_config.overload_policy == OverloadPolicy::PAUSE_LISTENER) {
+            pause_listener(shard);
+        }
+        return;
+    }
+
+    // Multishot accept shares one address buffer, so the peer is resolved lazily instead
+    auto handler = make_handler(client_socket, PeerAddress{});
+    handler->set_completion_mode(true);
+
+    const ConnectionId id = add_connection(shard, std::move(handler), client_socket);
+    if (id == INVALID_CONNECTION_ID) {
+        return;
+    }
+
+    Connection& connection = *shard.connections.find(id);
+    if (!shard.uring->recv_multishot(client_socket, id)) {
+        cancel_timers(shard, connection);
+        shard.connections.erase(id);    // handler destructor closes the socket
+        publish_count(shard);
+        return;
+    }
+    connection.recv_armed = true;
+
+    // Cancel the multishot accept now, before the kernel hands over sockets we'd have to drop
+    if (at_capacity() && m_config.overload_policy == OverloadPolicy::PAUSE_LISTENER) {
+        pause_listener(shard);
+    }
+}
+
+void AsyncServer::queue_flush(Shard& shard, ConnectionId id, Connection& connection) noexcept
+{
+    // One chain per connection at a time keeps the queued bytes in place while the kernel reads them
+    if (connection.flush_queued || connection.closing || connection.sends_in_flight > 0 ||
+        !connection.handler->has_pending_output()) {
+        return;
+    }
+
+    connection.flush_queued = true;
+    shard.flush_list.push_back(id);
+
+    // Calls from the loop itself are picked up before the next wait
+    if (!shard.in_completions && shard.flush_list.size() == 1) {
+        shard.uring->wakeup();
+    }
+}
+
+void AsyncServer::update_uring_reads(Shard& shard, ConnectionId id, Connection& connection) noexcept
+{
+    if (connection.handler->is_read_paused() || shard.draining) {
+        if (connection.recv_armed && !connection.recv_cancelled &&
+            shard.uring->cancel(IoUringEngine::Operation::RECV, id)) {
+            connection.recv_cancelled = true;
+        }
+        return;
+    }
+
+    // A cancel still in flight completes with -ECANCELED and lands back here to re-arm
+    connection.recv_cancelled = false;
+    if (!connection.recv_armed && shard.uring->recv_multishot(connection.socket, id)) {
+        connection.recv_armed = true;
+    }
+}
+
+void AsyncServer::flush_uring_output(Shard& shard) noexcept
+{
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    IoSlice slices[IoUringEngine::MAX_LINKED_SENDS];
+
+    for (ConnectionId id : shard.flush_list) {
+        Connection* found = shard.connections.find(id);
+        if (!found) {
+            continue;
+        }
+
+        Connection& connection = *found;
+        connection.flush_queued = false;
+        if (connection.closing || connection.sends_in_flight > 0) {
+            continue;
+        }
+
+        // Output queued from other threads may have crossed the high watermark
+        update_uring_reads(shard, id, connection);
+
+        size_t count = connection.handler->gather_output(slices, IoUringEngine::MAX_LINKED_SENDS);
+        if (count == 0) {
+            continue;
+        }
+
+        if (!shard.uring->send_linked(connection.socket, id, slices, count)) {
+            std::cerr << "io_uring send queue full" << std::endl;
+            begin_uring_close(shard, connection);
+            reap_if_done(shard, id, connection);
+            continue;
+        }
+
+        connection.sends_in_flight = count;
+        connection.bytes_in_flight = 0;
+        for (size_t i = 0; i < count; ++i) {
+            connection.bytes_in_flight += io_slice_length(slices[i]);
+        }
+    }
+
+    shard.flush_list.clear();
+    publish_count(shard);
+}
+
+void AsyncServer::begin_uring_close(Shard& shard, Connection& connection) noexcept
+{
+    if (connection.closing) {
+        return;
+    }
+
+    connection.closing = true;
+
+    // shutdown() completes outstanding requests; the fd stays open so it can't be reused yet
+    shutdown(connection.socket, SD_BOTH);
+    shard.uring->cancel(connection.socket);
+    connection.handler->mark_closed();
 }
 
-void AsyncServer::close_client(SOCKET client_socket) noexcept
+void AsyncServer::reap_if_done(Shard& shard, ConnectionId id, Connection& connection) noexcept
 {
-    std::lock_guard<std::mutex> lock(m_connections_mutex);
-    
-    auto it = m_connections.find(client_socket);
-    if (it != m_connections.end()) {
-        it->second->close();
-        m_connections.erase(it);
+    if (connection.closing && !connection.recv_armed && connection.sends_in_flight == 0) {
+        cancel_timers(shard, connection);
+        shard.connections.erase(id); // handler destructor closes the socket
     }
 }
 
@@ -1,16 +1,78 @@
 #include "AsyncSocket.h"
 #include <iostream>
 #include <sstream>
+#include <cstddef>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
 #include <iphlpapi.h>
 
 #pragma comment(lib, "iphlpapi.lib")
 #pragma comment(lib, "ws2_32.lib")
+#endif
 
 namespace core {
 namespace net {
 
 std::atomic<int> AsyncSocket::s_winsock_count(0);
 
+namespace {
+
+#ifndef _WIN32
+// Fill a sockaddr_un; a leading '@' selects the abstract namespace
+bool make_unix_address(const std::string& path, sockaddr_un& address, socklen_t& address_len) noexcept
+{
+    address = sockaddr_un{};
+    address.sun_family = AF_UNIX;
+
+    const bool is_abstract = !path.empty() && path[0] == '@';
+#ifndef __linux__
+    if (is_abstract) {
+        std::cerr << "Abstract Unix socket names are only supported on Linux" << std::endl;
+        return false;
+    }
+#endif
+
+    // Abstract names are length-delimited; filesystem paths need their terminator
+    const size_t terminator = is_abstract ? 0 : 1;
+    if (path.size() <= 1 || path.size() + terminator > sizeof(address.sun_path)) {
+        std::cerr << "Invalid Unix socket path: " << path << std::endl;
+        return false;
+    }
+
+    std::memcpy(address.sun_path, path.data(), path.size());
+    if (is_abstract) {
+        address.sun_path[0] = '\0';
+    }
+    address_len = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + terminator);
+    return true;
+}
+
+// The file of a listener that exited without cleaning up refuses connections
+bool is_stale_socket_file(const std::string& path, const sockaddr_un& address, socklen_t address_len) noexcept
+{
+    struct stat info{};
+    if (lstat(path.c_str(), &info) != 0 || !S_ISSOCK(info.st_mode)) {
+        return false;
+    }
+
+    SOCKET probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe == INVALID_SOCKET) {
+        return false;
+    }
+    const bool refused = ::connect(probe, reinterpret_cast<const sockaddr*>(&address), address_len) == SOCKET_ERROR &&
+                         last_socket_error() == ECONNREFUSED;
+    close_socket(probe);
+    return refused;
+}
+#endif
+
+} // namespace
+
 AsyncSocket::AsyncSocket(const std::string& address, uint16_t port)
     : m_socket(INVALID_SOCKET)
     , m_address(address)
@@ -21,13 +83,22 @@ AsyncSocket::AsyncSocket(const std::string& address, uint16_t port)
 AsyncSocket::~AsyncSocket() noexcept
 {
     if (m_socket != INVALID_SOCKET) {
-        closesocket(m_socket);
+        close_socket(m_socket);
         m_socket = INVALID_SOCKET;
     }
+
+#ifndef _WIN32
+    if (!m_bound_path.empty()) {
+        ::unlink(m_bound_path.c_str());
+    }
+#endif
 }
 
 bool AsyncSocket::initialize_winsock() noexcept
 {
+#ifndef _WIN32
+    return true;
+#else
     if (s_winsock_count.fetch_add(1) > 0) {
         // Already initialized
         return true;
@@ -43,33 +114,57 @@ bool AsyncSocket::initialize_winsock() noexcept
     }
 
     return true;
+#endif
 }
 
 void AsyncSocket::cleanup_winsock() noexcept
 {
+#ifdef _WIN32
     if (s_winsock_count.fetch_sub(1) == 1) {
         WSACleanup();
     }
+#endif
 }
 
-bool AsyncSocket::create_listening_socket(const std::string& listen_address, uint16_t port, int backlog) noexcept
+bool AsyncSocket::create_listening_socket(const std::string& listen_address, uint16_t port, int backlog,
+                                          bool reuse_port) noexcept
 {
     // Create socket
     m_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (m_socket == INVALID_SOCKET) {
-        std::cerr << "socket() failed: " << WSAGetLastError() << std::endl;
+        std::cerr << "socket() failed: " << last_socket_error() << std::endl;
         return false;
     }
 
     // Set socket to non-blocking mode
-    unsigned long mode = 1;
-    if (ioctlsocket(m_socket, FIONBIO, &mode) == SOCKET_ERROR) {
-        std::cerr << "ioctlsocket() failed: " << WSAGetLastError() << std::endl;
-        closesocket(m_socket);
+    if (!set_non_blocking(m_socket)) {
+        std::cerr << "set_non_blocking() failed: " << last_socket_error() << std::endl;
+        close_socket(m_socket);
         m_socket = INVALID_SOCKET;
         return false;
     }
 
+#if defined(SO_REUSEPORT) && !defined(_WIN32)
+    int enable = 1;
+    if (reuse_port && setsockopt(m_socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) == SOCKET_ERROR) {
+        std::cerr << "setsockopt(SO_REUSEPORT) failed: " << last_socket_error() << std::endl;
+        close_socket(m_socket);
+        m_socket = INVALID_SOCKET;
+        return false;
+    }
+#else
+    if (reuse_port) {
+        std::cerr << "SO_REUSEPORT not supported on this platform" << std::endl;
+        close_socket(m_socket);
+        m_socket = INVALID_SOCKET;
+        return false;
+    }
+#endif
+
+    // Before listen(): the receive buffer size fixes the window scale offered in the handshake
+    m_is_tcp = true;
+    apply_socket_options(m_socket, m_options, true);
+
     // Bind socket
     sockaddr_in sockaddr;
     sockaddr.sin_family = AF_INET;
@@ -77,23 +172,23 @@ bool AsyncSocket::create_listening_socket(const std::string& listen_address, uin
     sockaddr.sin_addr.s_addr = inet_addr(listen_address.c_str());
     
     if (sockaddr.sin_addr.s_addr == INADDR_NONE) {
-        std::cerr << "inet_addr() failed: " << WSAGetLastError() << std::endl;
-        closesocket(m_socket);
+        std::cerr << "inet_addr() failed: " << last_socket_error() << std::endl;
+        close_socket(m_socket);
         m_socket = INVALID_SOCKET;
         return false;
     }
 
     if (bind(m_socket, (struct sockaddr*)&sockaddr, sizeof(sockaddr)) == SOCKET_ERROR) {
-        std::cerr << "bind() failed: " << WSAGetLastError() << std::endl;
-        closesocket(m_socket);
+        std::cerr << "bind() failed: " << last_socket_error() << std::endl;
+        close_socket(m_socket);
         m_socket = INVALID_SOCKET;
         return false;
     }
 
     // Listen for connections
     if (listen(m_socket, backlog) == SOCKET_ERROR) {
-        std::cerr << "listen() failed: " << WSAGetLastError() << std::endl;
-        closesocket(m_socket);
+        std::cerr << "listen() failed: " << last_socket_error() << std::endl;
+        close_socket(m_socket);
         m_socket = INVALID_SOCKET;
         return false;
     }
@@ -103,27 +198,130 @@ bool AsyncSocket::create_listening_socket(const std::string& listen_address, uin
     return true;
 }
 
+bool AsyncSocket::create_unix_listening_socket(const std::string& path, int backlog) noexcept
+{
+#ifdef _WIN32
+    (void)path;
+    (void)backlog;
+    std::cerr << "Unix domain sockets not supported on this platform" << std::endl;
+    return false;
+#else
+    sockaddr_un address;
+    socklen_t address_len = 0;
+    if (!make_unix_address(path, address, address_len)) {
+        return false;
+    }
+
+    m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_socket == INVALID_SOCKET) {
+        std::cerr << "socket(AF_UNIX) failed: " << last_socket_error() << std::endl;
+        return false;
+    }
+
+    if (!set_non_blocking(m_socket)) {
+        std::cerr << "set_non_blocking() failed: " << last_socket_error() << std::endl;
+        close_socket(m_socket);
+        m_socket = INVALID_SOCKET;
+        return false;
+    }
+
+    m_is_tcp = false;
+    apply_socket_options(m_socket, m_options, false);
+
+    // bind() refuses an existing file, even one no process is listening on any more
+    const bool is_abstract = path[0] == '@';
+    if (!is_abstract && is_stale_socket_file(path, address, address_len)) {
+        ::unlink(path.c_str());
+    }
+
+    if (bind(m_socket, reinterpret_cast<const sockaddr*>(&address), address_len) == SOCKET_ERROR) {
+        std::cerr << "bind(" << path << ") failed: " << last_socket_error() << std::endl;
+        close_socket(m_socket);
+        m_socket = INVALID_SOCKET;
+        return false;
+    }
+
+    if (!is_abstract) {
+        m_bound_path = path;
+    }
+
+    if (listen(m_socket, backlog) == SOCKET_ERROR) {
+        std::cerr << "listen() failed: " << last_socket_error() << std::endl;
+        close_socket(m_socket);
+        m_socket = INVALID_SOCKET;
+        return false;
+    }
+
+    m_address = path;
+    m_port = 0;
+    return true;
+#endif
+}
+
+bool AsyncSocket::adopt_listening_socket(SOCKET listen_socket) noexcept
+{
+#ifdef _WIN32
+    (void)listen_socket;
+    std::cerr << "Sharing a listening socket is not supported on this platform" << std::endl;
+    return false;
+#else
+    // The duplicate shares the open file (queue and O_NONBLOCK) but is registered separately
+    m_socket = fcntl(listen_socket, F_DUPFD_CLOEXEC, 0);
+    if (m_socket == INVALID_SOCKET) {
+        std::cerr << "dup() of listening socket failed: " << last_socket_error() << std::endl;
+        return false;
+    }
+    return true;
+#endif
+}
+
 SOCKET AsyncSocket::accept_connection(std::string& client_addr, uint16_t& client_port) noexcept
 {
-    sockaddr_in client_sockaddr;
-    int client_sockaddr_len = sizeof(client_sockaddr);
+    PeerAddress peer;
+    SOCKET client_socket = accept_connection(peer);
+    if (client_socket == INVALID_SOCKET) {
+        return INVALID_SOCKET;
+    }
+
+    client_addr = peer.host();
+    client_port = peer.port();
+    return client_socket;
+}
+
+SOCKET AsyncSocket::accept_connection(PeerAddress& peer) noexcept
+{
+    socklen_t peer_len = sizeof(peer.storage);
+    sockaddr* peer_addr = reinterpret_cast<sockaddr*>(&peer.storage);
 
-    SOCKET client_socket = accept(m_socket, (struct sockaddr*)&client_sockaddr, &client_sockaddr_len);
+#ifdef __linux__
+    SOCKET client_socket = accept4(m_socket, peer_addr, &peer_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    SOCKET client_socket = accept(m_socket, peer_addr, &peer_len);
+#endif
 
     if (client_socket == INVALID_SOCKET) {
-        int error = WSAGetLastError();
-        if (error != WSAEWOULDBLOCK) {
+        int error = last_socket_error();
+        if (!is_would_block(error) && !is_resource_exhausted(error)) {
             std::cerr << "accept() failed: " << error << std::endl;
         }
         return INVALID_SOCKET;
     }
 
-    // Extract client address and port
-    char addr_buf[16]; // "xxx.xxx.xxx.xxx" fits in 15 chars + null
-    strcpy_s(addr_buf, sizeof(addr_buf), inet_ntoa(client_sockaddr.sin_addr));
-    client_addr = addr_buf;
-    client_port = ntohs(client_sockaddr.sin_port);
+#ifndef __linux__
+    // Accepted sockets only inherit non-blocking mode on Windows
+    if (!set_non_blocking(client_socket)) {
+        std::cerr << "set_non_blocking() failed: " << last_socket_error() << std::endl;
+        close_socket(client_socket);
+        return INVALID_SOCKET;
+    }
+
+    // Linux clones the listener's options into the accepted socket; elsewhere set them again
+    if (!m_options.is_default()) {
+        apply_socket_options(client_socket, m_options, m_is_tcp);
+    }
+#endif
 
+    peer.length = peer_len;
     return client_socket;
 }
 
@@ -132,19 +330,21 @@ bool AsyncSocket::connect(const std::string& remote_address, uint16_t remote_por
     // Create socket
     m_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (m_socket == INVALID_SOCKET) {
-        std::cerr << "socket() failed: " << WSAGetLastError() << std::endl;
+        std::cerr << "socket() failed: " << last_socket_error() << std::endl;
         return false;
     }
 
     // Set to non-blocking
-    unsigned long mode = 1;
-    if (ioctlsocket(m_socket, FIONBIO, &mode) == SOCKET_ERROR) {
-        std::cerr << "ioctlsocket() failed: " << WSAGetLastError() << std::endl;
-        closesocket(m_socket);
+    if (!set_non_blocking(m_socket)) {
+        std::cerr << "set_non_blocking() failed: " << last_socket_error() << std::endl;
+        close_socket(m_socket);
         m_socket = INVALID_SOCKET;
         return false;
     }
 
+    m_is_tcp = true;
+    apply_socket_options(m_socket, m_options, true);
+
     // Connect
     sockaddr_in server_addr;
     server_addr.sin_family = AF_INET;
@@ -153,18 +353,18 @@ bool AsyncSocket::connect(const std::string& remote_address, uint16_t remote_por
 
     if (server_addr.sin_addr.s_addr == INADDR_NONE) {
         std::cerr << "inet_addr() failed" << std::endl;
-        closesocket(m_socket);
+        close_socket(m_socket);
         m_socket = INVALID_SOCKET;
         return false;
     }
 
     int result = ::connect(m_socket, (struct sockaddr*)&server_addr, sizeof(server_addr));
     if (result == SOCKET_ERROR) {
-        int error = WSAGetLastError();
-        // WSAEWOULDBLOCK is expected for non-blocking sockets
-        if (error != WSAEWOULDBLOCK) {
+        int error = last_socket_error();
+        // In-progress is expected for non-blocking sockets
+        if (!is_in_progress(error)) {
             std::cerr << "connect() failed: " << error << std::endl;
-            closesocket(m_socket);
+            close_socket(m_socket);
             m_socket = INVALID_SOCKET;
             return false;
         }
@@ -173,22 +373,67 @@ bool AsyncSocket::connect(const std::string& remote_address, uint16_t remote_por
     return true;
 }
 
+bool AsyncSocket::connect_unix(const std::string& path) noexcept
+{
+#ifdef _WIN32
+    (void)path;
+    std::cerr << "Unix domain sockets not supported on this platform" << std::endl;
+    return false;
+#else
+    sockaddr_un address;
+    socklen_t address_len = 0;
+    if (!make_unix_address(path, address, address_len)) {
+        return false;
+    }
+
+    m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_socket == INVALID_SOCKET) {
+        std::cerr << "socket(AF_UNIX) failed: " << last_socket_error() << std::endl;
+        return false;
+    }
+
+    if (!set_non_blocking(m_socket)) {
+        std::cerr << "set_non_blocking() failed: " << last_socket_error() << std::endl;
+        close_socket(m_socket);
+        m_socket = INVALID_SOCKET;
+        return false;
+    }
+
+    m_is_tcp = false;
+    apply_socket_options(m_socket, m_options, false);
+
+    // Local connects complete immediately or fail (EAGAIN: listener backlog full)
+    if (::connect(m_socket, reinterpret_cast<const sockaddr*>(&address), address_len) == SOCKET_ERROR) {
+        std::cerr << "connect(" << path << ") failed: " << last_socket_error() << std::endl;
+        close_socket(m_socket);
+        m_socket = INVALID_SOCKET;
+        return false;
+    }
+
+    m_address = path;
+    m_port = 0;
+    return true;
+#endif
+}
+
+#ifdef _WIN32
 bool AsyncSocket::set_async_mode(WSAEVENT hEventObject, long lNetworkEvents) noexcept
 {
     if (WSAEventSelect(m_socket, hEventObject, lNetworkEvents) == SOCKET_ERROR) {
-        std::cerr << "WSAEventSelect() failed: " << WSAGetLastError() << std::endl;
+        std::cerr << "WSAEventSelect() failed: " << last_socket_error() << std::endl;
         return false;
     }
     return true;
 }
+#endif
 
 int AsyncSocket::send_data(SOCKET socket, const uint8_t* data, int length) noexcept
 {
-    int result = send(socket, reinterpret_cast<const char*>(data), length, 0);
+    int result = send(socket, reinterpret_cast<const char*>(data), length, SEND_NO_SIGNAL);
     
     if (result == SOCKET_ERROR) {
-        int error = WSAGetLastError();
-        if (error != WSAEWOULDBLOCK) {
+        int error = last_socket_error();
+        if (!is_would_block(error)) {
             std::cerr << "send() failed: " << error << std::endl;
         }
     }
@@ -201,8 +446,8 @@ int AsyncSocket::recv_data(SOCKET socket, uint8_t* buffer, int buffer_size) noex
     int result = recv(socket, reinterpret_cast<char*>(buffer), buffer_size, 0);
 
     if (result == SOCKET_ERROR) {
-        int error = WSAGetLastError();
-        if (error != WSAEWOULDBLOCK) {
+        int error = last_socket_error();
+        if (!is_would_block(error)) {
             std::cerr << "recv() failed: " << error << std::endl;
         }
     }
@@ -214,15 +459,29 @@ void AsyncSocket::close_client_socket(SOCKET socket) noexcept
 {
     if (socket != INVALID_SOCKET) {
         shutdown(socket, SD_BOTH);
-        closesocket(socket);
+        close_socket(socket);
     }
 }
 
+uint16_t AsyncSocket::get_local_port() const noexcept
+{
+    PeerAddress local;
+    socklen_t local_len = sizeof(local.storage);
+
+    if (getsockname(m_socket, reinterpret_cast<sockaddr*>(&local.storage), &local_len) == SOCKET_ERROR) {
+        return m_port;
+    }
+
+    // Unix domain sockets have no port
+    local.length = local_len;
+    return local.port();
+}
+
 std::string AsyncSocket::get_last_error() const noexcept
 {
-    int error = WSAGetLastError();
+    int error = last_socket_error();
     std::ostringstream oss;
-    oss << "WSA Error: " << error;
+    oss << "Socket Error: " << error;
     return oss.str();
 }
 
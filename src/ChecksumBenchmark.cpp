@@ -0,0 +1,100 @@
+#include "BinaryProtocol.h"
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace core::protocol;
+
+namespace {
+
+// The byte-at-a-time loop crc32::calculate used before the table/folding paths
+uint32_t bytewise_crc32(const uint8_t* data, size_t length) noexcept {
+    static const auto table = []() {
+        std::vector<uint32_t> entries(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int j = 0; j < 8; ++j) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+            }
+            entries[i] = crc;
+        }
+        return entries;
+    }();
+
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; ++i) {
+        crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+using Checksum = uint32_t (*)(const uint8_t*, size_t) noexcept;
+
+/**
+ * @brief Benchmark one checksum function on one frame size
+ * @return Throughput in GB/s
+ */
+double benchmark_checksum(Checksum checksum, const std::vector<uint8_t>& data, size_t frame_size) {
+    // About 256 MB per measurement, at least 1000 frames
+    const size_t iterations = std::max<size_t>(1000, (256u << 20) / std::max<size_t>(frame_size, 1));
+
+    volatile uint32_t sink = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        sink = sink ^ checksum(data.data(), frame_size);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    return static_cast<double>(frame_size) * static_cast<double>(iterations) / seconds / 1e9;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "\n======== Frame Checksum Benchmark ========\n" << std::endl;
+    std::cout << "crc32::calculate uses: " << crc32::implementation_name() << std::endl;
+    std::cout << "crc32c::calculate uses: " << crc32c::implementation_name() << "\n" << std::endl;
+
+    std::vector<uint8_t> data(MAX_PAYLOAD_SIZE);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+
+    const bool hardware = crc32::has_hardware_support();
+    const bool hardware_c = crc32c::has_hardware_support();
+    std::cout << std::left << std::setw(14) << "Payload" << std::right
+              << std::setw(12) << "bytewise" << std::setw(12) << "slicing-16";
+    if (hardware) {
+        std::cout << std::setw(12) << "pclmul";
+    }
+    std::cout << std::setw(12) << "c slicing";
+    if (hardware_c) {
+        std::cout << std::setw(12) << "c sse4.2";
+    }
+    std::cout << "   (GB/s)" << std::endl;
+
+    for (size_t frame_size : {size_t{16}, size_t{64}, size_t{256}, size_t{1024}, size_t{4096},
+                              size_t{16 * 1024}, size_t{32 * 1024}, size_t{MAX_PAYLOAD_SIZE}}) {
+        std::cout << std::left << std::setw(14) << (std::to_string(frame_size) + " bytes") << std::right
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << benchmark_checksum(&bytewise_crc32, data, frame_size)
+                  << std::setw(12) << benchmark_checksum(&crc32::calculate_portable, data, frame_size);
+        if (hardware) {
+            std::cout << std::setw(12) << benchmark_checksum(&crc32::calculate_hardware, data, frame_size);
+        }
+        std::cout << std::setw(12) << benchmark_checksum(&crc32c::calculate_portable, data, frame_size);
+        if (hardware_c) {
+            std::cout << std::setw(12) << benchmark_checksum(&crc32c::calculate_hardware, data, frame_size);
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "\n========================================\n" << std::endl;
+
+    return 0;
+}
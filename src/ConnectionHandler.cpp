@@ -1,7 +1,13 @@
 #include "ConnectionHandler.h"
+#include "SocketOptions.h"
 #include <iostream>
+#include <algorithm>
 #include <cstring>
 
+#ifdef __linux__
+    #include <linux/errqueue.h>
+#endif
+
 namespace core {
 namespace net {
 
@@ -9,85 +15,467 @@ ConnectionHandler::ConnectionHandler(SOCKET client_socket, const std::string& cl
     : m_client_socket(client_socket)
     , m_client_address(client_address)
     , m_client_port(client_port)
+    , m_address_resolved(true)
+{
+}
+
+ConnectionHandler::ConnectionHandler(SOCKET client_socket, const PeerAddress& peer)
+    : m_client_socket(client_socket)
+    , m_peer(peer)
 {
 }
 
+void ConnectionHandler::resolve_address() const noexcept
+{
+    if (m_address_resolved) {
+        return;
+    }
+
+    // Completion-engine accepts don't capture the address; ask the socket
+    if (m_peer.empty() && m_client_socket != INVALID_SOCKET) {
+        m_peer = PeerAddress::of_peer(m_client_socket);
+    }
+
+    try {
+        m_client_address = m_peer.host();
+    } catch (...) {
+        m_client_address.clear();
+    }
+    m_client_port = m_peer.port();
+    m_address_resolved = true;
+}
+
 ConnectionHandler::~ConnectionHandler() noexcept
 {
     close();
 }
 
-bool ConnectionHandler::handle_read_event() noexcept
+bool ConnectionHandler::handle_read_event(size_t budget, bool hang_up) noexcept
 {
-    if (!m_is_active) {
-        return false;
+    if (m_shm) {
+        return handle_shm_read(budget);
     }
 
-    int bytes_received = recv(m_client_socket, reinterpret_cast<char*>(m_read_buffer.data()), 
-                             static_cast<int>(m_read_buffer.size()), 0);
+    m_hung_up = m_hung_up || hang_up;
 
-    if (bytes_received == SOCKET_ERROR) {
-        int error = WSAGetLastError();
-        if (error != WSAEWOULDBLOCK) {
-            std::cerr << "recv() failed: " << error << std::endl;
-            m_is_active = false;
-            if (m_on_connection_closed) {
-                m_on_connection_closed();
+    size_t consumed = 0;
+
+    while (m_is_active && !is_read_paused()) {
+        if (consumed >= budget) {
+            return true;
+        }
+
+        size_t capacity = 0;
+        uint8_t* target = prepare_read(capacity);
+        if (!target) {
+            return false;
+        }
+
+        int bytes_received = recv(m_client_socket, reinterpret_cast<char*>(target), static_cast<int>(capacity), 0);
+
+        if (bytes_received == SOCKET_ERROR) {
+            int error = last_socket_error();
+            if (!is_would_block(error)) {
+                std::cerr << "recv() failed: " << error << std::endl;
+                mark_closed();
             }
             return false;
         }
-        return false;
+
+        if (bytes_received == 0) {
+            // Connection closed by client
+            std::cout << "Client " << get_client_address() << ":" << get_client_port() << " closed connection" << std::endl;
+            mark_closed();
+            return false;
+        }
+
+        consumed += static_cast<size_t>(bytes_received);
+        complete_read(target, static_cast<size_t>(bytes_received));
+
+        // A short read emptied the socket; skip the EAGAIN round trip.
+        // Not after a hang-up: an edge-triggered socket won't report the EOF behind the data again
+        if (!m_hung_up && static_cast<size_t>(bytes_received) < capacity) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+bool ConnectionHandler::handle_shm_read(size_t budget) noexcept
+{
+    m_shm->drain_doorbell();
+
+    // The doorbell may mean the peer made room: push output first, it may un-pause reads
+    if (!m_output.empty()) {
+        flush_to_shm();
     }
 
-    if (bytes_received == 0) {
-        // Connection closed by client
-        std::cout << "Client " << m_client_address << ":" << m_client_port << " closed connection" << std::endl;
-        m_is_active = false;
-        if (m_on_connection_closed) {
-            m_on_connection_closed();
+    size_t consumed = 0;
+    while (m_is_active && !is_read_paused()) {
+        if (consumed >= budget) {
+            return true;
+        }
+
+        size_t capacity = 0;
+        uint8_t* target = prepare_read(capacity);
+        if (!target) {
+            return false;
+        }
+
+        const size_t bytes_read = m_shm->read(target, capacity);
+        if (bytes_read == 0) {
+            if (m_shm->is_corrupt()) {
+                std::cerr << "Corrupt shared-memory ring from " << m_client_socket << ", closing connection" << std::endl;
+                mark_closed();
+                return false;
+            }
+            // Ask for the doorbell before sleeping; input that raced in is read now
+            if (m_shm->arm_read_wakeup()) {
+                break;
+            }
+            continue;
         }
+
+        consumed += bytes_read;
+        complete_read(target, bytes_read);
+    }
+
+    if (!m_is_active) {
         return false;
     }
 
-    m_bytes_received += bytes_received;
+    // Nothing is sent on the socket after the handshake: readable means the peer went away
+    char probe;
+    int result = recv(m_client_socket, &probe, 1, 0);
+    if (result == 0 || (result == SOCKET_ERROR && !is_would_block(last_socket_error()))) {
+        std::cout << "Shared-memory client " << m_client_socket << " closed connection" << std::endl;
+        mark_closed();
+    } else if (result > 0) {
+        std::cerr << "Unexpected data on shared-memory control socket " << m_client_socket << std::endl;
+        mark_closed();
+    }
+    return false;
+}
+
+uint8_t* ConnectionHandler::prepare_read(size_t& capacity) noexcept
+{
+    if (m_decoder) {
+        uint8_t* space = m_decoder->prepare(DECODER_READ_SIZE);
+        if (!space) {
+            std::cerr << "Out of memory buffering frames from " << m_client_socket << std::endl;
+            mark_closed();
+            return nullptr;
+        }
+        capacity = std::min(m_decoder->get_writable(), MAX_READ_BUFFER);
+        return space;
+    }
+
+    if (m_read_buffer.empty()) {
+        try {
+            m_read_buffer.resize(MIN_READ_BUFFER);
+        } catch (const std::bad_alloc&) {
+            std::cerr << "Failed to allocate read buffer" << std::endl;
+            return nullptr;
+        }
+    }
+    capacity = m_read_buffer.size();
+    return m_read_buffer.data();
+}
+
+void ConnectionHandler::complete_read(const uint8_t* data, size_t length) noexcept
+{
+    if (!m_decoder) {
+        deliver_received(data, length);
+        adapt_read_buffer(length);
+        return;
+    }
+
+    // The bytes already sit in the decoder's free space: commit them instead of feeding a copy
+    const protocol::FrameDecoder* decoder = m_decoder.get();
+    note_received(data, length);
+
+    // The data callback may have detached the decoder
+    if (m_decoder.get() == decoder && m_is_active) {
+        m_decoder->commit(length);
+        decode_frames();
+    }
+}
+
+void ConnectionHandler::adapt_read_buffer(size_t bytes_read) noexcept
+{
+    const size_t capacity = m_read_buffer.size();
+    size_t target = capacity;
+
+    if (bytes_read == capacity) {
+        // Bulk sender: fewer, larger reads
+        target = std::min(capacity * 2, MAX_READ_BUFFER);
+        m_small_reads = 0;
+    } else if (bytes_read <= capacity / 4) {
+        // Chatty client: give memory back after a run of small reads
+        if (++m_small_reads >= SHRINK_AFTER_SMALL_READS) {
+            target = std::max(capacity / 2, MIN_READ_BUFFER);
+            m_small_reads = 0;
+        }
+    } else {
+        m_small_reads = 0;
+    }
+
+    if (target == capacity) {
+        return;
+    }
+
+    // Contents are dead once delivered, so swap in a fresh buffer instead of resizing in place
+    try {
+        std::vector<uint8_t>(target).swap(m_read_buffer);
+    } catch (const std::bad_alloc&) {
+        // Keep the current buffer
+    }
+}
+
+void ConnectionHandler::count_received(size_t bytes) noexcept
+{
+    // Single writer: a plain load/store pair is enough and avoids a locked add
+    m_bytes_received.store(m_bytes_received.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+    if (m_traffic_stats) {
+        m_traffic_stats->bytes_received.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+void ConnectionHandler::count_sent(size_t bytes) noexcept
+{
+    m_bytes_sent.store(m_bytes_sent.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+    if (m_traffic_stats) {
+        m_traffic_stats->bytes_sent.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+bool ConnectionHandler::deliver_received(const uint8_t* data, size_t length) noexcept
+{
+    note_received(data, length);
+
+    if (m_decoder && m_is_active) {
+        if (!m_decoder->feed(data, length)) {
+            std::cerr << "Out of memory buffering frames from " << m_client_socket << std::endl;
+            mark_closed();
+        } else {
+            decode_frames();
+        }
+    }
+
+    return m_is_active;
+}
+
+void ConnectionHandler::note_received(const uint8_t* data, size_t length) noexcept
+{
+    count_received(length);
+
+    // Charged before dispatch: a message over the limit is still handled, the next read waits.
+    // Without a frame decoder a read is the best guess at a message; with one, frames are
+    // charged as decode_frames() finds them.
+    if (m_rate_limiter) {
+        const uint64_t now = RateLimiter::now_ns();
+        m_rate_limiter->charge(m_decoder ? 0 : 1, length, now);
+        m_rate_limited = !m_rate_limiter->admit(now);
+    }
 
     if (m_on_data_received) {
-        m_on_data_received(m_read_buffer.data(), bytes_received);
+        m_on_data_received(data, length);
     }
+}
 
+bool ConnectionHandler::set_frame_callback(FrameCallback callback, protocol::CorruptionPolicy policy) noexcept
+{
+    if (!callback) {
+        m_decoder.reset();
+        m_on_frame = nullptr;
+        return true;
+    }
+
+    try {
+        m_decoder = std::make_unique<protocol::FrameDecoder>(policy);
+    } catch (const std::bad_alloc&) {
+        std::cerr << "Failed to allocate frame decoder" << std::endl;
+        return false;
+    }
+    m_on_frame = std::move(callback);
     return true;
 }
 
+void ConnectionHandler::decode_frames() noexcept
+{
+    // Enforced at parse time: once the bucket is empty the rest stays buffered in the decoder
+    // until resume_if_rate_allows() lifts the pause
+    const uint64_t now = m_rate_limiter ? RateLimiter::now_ns() : 0;
+    protocol::FrameView frame;
+    while (m_is_active) {
+        if (m_rate_limiter && !m_rate_limiter->admit(now)) {
+            m_rate_limited = true;
+            break;
+        }
+
+        const protocol::DecodeStatus status = m_decoder->next(frame);
+        if (status == protocol::DecodeStatus::NEED_MORE) {
+            break;
+        }
+        if (status == protocol::DecodeStatus::CORRUPT) {
+            std::cerr << "Corrupt frame from " << m_client_socket << ", closing connection" << std::endl;
+            mark_closed();
+            break;
+        }
+        m_on_frame(frame);
+
+        if (m_rate_limiter) {
+            m_rate_limiter->charge(1, 0, now);
+            m_rate_limited = !m_rate_limiter->admit(now);
+        }
+    }
+}
+
+void ConnectionHandler::set_rate_limiter(std::unique_ptr<RateLimiter> limiter) noexcept
+{
+    m_rate_limiter = std::move(limiter);
+    m_rate_limited = false;
+}
+
+uint32_t ConnectionHandler::get_rate_limit_delay_ms() const noexcept
+{
+    if (!m_rate_limiter) {
+        return 0;
+    }
+
+    const uint64_t wait_ns = m_rate_limiter->wait_ns(RateLimiter::now_ns());
+    return static_cast<uint32_t>(std::min<uint64_t>((wait_ns + 999999) / 1000000, UINT32_MAX));
+}
+
+bool ConnectionHandler::resume_if_rate_allows() noexcept
+{
+    if (m_rate_limited && m_rate_limiter->admit(RateLimiter::now_ns())) {
+        m_rate_limited = false;
+
+        // Frames held back by the limit are already here: dispatch them without waiting for input
+        if (m_decoder && m_is_active && m_decoder->get_buffered() != 0) {
+            decode_frames();
+        }
+    }
+    return !m_rate_limited;
+}
+
+void ConnectionHandler::mark_closed() noexcept
+{
+    if (!m_is_active.exchange(false)) {
+        return;
+    }
+
+    if (m_on_connection_closed) {
+        m_on_connection_closed();
+    }
+}
+
 bool ConnectionHandler::handle_write_event() noexcept
 {
-    if (!m_is_active || m_write_pos == 0) {
+    if (!m_is_active || m_output.empty() || m_completion_mode) {
         return false;
     }
 
-    int bytes_sent = send(m_client_socket, reinterpret_cast<const char*>(m_write_buffer.data()), 
-                         static_cast<int>(m_write_pos), 0);
+    if (m_shm) {
+        return flush_to_shm();
+    }
 
-    if (bytes_sent == SOCKET_ERROR) {
-        int error = WSAGetLastError();
-        if (error != WSAEWOULDBLOCK) {
-            std::cerr << "send() failed: " << error << std::endl;
-            m_is_active = false;
-            return false;
+    IoSlice slices[MAX_IO_SLICES];
+    const bool corked = m_cork_flushes && set_cork(m_client_socket, true);
+
+    while (!m_output.empty()) {
+        // A large shared payload at the head goes out alone, straight from its pages
+        const SharedBuffer* pinned =
+            m_zerocopy_threshold != 0 ? m_output.shared_front(m_zerocopy_threshold) : nullptr;
+
+        size_t count = m_output.gather(slices, MAX_IO_SLICES, m_zerocopy_threshold);
+        size_t offered = 0;
+        for (size_t i = 0; i < count; ++i) {
+            offered += io_slice_length(slices[i]);
+        }
+
+        int64_t bytes_sent = send_slices(m_client_socket, slices, count, pinned ? SEND_ZEROCOPY : 0);
+
+        // Out of optmem for pinned pages: this one goes the copying way
+        if (bytes_sent == SOCKET_ERROR && pinned && last_socket_error() == ENOBUFS) {
+            pinned = nullptr;
+            if (m_zerocopy_stats) {
+                m_zerocopy_stats->copied_sends.fetch_add(1, std::memory_order_relaxed);
+            }
+            bytes_sent = send_slices(m_client_socket, slices, count);
+        }
+
+        if (bytes_sent == SOCKET_ERROR) {
+            int error = last_socket_error();
+            if (!is_would_block(error)) {
+                std::cerr << "send() failed: " << error << std::endl;
+                m_is_active = false;
+                return false;
+            }
+            break;
+        }
+
+        // Keep the payload alive until the kernel reports it's done with the pages
+        if (pinned) {
+            try {
+                m_zerocopy_in_flight.emplace_back(m_zerocopy_next_id, *pinned);
+            } catch (...) {
+                std::cerr << "Out of memory tracking zero-copy send" << std::endl;
+            }
+            ++m_zerocopy_next_id;
+            if (m_zerocopy_stats) {
+                m_zerocopy_stats->zerocopy_sends.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        m_output.consume(static_cast<size_t>(bytes_sent));
+        count_sent(static_cast<size_t>(bytes_sent));
+
+        // Short send: the socket buffer is full, skip the EAGAIN round trip
+        if (static_cast<size_t>(bytes_sent) < offered) {
+            break;
         }
-        return false;
     }
 
-    m_bytes_sent += bytes_sent;
+    // Uncorking pushes out the partial segment left at the end
+    if (corked) {
+        set_cork(m_client_socket, false);
+    }
+
+    check_watermarks();
+    return !m_output.empty();
+}
+
+bool ConnectionHandler::flush_to_shm() noexcept
+{
+    IoSlice slices[MAX_IO_SLICES];
+
+    while (!m_output.empty()) {
+        const size_t count = m_output.gather(slices, MAX_IO_SLICES);
+        size_t offered = 0;
+        for (size_t i = 0; i < count; ++i) {
+            offered += io_slice_length(slices[i]);
+        }
+
+        const size_t written = m_shm->write(slices, count);
+        if (m_shm->is_corrupt()) {
+            std::cerr << "Corrupt shared-memory ring to " << m_client_socket << ", closing connection" << std::endl;
+            mark_closed();
+            return false;
+        }
+        m_output.consume(written);
+        count_sent(written);
 
-    // Remove sent data from buffer
-    if (bytes_sent < static_cast<int>(m_write_pos)) {
-        std::memmove(m_write_buffer.data(), 
-                    m_write_buffer.data() + bytes_sent,
-                    m_write_pos - bytes_sent);
+        // Ring full: the peer rings our doorbell once it has read some of it
+        if (written < offered && m_shm->arm_write_wakeup()) {
+            break;
+        }
     }
 
-    m_write_pos -= bytes_sent;
-    return m_write_pos > 0;
+    check_watermarks();
+    return !m_output.empty();
 }
 
 bool ConnectionHandler::send_data(const uint8_t* data, size_t length) noexcept
@@ -96,25 +484,169 @@ bool ConnectionHandler::send_data(const uint8_t* data, size_t length) noexcept
         return false;
     }
 
-    // Check if we have space in write buffer
-    if (m_write_pos + length > m_write_buffer.size()) {
-        std::cerr << "Write buffer full" << std::endl;
+    // Zero-copy candidates are copied once into a shared buffer that outlives the queue entry
+    if (m_zerocopy_threshold != 0 && length >= m_zerocopy_threshold) {
+        try {
+            return send_shared(SharedBuffer::copy_of(data, length));
+        } catch (const std::bad_alloc&) {
+            std::cerr << "Out of memory queueing " << length << " bytes" << std::endl;
+            return false;
+        }
+    }
+
+    if (!m_output.append(data, length)) {
+        std::cerr << "Out of memory queueing " << length << " bytes" << std::endl;
+        return false;
+    }
+
+    return flush_queued_output();
+}
+
+bool ConnectionHandler::send_shared(const SharedBuffer& buffer) noexcept
+{
+    if (!m_is_active || buffer.empty()) {
+        return false;
+    }
+
+    if (!m_output.append(buffer)) {
+        std::cerr << "Out of memory queueing " << buffer.size() << " bytes" << std::endl;
+        return false;
+    }
+
+    return flush_queued_output();
+}
+
+bool ConnectionHandler::flush_queued_output() noexcept
+{
+    // The completion engine picks the data up on its next flush
+    if (m_completion_mode) {
+        check_watermarks();
+        return true;
+    }
+
+    // Try to send immediately (re-checks the watermarks)
+    handle_write_event();
+    return m_is_active;
+}
+
+bool ConnectionHandler::attach_shm(std::unique_ptr<ShmChannel> channel) noexcept
+{
+    if (!channel || m_completion_mode) {
+        return false;
+    }
+
+    m_shm = std::move(channel);
+    return true;
+}
+
+bool ConnectionHandler::enable_zerocopy(size_t threshold, ZeroCopyStats* stats) noexcept
+{
+    if (threshold == 0 || m_completion_mode || !net::enable_zerocopy(m_client_socket)) {
+        m_zerocopy_threshold = 0;
+        return false;
+    }
+
+    m_zerocopy_threshold = threshold;
+    m_zerocopy_stats = stats;
+    return true;
+}
+
+bool ConnectionHandler::reap_zerocopy_completions() noexcept
+{
+    bool reaped = false;
+
+#ifdef __linux__
+    if (m_zerocopy_threshold == 0) {
         return false;
     }
 
-    // Copy data to write buffer
-    std::memcpy(m_write_buffer.data() + m_write_pos, data, length);
-    m_write_pos += length;
+    // Drain to EAGAIN: a notification left behind keeps the socket reporting an error
+    for (;;) {
+        alignas(cmsghdr) char control[128];
+        msghdr message{};
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        if (recvmsg(m_client_socket, &message, MSG_ERRQUEUE) < 0) {
+            break;  // EAGAIN: nothing more queued
+        }
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+            const bool recverr = (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                                 (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+            if (!recverr) {
+                continue;
+            }
+
+            sock_extended_err error;
+            std::memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+            if (error.ee_origin != SO_EE_ORIGIN_ZEROCOPY || error.ee_errno != 0) {
+                continue;
+            }
+
+            // Notifications cover an inclusive range of send ids
+            const uint32_t first = error.ee_info;
+            const uint32_t span = error.ee_data - first;
+            // Counted as zero-copy when issued; the kernel copied them after all
+            if ((error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) && m_zerocopy_stats) {
+                m_zerocopy_stats->zerocopy_sends.fetch_sub(static_cast<size_t>(span) + 1, std::memory_order_relaxed);
+                m_zerocopy_stats->copied_sends.fetch_add(static_cast<size_t>(span) + 1, std::memory_order_relaxed);
+            }
+
+            auto done = std::remove_if(m_zerocopy_in_flight.begin(), m_zerocopy_in_flight.end(),
+                                       [first, span](const auto& entry) { return entry.first - first <= span; });
+            m_zerocopy_in_flight.erase(done, m_zerocopy_in_flight.end());
+            reaped = true;
+        }
+    }
+#endif
+
+    return reaped;
+}
+
+size_t ConnectionHandler::gather_output(IoSlice* slices, size_t max_slices) const noexcept
+{
+    return m_output.gather(slices, max_slices);
+}
+
+void ConnectionHandler::consume_output(size_t bytes) noexcept
+{
+    bytes = std::min(bytes, m_output.size());
+    m_output.consume(bytes);
+    count_sent(bytes);
+    check_watermarks();
+}
+
+void ConnectionHandler::set_output_watermarks(size_t low_watermark, size_t high_watermark) noexcept
+{
+    m_high_watermark = high_watermark;
+    m_low_watermark = std::min(low_watermark, high_watermark);
+    check_watermarks();
+}
+
+void ConnectionHandler::check_watermarks() noexcept
+{
+    const size_t queued = m_output.size();
 
-    // Try to send immediately
-    return handle_write_event() || m_write_pos > 0;
+    // Hysteresis between low and high keeps a busy connection from flapping
+    if (!m_above_high_watermark && queued > m_high_watermark) {
+        m_above_high_watermark = true;
+        if (m_on_watermark) {
+            m_on_watermark(true);
+        }
+    } else if (m_above_high_watermark && queued <= m_low_watermark) {
+        m_above_high_watermark = false;
+        if (m_on_watermark) {
+            m_on_watermark(false);
+        }
+    }
 }
 
 void ConnectionHandler::close() noexcept
 {
     if (m_client_socket != INVALID_SOCKET) {
         shutdown(m_client_socket, SD_BOTH);
-        closesocket(m_client_socket);
+        close_socket(m_client_socket);
         m_client_socket = INVALID_SOCKET;
     }
     m_is_active = false;
@@ -1,66 +1,123 @@
 #include "ConnectionManager.h"
+#include <algorithm>
 #include <iostream>
 
 namespace core {
 namespace net {
 
+ConnectionManager::ConnectionManager(size_t shard_count)
+{
+    shard_count = std::clamp<size_t>(shard_count, 1, MAX_SHARDS);
+    m_shards.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        m_shards.push_back(std::make_unique<Shard>());
+    }
+}
+
 ConnectionManager::~ConnectionManager() noexcept
 {
     close_all();
 }
 
-bool ConnectionManager::add_connection(SOCKET client_socket, std::unique_ptr<ConnectionHandler> handler) noexcept
+ConnectionId ConnectionManager::add_connection(std::unique_ptr<ConnectionHandler> handler) noexcept
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    if (m_connections.find(client_socket) != m_connections.end()) {
-        return false; // Already exists
+    if (!handler) {
+        return INVALID_CONNECTION_ID;
     }
 
-    m_connections[client_socket] = std::move(handler);
-    return true;
+    const size_t index = m_next_shard.fetch_add(1, std::memory_order_relaxed) % m_shards.size();
+    Shard& shard = *m_shards[index];
+    const size_t received = handler->get_bytes_received();
+    const size_t sent = handler->get_bytes_sent();
+    handler->set_traffic_stats(&shard.traffic);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const ConnectionId local = shard.connections.insert(std::move(handler));
+    if (local == INVALID_CONNECTION_ID) {
+        return INVALID_CONNECTION_ID;
+    }
+
+    // Bytes moved before registration count too; release_traffic() takes them all back out
+    shard.traffic.bytes_received.fetch_add(received, std::memory_order_relaxed);
+    shard.traffic.bytes_sent.fetch_add(sent, std::memory_order_relaxed);
+    shard.count.store(shard.connections.size(), std::memory_order_relaxed);
+    return local | (static_cast<ConnectionId>(index) << SHARD_SHIFT);
 }
 
-bool ConnectionManager::remove_connection(SOCKET client_socket) noexcept
+bool ConnectionManager::remove_connection(ConnectionId connection) noexcept
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    auto it = m_connections.find(client_socket);
-    if (it == m_connections.end()) {
-        return false; // Not found
+    ConnectionId local;
+    Shard* shard = shard_of(connection, local);
+    if (!shard) {
+        return false;
     }
 
-    m_connections.erase(it);
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    auto* handler = shard->connections.find(local);
+    if (!handler) {
+        return false;
+    }
+
+    release_traffic(*shard, **handler);
+    shard->connections.erase(local);
+    shard->count.store(shard->connections.size(), std::memory_order_relaxed);
     return true;
 }
 
-ConnectionHandler* ConnectionManager::get_connection(SOCKET client_socket) noexcept
+ConnectionHandler* ConnectionManager::get_connection(ConnectionId connection) noexcept
+{
+    ConnectionId local;
+    Shard* shard = shard_of(connection, local);
+    if (!shard) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    auto* handler = shard->connections.find(local);
+    return handler ? handler->get() : nullptr;
+}
+
+bool ConnectionManager::has_connection(ConnectionId connection) const noexcept
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    auto it = m_connections.find(client_socket);
-    if (it != m_connections.end()) {
-        return it->second.get();
+    ConnectionId local;
+    Shard* shard = shard_of(connection, local);
+    if (!shard) {
+        return false;
     }
 
-    return nullptr;
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    return shard->connections.contains(local);
 }
 
-bool ConnectionManager::has_connection(SOCKET client_socket) const noexcept
+std::vector<ConnectionId> ConnectionManager::get_all_ids() const noexcept
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_connections.find(client_socket) != m_connections.end();
+    std::vector<ConnectionId> ids;
+    ids.reserve(get_connection_count());
+
+    // One shard locked at a time: a snapshot per shard, not a global one
+    for (size_t index = 0; index < m_shards.size(); ++index) {
+        const Shard& shard = *m_shards[index];
+        const ConnectionId tag = static_cast<ConnectionId>(index) << SHARD_SHIFT;
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (ConnectionId local : shard.connections.ids()) {
+            ids.push_back(local | tag);
+        }
+    }
+
+    return ids;
 }
 
 std::vector<SOCKET> ConnectionManager::get_all_sockets() const noexcept
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
     std::vector<SOCKET> sockets;
-    sockets.reserve(m_connections.size());
-    
-    for (const auto& pair : m_connections) {
-        sockets.push_back(pair.first);
+    sockets.reserve(get_connection_count());
+
+    for (const auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->connections.for_each([&sockets](ConnectionId, const std::unique_ptr<ConnectionHandler>& handler) {
+            sockets.push_back(handler->get_socket());
+        });
     }
 
     return sockets;
@@ -68,51 +125,76 @@ std::vector<SOCKET> ConnectionManager::get_all_sockets() const noexcept
 
 size_t ConnectionManager::get_connection_count() const noexcept
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_connections.size();
+    size_t total = 0;
+    for (const auto& shard : m_shards) {
+        total += shard->count.load(std::memory_order_relaxed);
+    }
+    return total;
 }
 
 void ConnectionManager::close_all() noexcept
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_connections.clear();
+    for (auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->connections.for_each([&shard](ConnectionId, const std::unique_ptr<ConnectionHandler>& handler) {
+            release_traffic(*shard, *handler);
+        });
+        shard->connections.clear();
+        shard->count.store(0, std::memory_order_relaxed);
+    }
 }
 
 size_t ConnectionManager::get_total_bytes_received() const noexcept
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
     size_t total = 0;
-    for (const auto& pair : m_connections) {
-        total += pair.second->get_bytes_received();
+    for (const auto& shard : m_shards) {
+        total += shard->traffic.bytes_received.load(std::memory_order_relaxed);
     }
-
     return total;
 }
 
 size_t ConnectionManager::get_total_bytes_sent() const noexcept
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
     size_t total = 0;
-    for (const auto& pair : m_connections) {
-        total += pair.second->get_bytes_sent();
+    for (const auto& shard : m_shards) {
+        total += shard->traffic.bytes_sent.load(std::memory_order_relaxed);
     }
-
     return total;
 }
 
-std::pair<size_t, size_t> ConnectionManager::get_connection_stats(SOCKET client_socket) const noexcept
+std::pair<size_t, size_t> ConnectionManager::get_connection_stats(ConnectionId connection) const noexcept
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    auto it = m_connections.find(client_socket);
-    if (it != m_connections.end()) {
-        return {it->second->get_bytes_received(), it->second->get_bytes_sent()};
+    ConnectionId local;
+    Shard* shard = shard_of(connection, local);
+    if (!shard) {
+        return {0, 0};
+    }
+
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    const auto* handler = shard->connections.find(local);
+    if (handler) {
+        return {(*handler)->get_bytes_received(), (*handler)->get_bytes_sent()};
     }
 
     return {0, 0};
 }
 
+ConnectionManager::Shard* ConnectionManager::shard_of(ConnectionId connection, ConnectionId& local) const noexcept
+{
+    const size_t index = static_cast<size_t>(connection >> SHARD_SHIFT);
+    if (index >= m_shards.size()) {
+        return nullptr;
+    }
+
+    local = connection & HandlerTable::ID_MASK;
+    return m_shards[index].get();
+}
+
+void ConnectionManager::release_traffic(Shard& shard, const ConnectionHandler& handler) noexcept
+{
+    shard.traffic.bytes_received.fetch_sub(handler.get_bytes_received(), std::memory_order_relaxed);
+    shard.traffic.bytes_sent.fetch_sub(handler.get_bytes_sent(), std::memory_order_relaxed);
+}
+
 } // namespace net
 } // namespace core
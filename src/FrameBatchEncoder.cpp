@@ -0,0 +1,97 @@
+#include "FrameBatchEncoder.h"
+#include <algorithm>
+#include <cstring>
+
+namespace core {
+namespace protocol {
+
+FrameBatchEncoder::FrameBatchEncoder(size_t max_frames)
+    : m_max_frames(std::clamp<size_t>(max_frames, 1, (net::MAX_IO_SLICES - 1) / 2))
+    , m_arena(new uint8_t[m_max_frames * ARENA_BYTES_PER_FRAME])
+    , m_slices(new net::IoSlice[2 * m_max_frames + 1])
+{
+}
+
+bool FrameBatchEncoder::add(FrameHeader header, std::span<const uint8_t> payload) noexcept
+{
+    if (full() || m_sending || payload.size() > MAX_PAYLOAD_SIZE) {
+        return false;
+    }
+
+    header.payload_length = static_cast<uint16_t>(payload.size());
+    if (!header.is_valid()) {
+        return false;
+    }
+
+    uint8_t* out = m_arena.get() + m_arena_used;
+    MessageSerializer::store_header(header, out);
+    push_arena(out, FRAME_HEADER_SIZE);
+
+    if (!payload.empty()) {
+        m_slices[m_count++] = net::make_io_slice(payload.data(), payload.size());
+        m_last_is_arena = false;
+    }
+
+    const uint32_t checksum = EndianUtils::to_little_endian(
+        frame_checksum(header, payload.data(), header.payload_length));
+    std::memcpy(out + FRAME_HEADER_SIZE, &checksum, sizeof(checksum));
+    push_arena(out + FRAME_HEADER_SIZE, sizeof(checksum));
+
+    m_arena_used += ARENA_BYTES_PER_FRAME;
+    m_pending += MessageSerializer::calculate_frame_size(header);
+    ++m_frames;
+    return true;
+}
+
+void FrameBatchEncoder::push_arena(const uint8_t* data, size_t length) noexcept
+{
+    if (m_last_is_arena) {
+        net::IoSlice& last = m_slices[m_count - 1];
+        if (net::io_slice_data(last) + net::io_slice_length(last) == data) {
+            last = net::make_io_slice(net::io_slice_data(last), net::io_slice_length(last) + length);
+            return;
+        }
+    }
+
+    m_slices[m_count++] = net::make_io_slice(data, length);
+    m_last_is_arena = true;
+}
+
+void FrameBatchEncoder::consume(size_t bytes) noexcept
+{
+    bytes = std::min(bytes, m_pending);
+    if (bytes == 0) {
+        return;
+    }
+    m_pending -= bytes;
+    m_sending = true;
+
+    while (bytes > 0) {
+        net::IoSlice& slice = m_slices[m_first];
+        const size_t length = net::io_slice_length(slice);
+        if (bytes < length) {
+            slice = net::make_io_slice(net::io_slice_data(slice) + bytes, length - bytes);
+            break;
+        }
+        bytes -= length;
+        ++m_first;
+    }
+
+    if (m_pending == 0) {
+        clear();
+    }
+}
+
+void FrameBatchEncoder::clear() noexcept
+{
+    m_arena_used = 0;
+    m_count = 0;
+    m_first = 0;
+    m_last_is_arena = false;
+    m_frames = 0;
+    m_pending = 0;
+    m_sending = false;
+}
+
+} // namespace protocol
+} // namespace core
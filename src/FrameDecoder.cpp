@@ -0,0 +1,133 @@
+#include "FrameDecoder.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace core {
+namespace protocol {
+
+bool FrameDecoder::feed(const uint8_t* data, size_t length) noexcept
+{
+    if (length == 0) {
+        return true;
+    }
+
+    uint8_t* space = prepare(length);
+    if (!space) {
+        return false;
+    }
+
+    std::memcpy(space, data, length);
+    commit(length);
+    return true;
+}
+
+uint8_t* FrameDecoder::prepare(size_t min_bytes) noexcept
+{
+    if (m_start == m_end) {
+        m_start = 0;
+        m_end = 0;
+    }
+
+    if (get_writable() < min_bytes) {
+        // Move the unparsed tail to the front; offsets are relative to m_start so the parsed header stays valid
+        if (m_start > 0) {
+            std::memmove(m_buffer.data(), m_buffer.data() + m_start, m_end - m_start);
+            m_end -= m_start;
+            m_start = 0;
+        }
+
+        if (get_writable() < min_bytes) {
+            try {
+                m_buffer.resize(std::max({MIN_CAPACITY, m_buffer.size() * 2, m_end + min_bytes}));
+            } catch (const std::bad_alloc&) {
+                return nullptr;
+            }
+        }
+    }
+
+    return m_buffer.data() + m_end;
+}
+
+DecodeStatus FrameDecoder::next(FrameView& frame) noexcept
+{
+    if (m_failed) {
+        return DecodeStatus::CORRUPT;
+    }
+
+    while (true) {
+        const size_t available = m_end - m_start;
+        const uint8_t* data = m_buffer.data() + m_start;
+
+        if (!m_have_header) {
+            if (available < FRAME_HEADER_SIZE) {
+                return DecodeStatus::NEED_MORE;
+            }
+
+            m_header = MessageSerializer::load_header(data);
+            if (!m_header.is_valid()) {
+                if (!on_corrupt()) {
+                    return DecodeStatus::CORRUPT;
+                }
+                continue;
+            }
+            m_have_header = true;
+            m_frame_size = MessageSerializer::calculate_frame_size(m_header);
+        }
+
+        if (available < m_frame_size) {
+            return DecodeStatus::NEED_MORE;
+        }
+
+        const uint8_t* payload = data + FRAME_HEADER_SIZE;
+        uint32_t received_checksum;
+        std::memcpy(&received_checksum, payload + m_header.payload_length, sizeof(received_checksum));
+        received_checksum = EndianUtils::from_little_endian(received_checksum);
+
+        if (received_checksum != frame_checksum(m_header, payload, m_header.payload_length)) {
+            if (!on_corrupt()) {
+                return DecodeStatus::CORRUPT;
+            }
+            continue;
+        }
+
+        frame.header = m_header;
+        frame.payload = std::span<const uint8_t>(payload, m_header.payload_length);
+
+        m_start += m_frame_size;
+        m_have_header = false;
+        ++m_frames;
+        return DecodeStatus::FRAME;
+    }
+}
+
+bool FrameDecoder::on_corrupt() noexcept
+{
+    ++m_corrupt;
+    m_have_header = false;
+
+    if (m_policy == CorruptionPolicy::DISCONNECT) {
+        m_failed = true;
+        return false;
+    }
+
+    // The bad frame's length can't be trusted: look for a magic byte after its first byte
+    const uint8_t* from = m_buffer.data() + m_start + 1;
+    const void* found = std::memchr(from, PROTOCOL_MAGIC, m_end - m_start - 1);
+    const size_t resume = found ? static_cast<size_t>(static_cast<const uint8_t*>(found) - m_buffer.data()) : m_end;
+
+    m_skipped += resume - m_start;
+    m_start = resume;
+    return true;
+}
+
+void FrameDecoder::reset() noexcept
+{
+    m_start = 0;
+    m_end = 0;
+    m_have_header = false;
+    m_failed = false;
+}
+
+} // namespace protocol
+} // namespace core
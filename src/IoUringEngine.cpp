@@ -0,0 +1,541 @@
+#include "IoUringEngine.h"
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#endif
+
+namespace core {
+namespace net {
+
+#ifdef __linux__
+
+namespace {
+
+constexpr uint16_t BUFFER_GROUP = 0;
+constexpr unsigned TOKEN_BITS = 56;
+constexpr uint64_t TOKEN_MASK = (uint64_t{1} << TOKEN_BITS) - 1;
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* params) noexcept
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                       void* arg, size_t arg_size) noexcept
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, arg_size));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, void* arg, unsigned nr_args) noexcept
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+uint64_t encode_user_data(IoUringEngine::Operation operation, uint64_t token) noexcept
+{
+    return (static_cast<uint64_t>(operation) << TOKEN_BITS) | (token & TOKEN_MASK);
+}
+
+template<typename T>
+T load_acquire(T* location) noexcept
+{
+    return std::atomic_ref<T>(*location).load(std::memory_order_acquire);
+}
+
+template<typename T>
+void store_release(T* location, T value) noexcept
+{
+    std::atomic_ref<T>(*location).store(value, std::memory_order_release);
+}
+
+} // namespace
+
+/**
+ * @brief Kernel-shared ring state (kept out of the header)
+ */
+struct IoUringEngine::Ring {
+    int fd{-1};
+    int wakeup_fd{-1};
+    uint64_t wakeup_value{0};
+
+    // Submission queue
+    void* sq_map{MAP_FAILED};
+    size_t sq_map_size{0};
+    unsigned* sq_head{nullptr};
+    unsigned* sq_tail{nullptr};
+    unsigned* sq_array{nullptr};
+    unsigned sq_mask{0};
+    unsigned sq_entries{0};
+    io_uring_sqe* sqes{static_cast<io_uring_sqe*>(MAP_FAILED)};
+    size_t sqes_size{0};
+    unsigned sq_local_tail{0};
+    unsigned sq_to_submit{0};
+
+    // Completion queue
+    void* cq_map{MAP_FAILED};
+    size_t cq_map_size{0};
+    unsigned* cq_head{nullptr};
+    unsigned* cq_tail{nullptr};
+    unsigned cq_mask{0};
+    io_uring_cqe* cqes{nullptr};
+
+    // Provided receive buffers
+    void* buf_ring_map{MAP_FAILED};
+    size_t buf_ring_size{0};
+    io_uring_buf_ring* buf_ring{nullptr};
+    io_uring_buf* buf_entries{nullptr};
+    unsigned buf_count{0};
+    unsigned buf_mask{0};
+    uint16_t buf_local_tail{0};
+    bool buf_dirty{false};
+    std::vector<uint8_t> buffers;
+
+    ~Ring()
+    {
+        if (buf_ring_map != MAP_FAILED) {
+            munmap(buf_ring_map, buf_ring_size);
+        }
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_map != MAP_FAILED && cq_map != sq_map) {
+            munmap(cq_map, cq_map_size);
+        }
+        if (sq_map != MAP_FAILED) {
+            munmap(sq_map, sq_map_size);
+        }
+        if (wakeup_fd >= 0) {
+            ::close(wakeup_fd);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    bool setup(unsigned queue_depth) noexcept
+    {
+        io_uring_params params{};
+        // CQ twice the SQ: multishot requests post many completions per submission
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = queue_depth * 2;
+
+        fd = sys_io_uring_setup(queue_depth, &params);
+        if (fd < 0) {
+            std::cerr << "io_uring_setup() failed: " << errno << std::endl;
+            return false;
+        }
+
+        if (!(params.features & IORING_FEAT_EXT_ARG)) {
+            std::cerr << "io_uring lacks IORING_FEAT_EXT_ARG" << std::endl;
+            return false;
+        }
+
+        sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+        }
+
+        sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      fd, IORING_OFF_SQ_RING);
+        if (sq_map == MAP_FAILED) {
+            std::cerr << "mmap(SQ ring) failed: " << errno << std::endl;
+            return false;
+        }
+
+        cq_map = single_mmap ? sq_map
+                             : mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                    fd, IORING_OFF_CQ_RING);
+        if (cq_map == MAP_FAILED) {
+            std::cerr << "mmap(CQ ring) failed: " << errno << std::endl;
+            return false;
+        }
+
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            std::cerr << "mmap(SQEs) failed: " << errno << std::endl;
+            return false;
+        }
+
+        auto* sq_base = static_cast<uint8_t*>(sq_map);
+        sq_head = reinterpret_cast<unsigned*>(sq_base + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq_base + params.sq_off.tail);
+        sq_array = reinterpret_cast<unsigned*>(sq_base + params.sq_off.array);
+        sq_mask = *reinterpret_cast<unsigned*>(sq_base + params.sq_off.ring_mask);
+        sq_entries = *reinterpret_cast<unsigned*>(sq_base + params.sq_off.ring_entries);
+        sq_local_tail = *sq_tail;
+
+        auto* cq_base = static_cast<uint8_t*>(cq_map);
+        cq_head = reinterpret_cast<unsigned*>(cq_base + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq_base + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq_base + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq_base + params.cq_off.cqes);
+
+        return true;
+    }
+
+    bool setup_buffers(unsigned count, size_t size) noexcept
+    {
+        buf_count = count;
+        buf_mask = count - 1;
+        buf_ring_size = count * sizeof(io_uring_buf);
+
+        // Ring memory must be page aligned; anonymous mappings are
+        buf_ring_map = mmap(nullptr, buf_ring_size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buf_ring_map == MAP_FAILED) {
+            std::cerr << "mmap(buffer ring) failed: " << errno << std::endl;
+            return false;
+        }
+        buf_ring = static_cast<io_uring_buf_ring*>(buf_ring_map);
+        // Not buf_ring->bufs: in C++ the uapi flex-array macro shifts that member by 8 bytes
+        buf_entries = static_cast<io_uring_buf*>(buf_ring_map);
+
+        io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_map);
+        reg.ring_entries = count;
+        reg.bgid = BUFFER_GROUP;
+        if (sys_io_uring_register(fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            std::cerr << "IORING_REGISTER_PBUF_RING failed: " << errno << std::endl;
+            return false;
+        }
+
+        try {
+            buffers.resize(static_cast<size_t>(count) * size);
+        } catch (...) {
+            return false;
+        }
+
+        for (unsigned i = 0; i < count; ++i) {
+            add_buffer(static_cast<uint16_t>(i), size);
+        }
+        publish_buffers();
+        return true;
+    }
+
+    void add_buffer(uint16_t buffer_id, size_t size) noexcept
+    {
+        io_uring_buf* buf = &buf_entries[buf_local_tail & buf_mask];
+        buf->addr = reinterpret_cast<uint64_t>(buffers.data() + static_cast<size_t>(buffer_id) * size);
+        buf->len = static_cast<uint32_t>(size);
+        buf->bid = buffer_id;
+        ++buf_local_tail;
+        buf_dirty = true;
+    }
+
+    void publish_buffers() noexcept
+    {
+        if (buf_dirty) {
+            store_release(&buf_ring->tail, buf_local_tail);
+            buf_dirty = false;
+        }
+    }
+
+    unsigned sq_space() const noexcept
+    {
+        return sq_entries - (sq_local_tail - load_acquire(sq_head));
+    }
+
+    io_uring_sqe* next_sqe() noexcept
+    {
+        if (sq_space() == 0 && !flush()) {
+            return nullptr;
+        }
+
+        unsigned index = sq_local_tail & sq_mask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array[index] = index;
+        ++sq_local_tail;
+        ++sq_to_submit;
+        return sqe;
+    }
+
+    void publish_sqes() noexcept
+    {
+        store_release(sq_tail, sq_local_tail);
+    }
+
+    bool flush() noexcept
+    {
+        publish_sqes();
+        publish_buffers();
+        if (sq_to_submit == 0) {
+            return true;
+        }
+
+        int submitted = sys_io_uring_enter(fd, sq_to_submit, 0, 0, nullptr, 0);
+        if (submitted < 0) {
+            std::cerr << "io_uring_enter(submit) failed: " << errno << std::endl;
+            return false;
+        }
+
+        sq_to_submit -= static_cast<unsigned>(submitted);
+        return true;
+    }
+
+    bool arm_wakeup() noexcept
+    {
+        io_uring_sqe* sqe = next_sqe();
+        if (!sqe) {
+            return false;
+        }
+
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = wakeup_fd;
+        sqe->addr = reinterpret_cast<uint64_t>(&wakeup_value);
+        sqe->len = sizeof(wakeup_value);
+        sqe->user_data = encode_user_data(Operation::WAKEUP, 0);
+        return true;
+    }
+};
+
+IoUringEngine::IoUringEngine(unsigned queue_depth, unsigned buffer_count, size_t buffer_size)
+    : m_ring(std::make_unique<Ring>())
+    , m_buffer_size(buffer_size)
+{
+    if ((buffer_count & (buffer_count - 1)) != 0 || buffer_count == 0 || buffer_count > 32768) {
+        std::cerr << "io_uring buffer count must be a power of 2 up to 32768" << std::endl;
+        m_ring.reset();
+        return;
+    }
+
+    if (!m_ring->setup(queue_depth) || !m_ring->setup_buffers(buffer_count, buffer_size)) {
+        m_ring.reset();
+        return;
+    }
+
+    m_ring->wakeup_fd = eventfd(0, EFD_CLOEXEC);
+    if (m_ring->wakeup_fd < 0 || !m_ring->arm_wakeup()) {
+        std::cerr << "io_uring wakeup setup failed: " << errno << std::endl;
+        m_ring.reset();
+    }
+}
+
+IoUringEngine::~IoUringEngine() noexcept = default;
+
+bool IoUringEngine::is_supported() noexcept
+{
+    static const bool supported = []() {
+        IoUringEngine probe(8, 8, 64);
+        return probe.is_valid();
+    }();
+    return supported;
+}
+
+bool IoUringEngine::is_valid() const noexcept
+{
+    return m_ring != nullptr;
+}
+
+bool IoUringEngine::accept_multishot(SOCKET listen_socket, uint64_t token) noexcept
+{
+    io_uring_sqe* sqe = m_ring->next_sqe();
+    if (!sqe) {
+        return false;
+    }
+
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_socket;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = encode_user_data(Operation::ACCEPT, token);
+    return true;
+}
+
+bool IoUringEngine::recv_multishot(SOCKET socket, uint64_t token) noexcept
+{
+    io_uring_sqe* sqe = m_ring->next_sqe();
+    if (!sqe) {
+        return false;
+    }
+
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = socket;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = encode_user_data(Operation::RECV, token);
+    return true;
+}
+
+bool IoUringEngine::send_linked(SOCKET socket, uint64_t token, const IoSlice* slices, size_t count) noexcept
+{
+    if (count == 0 || count > MAX_LINKED_SENDS) {
+        return false;
+    }
+
+    // A chain must sit contiguously in one submission
+    if (m_ring->sq_space() < count && !m_ring->flush()) {
+        return false;
+    }
+    if (m_ring->sq_space() < count) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        io_uring_sqe* sqe = m_ring->next_sqe();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = socket;
+        sqe->addr = reinterpret_cast<uint64_t>(io_slice_data(slices[i]));
+        sqe->len = static_cast<uint32_t>(io_slice_length(slices[i]));
+        // WAITALL makes a short send retry in-kernel or fail the link, never leave a gap
+        sqe->msg_flags = MSG_WAITALL | MSG_NOSIGNAL;
+        sqe->user_data = encode_user_data(Operation::SEND, token);
+        if (i + 1 < count) {
+            sqe->flags = IOSQE_IO_LINK;
+        }
+    }
+    return true;
+}
+
+bool IoUringEngine::cancel(SOCKET socket) noexcept
+{
+    io_uring_sqe* sqe = m_ring->next_sqe();
+    if (!sqe) {
+        return false;
+    }
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = socket;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data = encode_user_data(Operation::CANCEL, 0);
+    return true;
+}
+
+bool IoUringEngine::cancel(Operation operation, uint64_t token) noexcept
+{
+    io_uring_sqe* sqe = m_ring->next_sqe();
+    if (!sqe) {
+        return false;
+    }
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = encode_user_data(operation, token);
+    sqe->user_data = encode_user_data(Operation::CANCEL, 0);
+    return true;
+}
+
+int IoUringEngine::submit_and_wait(int timeout_ms) noexcept
+{
+    Ring& ring = *m_ring;
+    ring.publish_sqes();
+    ring.publish_buffers();
+
+    __kernel_timespec ts{};
+    io_uring_getevents_arg arg{};
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+    }
+
+    // Completions already waiting: just submit, don't block
+    unsigned ready = load_acquire(ring.cq_tail) - *ring.cq_head;
+    unsigned min_complete = ready > 0 ? 0 : 1;
+
+    int result = sys_io_uring_enter(ring.fd, ring.sq_to_submit, min_complete,
+                                    IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                                    &arg, sizeof(arg));
+    if (result < 0) {
+        if (errno != ETIME && errno != EINTR && errno != EBUSY) {
+            std::cerr << "io_uring_enter() failed: " << errno << std::endl;
+            return -1;
+        }
+    } else {
+        ring.sq_to_submit -= static_cast<unsigned>(result);
+    }
+
+    return static_cast<int>(load_acquire(ring.cq_tail) - *ring.cq_head);
+}
+
+size_t IoUringEngine::process_completions(const CompletionHandler& handler) noexcept
+{
+    Ring& ring = *m_ring;
+    unsigned head = *ring.cq_head;
+    unsigned tail = load_acquire(ring.cq_tail);
+    size_t processed = 0;
+
+    for (; head != tail; ++head, ++processed) {
+        const io_uring_cqe& cqe = ring.cqes[head & ring.cq_mask];
+
+        Completion completion{};
+        completion.operation = static_cast<Operation>(cqe.user_data >> TOKEN_BITS);
+        completion.token = cqe.user_data & TOKEN_MASK;
+        completion.result = cqe.res;
+        completion.more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+        completion.data = nullptr;
+        completion.buffer_id = 0;
+
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+            completion.buffer_id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            completion.data = ring.buffers.data() + static_cast<size_t>(completion.buffer_id) * m_buffer_size;
+        }
+
+        if (completion.operation == Operation::WAKEUP) {
+            ring.arm_wakeup();
+            continue;
+        }
+
+        handler(completion);
+    }
+
+    store_release(ring.cq_head, head);
+    ring.publish_buffers();
+    return processed;
+}
+
+void IoUringEngine::recycle_buffer(uint16_t buffer_id) noexcept
+{
+    m_ring->add_buffer(buffer_id, m_buffer_size);
+}
+
+void IoUringEngine::wakeup() noexcept
+{
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t written = ::write(m_ring->wakeup_fd, &one, sizeof(one));
+}
+
+#else
+
+// ============ Unsupported platforms ============
+
+struct IoUringEngine::Ring {
+};
+
+IoUringEngine::IoUringEngine(unsigned /*queue_depth*/, unsigned /*buffer_count*/, size_t buffer_size)
+    : m_buffer_size(buffer_size)
+{
+}
+
+IoUringEngine::~IoUringEngine() noexcept = default;
+
+bool IoUringEngine::is_supported() noexcept { return false; }
+bool IoUringEngine::is_valid() const noexcept { return false; }
+bool IoUringEngine::accept_multishot(SOCKET, uint64_t) noexcept { return false; }
+bool IoUringEngine::recv_multishot(SOCKET, uint64_t) noexcept { return false; }
+bool IoUringEngine::send_linked(SOCKET, uint64_t, const IoSlice*, size_t) noexcept { return false; }
+bool IoUringEngine::cancel(SOCKET) noexcept { return false; }
+bool IoUringEngine::cancel(Operation, uint64_t) noexcept { return false; }
+int IoUringEngine::submit_and_wait(int) noexcept { return -1; }
+size_t IoUringEngine::process_completions(const CompletionHandler&) noexcept { return 0; }
+void IoUringEngine::recycle_buffer(uint16_t) noexcept {}
+void IoUringEngine::wakeup() noexcept {}
+
+#endif
+
+} // namespace net
+} // namespace core
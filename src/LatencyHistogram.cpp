@@ -0,0 +1,124 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace core {
+
+LatencyHistogram::LatencyHistogram()
+    : m_counts(BUCKET_COUNT, 0)
+{
+}
+
+void LatencyHistogram::record(uint64_t value, uint64_t count) noexcept
+{
+    if (count == 0) {
+        return;
+    }
+
+    m_counts[index_of(value)] += count;
+    m_count += count;
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+    m_sum += static_cast<double>(value) * static_cast<double>(count);
+}
+
+void LatencyHistogram::record_corrected(uint64_t value, uint64_t expected_interval, uint64_t count) noexcept
+{
+    record(value, count);
+    if (expected_interval == 0) {
+        return;
+    }
+
+    for (uint64_t missing = value - std::min(value, expected_interval); missing >= expected_interval;
+         missing -= expected_interval) {
+        record(missing, count);
+    }
+}
+
+LatencyHistogram LatencyHistogram::corrected(uint64_t expected_interval) const
+{
+    LatencyHistogram result;
+    for (size_t index = 0; index < BUCKET_COUNT; ++index) {
+        if (m_counts[index] != 0) {
+            result.record_corrected(std::min(highest_of(index), m_max), expected_interval, m_counts[index]);
+        }
+    }
+    return result;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) noexcept
+{
+    for (size_t index = 0; index < BUCKET_COUNT; ++index) {
+        m_counts[index] += other.m_counts[index];
+    }
+    m_count += other.m_count;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+    m_sum += other.m_sum;
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const noexcept
+{
+    if (m_count == 0) {
+        return 0;
+    }
+
+    const double clamped = std::clamp(percentile, 0.0, 100.0);
+    const uint64_t rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(m_count))));
+
+    uint64_t seen = 0;
+    for (size_t index = 0; index < BUCKET_COUNT; ++index) {
+        seen += m_counts[index];
+        if (seen >= rank) {
+            return std::min(highest_of(index), m_max);
+        }
+    }
+    return m_max;
+}
+
+void LatencyHistogram::reset() noexcept
+{
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_count = 0;
+    m_min = UINT64_MAX;
+    m_max = 0;
+    m_sum = 0.0;
+}
+
+size_t LatencyHistogram::index_of(uint64_t value) noexcept
+{
+    if (value < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value);
+    }
+
+    // Top SUB_BUCKET_BITS bits of the value pick the sub-bucket within its power of two
+    const unsigned shift = static_cast<unsigned>(std::bit_width(value)) - SUB_BUCKET_BITS;
+    const uint64_t sub_bucket = value >> shift;
+    return static_cast<size_t>(SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF + (sub_bucket - SUB_BUCKET_HALF));
+}
+
+uint64_t LatencyHistogram::lowest_of(size_t index) noexcept
+{
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+
+    const size_t offset = index - SUB_BUCKET_COUNT;
+    const unsigned shift = static_cast<unsigned>(offset / SUB_BUCKET_HALF) + 1;
+    const uint64_t sub_bucket = offset % SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+    return sub_bucket << shift;
+}
+
+uint64_t LatencyHistogram::highest_of(size_t index) noexcept
+{
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+
+    const unsigned shift = static_cast<unsigned>((index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF) + 1;
+    return lowest_of(index) + ((uint64_t{1} << shift) - 1);
+}
+
+} // namespace core
@@ -0,0 +1,457 @@
+#include "AsyncClient.h"
+#include "LatencyHistogram.h"
+#include "ProtocolMessages.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace core;
+using namespace core::net;
+using core::protocol::MessageType;
+
+namespace {
+
+/**
+ * @brief Command-line settings
+ */
+struct Options {
+    std::string address = "127.0.0.1";
+    uint16_t port = 5000;
+    size_t threads = 4;
+    size_t connections = 1000;          // Across all threads
+    size_t depth = 0;                   // Outstanding requests per connection (0 = 1 closed loop, 64 open loop)
+    double rate = 0.0;                  // Requests/s across all threads; > 0 selects open loop
+    double duration_s = 10.0;
+    double warmup_s = 2.0;
+    size_t payload_bytes = 64;          // ECHO and DATA payloads
+    std::string mix_text = "ping:1,echo:1,data:1";
+    std::vector<MessageType> mix;       // Weighted round-robin sequence of request types
+    SocketProfile profile = SocketProfile::LATENCY;
+    bool crc32c = false;                // Checksum requests with CRC32C instead of CRC32
+
+    [[nodiscard]] bool is_open_loop() const noexcept
+    {
+        return rate > 0.0;
+    }
+};
+
+/**
+ * @brief What one load thread measured
+ */
+struct ThreadResult {
+    LatencyHistogram latency;
+    uint64_t completed{0};      // Responses to requests scheduled inside the measurement window
+    uint64_t failed{0};         // Requests lost with their connection
+    uint64_t unfinished{0};     // Still outstanding when the run ended
+    uint64_t late{0};           // Open loop: sends deferred because every connection was at depth
+    uint64_t sends{0};
+    uint64_t requests{0};
+    size_t connections{0};
+};
+
+uint64_t now_ns() noexcept
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool match_option(const std::string& arg, const std::string& name, std::string& value)
+{
+    const std::string prefix = "--" + name + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    value = arg.substr(prefix.size());
+    return true;
+}
+
+// "ping:2,echo:1,data:1" -> PING, PING, ECHO, DATA
+bool parse_mix(const std::string& text, std::vector<MessageType>& mix)
+{
+    mix.clear();
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        const size_t colon = item.find(':');
+        const std::string name = item.substr(0, colon);
+        const unsigned long weight = colon == std::string::npos ? 1 : std::stoul(item.substr(colon + 1));
+
+        MessageType type;
+        if (name == "ping") {
+            type = MessageType::PING;
+        } else if (name == "echo") {
+            type = MessageType::ECHO;
+        } else if (name == "data") {
+            type = MessageType::DATA;
+        } else {
+            return false;
+        }
+        mix.insert(mix.end(), weight, type);
+    }
+    return !mix.empty();
+}
+
+void print_usage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --address=A        Server IPv4 address (127.0.0.1)\n"
+              << "  --port=P           Server port (5000)\n"
+              << "  --threads=N        Load threads, one client each (4)\n"
+              << "  --connections=N    Connections across all threads (1000)\n"
+              << "  --depth=N          Outstanding requests per connection (closed loop: 1, open loop: cap 64)\n"
+              << "  --rate=R           Requests/s across all threads; selects open loop (closed loop)\n"
+              << "  --duration=S       Measured seconds (10)\n"
+              << "  --warmup=S         Unmeasured seconds before that (2)\n"
+              << "  --mix=SPEC         Request mix, e.g. ping:2,echo:1,data:1 (ping:1,echo:1,data:1)\n"
+              << "  --payload=BYTES    ECHO/DATA payload size (64)\n"
+              << "  --profile=NAME     default|latency|throughput (latency)\n"
+              << "  --checksum=NAME    crc32|crc32c (crc32)" << std::endl;
+}
+
+bool parse_options(int argc, char* argv[], Options& options)
+{
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            std::string value;
+            if (match_option(arg, "address", value)) {
+                options.address = value;
+            } else if (match_option(arg, "port", value)) {
+                options.port = static_cast<uint16_t>(std::stoul(value));
+            } else if (match_option(arg, "threads", value)) {
+                options.threads = std::stoul(value);
+            } else if (match_option(arg, "connections", value)) {
+                options.connections = std::stoul(value);
+            } else if (match_option(arg, "depth", value)) {
+                options.depth = std::stoul(value);
+            } else if (match_option(arg, "rate", value)) {
+                options.rate = std::stod(value);
+            } else if (match_option(arg, "duration", value)) {
+                options.duration_s = std::stod(value);
+            } else if (match_option(arg, "warmup", value)) {
+                options.warmup_s = std::stod(value);
+            } else if (match_option(arg, "mix", value)) {
+                options.mix_text = value;
+            } else if (match_option(arg, "payload", value)) {
+                options.payload_bytes = std::stoul(value);
+            } else if (match_option(arg, "profile", value)) {
+                options.profile = value == "default"      ? SocketProfile::DEFAULT
+                                : value == "throughput"   ? SocketProfile::THROUGHPUT
+                                                          : SocketProfile::LATENCY;
+            } else if (match_option(arg, "checksum", value)) {
+                if (value != "crc32" && value != "crc32c") {
+                    return false;
+                }
+                options.crc32c = value == "crc32c";
+            } else {
+                return false;
+            }
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    if (options.depth == 0) {
+        options.depth = options.is_open_loop() ? 64 : 1;
+    }
+    return parse_mix(options.mix_text, options.mix) && options.threads > 0 &&
+           options.connections >= options.threads && options.duration_s > 0.0 &&
+           options.payload_bytes <= protocol::MAX_PAYLOAD_SIZE;
+}
+
+// Thousands of sockets need more descriptors than the usual soft limit of 1024
+void raise_descriptor_limit(size_t wanted)
+{
+#ifndef _WIN32
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < wanted + 64) {
+        limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, wanted + 64);
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+#else
+    (void)wanted;
+#endif
+}
+
+/**
+ * @brief One load thread: its own client, connection share and histogram
+ */
+class LoadThread {
+public:
+    LoadThread(const Options& options, size_t index, ThreadResult& result)
+        : m_options(options)
+        , m_index(index)
+        , m_result(result)
+        , m_ping_payload(sizeof(protocol::messages::PingMessage), 0)
+        , m_data_payload(options.payload_bytes, 0x5A)
+    {
+    }
+
+    /**
+     * @brief Open this thread's share of the connections
+     */
+    bool connect()
+    {
+        const size_t share = m_options.connections / m_options.threads +
+                             (m_index < m_options.connections % m_options.threads ? 1 : 0);
+
+        ClientConfig config;
+        config.pool_size = share;
+        config.max_in_flight = m_options.depth;
+        config.socket_profile = m_options.profile;
+        config.crc32c_checksums = m_options.crc32c;
+        m_client = std::make_unique<AsyncClient>(config);
+
+        const bool connected = m_client->connect(m_options.address, m_options.port);
+        m_result.connections = m_client->get_connection_count();
+        return connected;
+    }
+
+    /**
+     * @brief Generate load from start_ns until the measurement window closes
+     */
+    void run(uint64_t start_ns)
+    {
+        m_measure_start = start_ns + static_cast<uint64_t>(m_options.warmup_s * 1e9);
+        m_measure_end = m_measure_start + static_cast<uint64_t>(m_options.duration_s * 1e9);
+
+        if (m_options.is_open_loop()) {
+            run_open_loop(start_ns);
+        } else {
+            run_closed_loop();
+        }
+
+        // Stop issuing and collect what is still on the wire
+        m_client->wait_for_responses(2000);
+        m_result.unfinished = m_client->get_in_flight();
+        m_result.sends = m_client->get_send_count();
+    }
+
+private:
+    /**
+     * @brief Keep depth requests outstanding on every connection
+     */
+    void run_closed_loop()
+    {
+        const size_t outstanding = m_result.connections * m_options.depth;
+        for (size_t i = 0; i < outstanding; ++i) {
+            issue(now_ns());
+        }
+
+        while (now_ns() < m_measure_end) {
+            m_client->poll(10);
+        }
+    }
+
+    /**
+     * @brief Send on a fixed schedule whatever the responses do
+     * Latency is taken from the scheduled time, so a stalled server is charged for the
+     * requests that queued up behind the stall (no coordinated omission).
+     */
+    void run_open_loop(uint64_t start_ns)
+    {
+        const double interval = 1e9 * static_cast<double>(m_options.threads) / m_options.rate;
+
+        // Threads interleave their schedules instead of firing together
+        double next = static_cast<double>(start_ns) + interval * static_cast<double>(m_index) /
+                                                      static_cast<double>(m_options.threads);
+
+        while (true) {
+            uint64_t now = now_ns();
+            if (now >= m_measure_end) {
+                break;
+            }
+
+            while (static_cast<uint64_t>(next) <= now && static_cast<uint64_t>(next) < m_measure_end) {
+                if (!issue(static_cast<uint64_t>(next))) {
+                    ++m_result.late;    // Every connection at depth: retried, still charged from its slot
+                    break;
+                }
+                next += interval;
+            }
+
+            now = now_ns();
+            const uint64_t due = static_cast<uint64_t>(next);
+            const int wait_ms = due > now ? static_cast<int>(std::min<uint64_t>((due - now) / 1000000, 10)) : 0;
+            m_client->poll(wait_ms);
+        }
+    }
+
+    /**
+     * @brief Send the next request of the mix
+     * @param scheduled_ns When the request was meant to go out (latency is measured from here)
+     */
+    bool issue(uint64_t scheduled_ns)
+    {
+        const MessageType type = m_options.mix[m_next_type++ % m_options.mix.size()];
+        const std::vector<uint8_t>& payload = type == MessageType::PING ? m_ping_payload : m_data_payload;
+
+        const bool sent = m_client->send_request(type, payload.data(), static_cast<uint16_t>(payload.size()),
+                                                 [this, scheduled_ns](const ClientResponse& response) {
+            on_response(response, scheduled_ns);
+        });
+        m_result.requests += sent ? 1 : 0;
+        return sent;
+    }
+
+    void on_response(const ClientResponse& response, uint64_t scheduled_ns)
+    {
+        const uint64_t now = now_ns();
+        const bool measured = scheduled_ns >= m_measure_start && scheduled_ns < m_measure_end;
+
+        if (!response.ok) {
+            m_result.failed += measured ? 1 : 0;
+            return;
+        }
+        if (measured) {
+            m_result.latency.record(now - scheduled_ns);
+            ++m_result.completed;
+        }
+
+        // Closed loop: the response frees the slot for the next request
+        if (!m_options.is_open_loop() && now < m_measure_end) {
+            issue(now);
+        }
+    }
+
+    const Options& m_options;
+    size_t m_index;
+    ThreadResult& m_result;
+    std::unique_ptr<AsyncClient> m_client;
+    std::vector<uint8_t> m_ping_payload;
+    std::vector<uint8_t> m_data_payload;
+    size_t m_next_type{0};
+    uint64_t m_measure_start{0};
+    uint64_t m_measure_end{0};
+};
+
+void print_latency_row(const char* label, const LatencyHistogram& histogram)
+{
+    std::cout << "  " << std::left << std::setw(12) << label << std::right << std::fixed << std::setprecision(1);
+    for (double percentile : {50.0, 90.0, 99.0, 99.9, 99.99}) {
+        std::cout << std::setw(10) << static_cast<double>(histogram.percentile(percentile)) / 1000.0;
+    }
+    std::cout << std::setw(10) << static_cast<double>(histogram.get_max()) / 1000.0 << std::endl;
+}
+
+} // namespace
+
+/**
+ * @brief Load generator for HighPerfServer (run it with --serve)
+ *
+ * Demonstrates:
+ * - Closed-loop load (fixed concurrency) and open-loop load (constant arrival rate)
+ * - Coordinated-omission-corrected latency: open loop measures from each request's
+ *   scheduled time, closed loop is corrected after the fact with the mean latency as interval
+ * - One AsyncClient per thread, per-thread histograms merged at the end
+ */
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    raise_descriptor_limit(options.connections);
+
+    std::cout << "LoadGenerator: " << (options.is_open_loop() ? "open" : "closed") << " loop";
+    if (options.is_open_loop()) {
+        std::cout << " at " << options.rate << " req/s";
+    }
+    std::cout << ", " << options.threads << " threads, " << options.connections << " connections, depth "
+              << options.depth << ", mix " << options.mix_text << ", " << options.payload_bytes
+              << "-byte payloads, " << to_string(options.profile) << " sockets, "
+              << (options.crc32c ? "crc32c" : "crc32") << " checksums" << std::endl;
+
+    std::vector<ThreadResult> results(options.threads);
+    std::vector<std::unique_ptr<LoadThread>> loads;
+    for (size_t i = 0; i < options.threads; ++i) {
+        loads.push_back(std::make_unique<LoadThread>(options, i, results[i]));
+    }
+
+    // Connect everything first so connection setup doesn't pollute the numbers
+    std::atomic<size_t> ready{0};
+    std::atomic<uint64_t> start_ns{0};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < options.threads; ++i) {
+        threads.emplace_back([&, i]() {
+            const bool connected = loads[i]->connect();
+            ready.fetch_add(1);
+            while (start_ns.load() == 0) {
+                std::this_thread::yield();
+            }
+            if (connected) {
+                loads[i]->run(start_ns.load());
+            }
+        });
+    }
+
+    while (ready.load() < options.threads) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    size_t connected = 0;
+    for (const auto& result : results) {
+        connected += result.connections;
+    }
+    std::cout << "Connected " << connected << "/" << options.connections << "; warming up " << options.warmup_s
+              << " s, measuring " << options.duration_s << " s" << std::endl;
+    start_ns.store(now_ns());
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ThreadResult total;
+    for (const auto& result : results) {
+        total.latency.merge(result.latency);
+        total.completed += result.completed;
+        total.failed += result.failed;
+        total.unfinished += result.unfinished;
+        total.late += result.late;
+        total.sends += result.sends;
+        total.requests += result.requests;
+    }
+
+    if (connected == 0) {
+        std::cerr << "No connection to " << options.address << ":" << options.port
+                  << " (start the server with: HighPerfServer --serve)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Throughput:   " << static_cast<double>(total.completed) / options.duration_s << " req/s ("
+              << total.completed << " responses, " << total.failed << " failed, " << total.unfinished
+              << " unfinished)" << std::endl;
+    std::cout << "Batching:     " << (total.sends ? static_cast<double>(total.requests) / total.sends : 0.0)
+              << " requests per send" << std::endl;
+    if (options.is_open_loop()) {
+        std::cout << "Late sends:   " << total.late << " (every connection at depth when a request was due)"
+                  << std::endl;
+    }
+
+    std::cout << "Latency (us)        p50       p90       p99     p99.9    p99.99       max" << std::endl;
+    if (options.is_open_loop()) {
+        print_latency_row("scheduled", total.latency);
+        std::cout << "  (open loop: measured from each request's scheduled send time)" << std::endl;
+    } else {
+        print_latency_row("measured", total.latency);
+        print_latency_row("corrected", total.latency.corrected(static_cast<uint64_t>(total.latency.get_mean())));
+        std::cout << "  (closed loop: corrected for coordinated omission with the mean latency as interval)"
+                  << std::endl;
+    }
+
+    return total.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
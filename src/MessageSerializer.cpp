@@ -1,6 +1,7 @@
 #include "MessageSerializer.h"
 #include <cstring>
 #include <iostream>
+#include <new>
 
 namespace core {
 namespace protocol {
@@ -20,7 +21,7 @@ bool MessageSerializer::serialize_frame(const FrameHeader& header,
     }
 
     uint32_t checksum = 0;
-    if (!serialize_payload_and_checksum(payload, payload_length, buffer, checksum)) {
+    if (!serialize_payload_and_checksum(header, payload, payload_length, buffer, checksum)) {
         return false;
     }
 
@@ -30,15 +31,13 @@ bool MessageSerializer::serialize_frame(const FrameHeader& header,
 bool MessageSerializer::serialize_header(const FrameHeader& header,
                                         net::NetworkBuffer& buffer) noexcept
 {
-    return buffer.write_byte(header.magic) &&
-           buffer.write_byte(header.version) &&
-           buffer.write_byte(header.message_type) &&
-           buffer.write_byte(header.flags) &&
-           buffer.write_uint16(header.payload_length) &&
-           buffer.write_uint16(header.reserved);
+    uint8_t bytes[FRAME_HEADER_SIZE];
+    store_header(header, bytes);
+    return buffer.write(bytes, sizeof(bytes));
 }
 
-bool MessageSerializer::serialize_payload_and_checksum(const uint8_t* payload,
+bool MessageSerializer::serialize_payload_and_checksum(const FrameHeader& header,
+                                                      const uint8_t* payload,
                                                       uint16_t payload_length,
                                                       net::NetworkBuffer& buffer,
                                                       uint32_t& out_checksum) noexcept
@@ -54,7 +53,7 @@ bool MessageSerializer::serialize_payload_and_checksum(const uint8_t* payload,
     const uint8_t* data_to_checksum = buffer.data() + checksum_start;
     size_t data_length = payload_length;
 
-    out_checksum = crc32::calculate(data_to_checksum, data_length);
+    out_checksum = frame_checksum(header, data_to_checksum, data_length);
 
     // Write checksum (little-endian)
     uint8_t checksum_bytes[4] = {
@@ -75,14 +74,7 @@ size_t MessageSerializer::deserialize_header(const uint8_t* data,
         return 0; // Not enough data
     }
 
-    header.magic = data[0];
-    header.version = data[1];
-    header.message_type = data[2];
-    header.flags = data[3];
-    header.payload_length = static_cast<uint16_t>(data[4]) |
-                           (static_cast<uint16_t>(data[5]) << 8);
-    header.reserved = static_cast<uint16_t>(data[6]) |
-                     (static_cast<uint16_t>(data[7]) << 8);
+    header = load_header(data);
 
     if (!header.is_valid()) {
         std::cerr << "Invalid header" << std::endl;
@@ -92,80 +84,72 @@ size_t MessageSerializer::deserialize_header(const uint8_t* data,
     return FRAME_HEADER_SIZE;
 }
 
-size_t MessageSerializer::deserialize_frame(const uint8_t* data,
+DecodeStatus MessageSerializer::view_frame(const uint8_t* data,
                                            size_t length,
-                                           FrameHeader& header,
-                                           std::vector<uint8_t>& payload) noexcept
+                                           FrameView& view) noexcept
 {
-    // Deserialize header
-    size_t header_bytes = deserialize_header(data, length, header);
-    if (header_bytes == 0) {
-        return 0;
+    if (length < FRAME_HEADER_SIZE) {
+        return DecodeStatus::NEED_MORE;
     }
 
-    // Check if we have the full frame
-    size_t frame_size = calculate_frame_size(header);
-    if (length < frame_size) {
-        return 0; // Not enough data yet
+    const FrameHeader header = load_header(data);
+    if (!header.is_valid()) {
+        return DecodeStatus::CORRUPT;
     }
 
-    // Extract and validate checksum
-    const uint8_t* checksum_data = data + FRAME_HEADER_SIZE + header.payload_length;
-    uint32_t received_checksum = static_cast<uint32_t>(checksum_data[0]) |
-                                (static_cast<uint32_t>(checksum_data[1]) << 8) |
-                                (static_cast<uint32_t>(checksum_data[2]) << 16) |
-                                (static_cast<uint32_t>(checksum_data[3]) << 24);
+    const size_t frame_size = calculate_frame_size(header);
+    if (length < frame_size) {
+        return DecodeStatus::NEED_MORE;
+    }
 
-    uint32_t calculated_checksum = crc32::calculate(
-        data + FRAME_HEADER_SIZE, 
-        header.payload_length
-    );
+    // Checksum trailer (little-endian)
+    const uint8_t* payload = data + FRAME_HEADER_SIZE;
+    uint32_t received_checksum;
+    std::memcpy(&received_checksum, payload + header.payload_length, sizeof(received_checksum));
+    received_checksum = EndianUtils::from_little_endian(received_checksum);
 
-    if (received_checksum != calculated_checksum) {
-        std::cerr << "Checksum mismatch" << std::endl;
-        return 0;
+    if (received_checksum != frame_checksum(header, payload, header.payload_length)) {
+        return DecodeStatus::CORRUPT;
     }
 
-    // Extract payload
-    payload.assign(
-        data + FRAME_HEADER_SIZE,
-        data + FRAME_HEADER_SIZE + header.payload_length
-    );
-
-    return frame_size;
+    view.header = header;
+    view.payload = std::span<const uint8_t>(payload, header.payload_length);
+    return DecodeStatus::FRAME;
 }
 
-bool MessageSerializer::validate_frame(const uint8_t* frame_data,
-                                      size_t frame_size) noexcept
+size_t MessageSerializer::deserialize_frame(const uint8_t* data,
+                                           size_t length,
+                                           FrameHeader& header,
+                                           std::vector<uint8_t>& payload) noexcept
 {
-    if (frame_size < MIN_FRAME_SIZE) {
-        return false;
+    FrameView view;
+    const DecodeStatus status = view_frame(data, length, view);
+    if (status == DecodeStatus::CORRUPT) {
+        std::cerr << "Invalid frame" << std::endl;
+        return 0;
     }
-
-    FrameHeader header;
-    size_t header_size = deserialize_header(frame_data, frame_size, header);
-    if (header_size == 0) {
-        return false;
+    if (status == DecodeStatus::NEED_MORE) {
+        return 0; // Not enough data yet
     }
 
-    // Check total frame size
-    if (frame_size != calculate_frame_size(header)) {
-        return false;
+    // Extract payload
+    header = view.header;
+    try {
+        payload.assign(view.payload.begin(), view.payload.end());
+    } catch (const std::bad_alloc&) {
+        std::cerr << "Failed to allocate payload" << std::endl;
+        return 0;
     }
 
-    // Validate checksum
-    const uint8_t* checksum_data = frame_data + FRAME_HEADER_SIZE + header.payload_length;
-    uint32_t received_checksum = static_cast<uint32_t>(checksum_data[0]) |
-                                (static_cast<uint32_t>(checksum_data[1]) << 8) |
-                                (static_cast<uint32_t>(checksum_data[2]) << 16) |
-                                (static_cast<uint32_t>(checksum_data[3]) << 24);
-
-    uint32_t calculated_checksum = crc32::calculate(
-        frame_data + FRAME_HEADER_SIZE,
-        header.payload_length
-    );
+    return view.frame_size();
+}
 
-    return received_checksum == calculated_checksum;
+bool MessageSerializer::validate_frame(const uint8_t* frame_data,
+                                      size_t frame_size) noexcept
+{
+    FrameView view;
+    return view_frame(frame_data, frame_size, view) == DecodeStatus::FRAME &&
+           view.frame_size() == frame_size;
 }
 
 } // namespace protocol
@@ -0,0 +1,130 @@
+#include "OutputQueue.h"
+#include <algorithm>
+#include <cstring>
+
+namespace core {
+namespace net {
+
+bool OutputQueue::append(const uint8_t* data, size_t length) noexcept
+{
+    if (length == 0) {
+        return true;
+    }
+
+    try {
+        // Top up the tail segment first; its queued bytes never move
+        if (!m_segments.empty()) {
+            Segment& tail = m_segments.back();
+            size_t chunk = std::min(tail.room(), length);
+            if (chunk > 0) {
+                std::memcpy(tail.storage->data() + tail.end, data, chunk);
+                tail.end += chunk;
+                m_size += chunk;
+                data += chunk;
+                length -= chunk;
+            }
+        }
+
+        if (length > 0) {
+            Segment& segment = m_segments.emplace_back(std::max(length, SEGMENT_SIZE));
+            std::memcpy(segment.storage->data(), data, length);
+            segment.end = length;
+            m_size += length;
+        }
+    } catch (...) {
+        return false;
+    }
+
+    return true;
+}
+
+bool OutputQueue::append(const SharedBuffer& buffer) noexcept
+{
+    if (buffer.empty()) {
+        return true;
+    }
+
+    try {
+        m_segments.emplace_back(buffer);
+    } catch (...) {
+        return false;
+    }
+
+    m_size += buffer.size();
+    return true;
+}
+
+size_t OutputQueue::gather(IoSlice* slices, size_t max_slices, size_t isolate_shared) const noexcept
+{
+    size_t count = 0;
+    for (const Segment& segment : m_segments) {
+        if (count == max_slices) {
+            break;
+        }
+
+        size_t available = segment.end - segment.begin;
+        if (available == 0) {
+            continue;
+        }
+
+        const bool isolated = isolate_shared != 0 && !segment.storage && available >= isolate_shared;
+        if (isolated && count > 0) {
+            break;
+        }
+
+        slices[count++] = make_io_slice(segment.data() + segment.begin, available);
+        if (isolated) {
+            break;
+        }
+    }
+    return count;
+}
+
+const SharedBuffer* OutputQueue::shared_front(size_t min_length) const noexcept
+{
+    for (const Segment& segment : m_segments) {
+        if (segment.end == segment.begin) {
+            continue;  // Spent segment kept for reuse
+        }
+        if (segment.storage || segment.end - segment.begin < min_length) {
+            return nullptr;
+        }
+        return &segment.shared;
+    }
+    return nullptr;
+}
+
+void OutputQueue::consume(size_t bytes) noexcept
+{
+    bytes = std::min(bytes, m_size);
+    m_size -= bytes;
+
+    while (bytes > 0 && !m_segments.empty()) {
+        Segment& head = m_segments.front();
+        size_t available = head.end - head.begin;
+
+        if (bytes < available) {
+            head.begin += bytes;
+            return;
+        }
+
+        bytes -= available;
+
+        // Keep the last standard segment for reuse so a steady trickle doesn't hit the allocator
+        if (m_segments.size() == 1 && head.storage && head.storage->size() == SEGMENT_SIZE) {
+            head.begin = 0;
+            head.end = 0;
+            return;
+        }
+        m_segments.pop_front();
+    }
+}
+
+void OutputQueue::clear() noexcept
+{
+    m_segments.clear();
+    m_size = 0;
+}
+
+} // namespace net
+} // namespace core
@@ -0,0 +1,159 @@
+#include "RateLimiter.h"
+#include <algorithm>
+#include <chrono>
+#include <new>
+
+namespace core {
+namespace net {
+
+void TokenBucket::take(uint64_t tokens, uint64_t rate, uint64_t now_ns) noexcept
+{
+    if (rate == 0 || tokens == 0) {
+        return;
+    }
+
+    // An idle bucket's arrival time lags the clock: it starts again from now, i.e. full
+    const uint64_t cost = cost_ns(tokens, rate);
+    uint64_t tat = m_tat_ns.load(std::memory_order_relaxed);
+    while (!m_tat_ns.compare_exchange_weak(tat, std::max(tat, now_ns) + cost, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t TokenBucket::wait_ns(uint64_t rate, uint64_t now_ns) const noexcept
+{
+    if (rate == 0) {
+        return 0;
+    }
+
+    const uint64_t ready_at = m_tat_ns.load(std::memory_order_relaxed) + cost_ns(1, rate);
+    return ready_at > now_ns + BURST_NS ? ready_at - now_ns - BURST_NS : 0;
+}
+
+std::unique_ptr<RateLimiter> RateLimitRegistry::make_limiter(SOCKET socket, const PeerAddress& peer) noexcept
+{
+    try {
+        return std::make_unique<RateLimiter>(*this, socket, peer);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+std::shared_ptr<AddressBuckets> RateLimitRegistry::acquire_address(const PeerAddress& peer) noexcept
+{
+    // Port excluded: every socket from the host shares the buckets
+    std::string key;
+    try {
+        if (peer.storage.ss_family == AF_INET) {
+            const auto& address = reinterpret_cast<const sockaddr_in*>(&peer.storage)->sin_addr;
+            key.assign(reinterpret_cast<const char*>(&address), sizeof(address));
+        } else if (peer.storage.ss_family == AF_INET6) {
+            const auto& address = reinterpret_cast<const sockaddr_in6*>(&peer.storage)->sin6_addr;
+            key.assign(reinterpret_cast<const char*>(&address), sizeof(address));
+        } else {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (++m_acquisitions % SWEEP_INTERVAL == 0) {
+            for (auto it = m_addresses.begin(); it != m_addresses.end();) {
+                it = it->second.expired() ? m_addresses.erase(it) : std::next(it);
+            }
+        }
+
+        std::weak_ptr<AddressBuckets>& entry = m_addresses[key];
+        std::shared_ptr<AddressBuckets> buckets = entry.lock();
+        if (!buckets) {
+            buckets = std::make_shared<AddressBuckets>();
+            entry = buckets;
+        }
+        return buckets;
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+size_t RateLimitRegistry::get_tracked_address_count() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<size_t>(std::count_if(m_addresses.begin(), m_addresses.end(),
+                                             [](const auto& entry) { return !entry.second.expired(); }));
+}
+
+RateLimiter::RateLimiter(RateLimitRegistry& registry, SOCKET socket, const PeerAddress& peer) noexcept
+    : m_registry(registry)
+    , m_socket(socket)
+    , m_peer(peer)
+{
+}
+
+bool RateLimiter::admit(uint64_t now_ns) noexcept
+{
+    const RateLimits own = m_registry.get_connection_limits();
+    if (!m_messages.has_tokens(own.messages_per_second, now_ns) ||
+        !m_bytes.has_tokens(own.bytes_per_second, now_ns)) {
+        return false;
+    }
+
+    const RateLimits shared = m_registry.get_address_limits();
+    AddressBuckets* address = address_buckets(shared);
+    return !address || (address->messages.has_tokens(shared.messages_per_second, now_ns) &&
+                        address->bytes.has_tokens(shared.bytes_per_second, now_ns));
+}
+
+void RateLimiter::charge(size_t messages, size_t bytes, uint64_t now_ns) noexcept
+{
+    const RateLimits own = m_registry.get_connection_limits();
+    m_messages.take(messages, own.messages_per_second, now_ns);
+    m_bytes.take(bytes, own.bytes_per_second, now_ns);
+
+    const RateLimits shared = m_registry.get_address_limits();
+    if (AddressBuckets* address = address_buckets(shared)) {
+        address->messages.take(messages, shared.messages_per_second, now_ns);
+        address->bytes.take(bytes, shared.bytes_per_second, now_ns);
+    }
+}
+
+uint64_t RateLimiter::wait_ns(uint64_t now_ns) noexcept
+{
+    const RateLimits own = m_registry.get_connection_limits();
+    uint64_t wait = std::max(m_messages.wait_ns(own.messages_per_second, now_ns),
+                             m_bytes.wait_ns(own.bytes_per_second, now_ns));
+
+    const RateLimits shared = m_registry.get_address_limits();
+    if (AddressBuckets* address = address_buckets(shared)) {
+        wait = std::max({wait, address->messages.wait_ns(shared.messages_per_second, now_ns),
+                         address->bytes.wait_ns(shared.bytes_per_second, now_ns)});
+    }
+    return wait;
+}
+
+uint64_t RateLimiter::now_ns() noexcept
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+AddressBuckets* RateLimiter::address_buckets(const RateLimits& limits) noexcept
+{
+    if (limits.messages_per_second == 0 && limits.bytes_per_second == 0) {
+        return m_address.get();
+    }
+
+    // First use under address limits: one registry lookup, then the pointer is cached
+    if (!m_address_looked_up) {
+        m_address_looked_up = true;
+
+        if (m_peer.empty()) {
+            socklen_t length = sizeof(m_peer.storage);
+            if (getpeername(m_socket, reinterpret_cast<sockaddr*>(&m_peer.storage), &length) == 0) {
+                m_peer.length = length;
+            }
+        }
+        m_address = m_registry.acquire_address(m_peer);
+    }
+    return m_address.get();
+}
+
+} // namespace net
+} // namespace core
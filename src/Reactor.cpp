@@ -0,0 +1,383 @@
+#include "Reactor.h"
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+namespace core {
+namespace net {
+
+#ifdef __linux__
+
+// ============ epoll backend ============
+
+namespace {
+
+uint32_t to_epoll_events(uint32_t interest) noexcept
+{
+    uint32_t events = 0;
+    if (interest & Reactor::READABLE) {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (interest & Reactor::WRITABLE) {
+        events |= EPOLLOUT;
+    }
+    if (interest & Reactor::EDGE_TRIGGERED) {
+        events |= EPOLLET;
+    }
+    return events;
+}
+
+uint32_t from_epoll_events(uint32_t events) noexcept
+{
+    uint32_t ready = 0;
+    if (events & EPOLLIN) {
+        ready |= Reactor::READABLE;
+    }
+    if (events & EPOLLOUT) {
+        ready |= Reactor::WRITABLE;
+    }
+    if (events & (EPOLLHUP | EPOLLRDHUP)) {
+        ready |= Reactor::CLOSED;
+    }
+    if (events & EPOLLERR) {
+        ready |= Reactor::FAILED;
+    }
+    return ready;
+}
+
+} // namespace
+
+Reactor::Reactor()
+    : m_ready(64)
+{
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd < 0) {
+        std::cerr << "epoll_create1() failed: " << errno << std::endl;
+        return;
+    }
+
+    m_wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeup_fd < 0) {
+        std::cerr << "eventfd() failed: " << errno << std::endl;
+        return;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = WAKEUP_TOKEN;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wakeup_fd, &ev) < 0) {
+        std::cerr << "epoll_ctl(wakeup) failed: " << errno << std::endl;
+    }
+}
+
+Reactor::~Reactor() noexcept
+{
+    if (m_wakeup_fd >= 0) {
+        ::close(m_wakeup_fd);
+    }
+    if (m_epoll_fd >= 0) {
+        ::close(m_epoll_fd);
+    }
+}
+
+bool Reactor::is_valid() const noexcept
+{
+    return m_epoll_fd >= 0 && m_wakeup_fd >= 0;
+}
+
+bool Reactor::add(SOCKET socket, uint32_t interest, uint64_t token) noexcept
+{
+    epoll_event ev{};
+    ev.events = to_epoll_events(interest);
+    ev.data.u64 = token;
+
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, socket, &ev) < 0) {
+        std::cerr << "epoll_ctl(ADD) failed: " << errno << std::endl;
+        return false;
+    }
+
+    m_registered.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool Reactor::modify(SOCKET socket, uint32_t interest, uint64_t token) noexcept
+{
+    epoll_event ev{};
+    ev.events = to_epoll_events(interest);
+    ev.data.u64 = token;
+
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, socket, &ev) < 0) {
+        std::cerr << "epoll_ctl(MOD) failed: " << errno << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Reactor::remove(SOCKET socket) noexcept
+{
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, socket, nullptr) < 0) {
+        return false;
+    }
+
+    m_registered.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+int Reactor::wait(Event* events, size_t max_events, int timeout_ms) noexcept
+{
+    if (max_events == 0) {
+        return 0;
+    }
+
+    if (m_ready.size() < max_events) {
+        m_ready.resize(max_events);
+    }
+
+    int count = epoll_wait(m_epoll_fd, m_ready.data(), static_cast<int>(max_events), timeout_ms);
+    if (count < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    int out = 0;
+    for (int i = 0; i < count; ++i) {
+        if (m_ready[i].data.u64 == WAKEUP_TOKEN) {
+            drain_wakeup();
+            continue;
+        }
+
+        events[out].token = m_ready[i].data.u64;
+        events[out].events = from_epoll_events(m_ready[i].events);
+        ++out;
+    }
+
+    return out;
+}
+
+void Reactor::wakeup() noexcept
+{
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t written = ::write(m_wakeup_fd, &one, sizeof(one));
+}
+
+void Reactor::drain_wakeup() noexcept
+{
+    uint64_t value = 0;
+    [[maybe_unused]] ssize_t bytes = ::read(m_wakeup_fd, &value, sizeof(value));
+}
+
+#else
+
+// ============ poll / WSAPoll backend ============
+
+namespace {
+
+short to_poll_events(uint32_t interest) noexcept
+{
+    short events = 0;
+    if (interest & Reactor::READABLE) {
+        events |= POLLIN;
+    }
+    if (interest & Reactor::WRITABLE) {
+        events |= POLLOUT;
+    }
+    return events;
+}
+
+uint32_t from_poll_events(short revents) noexcept
+{
+    uint32_t ready = 0;
+    if (revents & POLLIN) {
+        ready |= Reactor::READABLE;
+    }
+    if (revents & POLLOUT) {
+        ready |= Reactor::WRITABLE;
+    }
+    if (revents & POLLHUP) {
+        ready |= Reactor::CLOSED;
+    }
+    if (revents & (POLLERR | POLLNVAL)) {
+        ready |= Reactor::FAILED;
+    }
+    return ready;
+}
+
+} // namespace
+
+Reactor::Reactor()
+{
+    // Self-connected loopback datagram socket used as a portable wakeup channel
+    m_wakeup_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (m_wakeup_socket == INVALID_SOCKET) {
+        std::cerr << "socket(wakeup) failed: " << last_socket_error() << std::endl;
+        return;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = 0;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+
+    if (bind(m_wakeup_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR ||
+        getsockname(m_wakeup_socket, reinterpret_cast<sockaddr*>(&addr), &addr_len) == SOCKET_ERROR ||
+        ::connect(m_wakeup_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR ||
+        !set_non_blocking(m_wakeup_socket)) {
+        std::cerr << "wakeup channel setup failed: " << last_socket_error() << std::endl;
+        close_socket(m_wakeup_socket);
+        m_wakeup_socket = INVALID_SOCKET;
+        return;
+    }
+
+    PollFd pfd{};
+    pfd.fd = m_wakeup_socket;
+    pfd.events = POLLIN;
+    m_poll_fds.push_back(pfd);
+    m_tokens.push_back(WAKEUP_TOKEN);
+    m_index[m_wakeup_socket] = 0;
+}
+
+Reactor::~Reactor() noexcept
+{
+    if (m_wakeup_socket != INVALID_SOCKET) {
+        close_socket(m_wakeup_socket);
+    }
+}
+
+bool Reactor::is_valid() const noexcept
+{
+    return m_wakeup_socket != INVALID_SOCKET;
+}
+
+bool Reactor::update(SOCKET socket, uint32_t interest, uint64_t token, bool is_add) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto it = m_index.find(socket);
+        if (is_add) {
+            if (it != m_index.end()) {
+                return false;
+            }
+
+            PollFd pfd{};
+            pfd.fd = socket;
+            pfd.events = to_poll_events(interest);
+            m_index[socket] = m_poll_fds.size();
+            m_poll_fds.push_back(pfd);
+            m_tokens.push_back(token);
+            m_registered.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            if (it == m_index.end()) {
+                return false;
+            }
+
+            m_poll_fds[it->second].events = to_poll_events(interest);
+            m_tokens[it->second] = token;
+        }
+    }
+
+    // A concurrent poll() only sees the new interest set on its next pass
+    if (m_in_wait.load(std::memory_order_acquire)) {
+        wakeup();
+    }
+    return true;
+}
+
+bool Reactor::add(SOCKET socket, uint32_t interest, uint64_t token) noexcept
+{
+    return update(socket, interest, token, true);
+}
+
+bool Reactor::modify(SOCKET socket, uint32_t interest, uint64_t token) noexcept
+{
+    return update(socket, interest, token, false);
+}
+
+bool Reactor::remove(SOCKET socket) noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_index.find(socket);
+    if (it == m_index.end() || socket == m_wakeup_socket) {
+        return false;
+    }
+
+    // Swap-with-last keeps the poll array dense
+    size_t slot = it->second;
+    size_t last = m_poll_fds.size() - 1;
+    if (slot != last) {
+        m_poll_fds[slot] = m_poll_fds[last];
+        m_tokens[slot] = m_tokens[last];
+        m_index[static_cast<SOCKET>(m_poll_fds[slot].fd)] = slot;
+    }
+
+    m_poll_fds.pop_back();
+    m_tokens.pop_back();
+    m_index.erase(it);
+    m_registered.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+int Reactor::wait(Event* events, size_t max_events, int timeout_ms) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_snapshot_fds = m_poll_fds;
+        m_snapshot_tokens = m_tokens;
+    }
+
+    m_in_wait.store(true, std::memory_order_release);
+#ifdef _WIN32
+    int count = WSAPoll(m_snapshot_fds.data(), static_cast<ULONG>(m_snapshot_fds.size()), timeout_ms);
+#else
+    int count = ::poll(m_snapshot_fds.data(), static_cast<nfds_t>(m_snapshot_fds.size()), timeout_ms);
+#endif
+    m_in_wait.store(false, std::memory_order_release);
+
+    if (count == SOCKET_ERROR) {
+        return -1;
+    }
+
+    int out = 0;
+    for (size_t i = 0; i < m_snapshot_fds.size() && count > 0; ++i) {
+        if (m_snapshot_fds[i].revents == 0) {
+            continue;
+        }
+        --count;
+
+        if (m_snapshot_tokens[i] == WAKEUP_TOKEN) {
+            drain_wakeup();
+            continue;
+        }
+
+        if (static_cast<size_t>(out) == max_events) {
+            break; // Remaining sockets stay ready for the next wait (level-triggered)
+        }
+
+        events[out].token = m_snapshot_tokens[i];
+        events[out].events = from_poll_events(m_snapshot_fds[i].revents);
+        ++out;
+    }
+
+    return out;
+}
+
+void Reactor::wakeup() noexcept
+{
+    char byte = 1;
+    send(m_wakeup_socket, &byte, 1, 0);
+}
+
+void Reactor::drain_wakeup() noexcept
+{
+    char buffer[64];
+    while (recv(m_wakeup_socket, buffer, sizeof(buffer), 0) > 0) {
+    }
+}
+
+#endif
+
+} // namespace net
+} // namespace core
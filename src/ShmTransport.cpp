@@ -0,0 +1,507 @@
+#include "ShmTransport.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace core {
+namespace net {
+
+// ============ ShmRing ============
+
+void ShmRing::initialize(Header* header, uint64_t capacity) noexcept
+{
+    new (header) Header;
+    header->head.store(0, std::memory_order_relaxed);
+    header->tail.store(0, std::memory_order_relaxed);
+    header->consumer_waiting.store(1, std::memory_order_relaxed);
+    header->producer_waiting.store(0, std::memory_order_relaxed);
+    header->capacity = capacity;
+}
+
+size_t ShmRing::write(const uint8_t* data, size_t length) noexcept
+{
+    const uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+    const uint64_t head = m_header->head.load(std::memory_order_acquire);   // Consumer is done with bytes before head
+
+    // Both positions live in memory the peer can write: never trust their distance
+    const uint64_t capacity = m_mask + 1;
+    if (m_corrupt || tail - head > capacity) {
+        m_corrupt = true;
+        return 0;
+    }
+
+    const size_t count = static_cast<size_t>(std::min<uint64_t>({length, capacity - (tail - head), capacity}));
+    if (count == 0) {
+        return 0;
+    }
+
+    const size_t offset = static_cast<size_t>(tail & m_mask);
+    const size_t first = std::min<size_t>(count, static_cast<size_t>(m_mask + 1) - offset);
+    std::memcpy(m_data + offset, data, first);
+    std::memcpy(m_data, data + first, count - first);
+
+    m_header->tail.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+size_t ShmRing::read(uint8_t* buffer, size_t length) noexcept
+{
+    const uint64_t head = m_header->head.load(std::memory_order_relaxed);
+    const uint64_t tail = m_header->tail.load(std::memory_order_acquire);   // Bytes before tail are published
+
+    const uint64_t capacity = m_mask + 1;
+    if (m_corrupt || tail - head > capacity) {
+        m_corrupt = true;
+        return 0;
+    }
+
+    const size_t count = static_cast<size_t>(std::min<uint64_t>({length, tail - head, capacity}));
+    if (count == 0) {
+        return 0;
+    }
+
+    const size_t offset = static_cast<size_t>(head & m_mask);
+    const size_t first = std::min<size_t>(count, static_cast<size_t>(m_mask + 1) - offset);
+    std::memcpy(buffer, m_data + offset, first);
+    std::memcpy(buffer + first, m_data, count - first);
+
+    m_header->head.store(head + count, std::memory_order_release);
+    return count;
+}
+
+// Each side stores its flag (or position), fences, then loads the other's: at least one of
+// them sees the other, so a sleeper is never left without a doorbell.
+
+bool ShmRing::prepare_consumer_wait() noexcept
+{
+    m_header->consumer_waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_header->tail.load(std::memory_order_relaxed) != m_header->head.load(std::memory_order_relaxed)) {
+        m_header->consumer_waiting.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool ShmRing::prepare_producer_wait() noexcept
+{
+    m_header->producer_waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (writable() != 0) {
+        m_header->producer_waiting.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool ShmRing::take_consumer_wakeup() noexcept
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // Plain load first: a busy consumer costs the producer no write to the shared line
+    return m_header->consumer_waiting.load(std::memory_order_relaxed) != 0 &&
+           m_header->consumer_waiting.exchange(0, std::memory_order_relaxed) != 0;
+}
+
+bool ShmRing::take_producer_wakeup() noexcept
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    return m_header->producer_waiting.load(std::memory_order_relaxed) != 0 &&
+           m_header->producer_waiting.exchange(0, std::memory_order_relaxed) != 0;
+}
+
+// ============ ShmChannel ============
+
+namespace {
+
+// Ring headers share the first page; the data areas follow, client-to-server first
+constexpr size_t HEADERS_BYTES = 4096;
+static_assert(2 * sizeof(ShmRing::Header) <= HEADERS_BYTES, "ring headers must fit the first page");
+
+constexpr size_t MAX_RING_BYTES = size_t{1} << 30;
+constexpr uint32_t HANDSHAKE_MAGIC = 0x53484D52;   // "SHMR"
+constexpr uint32_t HANDSHAKE_VERSION = 1;
+
+/**
+ * @brief Sent alongside the descriptors (memfd, client doorbell, server doorbell)
+ */
+struct Handshake {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t region_bytes;
+    uint64_t ring_bytes;
+};
+
+enum Direction : size_t {
+    CLIENT_TO_SERVER = 0,
+    SERVER_TO_CLIENT = 1
+};
+
+ShmRing::Header* ring_header(void* region, Direction direction) noexcept
+{
+    return reinterpret_cast<ShmRing::Header*>(static_cast<uint8_t*>(region) + direction * sizeof(ShmRing::Header));
+}
+
+inline void cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // namespace
+
+ShmChannel::~ShmChannel() noexcept
+{
+#ifdef __linux__
+    if (m_region) {
+        ::munmap(m_region, m_region_bytes);
+    }
+    for (int fd : {m_memfd, m_own_doorbell, m_peer_doorbell}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+#endif
+}
+
+std::unique_ptr<ShmChannel> ShmChannel::create(size_t ring_bytes) noexcept
+{
+#ifdef __linux__
+    if (ring_bytes > MAX_RING_BYTES) {
+        std::cerr << "Shared-memory ring too large: " << ring_bytes << std::endl;
+        return nullptr;
+    }
+
+    size_t capacity = MIN_RING_BYTES;
+    while (capacity < ring_bytes) {
+        capacity <<= 1;
+    }
+    const size_t region_bytes = HEADERS_BYTES + 2 * capacity;
+
+    std::unique_ptr<ShmChannel> channel(new (std::nothrow) ShmChannel());
+    if (!channel) {
+        return nullptr;
+    }
+
+    channel->m_memfd = memfd_create("hpams-shm", MFD_CLOEXEC);
+    if (channel->m_memfd < 0) {
+        std::cerr << "memfd_create() failed: " << errno << std::endl;
+        return nullptr;
+    }
+
+    if (ftruncate(channel->m_memfd, static_cast<off_t>(region_bytes)) != 0) {
+        std::cerr << "ftruncate() failed: " << errno << std::endl;
+        return nullptr;
+    }
+
+    channel->m_own_doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    channel->m_peer_doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (channel->m_own_doorbell < 0 || channel->m_peer_doorbell < 0) {
+        std::cerr << "eventfd() failed: " << errno << std::endl;
+        return nullptr;
+    }
+
+    if (!channel->map_region(channel->m_memfd, region_bytes)) {
+        return nullptr;
+    }
+
+    ShmRing::initialize(ring_header(channel->m_region, CLIENT_TO_SERVER), capacity);
+    ShmRing::initialize(ring_header(channel->m_region, SERVER_TO_CLIENT), capacity);
+    channel->attach_rings(true);
+    return channel;
+#else
+    (void)ring_bytes;
+    std::cerr << "Shared-memory transport not supported on this platform" << std::endl;
+    return nullptr;
+#endif
+}
+
+bool ShmChannel::send_handshake(SOCKET control) noexcept
+{
+#ifdef __linux__
+    if (m_memfd < 0) {
+        return false;
+    }
+
+    Handshake hello{HANDSHAKE_MAGIC, HANDSHAKE_VERSION, m_region_bytes, ring_capacity()};
+    iovec payload = make_io_slice(&hello, sizeof(hello));
+
+    // The client waits on our peer doorbell and rings our own
+    const int fds[3] = {m_memfd, m_peer_doorbell, m_own_doorbell};
+    alignas(cmsghdr) char control_buffer[CMSG_SPACE(sizeof(fds))] = {};
+
+    msghdr message{};
+    message.msg_iov = &payload;
+    message.msg_iovlen = 1;
+    message.msg_control = control_buffer;
+    message.msg_controllen = sizeof(control_buffer);
+
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    if (sendmsg(control, &message, SEND_NO_SIGNAL) != static_cast<ssize_t>(sizeof(hello))) {
+        std::cerr << "Shared-memory handshake failed: " << last_socket_error() << std::endl;
+        return false;
+    }
+
+    // The client holds its own reference to the region now
+    ::close(m_memfd);
+    m_memfd = -1;
+    return true;
+#else
+    (void)control;
+    return false;
+#endif
+}
+
+std::unique_ptr<ShmChannel> ShmChannel::connect(const std::string& path, int timeout_ms) noexcept
+{
+#ifdef __linux__
+    auto control = std::make_unique<AsyncSocket>(path, 0);
+    if (!control->connect_unix(path)) {
+        return nullptr;
+    }
+
+    pollfd ready{control->get_socket(), POLLIN, 0};
+    if (::poll(&ready, 1, timeout_ms) <= 0) {
+        std::cerr << "Shared-memory handshake timed out" << std::endl;
+        return nullptr;
+    }
+
+    Handshake hello{};
+    iovec payload = make_io_slice(&hello, sizeof(hello));
+    int fds[3] = {-1, -1, -1};
+    alignas(cmsghdr) char control_buffer[CMSG_SPACE(sizeof(fds))] = {};
+
+    msghdr message{};
+    message.msg_iov = &payload;
+    message.msg_iovlen = 1;
+    message.msg_control = control_buffer;
+    message.msg_controllen = sizeof(control_buffer);
+
+    const ssize_t received = recvmsg(control->get_socket(), &message, MSG_CMSG_CLOEXEC);
+
+    size_t fd_count = 0;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            fd_count = std::min<size_t>((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int), 3);
+            std::memcpy(fds, CMSG_DATA(cmsg), fd_count * sizeof(int));
+        }
+    }
+
+    std::unique_ptr<ShmChannel> channel(new (std::nothrow) ShmChannel());
+    if (!channel) {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        return nullptr;
+    }
+
+    // Owned by the channel from here on, so every failure below cleans up
+    channel->m_memfd = fds[0];
+    channel->m_own_doorbell = fds[1];
+    channel->m_peer_doorbell = fds[2];
+
+    const size_t ring_bytes = static_cast<size_t>(hello.ring_bytes);
+    const bool valid = received == static_cast<ssize_t>(sizeof(hello)) && fd_count == 3 &&
+                       hello.magic == HANDSHAKE_MAGIC && hello.version == HANDSHAKE_VERSION &&
+                       ring_bytes >= MIN_RING_BYTES && ring_bytes <= MAX_RING_BYTES &&
+                       (ring_bytes & (ring_bytes - 1)) == 0 &&
+                       hello.region_bytes == HEADERS_BYTES + 2 * ring_bytes;
+    if (!valid) {
+        std::cerr << "Invalid shared-memory handshake" << std::endl;
+        return nullptr;
+    }
+
+    // Mapping past the end of the file would fault on first touch
+    struct stat info{};
+    if (fstat(channel->m_memfd, &info) != 0 || static_cast<uint64_t>(info.st_size) < hello.region_bytes) {
+        std::cerr << "Shared-memory region smaller than announced" << std::endl;
+        return nullptr;
+    }
+
+    if (!channel->map_region(channel->m_memfd, static_cast<size_t>(hello.region_bytes))) {
+        return nullptr;
+    }
+    ::close(channel->m_memfd);
+    channel->m_memfd = -1;
+
+    if (ring_header(channel->m_region, CLIENT_TO_SERVER)->capacity != ring_bytes ||
+        ring_header(channel->m_region, SERVER_TO_CLIENT)->capacity != ring_bytes) {
+        std::cerr << "Shared-memory ring size mismatch" << std::endl;
+        return nullptr;
+    }
+
+    channel->attach_rings(false);
+    channel->m_control = std::move(control);
+    return channel;
+#else
+    (void)path;
+    (void)timeout_ms;
+    std::cerr << "Shared-memory transport not supported on this platform" << std::endl;
+    return nullptr;
+#endif
+}
+
+bool ShmChannel::map_region(int memfd, size_t region_bytes) noexcept
+{
+#ifdef __linux__
+    void* region = ::mmap(nullptr, region_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (region == MAP_FAILED) {
+        std::cerr << "mmap() failed: " << errno << std::endl;
+        return false;
+    }
+
+    m_region = region;
+    m_region_bytes = region_bytes;
+    return true;
+#else
+    (void)memfd;
+    (void)region_bytes;
+    return false;
+#endif
+}
+
+void ShmChannel::attach_rings(bool is_server) noexcept
+{
+    const size_t ring_bytes = static_cast<size_t>(ring_header(m_region, CLIENT_TO_SERVER)->capacity);
+    uint8_t* data = static_cast<uint8_t*>(m_region) + HEADERS_BYTES;
+
+    ShmRing to_server(ring_header(m_region, CLIENT_TO_SERVER), data);
+    ShmRing to_client(ring_header(m_region, SERVER_TO_CLIENT), data + ring_bytes);
+
+    m_rx = is_server ? to_server : to_client;
+    m_tx = is_server ? to_client : to_server;
+}
+
+size_t ShmChannel::write(const uint8_t* data, size_t length) noexcept
+{
+    const size_t written = m_tx.write(data, length);
+    if (written != 0 && m_tx.take_consumer_wakeup()) {
+        ring_peer();
+    }
+    return written;
+}
+
+size_t ShmChannel::write(const IoSlice* slices, size_t count) noexcept
+{
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t length = io_slice_length(slices[i]);
+        const size_t written = m_tx.write(io_slice_data(slices[i]), length);
+        total += written;
+        if (written < length) {
+            break;
+        }
+    }
+
+    if (total != 0 && m_tx.take_consumer_wakeup()) {
+        ring_peer();
+    }
+    return total;
+}
+
+size_t ShmChannel::read(uint8_t* buffer, size_t length) noexcept
+{
+    const size_t received = m_rx.read(buffer, length);
+    if (received != 0 && m_rx.take_producer_wakeup()) {
+        ring_peer();
+    }
+    return received;
+}
+
+void ShmChannel::drain_doorbell() noexcept
+{
+#ifdef __linux__
+    uint64_t value = 0;
+    [[maybe_unused]] ssize_t bytes = ::read(m_own_doorbell, &value, sizeof(value));
+#endif
+}
+
+void ShmChannel::ring_peer() noexcept
+{
+#ifdef __linux__
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t written = ::write(m_peer_doorbell, &one, sizeof(one));
+#endif
+}
+
+bool ShmChannel::wait_readable(int timeout_ms) noexcept
+{
+    return wait_for(true, timeout_ms);
+}
+
+bool ShmChannel::wait_writable(int timeout_ms) noexcept
+{
+    return wait_for(false, timeout_ms);
+}
+
+bool ShmChannel::wait_for(bool for_read, int timeout_ms) noexcept
+{
+    auto is_ready = [this, for_read]() { return for_read ? m_rx.readable() != 0 : m_tx.writable() != 0; };
+
+    for (size_t i = 0; i < SPIN_ITERATIONS; ++i) {
+        if (is_ready()) {
+            return true;
+        }
+        cpu_relax();
+    }
+
+#ifdef __linux__
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    for (;;) {
+        const bool armed = for_read ? m_rx.prepare_consumer_wait() : m_tx.prepare_producer_wait();
+        if (!armed) {
+            return true;
+        }
+
+        int wait_ms = -1;
+        if (timeout_ms >= 0) {
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            wait_ms = static_cast<int>(std::max<int64_t>(remaining, 0));
+        }
+
+        // The control socket only becomes readable when the peer goes away
+        pollfd fds[2] = {{m_own_doorbell, POLLIN, 0}, {control_socket(), POLLIN, 0}};
+        const int count = ::poll(fds, m_control ? 2 : 1, wait_ms);
+        if (count > 0 && (fds[0].revents & POLLIN)) {
+            drain_doorbell();
+        }
+
+        if (is_ready()) {
+            return true;
+        }
+        if (count == 0 || (m_control && fds[1].revents != 0)) {
+            return false;
+        }
+    }
+#else
+    (void)timeout_ms;
+    return false;
+#endif
+}
+
+} // namespace net
+} // namespace core
@@ -0,0 +1,72 @@
+#include "SocketOptions.h"
+#include <iostream>
+
+namespace core {
+namespace net {
+
+namespace {
+
+bool set_int_option(SOCKET socket, int level, int option, int value, const char* name) noexcept
+{
+    if (setsockopt(socket, level, option, reinterpret_cast<const char*>(&value), sizeof(value)) == SOCKET_ERROR) {
+        std::cerr << "setsockopt(" << name << ") failed: " << last_socket_error() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+SocketOptions SocketOptions::for_profile(SocketProfile profile) noexcept
+{
+    SocketOptions options;
+    switch (profile) {
+        case SocketProfile::DEFAULT:
+            break;
+        case SocketProfile::LATENCY:
+            options.no_delay = true;
+            options.busy_poll_us = LATENCY_BUSY_POLL_US;
+            break;
+        case SocketProfile::THROUGHPUT:
+            options.cork_flushes = cork_supported();
+            options.send_buffer_bytes = THROUGHPUT_BUFFER_BYTES;
+            options.receive_buffer_bytes = THROUGHPUT_BUFFER_BYTES;
+            break;
+    }
+    return options;
+}
+
+bool apply_socket_options(SOCKET socket, const SocketOptions& options, bool is_tcp) noexcept
+{
+    bool applied = true;
+
+    // Fixed sizes switch off the kernel's autotuning for this socket
+    if (options.send_buffer_bytes > 0) {
+        applied &= set_int_option(socket, SOL_SOCKET, SO_SNDBUF, options.send_buffer_bytes, "SO_SNDBUF");
+    }
+    if (options.receive_buffer_bytes > 0) {
+        applied &= set_int_option(socket, SOL_SOCKET, SO_RCVBUF, options.receive_buffer_bytes, "SO_RCVBUF");
+    }
+
+    if (!is_tcp) {
+        return applied;
+    }
+
+    if (options.no_delay) {
+        applied &= set_int_option(socket, IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY");
+    }
+
+    if (options.busy_poll_us > 0) {
+#if defined(SO_BUSY_POLL)
+        applied &= set_int_option(socket, SOL_SOCKET, SO_BUSY_POLL, options.busy_poll_us, "SO_BUSY_POLL");
+#else
+        std::cerr << "SO_BUSY_POLL not supported on this platform" << std::endl;
+        applied = false;
+#endif
+    }
+
+    return applied;
+}
+
+} // namespace net
+} // namespace core
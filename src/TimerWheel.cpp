@@ -0,0 +1,281 @@
+#include "TimerWheel.h"
+#include <algorithm>
+#include <climits>
+
+namespace core {
+namespace net {
+
+namespace {
+
+constexpr uint64_t SLOT_MASK = TimerWheel::SLOTS - 1;
+
+// Ticks covered by levels [0, level]
+constexpr uint64_t level_span(size_t level) noexcept
+{
+    return uint64_t{1} << (TimerWheel::SLOT_BITS * (level + 1));
+}
+
+} // namespace
+
+TimerWheel::TimerWheel(uint64_t now_ms, uint32_t tick_ms)
+    : m_tick_ms(std::max<uint32_t>(tick_ms, 1))
+    , m_current_tick(now_ms / m_tick_ms)
+{
+    m_slots.fill(NIL);
+    m_level_count.fill(0);
+}
+
+uint64_t TimerWheel::to_tick(uint64_t deadline_ms) const noexcept
+{
+    // Round up so a timer never fires before its deadline
+    return deadline_ms / m_tick_ms + (deadline_ms % m_tick_ms != 0 ? 1 : 0);
+}
+
+TimerWheel::Node* TimerWheel::lookup(TimerId id) noexcept
+{
+    const uint64_t index = id & 0xFFFFFFFFu;
+    const uint32_t generation = static_cast<uint32_t>(id >> 32);
+
+    if (index >= m_nodes.size()) {
+        return nullptr;
+    }
+
+    Node& node = m_nodes[index];
+    if (node.generation != generation || node.slot == NIL) {
+        return nullptr;
+    }
+    return &node;
+}
+
+TimerWheel::TimerId TimerWheel::schedule(uint64_t deadline_ms, uint64_t token, uint32_t tag) noexcept
+{
+    uint32_t index;
+    try {
+        if (!m_free.empty()) {
+            index = m_free.back();
+            m_free.pop_back();
+        } else {
+            if (m_nodes.size() >= NIL) {
+                return INVALID_TIMER;
+            }
+            index = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.emplace_back();
+
+            // Every node may end up on the free list; release() must not allocate
+            m_free.reserve(m_nodes.capacity());
+        }
+    } catch (...) {
+        return INVALID_TIMER;
+    }
+
+    Node& node = m_nodes[index];
+    node.deadline_tick = std::max(to_tick(deadline_ms), m_current_tick + 1);
+    node.token = token;
+    node.tag = tag;
+    link(index);
+    ++m_size;
+
+    return (static_cast<uint64_t>(node.generation) << 32) | index;
+}
+
+bool TimerWheel::reschedule(TimerId id, uint64_t deadline_ms) noexcept
+{
+    Node* node = lookup(id);
+    if (!node) {
+        return false;
+    }
+
+    const uint64_t deadline_tick = std::max(to_tick(deadline_ms), m_current_tick + 1);
+
+    // Later: leave it where it is and re-file it when that slot comes up
+    if (deadline_tick >= node->deadline_tick) {
+        node->deadline_tick = deadline_tick;
+        return true;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+    unlink(index);
+    node->deadline_tick = deadline_tick;
+    link(index);
+    return true;
+}
+
+bool TimerWheel::cancel(TimerId id) noexcept
+{
+    if (!lookup(id)) {
+        return false;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+    unlink(index);
+    release(index);
+    return true;
+}
+
+void TimerWheel::link(uint32_t index) noexcept
+{
+    Node& node = m_nodes[index];
+
+    // Cascades may file a timer into the slot being expired right now
+    const uint64_t expires = std::max(node.deadline_tick, m_current_tick);
+    uint64_t delta = expires - m_current_tick;
+
+    size_t level = 0;
+    while (level + 1 < LEVELS && delta >= level_span(level)) {
+        ++level;
+    }
+
+    // Beyond the top level: park at the far edge and re-file when it cascades down
+    uint64_t position = expires;
+    if (delta >= level_span(LEVELS - 1)) {
+        position = m_current_tick + level_span(LEVELS - 1) - 1;
+    }
+
+    const uint32_t slot = static_cast<uint32_t>(level * SLOTS + ((position >> (SLOT_BITS * level)) & SLOT_MASK));
+
+    node.slot = slot;
+    ++m_level_count[level];
+    node.prev = NIL;
+    node.next = m_slots[slot];
+    if (node.next != NIL) {
+        m_nodes[node.next].prev = index;
+    }
+    m_slots[slot] = index;
+}
+
+void TimerWheel::unlink(uint32_t index) noexcept
+{
+    Node& node = m_nodes[index];
+
+    if (node.prev != NIL) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_slots[node.slot] = node.next;
+    }
+    if (node.next != NIL) {
+        m_nodes[node.next].prev = node.prev;
+    }
+    --m_level_count[node.slot / SLOTS];
+
+    node.prev = NIL;
+    node.next = NIL;
+    node.slot = NIL;
+}
+
+void TimerWheel::release(uint32_t index) noexcept
+{
+    Node& node = m_nodes[index];
+    if (++node.generation == 0) {
+        node.generation = 1;
+    }
+    --m_size;
+
+    // Capacity reserved by schedule()
+    m_free.push_back(index);
+}
+
+void TimerWheel::cascade(size_t level) noexcept
+{
+    const size_t slot = level * SLOTS + ((m_current_tick >> (SLOT_BITS * level)) & SLOT_MASK);
+
+    uint32_t index = m_slots[slot];
+    m_slots[slot] = NIL;
+
+    while (index != NIL) {
+        const uint32_t next = m_nodes[index].next;
+        --m_level_count[level];
+        link(index);
+        index = next;
+    }
+}
+
+uint64_t TimerWheel::next_event_tick() const noexcept
+{
+    for (size_t level = 0; level < LEVELS; ++level) {
+        const size_t shift = SLOT_BITS * level;
+        const uint64_t position = m_current_tick >> shift;
+        const size_t index = position & SLOT_MASK;
+
+        // Occupied slots ahead in this level's rotation come before anything coarser
+        for (size_t i = 1; index + i < SLOTS; ++i) {
+            if (m_slots[level * SLOTS + index + i] != NIL) {
+                return (position + i) << shift;
+            }
+        }
+
+        // The rest of this level lies past its wrap, where the next level cascades anyway
+        if (m_level_count[level] != 0) {
+            return ((position >> SLOT_BITS) + 1) << (shift + SLOT_BITS);
+        }
+    }
+    return UINT64_MAX;
+}
+
+size_t TimerWheel::advance(uint64_t now_ms, const ExpiryHandler& on_expired) noexcept
+{
+    const uint64_t target = now_ms / m_tick_ms;
+    size_t fired = 0;
+
+    while (m_current_tick < target) {
+        // Jump straight over ticks where no slot fires or cascades
+        const uint64_t next = m_size != 0 ? next_event_tick() : UINT64_MAX;
+        if (next > target) {
+            m_current_tick = target;
+            break;
+        }
+        m_current_tick = next;
+
+        // Level 0 wrapped: pull the next stretch of each coarser level down
+        if ((m_current_tick & SLOT_MASK) == 0) {
+            for (size_t level = 1; level < LEVELS; ++level) {
+                cascade(level);
+                if (((m_current_tick >> (SLOT_BITS * level)) & SLOT_MASK) != 0) {
+                    break;
+                }
+            }
+        }
+
+        const size_t slot = m_current_tick & SLOT_MASK;
+        while (m_slots[slot] != NIL) {
+            const uint32_t index = m_slots[slot];
+            unlink(index);
+
+            Node& node = m_nodes[index];
+            if (node.deadline_tick > m_current_tick) {
+                link(index);  // Pushed back since it was filed
+                continue;
+            }
+
+            const Expiry expiry{(static_cast<uint64_t>(node.generation) << 32) | index, node.token, node.tag};
+            release(index);
+            ++fired;
+
+            if (on_expired) {
+                on_expired(expiry);
+            }
+        }
+    }
+
+    return fired;
+}
+
+int TimerWheel::next_timeout_ms(uint64_t now_ms) const noexcept
+{
+    if (m_size == 0) {
+        return -1;
+    }
+
+    const uint64_t next = next_event_tick();
+    if (next > UINT64_MAX / m_tick_ms) {
+        return INT_MAX;
+    }
+
+    const uint64_t due_ms = next * m_tick_ms;
+    if (due_ms <= now_ms) {
+        return 0;
+    }
+    return static_cast<int>(std::min<uint64_t>(due_ms - now_ms, INT_MAX));
+}
+
+} // namespace net
+} // namespace core
@@ -0,0 +1,321 @@
+#include "UdpListener.h"
+#include "MessageSerializer.h"
+#include <cstring>
+#include <iostream>
+
+namespace core {
+namespace net {
+
+UdpListener::UdpListener(protocol::HandlerRegistry& registry, size_t max_datagram_bytes)
+    : m_registry(registry)
+    , m_max_datagram_bytes(max_datagram_bytes)
+    , m_rx_buffer(BATCH_SIZE * max_datagram_bytes)
+    , m_rx_from(BATCH_SIZE)
+    , m_rx_length(BATCH_SIZE)
+    , m_tx_buffer(BATCH_SIZE * max_datagram_bytes)
+    , m_reply(max_datagram_bytes)
+{
+    m_tx_to.reserve(BATCH_SIZE);
+    m_tx_length.reserve(BATCH_SIZE);
+
+#ifdef __linux__
+    // Receive headers never change: slot i always lands in the same buffer and address
+    m_rx_headers.resize(BATCH_SIZE);
+    m_rx_slices.resize(BATCH_SIZE);
+    for (size_t i = 0; i < BATCH_SIZE; ++i) {
+        m_rx_slices[i] = make_io_slice(m_rx_buffer.data() + i * m_max_datagram_bytes, m_max_datagram_bytes);
+        msghdr& header = m_rx_headers[i].msg_hdr;
+        header.msg_name = &m_rx_from[i].storage;
+        header.msg_iov = &m_rx_slices[i];
+        header.msg_iovlen = 1;
+    }
+
+    m_tx_headers.resize(BATCH_SIZE);
+    m_tx_slices.resize(BATCH_SIZE);
+#endif
+}
+
+UdpListener::~UdpListener() noexcept
+{
+    stop();
+
+    if (m_socket != INVALID_SOCKET) {
+        m_reactor.remove(m_socket);
+        close_socket(m_socket);
+    }
+}
+
+bool UdpListener::start(const std::string& listen_address, uint16_t port) noexcept
+{
+    if (m_socket != INVALID_SOCKET) {
+        std::cerr << "UdpListener already started" << std::endl;
+        return false;
+    }
+
+    if (!m_reactor.is_valid()) {
+        std::cerr << "Failed to create reactor" << std::endl;
+        return false;
+    }
+
+    m_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (m_socket == INVALID_SOCKET) {
+        std::cerr << "socket(UDP) failed: " << last_socket_error() << std::endl;
+        return false;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = inet_addr(listen_address.c_str());
+
+    if (address.sin_addr.s_addr == INADDR_NONE ||
+        !set_non_blocking(m_socket) ||
+        bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+        !m_reactor.add(m_socket, Reactor::READABLE, 0)) {
+        std::cerr << "UDP bind to " << listen_address << ":" << port << " failed: "
+                  << last_socket_error() << std::endl;
+        close_socket(m_socket);
+        m_socket = INVALID_SOCKET;
+        return false;
+    }
+
+    m_is_running.store(true, std::memory_order_release);
+    return true;
+}
+
+void UdpListener::stop() noexcept
+{
+    if (m_is_running.exchange(false, std::memory_order_acq_rel)) {
+        m_reactor.wakeup();
+    }
+}
+
+void UdpListener::run(int timeout_ms) noexcept
+{
+    Reactor::Event event{};
+
+    while (m_is_running.load(std::memory_order_acquire)) {
+        int count = m_reactor.wait(&event, 1, timeout_ms);
+        if (count < 0) {
+            std::cerr << "UDP wait failed: " << last_socket_error() << std::endl;
+            break;
+        }
+
+        if (count > 0) {
+            process_incoming();
+            flush_sends();
+        }
+    }
+}
+
+size_t UdpListener::process_incoming() noexcept
+{
+    size_t handled = 0;
+
+    for (size_t batch = 0; batch < MAX_BATCHES_PER_WAKEUP; ++batch) {
+        const size_t count = receive_batch();
+        for (size_t i = 0; i < count; ++i) {
+            if (handle_datagram(m_rx_buffer.data() + i * m_max_datagram_bytes, m_rx_length[i], m_rx_from[i])) {
+                ++handled;
+            }
+        }
+
+        // A short batch means the socket is drained
+        if (count < BATCH_SIZE) {
+            break;
+        }
+    }
+
+    return handled;
+}
+
+size_t UdpListener::receive_batch() noexcept
+{
+    size_t count = 0;
+
+#ifdef __linux__
+    for (auto& message : m_rx_headers) {
+        message.msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+
+    int received = recvmmsg(m_socket, m_rx_headers.data(), BATCH_SIZE, MSG_DONTWAIT, nullptr);
+    m_receive_calls.fetch_add(1, std::memory_order_relaxed);
+    if (received < 0) {
+        if (!is_would_block(errno) && errno != EINTR) {
+            std::cerr << "recvmmsg() failed: " << errno << std::endl;
+        }
+        return 0;
+    }
+
+    count = static_cast<size_t>(received);
+    for (size_t i = 0; i < count; ++i) {
+        const msghdr& header = m_rx_headers[i].msg_hdr;
+        m_rx_from[i].length = header.msg_namelen;
+
+        // A cut-off datagram can't match its frame length; make sure it never does
+        m_rx_length[i] = (header.msg_flags & MSG_TRUNC) ? m_max_datagram_bytes + 1 : m_rx_headers[i].msg_len;
+    }
+#else
+    // One syscall per datagram off Linux
+    for (; count < BATCH_SIZE; ++count) {
+        PeerAddress& from = m_rx_from[count];
+        socklen_t from_length = sizeof(from.storage);
+        int received = recvfrom(m_socket, reinterpret_cast<char*>(m_rx_buffer.data() + count * m_max_datagram_bytes),
+                                static_cast<int>(m_max_datagram_bytes), 0,
+                                reinterpret_cast<sockaddr*>(&from.storage), &from_length);
+        m_receive_calls.fetch_add(1, std::memory_order_relaxed);
+        if (received == SOCKET_ERROR) {
+#ifdef _WIN32
+            if (last_socket_error() == WSAEMSGSIZE) {
+                from.length = from_length;
+                m_rx_length[count] = m_max_datagram_bytes + 1;
+                continue;
+            }
+#endif
+            break;
+        }
+
+        from.length = from_length;
+        m_rx_length[count] = static_cast<size_t>(received);
+    }
+#endif
+
+    m_received.fetch_add(count, std::memory_order_relaxed);
+    return count;
+}
+
+bool UdpListener::handle_datagram(const uint8_t* data, size_t length, const PeerAddress& from) noexcept
+{
+    // Cheap rejects first: stray traffic shouldn't reach the serializer's error logging
+    if (length < protocol::MIN_FRAME_SIZE || length > m_max_datagram_bytes ||
+        data[0] != protocol::PROTOCOL_MAGIC || data[1] != protocol::PROTOCOL_VERSION ||
+        !protocol::MessageSerializer::validate_frame(data, length)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    protocol::FrameHeader header{};
+    protocol::MessageSerializer::deserialize_header(data, length, header);
+    const uint8_t* payload = data + protocol::FRAME_HEADER_SIZE;
+    const auto type = static_cast<protocol::MessageType>(header.message_type);
+
+    bool answered = false;
+    if (type == protocol::MessageType::PING) {
+        answered = queue_pong(from, payload, header.payload_length);
+    }
+
+    // get_handler() rather than dispatch(): unhandled telemetry is routine, not worth a log line
+    protocol::IMessageHandler* handler = m_registry.get_handler(type);
+    const bool handled = handler && handler->handle(payload, header.payload_length);
+
+    if (handled || answered) {
+        m_dispatched.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool UdpListener::queue_pong(const PeerAddress& to, const uint8_t* payload, uint16_t payload_length) noexcept
+{
+    protocol::FrameHeader header{protocol::PROTOCOL_MAGIC, protocol::PROTOCOL_VERSION,
+                                 static_cast<uint8_t>(protocol::MessageType::PONG), 0, payload_length, 0};
+
+    m_reply.reset();
+    if (!protocol::MessageSerializer::serialize_frame(header, payload, payload_length, m_reply)) {
+        return false;
+    }
+    return queue_send(to, m_reply.data(), m_reply.write_pos());
+}
+
+bool UdpListener::queue_send(const PeerAddress& to, const uint8_t* data, size_t length) noexcept
+{
+    if (length > m_max_datagram_bytes) {
+        return false;
+    }
+
+    if (m_tx_length.size() == BATCH_SIZE) {
+        flush_sends();
+    }
+
+    std::memcpy(m_tx_buffer.data() + m_tx_used, data, length);
+    m_tx_used += length;
+    m_tx_to.push_back(to);
+    m_tx_length.push_back(length);
+    return true;
+}
+
+size_t UdpListener::flush_sends() noexcept
+{
+    const size_t count = m_tx_length.size();
+    if (count == 0) {
+        return 0;
+    }
+
+    size_t sent = 0;
+
+#ifdef __linux__
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        m_tx_slices[i] = make_io_slice(m_tx_buffer.data() + offset, m_tx_length[i]);
+        msghdr& header = m_tx_headers[i].msg_hdr;
+        header.msg_name = &m_tx_to[i].storage;
+        header.msg_namelen = m_tx_to[i].length;
+        header.msg_iov = &m_tx_slices[i];
+        header.msg_iovlen = 1;
+        offset += m_tx_length[i];
+    }
+
+    // sendmmsg stops at the first datagram that fails; skip it and carry on with the rest
+    size_t next = 0;
+    while (next < count) {
+        int result = sendmmsg(m_socket, m_tx_headers.data() + next, static_cast<unsigned int>(count - next),
+                              MSG_DONTWAIT | SEND_NO_SIGNAL);
+        if (result > 0) {
+            sent += static_cast<size_t>(result);
+            next += static_cast<size_t>(result);
+        } else if (result < 0 && errno == EINTR) {
+            continue;
+        } else if (result < 0 && is_would_block(errno)) {
+            break;  // Socket buffer full: the rest are lost, as on a congested link
+        } else {
+            ++next;
+        }
+    }
+#else
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const PeerAddress& to = m_tx_to[i];
+        if (sendto(m_socket, reinterpret_cast<const char*>(m_tx_buffer.data() + offset),
+                   static_cast<int>(m_tx_length[i]), 0,
+                   reinterpret_cast<const sockaddr*>(&to.storage), to.length) != SOCKET_ERROR) {
+            ++sent;
+        }
+        offset += m_tx_length[i];
+    }
+#endif
+
+    m_sent.fetch_add(sent, std::memory_order_relaxed);
+    m_send_dropped.fetch_add(count - sent, std::memory_order_relaxed);
+
+    m_tx_to.clear();
+    m_tx_length.clear();
+    m_tx_used = 0;
+    return sent;
+}
+
+uint16_t UdpListener::get_local_port() const noexcept
+{
+    PeerAddress local;
+    socklen_t local_length = sizeof(local.storage);
+    if (getsockname(m_socket, reinterpret_cast<sockaddr*>(&local.storage), &local_length) == SOCKET_ERROR) {
+        return 0;
+    }
+
+    local.length = local_length;
+    return local.port();
+}
+
+} // namespace net
+} // namespace core
@@ -18,8 +18,94 @@
 #include <thread>
 #include <chrono>
 #include <iomanip>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <string>
 
-int main() {
+namespace {
+
+std::atomic<bool> g_stop_requested{false};
+
+void request_stop(int) {
+    g_stop_requested = true;
+}
+
+// Match "--name=value"; value receives the part after '='
+bool match_option(const std::string& arg, const std::string& name, std::string& value) {
+    const std::string prefix = "--" + name + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    value = arg.substr(prefix.size());
+    return true;
+}
+
+/**
+ * @brief Run the echo server until SIGINT/SIGTERM (target for LoadGenerator)
+ */
+int serve(int argc, char* argv[]) {
+    using namespace core::net;
+
+    ServerConfig config;
+    config.num_reactor_threads = 0;     // One per core
+    config.max_connections = 100000;
+    config.trace_echo = false;
+    std::string address = "0.0.0.0";
+    uint16_t port = 5000;
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        std::string value;
+        if (match_option(arg, "address", value)) {
+            address = value;
+        } else if (match_option(arg, "port", value)) {
+            port = static_cast<uint16_t>(std::stoul(value));
+        } else if (match_option(arg, "reactors", value)) {
+            config.num_reactor_threads = std::stoul(value);
+        } else if (match_option(arg, "max-connections", value)) {
+            config.max_connections = std::stoul(value);
+        } else if (match_option(arg, "engine", value)) {
+            config.io_engine = value == "io_uring" ? IoEngine::IO_URING : IoEngine::READINESS;
+        } else if (match_option(arg, "profile", value)) {
+            config.socket_profile = value == "latency"      ? SocketProfile::LATENCY
+                                  : value == "throughput"   ? SocketProfile::THROUGHPUT
+                                                            : SocketProfile::DEFAULT;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " --serve [--address=A] [--port=P] [--reactors=N]"
+                      << " [--max-connections=N] [--engine=readiness|io_uring]"
+                      << " [--profile=default|latency|throughput]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    AsyncServer server(config);
+    if (!server.start(address, port)) {
+        return EXIT_FAILURE;
+    }
+
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+
+    // Signal handlers can't call stop(); a watcher thread does
+    std::thread watcher([&server]() {
+        while (!g_stop_requested && server.is_running()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        server.stop();
+    });
+
+    server.run();
+    watcher.join();
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--serve") {
+        return serve(argc, argv);
+    }
  
     // Demo RAII Socket Wrapper
     {
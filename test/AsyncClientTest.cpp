@@ -0,0 +1,287 @@
+#include <gtest/gtest.h>
+#include "AsyncClient.h"
+#include "AsyncServer.h"
+#include "ProtocolMessages.h"
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace core::net;
+using core::protocol::FrameHeader;
+using core::protocol::MessageType;
+
+namespace {
+
+// Echo server running its loop on a background thread
+class AsyncClientEchoTest : public ::testing::Test {
+protected:
+    void start_server(ServerConfig config = ServerConfig{}) {
+        config.num_worker_threads = 1;
+        server = std::make_unique<AsyncServer>(config);
+        ASSERT_TRUE(server->start("127.0.0.1", 0));
+        loop = std::thread([this]() { server->run(20); });
+    }
+
+    void TearDown() override {
+        if (server) {
+            server->stop_now();
+        }
+        if (loop.joinable()) {
+            loop.join();
+        }
+    }
+
+    std::unique_ptr<AsyncServer> server;
+    std::thread loop;
+};
+
+bool send_text(AsyncClient& client, MessageType type, const std::string& text, AsyncClient::ResponseCallback callback) {
+    return client.send_request(type, reinterpret_cast<const uint8_t*>(text.data()),
+                               static_cast<uint16_t>(text.size()), std::move(callback));
+}
+
+} // namespace
+
+TEST_F(AsyncClientEchoTest, PoolOpensEveryConnection) {
+    start_server();
+
+    ClientConfig config;
+    config.pool_size = 4;
+    AsyncClient client(config);
+    ASSERT_TRUE(client.connect("127.0.0.1", server->get_listen_port()));
+    EXPECT_EQ(client.get_connection_count(), 4u);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (server->get_connection_count() < 4 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(server->get_connection_count(), 4u);
+}
+
+TEST_F(AsyncClientEchoTest, PipelinedRequestsMatchTheirResponses) {
+    start_server();
+
+    ClientConfig config;
+    config.pool_size = 2;
+    AsyncClient client(config);
+    ASSERT_TRUE(client.connect("127.0.0.1", server->get_listen_port()));
+
+    constexpr size_t NUM_REQUESTS = 1000;
+    std::vector<std::string> responses(NUM_REQUESTS);
+    size_t completed = 0;
+
+    for (size_t i = 0; i < NUM_REQUESTS; ++i) {
+        ASSERT_TRUE(send_text(client, MessageType::ECHO, "request " + std::to_string(i),
+                              [&responses, &completed, i](const ClientResponse& response) {
+            ASSERT_TRUE(response.ok);
+            EXPECT_EQ(response.header.message_type, static_cast<uint8_t>(MessageType::ECHO));
+            responses[i].assign(reinterpret_cast<const char*>(response.payload), response.payload_length);
+            ++completed;
+        }));
+    }
+    EXPECT_EQ(client.get_in_flight(), NUM_REQUESTS);
+
+    ASSERT_TRUE(client.wait_for_responses(5000));
+    EXPECT_EQ(completed, NUM_REQUESTS);
+    for (size_t i = 0; i < NUM_REQUESTS; ++i) {
+        EXPECT_EQ(responses[i], "request " + std::to_string(i));
+    }
+
+    // Queued requests leave in batches, not one send per frame
+    EXPECT_LT(client.get_send_count(), NUM_REQUESTS / 10);
+}
+
+TEST_F(AsyncClientEchoTest, PipelineDepthBoundsOutstandingRequests) {
+    start_server();
+
+    ClientConfig config;
+    config.pool_size = 1;
+    config.max_in_flight = 8;
+    AsyncClient client(config);
+    ASSERT_TRUE(client.connect("127.0.0.1", server->get_listen_port()));
+
+    size_t accepted = 0;
+    while (send_text(client, MessageType::PING, "", nullptr)) {
+        ++accepted;
+    }
+    EXPECT_EQ(accepted, 8u);
+
+    // Responses free the slots again
+    ASSERT_TRUE(client.wait_for_responses(2000));
+    EXPECT_TRUE(send_text(client, MessageType::PING, "", nullptr));
+}
+
+TEST_F(AsyncClientEchoTest, ClosedLoopCallbacksSendFollowUps) {
+    start_server();
+
+    ClientConfig config;
+    config.pool_size = 1;
+    AsyncClient client(config);
+    ASSERT_TRUE(client.connect("127.0.0.1", server->get_listen_port()));
+
+    constexpr int ROUNDS = 200;
+    int rounds = 0;
+    std::function<void(const ClientResponse&)> next = [&](const ClientResponse& response) {
+        ASSERT_TRUE(response.ok);
+        if (++rounds < ROUNDS) {
+            ASSERT_TRUE(send_text(client, MessageType::DATA, "again", next));
+        }
+    };
+    ASSERT_TRUE(send_text(client, MessageType::DATA, "first", next));
+
+    ASSERT_TRUE(client.wait_for_responses(5000));
+    EXPECT_EQ(rounds, ROUNDS);
+}
+
+TEST_F(AsyncClientEchoTest, LargePayloadsAreReassembled) {
+    start_server();
+
+    AsyncClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", server->get_listen_port()));
+
+    std::vector<uint8_t> payload(core::protocol::MAX_PAYLOAD_SIZE);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<uint8_t>(i * 13);
+    }
+
+    size_t intact = 0;
+    for (int i = 0; i < 16; ++i) {
+        ASSERT_TRUE(client.send_request(MessageType::DATA, payload.data(), static_cast<uint16_t>(payload.size()),
+                                        [&](const ClientResponse& response) {
+            ASSERT_TRUE(response.ok);
+            if (response.payload_length == payload.size() &&
+                std::memcmp(response.payload, payload.data(), payload.size()) == 0) {
+                ++intact;
+            }
+        }));
+    }
+
+    ASSERT_TRUE(client.wait_for_responses(5000));
+    EXPECT_EQ(intact, 16u);
+}
+
+TEST_F(AsyncClientEchoTest, Crc32cChecksumsRoundTrip) {
+    start_server();
+
+    ClientConfig config;
+    config.pool_size = 1;
+    config.crc32c_checksums = true;
+    AsyncClient client(config);
+    ASSERT_TRUE(client.connect("127.0.0.1", server->get_listen_port()));
+
+    std::string echoed;
+    bool flagged = false;
+    ASSERT_TRUE(send_text(client, MessageType::ECHO, std::string(40000, 'c'), [&](const ClientResponse& response) {
+        ASSERT_TRUE(response.ok);
+        flagged = response.header.has_flag(core::protocol::FrameFlags::CRC32C);
+        echoed.assign(reinterpret_cast<const char*>(response.payload), response.payload_length);
+    }));
+    ASSERT_TRUE(client.wait_for_responses(2000));
+    EXPECT_TRUE(flagged);
+    EXPECT_EQ(echoed, std::string(40000, 'c'));
+}
+
+TEST_F(AsyncClientEchoTest, ServerFramesAreNotTakenForResponses) {
+    ServerConfig server_config;
+    server_config.heartbeat_interval_ms = 20;
+    server_config.timer_tick_ms = 5;
+    start_server(server_config);
+
+    ClientConfig config;
+    config.pool_size = 1;
+    AsyncClient client(config);
+    int pings = 0;
+    client.set_unsolicited_callback([&pings](const FrameHeader& header, const uint8_t*, size_t) {
+        pings += header.message_type == static_cast<uint8_t>(MessageType::PING);
+    });
+    ASSERT_TRUE(client.connect("127.0.0.1", server->get_listen_port()));
+
+    std::string echoed;
+    ASSERT_TRUE(send_text(client, MessageType::ECHO, "mine", [&echoed](const ClientResponse& response) {
+        echoed.assign(reinterpret_cast<const char*>(response.payload), response.payload_length);
+    }));
+    ASSERT_TRUE(client.wait_for_responses(2000));
+    EXPECT_EQ(echoed, "mine");
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (pings == 0 && std::chrono::steady_clock::now() < deadline) {
+        client.poll(10);
+    }
+    EXPECT_GT(pings, 0);
+}
+
+TEST_F(AsyncClientEchoTest, GoingAwayStopsNewRequests) {
+    start_server();
+
+    ClientConfig config;
+    config.pool_size = 1;
+    AsyncClient client(config);
+    bool going_away = false;
+    client.set_unsolicited_callback([&going_away](const FrameHeader& header, const uint8_t* payload, size_t length) {
+        going_away = header.message_type == static_cast<uint8_t>(MessageType::STATUS) && length > 0 &&
+                     payload[0] == core::protocol::messages::STATUS_GOING_AWAY;
+    });
+    ASSERT_TRUE(client.connect("127.0.0.1", server->get_listen_port()));
+
+    std::thread stopper([this]() { server->stop(); });
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!going_away && std::chrono::steady_clock::now() < deadline) {
+        client.poll(10);
+    }
+    stopper.join();
+
+    EXPECT_TRUE(going_away);
+    EXPECT_FALSE(send_text(client, MessageType::PING, "", nullptr));
+}
+
+TEST(AsyncClientTest, LostConnectionFailsOutstandingRequests) {
+    AsyncSocket listener("127.0.0.1", 0);
+    ASSERT_TRUE(listener.create_listening_socket("127.0.0.1", 0));
+
+    ClientConfig config;
+    config.pool_size = 1;
+    AsyncClient client(config);
+    ASSERT_TRUE(client.connect("127.0.0.1", listener.get_local_port()));
+
+    int failures = 0;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(send_text(client, MessageType::PING, "", [&failures](const ClientResponse& response) {
+            failures += !response.ok;
+        }));
+    }
+    client.flush();
+
+    // Accept and hang up without answering
+    PeerAddress peer;
+    SOCKET accepted = INVALID_SOCKET;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (accepted == INVALID_SOCKET && std::chrono::steady_clock::now() < deadline) {
+        accepted = listener.accept_connection(peer);
+    }
+    ASSERT_NE(accepted, INVALID_SOCKET);
+    close_socket(accepted);
+
+    EXPECT_TRUE(client.wait_for_responses(2000));
+    EXPECT_EQ(failures, 3);
+    EXPECT_EQ(client.get_connection_count(), 0u);
+    EXPECT_FALSE(send_text(client, MessageType::PING, "", nullptr));
+}
+
+TEST(AsyncClientTest, RefusedConnectFails) {
+    // Bind a port, then free it so nothing listens there
+    uint16_t port = 0;
+    {
+        AsyncSocket listener("127.0.0.1", 0);
+        ASSERT_TRUE(listener.create_listening_socket("127.0.0.1", 0));
+        port = listener.get_local_port();
+    }
+
+    ClientConfig config;
+    config.pool_size = 2;
+    config.connect_timeout_ms = 1000;
+    AsyncClient client(config);
+    EXPECT_FALSE(client.connect("127.0.0.1", port));
+    EXPECT_EQ(client.get_connection_count(), 0u);
+}
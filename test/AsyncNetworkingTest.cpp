@@ -1,7 +1,30 @@
 #include <gtest/gtest.h>
 #include "NetworkBuffer.h"
+#include "BinaryProtocol.h"
+#include "ProtocolMessages.h"
+#include "ConnectionHandler.h"
 #include "ConnectionManager.h"
-#include <winsock2.h>
+#include "MessageSerializer.h"
+#include "Reactor.h"
+#include "AsyncServer.h"
+#include "OutputQueue.h"
+#include "PlatformSocket.h"
+#include "SharedBuffer.h"
+#include "ShmTransport.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/stat.h>
+#endif
 
 using namespace core::net;
 
@@ -109,73 +132,2029 @@ TEST_F(ConnectionManagerTest, AddConnection) {
     SOCKET mock_socket = (SOCKET)1001;
     auto handler = std::make_unique<ConnectionHandler>(mock_socket, "127.0.0.1", 1234);
     
-    EXPECT_TRUE(manager.add_connection(mock_socket, std::move(handler)));
+    EXPECT_NE(manager.add_connection(std::move(handler)), INVALID_CONNECTION_ID);
     EXPECT_EQ(manager.get_connection_count(), 1);
 }
 
-TEST_F(ConnectionManagerTest, DuplicateConnection) {
-    SOCKET mock_socket = (SOCKET)1001;
-    auto handler1 = std::make_unique<ConnectionHandler>(mock_socket, "127.0.0.1", 1234);
-    auto handler2 = std::make_unique<ConnectionHandler>(mock_socket, "127.0.0.1", 1234);
-    
-    EXPECT_TRUE(manager.add_connection(mock_socket, std::move(handler1)));
-    EXPECT_FALSE(manager.add_connection(mock_socket, std::move(handler2)));
+TEST_F(ConnectionManagerTest, NullHandlerRejected) {
+    EXPECT_EQ(manager.add_connection(nullptr), INVALID_CONNECTION_ID);
+    EXPECT_EQ(manager.get_connection_count(), 0);
 }
 
 TEST_F(ConnectionManagerTest, RemoveConnection) {
     SOCKET mock_socket = (SOCKET)1001;
     auto handler = std::make_unique<ConnectionHandler>(mock_socket, "127.0.0.1", 1234);
     
-    manager.add_connection(mock_socket, std::move(handler));
-    EXPECT_TRUE(manager.remove_connection(mock_socket));
+    ConnectionId id = manager.add_connection(std::move(handler));
+    EXPECT_TRUE(manager.remove_connection(id));
     EXPECT_EQ(manager.get_connection_count(), 0);
 }
 
 TEST_F(ConnectionManagerTest, RemoveNonexistent) {
-    SOCKET mock_socket = (SOCKET)1001;
-    EXPECT_FALSE(manager.remove_connection(mock_socket));
+    EXPECT_FALSE(manager.remove_connection(INVALID_CONNECTION_ID));
+    EXPECT_FALSE(manager.remove_connection(ConnectionId{12345}));
 }
 
 TEST_F(ConnectionManagerTest, HasConnection) {
     SOCKET mock_socket = (SOCKET)1001;
     auto handler = std::make_unique<ConnectionHandler>(mock_socket, "127.0.0.1", 1234);
     
-    EXPECT_FALSE(manager.has_connection(mock_socket));
-    manager.add_connection(mock_socket, std::move(handler));
-    EXPECT_TRUE(manager.has_connection(mock_socket));
+    ConnectionId id = manager.add_connection(std::move(handler));
+    EXPECT_TRUE(manager.has_connection(id));
+    manager.remove_connection(id);
+    EXPECT_FALSE(manager.has_connection(id));
 }
 
 TEST_F(ConnectionManagerTest, GetConnection) {
     SOCKET mock_socket = (SOCKET)1001;
     auto handler = std::make_unique<ConnectionHandler>(mock_socket, "127.0.0.1", 1234);
     
-    manager.add_connection(mock_socket, std::move(handler));
-    auto* retrieved = manager.get_connection(mock_socket);
+    ConnectionId id = manager.add_connection(std::move(handler));
+    auto* retrieved = manager.get_connection(id);
     
     EXPECT_NE(retrieved, nullptr);
     EXPECT_EQ(retrieved->get_socket(), mock_socket);
 }
 
+TEST_F(ConnectionManagerTest, StaleIdMissesRecycledSocket) {
+    SOCKET mock_socket = (SOCKET)1001;
+    ConnectionId old_id = manager.add_connection(
+        std::make_unique<ConnectionHandler>(mock_socket, "127.0.0.1", 1234));
+    ASSERT_TRUE(manager.remove_connection(old_id));
+
+    // Same socket number, same slot: only the generation tells them apart
+    ConnectionId new_id = manager.add_connection(
+        std::make_unique<ConnectionHandler>(mock_socket, "127.0.0.1", 5678));
+    EXPECT_NE(new_id, old_id);
+    EXPECT_EQ(manager.get_connection(old_id), nullptr);
+    EXPECT_FALSE(manager.remove_connection(old_id));
+    ASSERT_NE(manager.get_connection(new_id), nullptr);
+    EXPECT_EQ(manager.get_connection(new_id)->get_client_port(), 5678);
+}
+
 TEST_F(ConnectionManagerTest, GetAllSockets) {
-    std::vector<SOCKET> sockets;
+    std::vector<ConnectionId> ids;
     for (int i = 0; i < 5; ++i) {
         SOCKET mock_socket = (SOCKET)(1000 + i);
         auto handler = std::make_unique<ConnectionHandler>(mock_socket, "127.0.0.1", 1234 + i);
-        manager.add_connection(mock_socket, std::move(handler));
+        ids.push_back(manager.add_connection(std::move(handler)));
     }
     
     auto all_sockets = manager.get_all_sockets();
     EXPECT_EQ(all_sockets.size(), 5);
+
+    // Removing from the middle keeps the rest reachable
+    manager.remove_connection(ids[1]);
+    auto all_ids = manager.get_all_ids();
+    EXPECT_EQ(all_ids.size(), 4);
+    for (ConnectionId id : all_ids) {
+        EXPECT_NE(id, ids[1]);
+        EXPECT_NE(manager.get_connection(id), nullptr);
+    }
 }
 
 TEST_F(ConnectionManagerTest, CloseAll) {
     for (int i = 0; i < 5; ++i) {
         SOCKET mock_socket = (SOCKET)(1000 + i);
         auto handler = std::make_unique<ConnectionHandler>(mock_socket, "127.0.0.1", 1234 + i);
-        manager.add_connection(mock_socket, std::move(handler));
+        manager.add_connection(std::move(handler));
     }
     
     EXPECT_EQ(manager.get_connection_count(), 5);
     manager.close_all();
     EXPECT_EQ(manager.get_connection_count(), 0);
 }
+
+TEST(ConnectionManagerShardTest, SpreadsConnectionsAcrossShards) {
+    ConnectionManager manager(4);
+    EXPECT_EQ(manager.get_shard_count(), 4u);
+    EXPECT_EQ(ConnectionManager(0).get_shard_count(), 1u);
+    EXPECT_EQ(ConnectionManager(1000).get_shard_count(), ConnectionManager::MAX_SHARDS);
+
+    std::vector<ConnectionId> ids;
+    for (int i = 0; i < 8; ++i) {
+        ids.push_back(manager.add_connection(std::make_unique<ConnectionHandler>(INVALID_SOCKET, "127.0.0.1", 1234)));
+        ASSERT_NE(ids.back(), INVALID_CONNECTION_ID);
+    }
+
+    // Same slot in different shards still yields distinct ids
+    std::sort(ids.begin(), ids.end());
+    EXPECT_EQ(std::unique(ids.begin(), ids.end()), ids.end());
+    EXPECT_EQ(manager.get_connection_count(), 8u);
+    EXPECT_EQ(manager.get_all_ids().size(), 8u);
+    for (ConnectionId id : ids) {
+        EXPECT_TRUE(manager.has_connection(id));
+    }
+
+    // An id tagged with a shard that doesn't exist is rejected, not masked into range
+    EXPECT_FALSE(manager.has_connection(ids.front() | (ConnectionId{63} << 56)));
+}
+
+TEST(ConnectionManagerShardTest, ChurnWhileStatisticsArePolled) {
+    ConnectionManager manager(8);
+    constexpr int NUM_THREADS = 4;
+    constexpr int CONNECTIONS_PER_THREAD = 2000;
+    std::atomic<bool> done{false};
+    std::atomic<size_t> polls{0};
+
+    std::thread poller([&]() {
+        while (!done.load()) {
+            EXPECT_LE(manager.get_connection_count(), static_cast<size_t>(NUM_THREADS * CONNECTIONS_PER_THREAD));
+            EXPECT_EQ(manager.get_total_bytes_received(), 0u);
+            polls.fetch_add(1);
+        }
+    });
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        workers.emplace_back([&manager]() {
+            std::vector<ConnectionId> ids;
+            for (int i = 0; i < CONNECTIONS_PER_THREAD; ++i) {
+                ids.push_back(manager.add_connection(
+                    std::make_unique<ConnectionHandler>(INVALID_SOCKET, "127.0.0.1", 1234)));
+                if (i % 2 == 1) {
+                    EXPECT_TRUE(manager.remove_connection(ids[i - 1]));
+                }
+            }
+            for (int i = 1; i < CONNECTIONS_PER_THREAD; i += 2) {
+                EXPECT_TRUE(manager.remove_connection(ids[i]));
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    done.store(true);
+    poller.join();
+
+    EXPECT_GT(polls.load(), 0u);
+    EXPECT_EQ(manager.get_connection_count(), 0u);
+    EXPECT_TRUE(manager.get_all_ids().empty());
+}
+
+// ============ OutputQueue Tests ============
+
+TEST(OutputQueueTest, SmallWritesCoalesceIntoOneSegment) {
+    OutputQueue queue;
+    const uint8_t data[] = {1, 2, 3, 4};
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(queue.append(data, sizeof(data)));
+    }
+
+    EXPECT_EQ(queue.size(), 400u);
+    EXPECT_EQ(queue.segment_count(), 1u);
+
+    IoSlice slices[4];
+    ASSERT_EQ(queue.gather(slices, 4), 1u);
+    EXPECT_EQ(io_slice_length(slices[0]), 400u);
+}
+
+TEST(OutputQueueTest, LargePayloadIsNotTruncated) {
+    OutputQueue queue;
+    std::vector<uint8_t> payload(OutputQueue::SEGMENT_SIZE * 3 + 17);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<uint8_t>(i);
+    }
+
+    ASSERT_TRUE(queue.append(payload.data(), payload.size()));
+    EXPECT_EQ(queue.size(), payload.size());
+
+    IoSlice slices[MAX_IO_SLICES];
+    size_t count = queue.gather(slices, MAX_IO_SLICES);
+
+    std::vector<uint8_t> gathered;
+    for (size_t i = 0; i < count; ++i) {
+        gathered.insert(gathered.end(), io_slice_data(slices[i]), io_slice_data(slices[i]) + io_slice_length(slices[i]));
+    }
+    EXPECT_EQ(gathered, payload);
+}
+
+TEST(OutputQueueTest, PartialConsumeKeepsQueuedBytesInPlace) {
+    OutputQueue queue;
+    std::vector<uint8_t> first(OutputQueue::SEGMENT_SIZE, 0xAA);
+    std::vector<uint8_t> second(100, 0xBB);
+    ASSERT_TRUE(queue.append(first.data(), first.size()));
+    ASSERT_TRUE(queue.append(second.data(), second.size()));
+    ASSERT_EQ(queue.segment_count(), 2u);
+
+    IoSlice before[2];
+    ASSERT_EQ(queue.gather(before, 2), 2u);
+
+    // Partial send: the head offset advances, nothing is copied
+    queue.consume(10);
+    IoSlice after[2];
+    ASSERT_EQ(queue.gather(after, 2), 2u);
+    EXPECT_EQ(io_slice_data(after[0]), io_slice_data(before[0]) + 10);
+    EXPECT_EQ(io_slice_data(after[1]), io_slice_data(before[1]));
+    EXPECT_EQ(queue.size(), first.size() + second.size() - 10);
+
+    queue.consume(first.size() - 10);
+    EXPECT_EQ(queue.segment_count(), 1u);
+    ASSERT_EQ(queue.gather(after, 2), 1u);
+    EXPECT_EQ(io_slice_data(after[0]), io_slice_data(before[1]));
+
+    queue.consume(second.size());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(OutputQueueTest, GatherRespectsSliceLimit) {
+    OutputQueue queue;
+    std::vector<uint8_t> payload(OutputQueue::SEGMENT_SIZE + 1);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.append(payload.data(), payload.size()));
+    }
+
+    IoSlice slices[2];
+    EXPECT_EQ(queue.gather(slices, 2), 2u);
+}
+
+TEST(OutputQueueTest, SharedPayloadIsQueuedByReference) {
+    const uint8_t bytes[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    SharedBuffer payload = SharedBuffer::copy_of(bytes, sizeof(bytes));
+
+    OutputQueue queue;
+    const uint8_t header[] = {0xFF};
+    ASSERT_TRUE(queue.append(header, sizeof(header)));
+    ASSERT_TRUE(queue.append(payload));
+    ASSERT_TRUE(queue.append(header, sizeof(header)));
+    EXPECT_EQ(payload.use_count(), 2);
+    EXPECT_EQ(queue.size(), sizeof(bytes) + 2);
+
+    // The shared bytes are gathered in place; later writes don't touch them
+    IoSlice slices[4];
+    ASSERT_EQ(queue.gather(slices, 4), 3u);
+    EXPECT_EQ(io_slice_data(slices[1]), payload.data());
+    EXPECT_EQ(io_slice_length(slices[1]), sizeof(bytes));
+
+    queue.consume(1 + 4);
+    ASSERT_EQ(queue.gather(slices, 4), 2u);
+    EXPECT_EQ(io_slice_data(slices[0]), payload.data() + 4);
+
+    queue.consume(5);
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(payload.use_count(), 1);
+}
+
+TEST(OutputQueueTest, LargeSharedPayloadIsGatheredAlone) {
+    std::vector<uint8_t> bytes(32 * 1024, 0x5A);
+    SharedBuffer payload = SharedBuffer::copy_of(bytes.data(), bytes.size());
+    const uint8_t small[] = {1, 2, 3};
+
+    OutputQueue queue;
+    ASSERT_TRUE(queue.append(small, sizeof(small)));
+    ASSERT_TRUE(queue.append(payload));
+    ASSERT_TRUE(queue.append(small, sizeof(small)));
+
+    // Owned bytes ahead of it go first, without the payload
+    IoSlice slices[4];
+    EXPECT_EQ(queue.shared_front(16 * 1024), nullptr);
+    ASSERT_EQ(queue.gather(slices, 4, 16 * 1024), 1u);
+    queue.consume(sizeof(small));
+
+    ASSERT_NE(queue.shared_front(16 * 1024), nullptr);
+    EXPECT_EQ(queue.shared_front(16 * 1024)->data(), payload.data());
+    ASSERT_EQ(queue.gather(slices, 4, 16 * 1024), 1u);
+    EXPECT_EQ(io_slice_length(slices[0]), bytes.size());
+
+    // Without a threshold everything is gathered together
+    EXPECT_EQ(queue.gather(slices, 4), 2u);
+}
+
+// ============ Reactor Tests ============
+
+namespace {
+
+// Retry a non-blocking operation on loopback until it succeeds or times out
+template<typename Op>
+bool retry_for(Op op, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000)) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (op()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+// Half-close: the peer sees EOF, the socket can still receive
+void shutdown_send(SOCKET socket) {
+#ifdef _WIN32
+    ASSERT_EQ(::shutdown(socket, SD_SEND), 0);
+#else
+    ASSERT_EQ(::shutdown(socket, SHUT_WR), 0);
+#endif
+}
+
+} // namespace
+
+class ReactorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(AsyncSocket::initialize_winsock());
+        ASSERT_TRUE(listener.create_listening_socket("127.0.0.1", 0));
+        port = listener.get_local_port();
+    }
+
+    void TearDown() override {
+        AsyncSocket::cleanup_winsock();
+    }
+
+    SOCKET accept_one() {
+        SOCKET accepted = INVALID_SOCKET;
+        std::string address;
+        uint16_t client_port = 0;
+        retry_for([&]() {
+            accepted = listener.accept_connection(address, client_port);
+            return accepted != INVALID_SOCKET;
+        });
+        return accepted;
+    }
+
+    AsyncSocket listener{"127.0.0.1", 0};
+    uint16_t port{0};
+};
+
+TEST_F(ReactorTest, ReportsOnlyReadySockets) {
+    Reactor reactor;
+    ASSERT_TRUE(reactor.is_valid());
+
+    constexpr int NUM_CLIENTS = 4;
+    std::vector<std::unique_ptr<AsyncSocket>> clients;
+    std::vector<SOCKET> accepted;
+
+    for (int i = 0; i < NUM_CLIENTS; ++i) {
+        auto client = std::make_unique<AsyncSocket>("127.0.0.1", port);
+        ASSERT_TRUE(client->connect("127.0.0.1", port));
+        clients.push_back(std::move(client));
+
+        SOCKET server_side = accept_one();
+        ASSERT_NE(server_side, INVALID_SOCKET);
+        accepted.push_back(server_side);
+        EXPECT_TRUE(reactor.add(server_side, Reactor::READABLE, 100 + i));
+    }
+    EXPECT_EQ(reactor.registered_count(), static_cast<size_t>(NUM_CLIENTS));
+
+    // Only client 2 sends data
+    const uint8_t payload[] = {1, 2, 3};
+    ASSERT_TRUE(retry_for([&]() {
+        return clients[2]->send_data(clients[2]->get_socket(), payload, 3) == 3;
+    }));
+
+    Reactor::Event events[8];
+    int count = reactor.wait(events, 8, 1000);
+    ASSERT_EQ(count, 1);
+    EXPECT_EQ(events[0].token, 102u);
+    EXPECT_TRUE(events[0].events & Reactor::READABLE);
+
+    for (SOCKET s : accepted) {
+        EXPECT_TRUE(reactor.remove(s));
+        close_socket(s);
+    }
+    EXPECT_EQ(reactor.registered_count(), 0u);
+}
+
+TEST_F(ReactorTest, WritableInterestOnlyWhenRequested) {
+    Reactor reactor;
+    AsyncSocket client("127.0.0.1", port);
+    ASSERT_TRUE(client.connect("127.0.0.1", port));
+    SOCKET server_side = accept_one();
+    ASSERT_NE(server_side, INVALID_SOCKET);
+
+    ASSERT_TRUE(reactor.add(server_side, Reactor::READABLE, 7));
+    Reactor::Event events[4];
+    EXPECT_EQ(reactor.wait(events, 4, 50), 0);
+
+    ASSERT_TRUE(reactor.modify(server_side, Reactor::READABLE | Reactor::WRITABLE, 7));
+    ASSERT_EQ(reactor.wait(events, 4, 1000), 1);
+    EXPECT_TRUE(events[0].events & Reactor::WRITABLE);
+
+    reactor.remove(server_side);
+    close_socket(server_side);
+}
+
+TEST_F(ReactorTest, WakeupInterruptsWait) {
+    Reactor reactor;
+    std::thread waker([&reactor]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        reactor.wakeup();
+    });
+
+    Reactor::Event events[4];
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(reactor.wait(events, 4, 5000), 0);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(4));
+
+    waker.join();
+}
+
+TEST_F(ReactorTest, EdgeTriggeredReportsNewInputOnce) {
+    Reactor reactor;
+    AsyncSocket client("127.0.0.1", port);
+    ASSERT_TRUE(client.connect("127.0.0.1", port));
+    SOCKET server_side = accept_one();
+    ASSERT_NE(server_side, INVALID_SOCKET);
+
+    ASSERT_TRUE(reactor.add(server_side, Reactor::READABLE | Reactor::EDGE_TRIGGERED, 9));
+
+    const uint8_t payload[] = {1, 2, 3};
+    ASSERT_TRUE(retry_for([&]() {
+        return client.send_data(client.get_socket(), payload, 3) == 3;
+    }));
+
+    Reactor::Event events[4];
+    ASSERT_EQ(reactor.wait(events, 4, 1000), 1);
+    EXPECT_EQ(events[0].token, 9u);
+
+#ifdef __linux__
+    // Unread input doesn't re-report: the owner has to drain until EAGAIN
+    EXPECT_EQ(reactor.wait(events, 4, 50), 0);
+#endif
+
+    reactor.remove(server_side);
+    close_socket(server_side);
+}
+
+// ============ ConnectionHandler Tests ============
+
+class ConnectionHandlerTest : public ReactorTest {
+protected:
+    void SetUp() override {
+        ReactorTest::SetUp();
+        client = std::make_unique<AsyncSocket>("127.0.0.1", port);
+        ASSERT_TRUE(client->connect("127.0.0.1", port));
+        SOCKET server_side = accept_one();
+        ASSERT_NE(server_side, INVALID_SOCKET);
+        handler = std::make_unique<ConnectionHandler>(server_side, "127.0.0.1", port);
+    }
+
+    // Send length bytes and read them on the server side, one read event per pass
+    void send_and_read(size_t length, size_t chunk) {
+        std::vector<uint8_t> data(chunk);
+        const size_t target = handler->get_bytes_received() + length;
+        size_t sent = 0;
+        ASSERT_TRUE(retry_for([&]() {
+            if (sent < length) {
+                int result = client->send_data(client->get_socket(), data.data(),
+                                               static_cast<int>(std::min(chunk, length - sent)));
+                if (result > 0) {
+                    sent += static_cast<size_t>(result);
+                }
+            }
+            handler->handle_read_event();
+            max_buffer = std::max(max_buffer, handler->get_read_buffer_size());
+            return handler->get_bytes_received() >= target;
+        }, std::chrono::milliseconds(5000)));
+    }
+
+    std::unique_ptr<AsyncSocket> client;
+    std::unique_ptr<ConnectionHandler> handler;
+    size_t max_buffer{0};
+};
+
+TEST_F(ConnectionHandlerTest, BulkInputGrowsReadBuffer) {
+    EXPECT_EQ(handler->get_read_buffer_size(), 0u);
+
+    send_and_read(1024 * 1024, 64 * 1024);
+    EXPECT_EQ(max_buffer, 64u * 1024);
+    EXPECT_TRUE(handler->is_active());
+}
+
+TEST_F(ConnectionHandlerTest, SmallReadsShrinkBufferBack) {
+    send_and_read(1024 * 1024, 64 * 1024);
+    ASSERT_EQ(handler->get_read_buffer_size(), 64u * 1024);
+
+    // Halves after every eight small reads: 64 KB -> 4 KB takes 32
+    for (int i = 0; i < 32; ++i) {
+        send_and_read(100, 100);
+    }
+    EXPECT_EQ(handler->get_read_buffer_size(), 4096u);
+}
+
+TEST_F(ConnectionHandlerTest, ReadBudgetYieldsWithInputLeft) {
+    std::vector<uint8_t> data(64 * 1024);
+    ASSERT_TRUE(retry_for([&]() {
+        return client->send_data(client->get_socket(), data.data(), static_cast<int>(data.size())) ==
+               static_cast<int>(data.size());
+    }));
+
+    bool budget_hit = false;
+    ASSERT_TRUE(retry_for([&]() {
+        budget_hit = handler->handle_read_event(1);
+        return handler->get_bytes_received() > 0;
+    }));
+    EXPECT_TRUE(budget_hit);
+    EXPECT_LT(handler->get_bytes_received(), data.size());
+
+    // Without a budget the socket is drained
+    ASSERT_TRUE(retry_for([&]() {
+        EXPECT_FALSE(handler->handle_read_event());
+        return handler->get_bytes_received() == data.size();
+    }));
+}
+
+TEST_F(ConnectionHandlerTest, PeerCloseIsDetected) {
+    client.reset();
+    ASSERT_TRUE(retry_for([&]() {
+        handler->handle_read_event();
+        return !handler->is_active();
+    }));
+}
+
+TEST_F(ConnectionHandlerTest, EdgeTriggeredDataThenHangUpIsDetected) {
+    Reactor reactor;
+    ASSERT_TRUE(reactor.add(handler->get_socket(), Reactor::READABLE | Reactor::EDGE_TRIGGERED, 1));
+
+    const uint8_t payload[] = {'h', 'e', 'l', 'l', 'o'};
+    ASSERT_TRUE(retry_for([&]() {
+        return client->send_data(client->get_socket(), payload, sizeof(payload)) == static_cast<int>(sizeof(payload));
+    }));
+    shutdown_send(client->get_socket());
+
+    // Data and FIN may be reported together; the short read must not hide the EOF
+    Reactor::Event events[4];
+    ASSERT_TRUE(retry_for([&]() {
+        if (reactor.wait(events, 4, 10) != 1) {
+            return false;
+        }
+        handler->handle_read_event(SIZE_MAX, (events[0].events & (Reactor::CLOSED | Reactor::FAILED)) != 0);
+        return !handler->is_active();
+    }));
+    EXPECT_EQ(handler->get_bytes_received(), sizeof(payload));
+
+    reactor.remove(handler->get_socket());
+}
+
+std::vector<uint8_t> serialize_data_frame(const std::string& text) {
+    core::protocol::FrameHeader header{core::protocol::PROTOCOL_MAGIC, core::protocol::PROTOCOL_VERSION,
+                                       static_cast<uint8_t>(core::protocol::MessageType::DATA), 0,
+                                       static_cast<uint16_t>(text.size()), 0};
+    NetworkBuffer buffer(core::protocol::MIN_FRAME_SIZE + text.size());
+    EXPECT_TRUE(core::protocol::MessageSerializer::serialize_frame(
+        header, reinterpret_cast<const uint8_t*>(text.data()), static_cast<uint16_t>(text.size()), buffer));
+    return std::vector<uint8_t>(buffer.data(), buffer.data() + buffer.write_pos());
+}
+
+TEST_F(ConnectionHandlerTest, FrameCallbackReassemblesAcrossReads) {
+    std::vector<std::string> frames;
+    ASSERT_TRUE(handler->set_frame_callback([&frames](const core::protocol::FrameView& frame) {
+        frames.emplace_back(frame.payload.begin(), frame.payload.end());
+    }));
+
+    std::vector<uint8_t> stream = serialize_data_frame("first");
+    const std::vector<uint8_t> second = serialize_data_frame("second");
+    stream.insert(stream.end(), second.begin(), second.end());
+
+    // Cut inside the second frame's header, then inside its payload
+    const size_t cuts[] = {0, stream.size() - second.size() + 3, stream.size() - 2, stream.size()};
+    for (size_t i = 0; i + 1 < std::size(cuts); ++i) {
+        ASSERT_TRUE(handler->deliver_received(stream.data() + cuts[i], cuts[i + 1] - cuts[i]));
+    }
+
+    EXPECT_EQ(frames, (std::vector<std::string>{"first", "second"}));
+    EXPECT_EQ(handler->get_frame_decoder()->get_buffered(), 0u);
+}
+
+TEST_F(ConnectionHandlerTest, FramesAreReadStraightIntoDecoder) {
+    std::vector<std::string> frames;
+    ASSERT_TRUE(handler->set_frame_callback([&frames](const core::protocol::FrameView& frame) {
+        frames.emplace_back(frame.payload.begin(), frame.payload.end());
+    }));
+
+    const std::vector<uint8_t> frame = serialize_data_frame("no copy");
+    ASSERT_TRUE(retry_for([&]() {
+        return client->send_data(client->get_socket(), frame.data(), static_cast<int>(frame.size())) ==
+               static_cast<int>(frame.size());
+    }));
+    ASSERT_TRUE(retry_for([&]() {
+        handler->handle_read_event();
+        return !frames.empty();
+    }));
+
+    EXPECT_EQ(frames, (std::vector<std::string>{"no copy"}));
+    EXPECT_EQ(handler->get_bytes_received(), frame.size());
+    EXPECT_EQ(handler->get_read_buffer_size(), 0u);     // recv() never used the read buffer
+}
+
+TEST_F(ConnectionHandlerTest, CorruptFrameClosesConnection) {
+    size_t frames = 0;
+    ASSERT_TRUE(handler->set_frame_callback([&frames](const core::protocol::FrameView&) { ++frames; }));
+
+    std::vector<uint8_t> frame = serialize_data_frame("tampered");
+    frame[core::protocol::FRAME_HEADER_SIZE] ^= 0x20;
+
+    EXPECT_FALSE(handler->deliver_received(frame.data(), frame.size()));
+    EXPECT_FALSE(handler->is_active());
+    EXPECT_EQ(frames, 0u);
+}
+
+TEST_F(ConnectionHandlerTest, ResyncPolicySkipsCorruptFrame) {
+    std::vector<std::string> frames;
+    ASSERT_TRUE(handler->set_frame_callback([&frames](const core::protocol::FrameView& frame) {
+        frames.emplace_back(frame.payload.begin(), frame.payload.end());
+    }, core::protocol::CorruptionPolicy::RESYNC));
+
+    std::vector<uint8_t> stream = {0x00, 0x11, 0x22};
+    const std::vector<uint8_t> good = serialize_data_frame("after noise");
+    stream.insert(stream.end(), good.begin(), good.end());
+
+    EXPECT_TRUE(handler->deliver_received(stream.data(), stream.size()));
+    EXPECT_TRUE(handler->is_active());
+    EXPECT_EQ(frames, (std::vector<std::string>{"after noise"}));
+    EXPECT_EQ(handler->get_frame_decoder()->get_skipped_bytes(), 3u);
+}
+
+TEST_F(ConnectionHandlerTest, ManagerTotalsFollowLiveTraffic) {
+    // Bytes read before registration are counted once the handler joins
+    send_and_read(1000, 1000);
+
+    ConnectionManager manager(2);
+    ConnectionHandler* raw = handler.get();
+    ConnectionId id = manager.add_connection(std::move(handler));
+    ASSERT_NE(id, INVALID_CONNECTION_ID);
+    EXPECT_EQ(manager.get_total_bytes_received(), 1000u);
+
+    const uint8_t data[300] = {};
+    ASSERT_TRUE(retry_for([&]() {
+        return client->send_data(client->get_socket(), data, sizeof(data)) == static_cast<int>(sizeof(data));
+    }));
+    ASSERT_TRUE(retry_for([&]() {
+        raw->handle_read_event();
+        return manager.get_total_bytes_received() == 1300u;
+    }));
+
+    ASSERT_TRUE(raw->send_data(data, 200));
+    EXPECT_EQ(manager.get_total_bytes_sent(), 200u);
+    EXPECT_EQ(manager.get_connection_stats(id), std::make_pair(size_t{1300}, size_t{200}));
+
+    // Totals cover live connections only
+    EXPECT_TRUE(manager.remove_connection(id));
+    EXPECT_EQ(manager.get_total_bytes_received(), 0u);
+    EXPECT_EQ(manager.get_total_bytes_sent(), 0u);
+}
+
+// ============ AsyncServer Tests ============
+
+// Send a message on a connected client and collect the echo
+void expect_round_trip(AsyncSocket& client, const std::string& message) {
+    ASSERT_TRUE(retry_for([&]() {
+        return client.send_data(client.get_socket(),
+                                reinterpret_cast<const uint8_t*>(message.data()),
+                                static_cast<int>(message.size())) == static_cast<int>(message.size());
+    }));
+
+    std::string echoed;
+    EXPECT_TRUE(retry_for([&]() {
+        uint8_t buffer[64];
+        int received = client.recv_data(client.get_socket(), buffer, sizeof(buffer));
+        if (received > 0) {
+            echoed.append(reinterpret_cast<const char*>(buffer), received);
+        }
+        return echoed.size() >= message.size();
+    }));
+    EXPECT_EQ(echoed, message);
+}
+
+// Connect to a running server, send a message and collect the echo
+void expect_echo(AsyncServer& server, const std::string& message) {
+    uint16_t port = server.get_listen_port();
+
+    AsyncSocket client("127.0.0.1", port);
+    ASSERT_TRUE(client.connect("127.0.0.1", port));
+
+    expect_round_trip(client, message);
+    EXPECT_EQ(server.get_connection_count(), 1u);
+}
+
+TEST(AsyncServerTest, EchoesClientData) {
+    AsyncServer server(1);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    EXPECT_EQ(server.get_io_engine(), IoEngine::READINESS);
+
+    std::thread loop([&server]() { server.run(20); });
+
+    expect_echo(server, "hello reactor");
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, HalfClosedClientIsDropped) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    ASSERT_TRUE(config.edge_triggered_reads);
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    std::thread loop([&server]() { server.run(20); });
+
+    AsyncSocket client("127.0.0.1", server.get_listen_port());
+    ASSERT_TRUE(client.connect("127.0.0.1", server.get_listen_port()));
+    ASSERT_TRUE(retry_for([&]() { return server.get_connection_count() == 1u; }));
+
+    const std::string message = "hello";
+    ASSERT_TRUE(retry_for([&]() {
+        return client.send_data(client.get_socket(), reinterpret_cast<const uint8_t*>(message.data()),
+                                static_cast<int>(message.size())) == static_cast<int>(message.size());
+    }));
+    shutdown_send(client.get_socket());
+
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 0u; }));
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, FrameCallbackDecodesEveryConnection) {
+    AsyncServer server(1);
+    std::mutex mutex;
+    std::vector<std::string> payloads;
+    std::set<ConnectionId> connections;
+    server.set_frame_callback([&](AsyncServer::FrameReply& reply, const core::protocol::FrameView& frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        payloads.emplace_back(frame.payload.begin(), frame.payload.end());
+        connections.insert(reply.connection());
+    });
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    std::thread loop([&server]() { server.run(20); });
+
+    AsyncSocket client("127.0.0.1", server.get_listen_port());
+    ASSERT_TRUE(client.connect("127.0.0.1", server.get_listen_port()));
+
+    // Two frames in one send, then a third split across sends
+    std::vector<uint8_t> stream = serialize_data_frame("one");
+    for (const char* text : {"two", "three"}) {
+        const std::vector<uint8_t> frame = serialize_data_frame(text);
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    const size_t cut = stream.size() - 4;
+    for (const auto& [begin, end] : {std::make_pair(size_t{0}, cut), std::make_pair(cut, stream.size())}) {
+        ASSERT_TRUE(retry_for([&]() {
+            return client.send_data(client.get_socket(), stream.data() + begin, static_cast<int>(end - begin)) ==
+                   static_cast<int>(end - begin);
+        }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    EXPECT_TRUE(retry_for([&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return payloads.size() == 3;
+    }));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_EQ(payloads, (std::vector<std::string>{"one", "two", "three"}));
+        EXPECT_EQ(connections.size(), 1u);
+    }
+
+    // A corrupt frame closes the connection under the default policy
+    std::vector<uint8_t> corrupt = serialize_data_frame("tampered");
+    corrupt[core::protocol::FRAME_HEADER_SIZE] ^= 0x20;
+    ASSERT_TRUE(retry_for([&]() {
+        return client.send_data(client.get_socket(), corrupt.data(), static_cast<int>(corrupt.size())) ==
+               static_cast<int>(corrupt.size());
+    }));
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 0u; }));
+
+    server.stop();
+    loop.join();
+}
+
+void expect_frame_callback_replies(IoEngine engine) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.io_engine = engine;
+
+    AsyncServer server(config);
+    std::atomic<bool> lookup_refused{false};
+    server.set_frame_callback([&](AsyncServer::FrameReply& reply, const core::protocol::FrameView& frame) {
+        const std::string text(frame.payload.begin(), frame.payload.end());
+        if (text == "bye") {
+            reply.close();
+            return;
+        }
+
+        // The shard is locked here: a lookup on it is refused rather than deadlocking
+        const uint8_t byte = 0;
+        lookup_refused = !server.send_to_client(reply.connection(), &byte, 1);
+
+        const std::vector<uint8_t> answer = serialize_data_frame("ack:" + text);
+        EXPECT_TRUE(reply.send(answer.data(), answer.size()));
+    });
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    std::thread loop([&server]() { server.run(20); });
+
+    AsyncSocket client("127.0.0.1", server.get_listen_port());
+    ASSERT_TRUE(client.connect("127.0.0.1", server.get_listen_port()));
+
+    const std::vector<uint8_t> request = serialize_data_frame("ping");
+    ASSERT_TRUE(retry_for([&]() {
+        return client.send_data(client.get_socket(), request.data(), static_cast<int>(request.size())) ==
+               static_cast<int>(request.size());
+    }));
+
+    // The raw echo comes first, then the callback's answer
+    core::protocol::FrameDecoder decoder;
+    std::vector<std::string> received;
+    EXPECT_TRUE(retry_for([&]() {
+        uint8_t buffer[256];
+        const int count = client.recv_data(client.get_socket(), buffer, sizeof(buffer));
+        if (count > 0) {
+            EXPECT_TRUE(decoder.feed(buffer, static_cast<size_t>(count)));
+        }
+        core::protocol::FrameView frame;
+        while (decoder.next(frame) == core::protocol::DecodeStatus::FRAME) {
+            received.emplace_back(frame.payload.begin(), frame.payload.end());
+        }
+        return received.size() >= 2;
+    }));
+    EXPECT_EQ(received, (std::vector<std::string>{"ping", "ack:ping"}));
+    EXPECT_TRUE(lookup_refused);
+
+    // The shard loop is still serving API calls
+    EXPECT_EQ(server.get_connection_ids().size(), 1u);
+
+    const std::vector<uint8_t> bye = serialize_data_frame("bye");
+    ASSERT_TRUE(retry_for([&]() {
+        return client.send_data(client.get_socket(), bye.data(), static_cast<int>(bye.size())) ==
+               static_cast<int>(bye.size());
+    }));
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 0u; }));
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, FrameCallbackRepliesThroughItsHandle) {
+    expect_frame_callback_replies(IoEngine::READINESS);
+}
+
+TEST(AsyncServerTest, IoUringFrameCallbackRepliesThroughItsHandle) {
+    if (!IoUringEngine::is_supported()) {
+        GTEST_SKIP() << "io_uring not supported on this system";
+    }
+    expect_frame_callback_replies(IoEngine::IO_URING);
+}
+
+TEST(AsyncServerTest, IoUringEngineEchoesClientData) {
+    if (!IoUringEngine::is_supported()) {
+        GTEST_SKIP() << "io_uring not supported on this system";
+    }
+
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.io_engine = IoEngine::IO_URING;
+    config.uring_queue_depth = 64;
+    config.uring_buffer_count = 16;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    EXPECT_EQ(server.get_io_engine(), IoEngine::IO_URING);
+
+    std::thread loop([&server]() { server.run(20); });
+
+    expect_echo(server, "hello io_uring");
+
+    // Client is gone: teardown goes through cancel + reap on the loop thread
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 0u; }));
+
+    server.stop();
+    loop.join();
+}
+
+#ifndef _WIN32
+TEST(AsyncServerTest, UnixSocketEchoesClientData) {
+    const std::string path = ::testing::TempDir() + "hpams-echo-" + std::to_string(getpid()) + ".sock";
+
+    // Left behind by a listener that died without cleaning up
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    SOCKET stale = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_EQ(bind(stale, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    close_socket(stale);
+
+    {
+        AsyncServer server(1);
+        ASSERT_TRUE(server.start_unix(path));
+        EXPECT_EQ(server.get_listen_path(), path);
+        EXPECT_EQ(server.get_listen_port(), 0u);
+
+        std::thread loop([&server]() { server.run(20); });
+
+        AsyncSocket client(path, 0);
+        ASSERT_TRUE(client.connect_unix(path));
+        expect_round_trip(client, "hello unix socket");
+        EXPECT_EQ(server.get_connection_count(), 1u);
+
+        // A second server must not steal a live socket
+        AsyncServer intruder(1);
+        EXPECT_FALSE(intruder.start_unix(path));
+
+        server.stop();
+        loop.join();
+    }
+
+    struct stat info{};
+    EXPECT_NE(::lstat(path.c_str(), &info), 0) << "socket file left behind";
+}
+#endif
+
+TEST(AsyncServerTest, StaleConnectionIdMissesNextConnection) {
+    AsyncServer server(1);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    uint16_t port = server.get_listen_port();
+
+    std::thread loop([&server]() { server.run(20); });
+
+    auto first = std::make_unique<AsyncSocket>("127.0.0.1", port);
+    ASSERT_TRUE(first->connect("127.0.0.1", port));
+    ASSERT_TRUE(retry_for([&]() { return server.get_connection_count() == 1; }));
+    const ConnectionId first_id = server.get_connection_ids().front();
+
+    const std::string greeting = "hello";
+    EXPECT_TRUE(server.send_to_client(first_id, reinterpret_cast<const uint8_t*>(greeting.data()), greeting.size()));
+    std::string received;
+    EXPECT_TRUE(retry_for([&]() {
+        uint8_t buffer[64];
+        int count = first->recv_data(first->get_socket(), buffer, sizeof(buffer));
+        if (count > 0) {
+            received.append(reinterpret_cast<const char*>(buffer), count);
+        }
+        return received == greeting;
+    }));
+
+    server.close_client(first_id);
+    EXPECT_EQ(server.get_connection_count(), 0u);
+    first.reset();
+
+    // The next client typically gets the same socket number and slot back
+    AsyncSocket second("127.0.0.1", port);
+    ASSERT_TRUE(second.connect("127.0.0.1", port));
+    ASSERT_TRUE(retry_for([&]() { return server.get_connection_count() == 1; }));
+    EXPECT_NE(server.get_connection_ids().front(), first_id);
+
+    EXPECT_FALSE(server.send_to_client(first_id, reinterpret_cast<const uint8_t*>(greeting.data()), greeting.size()));
+    server.close_client(first_id);
+    EXPECT_EQ(server.get_connection_count(), 1u);
+    expect_round_trip(second, "still connected");
+
+    server.stop();
+    loop.join();
+}
+
+#ifdef __linux__
+// Abstract names leave nothing on disk; every shard accepts from the shared socket
+void expect_abstract_unix_echo_on_all_shards(IoEngine engine) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.num_reactor_threads = 2;
+    config.io_engine = engine;
+    config.uring_queue_depth = 64;
+    config.uring_buffer_count = 16;
+
+    const std::string name = "@hpams-test-" + std::to_string(getpid()) + "-" + to_string(engine);
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start_unix(name));
+    ASSERT_EQ(server.get_shard_count(), 2u);
+
+    std::thread loop([&server]() { server.run(20); });
+
+    constexpr size_t NUM_CLIENTS = 16;
+    std::vector<std::unique_ptr<AsyncSocket>> clients;
+    for (size_t i = 0; i < NUM_CLIENTS; ++i) {
+        clients.push_back(std::make_unique<AsyncSocket>(name, 0));
+        ASSERT_TRUE(clients.back()->connect_unix(name));
+        expect_round_trip(*clients.back(), "client " + std::to_string(i));
+    }
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == NUM_CLIENTS; }));
+    EXPECT_EQ(server.get_connection_count(0) + server.get_connection_count(1), NUM_CLIENTS);
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, AbstractUnixSocketServesEveryShard) {
+    expect_abstract_unix_echo_on_all_shards(IoEngine::READINESS);
+}
+
+TEST(AsyncServerTest, IoUringAbstractUnixSocketServesEveryShard) {
+    if (!IoUringEngine::is_supported()) {
+        GTEST_SKIP() << "io_uring not supported on this system";
+    }
+    expect_abstract_unix_echo_on_all_shards(IoEngine::IO_URING);
+}
+#endif
+
+#ifdef __linux__
+TEST(AsyncServerTest, SharedMemoryClientEchoesThroughRings) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.shm_ring_bytes = ShmChannel::MIN_RING_BYTES;
+
+    const std::string name = "@hpams-shm-" + std::to_string(getpid());
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start_shm(name));
+
+    std::thread loop([&server]() { server.run(20); });
+
+    auto client = ShmChannel::connect(name);
+    ASSERT_TRUE(client);
+    EXPECT_EQ(client->ring_capacity(), ShmChannel::MIN_RING_BYTES);
+
+    // Many times the ring size: both directions fill and wait on their doorbells
+    std::string payload(256 * 1024, '\0');
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<char>('a' + i % 26);
+    }
+
+    std::string echoed;
+    size_t sent = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (echoed.size() < payload.size() && std::chrono::steady_clock::now() < deadline) {
+        if (sent < payload.size()) {
+            sent += client->write(reinterpret_cast<const uint8_t*>(payload.data()) + sent, payload.size() - sent);
+        }
+
+        uint8_t buffer[1024];
+        size_t received = client->read(buffer, sizeof(buffer));
+        if (received > 0) {
+            echoed.append(reinterpret_cast<const char*>(buffer), received);
+        } else if (sent == payload.size()) {
+            client->wait_readable(100);
+        }
+    }
+    EXPECT_TRUE(echoed == payload) << "echoed " << echoed.size() << " of " << payload.size() << " bytes";
+    EXPECT_EQ(server.get_connection_count(), 1u);
+
+    // Closing the control socket is the disconnect
+    client.reset();
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 0; }));
+
+    server.stop();
+    loop.join();
+}
+#endif
+
+TEST(AsyncServerTest, ReactorShardsServeClientsAcrossThreads) {
+    if (!AsyncSocket::supports_reuse_port()) {
+        GTEST_SKIP() << "SO_REUSEPORT not supported on this platform";
+    }
+
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.num_reactor_threads = 3;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    ASSERT_EQ(server.get_shard_count(), 3u);
+    uint16_t port = server.get_listen_port();
+
+    std::thread loop([&server]() { server.run(20); });
+
+    constexpr size_t CLIENTS = 8;
+    std::vector<std::unique_ptr<AsyncSocket>> clients;
+    for (size_t i = 0; i < CLIENTS; ++i) {
+        clients.push_back(std::make_unique<AsyncSocket>("127.0.0.1", port));
+        ASSERT_TRUE(clients.back()->connect("127.0.0.1", port));
+    }
+
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == CLIENTS; }));
+    EXPECT_EQ(server.get_connection_count(0) + server.get_connection_count(1) + server.get_connection_count(2),
+              CLIENTS);
+
+    // Broadcast reaches every shard's connections
+    const std::string message = "to all shards";
+    server.broadcast(reinterpret_cast<const uint8_t*>(message.data()), message.size());
+
+    for (auto& client : clients) {
+        std::string received_text;
+        EXPECT_TRUE(retry_for([&]() {
+            uint8_t buffer[64];
+            int received = client->recv_data(client->get_socket(), buffer, sizeof(buffer));
+            if (received > 0) {
+                received_text.append(reinterpret_cast<const char*>(buffer), received);
+            }
+            return received_text.size() >= message.size();
+        }));
+        EXPECT_EQ(received_text, message);
+    }
+
+    clients.clear();
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 0u; }));
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, AcceptAndCloseShedsConnectionsOverLimit) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.max_connections = 2;
+    config.overload_policy = OverloadPolicy::ACCEPT_AND_CLOSE;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    uint16_t port = server.get_listen_port();
+
+    std::thread loop([&server]() { server.run(20); });
+
+    std::vector<std::unique_ptr<AsyncSocket>> clients;
+    for (size_t i = 0; i < 3; ++i) {
+        clients.push_back(std::make_unique<AsyncSocket>("127.0.0.1", port));
+        ASSERT_TRUE(clients.back()->connect("127.0.0.1", port));
+        EXPECT_TRUE(retry_for([&]() {
+            return server.get_connection_count() + server.get_rejected_connection_count() == i + 1;
+        }));
+    }
+
+    EXPECT_EQ(server.get_connection_count(), 2u);
+    EXPECT_EQ(server.get_rejected_connection_count(), 1u);
+    EXPECT_EQ(server.get_paused_listener_count(), 0u);
+
+    // The excess client is closed straight away rather than left in the backlog
+    AsyncSocket& rejected = *clients.back();
+    EXPECT_TRUE(retry_for([&]() {
+        uint8_t buffer[8];
+        return rejected.recv_data(rejected.get_socket(), buffer, sizeof(buffer)) == 0;
+    }));
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, PauseListenerResumesWhenCapacityFrees) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.max_connections = 1;
+    config.overload_policy = OverloadPolicy::PAUSE_LISTENER;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    uint16_t port = server.get_listen_port();
+
+    std::thread loop([&server]() { server.run(20); });
+
+    auto first = std::make_unique<AsyncSocket>("127.0.0.1", port);
+    ASSERT_TRUE(first->connect("127.0.0.1", port));
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 1u; }));
+
+    // Second client waits in the kernel backlog while the listener is paused
+    AsyncSocket second("127.0.0.1", port);
+    ASSERT_TRUE(second.connect("127.0.0.1", port));
+    EXPECT_TRUE(retry_for([&]() { return server.get_paused_listener_count() == 1u; }));
+    EXPECT_EQ(server.get_connection_count(), 1u);
+    EXPECT_EQ(server.get_rejected_connection_count(), 0u);
+
+    // Closing the first frees the slot: the listener resumes and picks up the second
+    first.reset();
+    const std::string message = "from backlog";
+    ASSERT_TRUE(retry_for([&]() {
+        return second.send_data(second.get_socket(), reinterpret_cast<const uint8_t*>(message.data()),
+                                static_cast<int>(message.size())) == static_cast<int>(message.size());
+    }));
+
+    std::string echoed;
+    EXPECT_TRUE(retry_for([&]() {
+        uint8_t buffer[64];
+        int received = second.recv_data(second.get_socket(), buffer, sizeof(buffer));
+        if (received > 0) {
+            echoed.append(reinterpret_cast<const char*>(buffer), received);
+        }
+        return echoed.size() >= message.size();
+    }));
+    EXPECT_EQ(echoed, message);
+    EXPECT_EQ(server.get_connection_count(), 1u);
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, PauseListenerResumesWhenApiThreadCloses) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.max_connections = 1;
+    config.overload_policy = OverloadPolicy::PAUSE_LISTENER;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    uint16_t port = server.get_listen_port();
+
+    // No wait timeout: only a wakeup gets the loop to resume its listener
+    std::thread loop([&server]() { server.run(); });
+
+    AsyncSocket first("127.0.0.1", port);
+    ASSERT_TRUE(first.connect("127.0.0.1", port));
+    ASSERT_TRUE(retry_for([&]() { return server.get_connection_count() == 1u; }));
+
+    AsyncSocket second("127.0.0.1", port);
+    ASSERT_TRUE(second.connect("127.0.0.1", port));
+    ASSERT_TRUE(retry_for([&]() { return server.get_paused_listener_count() == 1u; }));
+
+    const std::vector<ConnectionId> ids = server.get_connection_ids();
+    ASSERT_EQ(ids.size(), 1u);
+    server.close_client(ids.front());
+
+    EXPECT_TRUE(retry_for([&]() {
+        const std::vector<ConnectionId> now = server.get_connection_ids();
+        return now.size() == 1u && now.front() != ids.front();
+    }));
+    EXPECT_EQ(server.get_paused_listener_count(), 1u);  // Full again with the second client
+
+    server.stop_now();
+    loop.join();
+}
+
+#ifdef __linux__
+TEST(AsyncServerTest, ListenerBacksOffWhenOutOfDescriptors) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.accept_retry_ms = 20;
+    config.trace_echo = false;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    uint16_t port = server.get_listen_port();
+    std::thread loop([&server]() { server.run(20); });
+
+    // Cap descriptors so the client's socket takes the last one and the server's accept gets EMFILE
+    rlimit original{};
+    ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &original), 0);
+    const int last = ::dup(0);
+    ASSERT_GE(last, 0);
+    rlimit capped = original;
+    capped.rlim_cur = static_cast<rlim_t>(last) + 1;
+    ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &capped), 0);
+    ::close(last);
+
+    AsyncSocket client("127.0.0.1", port);
+    const bool connected = client.connect("127.0.0.1", port);
+    const bool backed_off = retry_for([&]() { return server.get_accept_backoff_count() > 0u; });
+
+    // Level-triggered listener: without the pause every loop pass would retry the accept
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    const size_t backoffs = server.get_accept_backoff_count();
+    const size_t connections = server.get_connection_count();
+    ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &original), 0);
+
+    ASSERT_TRUE(connected);
+    EXPECT_TRUE(backed_off);
+    EXPECT_LE(backoffs, 20u);
+    EXPECT_EQ(connections, 0u);
+
+    // Descriptors free again: the next retry picks the connection out of the backlog
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 1u; }));
+    expect_round_trip(client, "after backoff");
+
+    server.stop_now();
+    loop.join();
+}
+#endif
+
+TEST(AsyncServerTest, EchoesPayloadLargerThanSocketBuffers) {
+    AsyncServer server(1);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    uint16_t port = server.get_listen_port();
+
+    std::thread loop([&server]() { server.run(20); });
+
+    AsyncSocket client("127.0.0.1", port);
+    ASSERT_TRUE(client.connect("127.0.0.1", port));
+
+    // Far beyond the old 4 KB write buffer; the server has to queue and flush in pieces
+    std::vector<uint8_t> payload(4 * 1024 * 1024);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<uint8_t>(i * 31);
+    }
+
+    size_t sent = 0;
+    std::vector<uint8_t> echoed;
+    echoed.reserve(payload.size());
+
+    EXPECT_TRUE(retry_for([&]() {
+        if (sent < payload.size()) {
+            int chunk = static_cast<int>(std::min<size_t>(64 * 1024, payload.size() - sent));
+            int result = client.send_data(client.get_socket(), payload.data() + sent, chunk);
+            if (result > 0) {
+                sent += static_cast<size_t>(result);
+            }
+        }
+
+        uint8_t buffer[64 * 1024];
+        int received = client.recv_data(client.get_socket(), buffer, sizeof(buffer));
+        if (received > 0) {
+            echoed.insert(echoed.end(), buffer, buffer + received);
+        }
+        return echoed.size() >= payload.size();
+    }, std::chrono::milliseconds(10000)));
+
+    EXPECT_EQ(echoed.size(), payload.size());
+    EXPECT_TRUE(echoed == payload);
+
+    server.stop();
+    loop.join();
+}
+
+// Client writes without reading until the server reports backpressure, then drains
+void expect_reads_pause_until_output_drains(IoEngine engine) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.io_engine = engine;
+    config.output_high_watermark = 64 * 1024;
+    config.output_low_watermark = 16 * 1024;
+
+    AsyncServer server(config);
+    std::atomic<size_t> paused{0};
+    std::atomic<size_t> resumed{0};
+    server.set_watermark_callback([&](ConnectionId connection, bool above_high_watermark) {
+        EXPECT_NE(connection, INVALID_CONNECTION_ID);
+        (above_high_watermark ? paused : resumed).fetch_add(1);
+    });
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    uint16_t port = server.get_listen_port();
+
+    std::thread loop([&server]() { server.run(20); });
+
+    AsyncSocket client("127.0.0.1", port);
+    ASSERT_TRUE(client.connect("127.0.0.1", port));
+
+    std::vector<uint8_t> chunk(64 * 1024);
+    size_t sent = 0;
+    EXPECT_TRUE(retry_for([&]() {
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            chunk[i] = static_cast<uint8_t>((sent + i) * 7);
+        }
+        int result = client.send_data(client.get_socket(), chunk.data(), static_cast<int>(chunk.size()));
+        if (result > 0) {
+            sent += static_cast<size_t>(result);
+        }
+        return paused.load() > 0;
+    }, std::chrono::milliseconds(10000)));
+
+    size_t received = 0;
+    bool intact = true;
+    EXPECT_TRUE(retry_for([&]() {
+        uint8_t buffer[64 * 1024];
+        int result = client.recv_data(client.get_socket(), buffer, sizeof(buffer));
+        for (int i = 0; i < result; ++i) {
+            intact = intact && buffer[i] == static_cast<uint8_t>((received + i) * 7);
+        }
+        if (result > 0) {
+            received += static_cast<size_t>(result);
+        }
+        return received >= sent;
+    }, std::chrono::milliseconds(10000)));
+
+    EXPECT_EQ(received, sent);
+    EXPECT_TRUE(intact);
+    EXPECT_GT(resumed.load(), 0u);
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, SlowReaderPausesReadsUntilOutputDrains) {
+    expect_reads_pause_until_output_drains(IoEngine::READINESS);
+}
+
+TEST(AsyncServerTest, IoUringSlowReaderPausesReadsUntilOutputDrains) {
+    if (!IoUringEngine::is_supported()) {
+        GTEST_SKIP() << "io_uring not supported on this system";
+    }
+    expect_reads_pause_until_output_drains(IoEngine::IO_URING);
+}
+
+TEST(AsyncServerTest, WatermarkCallbackMayCloseTheConnection) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.output_high_watermark = 64 * 1024;
+    config.output_low_watermark = 16 * 1024;
+
+    AsyncServer server(config);
+    std::atomic<size_t> closed{0};
+    server.set_watermark_callback([&](ConnectionId connection, bool above_high_watermark) {
+        if (above_high_watermark) {
+            // Runs outside the shard lock: the server's own API is usable here
+            server.close_client(connection);
+            closed.fetch_add(1);
+        }
+    });
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    std::thread loop([&server]() { server.run(20); });
+
+    AsyncSocket client("127.0.0.1", server.get_listen_port());
+    ASSERT_TRUE(client.connect("127.0.0.1", server.get_listen_port()));
+
+    // Write without reading the echo until the server gives up on us
+    std::vector<uint8_t> chunk(64 * 1024);
+    EXPECT_TRUE(retry_for([&]() {
+        if (client.send_data(client.get_socket(), chunk.data(), static_cast<int>(chunk.size())) < 0 &&
+            !is_would_block(last_socket_error())) {
+            return true;    // Reset by the close
+        }
+        return closed.load() > 0;
+    }, std::chrono::milliseconds(10000)));
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 0u; }));
+    EXPECT_TRUE(server.get_connection_ids().empty());
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, BroadcastSharesOnePayloadAcrossConnections) {
+    AsyncServer server(1);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    uint16_t port = server.get_listen_port();
+
+    std::thread loop([&server]() { server.run(20); });
+
+    constexpr size_t CLIENTS = 4;
+    std::vector<std::unique_ptr<AsyncSocket>> clients;
+    for (size_t i = 0; i < CLIENTS; ++i) {
+        clients.push_back(std::make_unique<AsyncSocket>("127.0.0.1", port));
+        ASSERT_TRUE(clients.back()->connect("127.0.0.1", port));
+    }
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == CLIENTS; }));
+
+    const std::string message = "serialized once";
+    SharedBuffer payload = SharedBuffer::copy_of(reinterpret_cast<const uint8_t*>(message.data()), message.size());
+    server.broadcast(payload);
+
+    for (auto& client : clients) {
+        std::string received_text;
+        EXPECT_TRUE(retry_for([&]() {
+            uint8_t buffer[64];
+            int received = client->recv_data(client->get_socket(), buffer, sizeof(buffer));
+            if (received > 0) {
+                received_text.append(reinterpret_cast<const char*>(buffer), received);
+            }
+            return received_text.size() >= message.size();
+        }));
+        EXPECT_EQ(received_text, message);
+    }
+
+    // Every connection let go of its reference once the bytes were sent
+    EXPECT_TRUE(retry_for([&]() { return payload.use_count() == 1; }));
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, LargeBroadcastUsesZeroCopyAndReleasesPayload) {
+    if (!ZEROCOPY_SUPPORTED) {
+        GTEST_SKIP() << "MSG_ZEROCOPY not supported on this platform";
+    }
+
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.zerocopy_threshold = 16 * 1024;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    uint16_t port = server.get_listen_port();
+
+    std::thread loop([&server]() { server.run(20); });
+
+    AsyncSocket client("127.0.0.1", port);
+    ASSERT_TRUE(client.connect("127.0.0.1", port));
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 1u; }));
+
+    std::vector<uint8_t> bytes(256 * 1024);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 13);
+    }
+    SharedBuffer payload = SharedBuffer::copy_of(bytes.data(), bytes.size());
+
+    // Small frames stay on the copying path
+    const uint8_t small[] = {1, 2, 3};
+    server.broadcast(small, sizeof(small));
+    server.broadcast(payload);
+
+    std::vector<uint8_t> received;
+    EXPECT_TRUE(retry_for([&]() {
+        uint8_t buffer[64 * 1024];
+        int result = client.recv_data(client.get_socket(), buffer, sizeof(buffer));
+        if (result > 0) {
+            received.insert(received.end(), buffer, buffer + result);
+        }
+        return received.size() >= sizeof(small) + bytes.size();
+    }, std::chrono::milliseconds(5000)));
+
+    ASSERT_EQ(received.size(), sizeof(small) + bytes.size());
+    EXPECT_TRUE(std::equal(bytes.begin(), bytes.end(), received.begin() + sizeof(small)));
+
+    if (server.get_zerocopy_send_count() + server.get_zerocopy_fallback_count() == 0) {
+        // SO_ZEROCOPY refused by this kernel: the copying path carried the data
+        GTEST_SKIP() << "kernel refused SO_ZEROCOPY";
+    }
+
+    // The kernel's completion notifications release the last reference
+    EXPECT_TRUE(retry_for([&]() { return payload.use_count() == 1; }));
+
+    // Loopback copies every send: each one moves over to the fallback count instead of being in both
+    EXPECT_EQ(server.get_zerocopy_send_count(), 0u);
+    EXPECT_GT(server.get_zerocopy_fallback_count(), 0u);
+
+    server.stop();
+    loop.join();
+}
+
+// Wait until the server closes the client's connection
+bool wait_for_server_close(AsyncSocket& client, std::chrono::milliseconds timeout) {
+    return retry_for([&]() {
+        uint8_t buffer[256];
+        return client.recv_data(client.get_socket(), buffer, sizeof(buffer)) == 0;
+    }, timeout);
+}
+
+TEST(AsyncServerTest, IdleConnectionIsClosedButActiveOneSurvives) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.idle_timeout_ms = 300;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    uint16_t port = server.get_listen_port();
+
+    std::thread loop([&server]() { server.run(INFINITE); });
+
+    AsyncSocket idle("127.0.0.1", port);
+    AsyncSocket active("127.0.0.1", port);
+    ASSERT_TRUE(idle.connect("127.0.0.1", port));
+    ASSERT_TRUE(active.connect("127.0.0.1", port));
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 2u; }));
+
+    // Keep one connection talking for longer than the idle timeout
+    const auto start = std::chrono::steady_clock::now();
+    const uint8_t byte = 'x';
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(600)) {
+        EXPECT_EQ(active.send_data(active.get_socket(), &byte, 1), 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    EXPECT_TRUE(wait_for_server_close(idle, std::chrono::milliseconds(2000)));
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 1u; }));
+
+    EXPECT_TRUE(wait_for_server_close(active, std::chrono::milliseconds(2000)));
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 0u; }));
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, SilentClientMissesHandshakeDeadline) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.io_engine = IoUringEngine::is_supported() ? IoEngine::IO_URING : IoEngine::READINESS;
+    config.handshake_timeout_ms = 100;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    uint16_t port = server.get_listen_port();
+
+    std::thread loop([&server]() { server.run(INFINITE); });
+
+    AsyncSocket client("127.0.0.1", port);
+    ASSERT_TRUE(client.connect("127.0.0.1", port));
+    EXPECT_TRUE(wait_for_server_close(client, std::chrono::milliseconds(2000)));
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 0u; }));
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, HeartbeatSendsPingFrames) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.heartbeat_interval_ms = 50;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    uint16_t port = server.get_listen_port();
+
+    std::thread loop([&server]() { server.run(INFINITE); });
+
+    AsyncSocket client("127.0.0.1", port);
+    ASSERT_TRUE(client.connect("127.0.0.1", port));
+
+    std::vector<uint8_t> received;
+    EXPECT_TRUE(retry_for([&]() {
+        uint8_t buffer[256];
+        int result = client.recv_data(client.get_socket(), buffer, sizeof(buffer));
+        if (result > 0) {
+            received.insert(received.end(), buffer, buffer + result);
+        }
+        return received.size() >= 2 * core::protocol::MIN_FRAME_SIZE;
+    }));
+
+    ASSERT_GE(received.size(), 2 * core::protocol::MIN_FRAME_SIZE);
+    for (size_t offset = 0; offset + core::protocol::MIN_FRAME_SIZE <= received.size();
+         offset += core::protocol::MIN_FRAME_SIZE) {
+        EXPECT_EQ(received[offset], core::protocol::PROTOCOL_MAGIC);
+        EXPECT_EQ(received[offset + 2], static_cast<uint8_t>(core::protocol::MessageType::PING));
+    }
+
+    server.stop();
+    loop.join();
+}
+
+// Connect one client and queue payload_bytes for it without the client reading
+ConnectionId connect_and_queue(AsyncServer& server, AsyncSocket& client, size_t payload_bytes,
+                               std::vector<uint8_t>& payload) {
+    uint16_t port = server.get_listen_port();
+    EXPECT_TRUE(client.connect("127.0.0.1", port));
+    EXPECT_TRUE(retry_for([&]() { return server.get_connection_count() == 1u; }));
+
+    const auto ids = server.get_connection_ids();
+    if (ids.size() != 1) {
+        return INVALID_CONNECTION_ID;
+    }
+
+    payload.resize(payload_bytes);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<uint8_t>(i * 13);
+    }
+    EXPECT_TRUE(server.send_to_client(ids[0], payload.data(), payload.size()));
+    return ids[0];
+}
+
+// Stop with more output queued than the socket buffers hold: all of it must still arrive
+void expect_stop_drains_output(IoEngine engine) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.io_engine = engine;
+    config.drain_timeout_ms = 10000;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    std::thread loop([&server]() { server.run(20); });
+
+    AsyncSocket client("127.0.0.1", server.get_listen_port());
+    std::vector<uint8_t> payload;
+    ASSERT_NE(connect_and_queue(server, client, 8 * 1024 * 1024, payload), INVALID_CONNECTION_ID);
+
+    std::thread stopper([&server]() { server.stop(); });
+    EXPECT_TRUE(retry_for([&]() { return server.is_draining() || !server.is_running(); }));
+
+    std::vector<uint8_t> received;
+    EXPECT_TRUE(retry_for([&]() {
+        uint8_t buffer[64 * 1024];
+        int result = client.recv_data(client.get_socket(), buffer, sizeof(buffer));
+        if (result > 0) {
+            received.insert(received.end(), buffer, buffer + result);
+        }
+        return result == 0;
+    }, std::chrono::milliseconds(10000)));
+
+    stopper.join();
+    loop.join();
+    EXPECT_FALSE(server.is_running());
+    EXPECT_EQ(server.get_connection_count(), 0u);
+
+    // Queued output first, then the going-away notice, then the close
+    constexpr size_t NOTICE_PAYLOAD = 3 + 10;   // status_code, error_code, "going away"
+    ASSERT_EQ(received.size(), payload.size() + core::protocol::MIN_FRAME_SIZE + NOTICE_PAYLOAD);
+    EXPECT_TRUE(std::equal(payload.begin(), payload.end(), received.begin()));
+
+    const uint8_t* notice = received.data() + payload.size();
+    EXPECT_EQ(notice[0], core::protocol::PROTOCOL_MAGIC);
+    EXPECT_EQ(notice[2], static_cast<uint8_t>(core::protocol::MessageType::STATUS));
+    EXPECT_EQ(notice[core::protocol::FRAME_HEADER_SIZE], core::protocol::messages::STATUS_GOING_AWAY);
+}
+
+TEST(AsyncServerTest, StopDrainsQueuedOutputBeforeClosing) {
+    expect_stop_drains_output(IoEngine::READINESS);
+}
+
+TEST(AsyncServerTest, IoUringStopDrainsQueuedOutputBeforeClosing) {
+    if (!IoUringEngine::is_supported()) {
+        GTEST_SKIP() << "io_uring not supported on this system";
+    }
+    expect_stop_drains_output(IoEngine::IO_URING);
+}
+
+TEST(AsyncServerTest, DrainDeadlineBoundsStop) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.drain_timeout_ms = 200;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    std::thread loop([&server]() { server.run(INFINITE); });
+
+    // The client never reads, so the queue can't drain
+    AsyncSocket client("127.0.0.1", server.get_listen_port());
+    std::vector<uint8_t> payload;
+    ASSERT_NE(connect_and_queue(server, client, 32 * 1024 * 1024, payload), INVALID_CONNECTION_ID);
+
+    const auto start = std::chrono::steady_clock::now();
+    server.stop();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    loop.join();
+
+    EXPECT_GE(elapsed, std::chrono::milliseconds(150));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(5000));
+    EXPECT_EQ(server.get_connection_count(), 0u);
+}
+
+TEST(AsyncServerTest, StopNowSkipsTheDrain) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.drain_timeout_ms = 60000;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    std::thread loop([&server]() { server.run(INFINITE); });
+
+    AsyncSocket client("127.0.0.1", server.get_listen_port());
+    std::vector<uint8_t> payload;
+    ASSERT_NE(connect_and_queue(server, client, 32 * 1024 * 1024, payload), INVALID_CONNECTION_ID);
+
+    const auto start = std::chrono::steady_clock::now();
+    server.stop_now();
+    loop.join();
+
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(2000));
+    EXPECT_FALSE(server.is_draining());
+    EXPECT_EQ(server.get_connection_count(), 0u);
+}
+
+// Send payload while collecting the echo; returns how long the round trip took
+std::chrono::milliseconds echo_bulk(AsyncSocket& client, const std::vector<uint8_t>& payload) {
+    const auto start = std::chrono::steady_clock::now();
+    size_t sent = 0;
+    size_t received = 0;
+    bool intact = true;
+
+    EXPECT_TRUE(retry_for([&]() {
+        if (sent < payload.size()) {
+            int result = client.send_data(client.get_socket(), payload.data() + sent,
+                                          static_cast<int>(std::min<size_t>(64 * 1024, payload.size() - sent)));
+            if (result > 0) {
+                sent += static_cast<size_t>(result);
+            }
+        }
+
+        uint8_t buffer[64 * 1024];
+        int result = client.recv_data(client.get_socket(), buffer, sizeof(buffer));
+        for (int i = 0; i < result; ++i) {
+            intact = intact && buffer[i] == payload[received + i];
+        }
+        if (result > 0) {
+            received += static_cast<size_t>(result);
+        }
+        return received == payload.size();
+    }, std::chrono::milliseconds(10000)));
+
+    EXPECT_TRUE(intact);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+}
+
+TEST(AsyncServerTest, ByteRateLimitPacesReads) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.timer_tick_ms = 1;
+    config.connection_rate_limits.bytes_per_second = 1024 * 1024;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    std::thread loop([&server]() { server.run(20); });
+
+    AsyncSocket client("127.0.0.1", server.get_listen_port());
+    ASSERT_TRUE(client.connect("127.0.0.1", server.get_listen_port()));
+
+    // One second's burst, then another megabyte at 1 MB/s
+    std::vector<uint8_t> payload(2 * 1024 * 1024);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<uint8_t>(i * 11);
+    }
+    EXPECT_GE(echo_bulk(client, payload), std::chrono::milliseconds(800));
+    EXPECT_GT(server.get_rate_limited_count(), 0u);
+
+    // Lifting the limit at runtime applies to the open connection
+    server.set_rate_limits(RateLimits{}, RateLimits{});
+    const size_t pauses = server.get_rate_limited_count();
+    EXPECT_LT(echo_bulk(client, payload), std::chrono::milliseconds(800));
+    EXPECT_LE(server.get_rate_limited_count(), pauses + 1);
+
+    server.stop();
+    loop.join();
+}
+
+TEST(AsyncServerTest, AddressRateLimitIsSharedByConnections) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.timer_tick_ms = 1;
+    config.address_rate_limits.messages_per_second = 20;
+
+    AsyncServer server(config);
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    std::thread loop([&server]() { server.run(20); });
+
+    // Each connection alone stays within 20 messages; together they exceed it
+    constexpr int NUM_CLIENTS = 4;
+    constexpr int MESSAGES_PER_CLIENT = 10;
+    std::vector<std::unique_ptr<AsyncSocket>> clients;
+    for (int i = 0; i < NUM_CLIENTS; ++i) {
+        clients.push_back(std::make_unique<AsyncSocket>("127.0.0.1", server.get_listen_port()));
+        ASSERT_TRUE(clients.back()->connect("127.0.0.1", server.get_listen_port()));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < MESSAGES_PER_CLIENT; ++round) {
+        for (auto& client : clients) {
+            expect_round_trip(*client, "m" + std::to_string(round));
+        }
+    }
+
+    // 40 messages at 20/s with a 20 message burst: about a second
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(700));
+    EXPECT_GT(server.get_rate_limited_count(), 0u);
+
+    server.stop();
+    loop.join();
+}
+
+void expect_frames_paced_by_message_limit(IoEngine engine) {
+    ServerConfig config;
+    config.num_worker_threads = 1;
+    config.io_engine = engine;
+    config.timer_tick_ms = 1;
+    config.connection_rate_limits.messages_per_second = 100;
+
+    AsyncServer server(config);
+    std::atomic<size_t> frames{0};
+    server.set_frame_callback([&frames](AsyncServer::FrameReply& reply, const core::protocol::FrameView&) {
+        if (++frames == 200u) {
+            const std::string done = "done";
+            reply.send(reinterpret_cast<const uint8_t*>(done.data()), done.size());
+        }
+    });
+    ASSERT_TRUE(server.start("127.0.0.1", 0));
+    std::thread loop([&server]() { server.run(20); });
+
+    AsyncSocket client("127.0.0.1", server.get_listen_port());
+    ASSERT_TRUE(client.connect("127.0.0.1", server.get_listen_port()));
+
+    // 200 frames in one send: one or two reads, but two seconds' worth of messages
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 200; ++i) {
+        const std::vector<uint8_t> frame = serialize_data_frame("m" + std::to_string(i));
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    ASSERT_TRUE(retry_for([&]() {
+        return client.send_data(client.get_socket(), stream.data(), static_cast<int>(stream.size())) ==
+               static_cast<int>(stream.size());
+    }));
+
+    // The burst is dispatched, the rest waits in the decoder
+    EXPECT_TRUE(retry_for([&]() { return frames.load() > 0u; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_LT(frames.load(), 200u);
+    EXPECT_TRUE(retry_for([&]() { return server.get_rate_limited_count() > 0u; }));
+
+    // Buffered frames drain as the bucket refills, with nothing more sent; the echo is followed by the reply
+    EXPECT_TRUE(retry_for([&]() { return frames.load() == 200u; }, std::chrono::milliseconds(5000)));
+    std::string received;
+    EXPECT_TRUE(retry_for([&]() {
+        uint8_t buffer[4096];
+        const int result = client.recv_data(client.get_socket(), buffer, sizeof(buffer));
+        if (result > 0) {
+            received.append(reinterpret_cast<const char*>(buffer), static_cast<size_t>(result));
+        }
+        return received.size() == stream.size() + 4;
+    }));
+    EXPECT_EQ(received.substr(stream.size()), "done");
+
+    server.stop_now();
+    loop.join();
+}
+
+TEST(AsyncServerTest, MessageRateLimitCountsDecodedFrames) {
+    expect_frames_paced_by_message_limit(IoEngine::READINESS);
+}
+
+TEST(AsyncServerTest, IoUringMessageRateLimitCountsDecodedFrames) {
+    if (!IoUringEngine::is_supported()) {
+        GTEST_SKIP() << "io_uring not supported on this system";
+    }
+    expect_frames_paced_by_message_limit(IoEngine::IO_URING);
+}
+
+// ============ Socket Options Tests ============
+
+int get_int_option(SOCKET socket, int level, int option) {
+    int value = 0;
+    socklen_t length = sizeof(value);
+    EXPECT_EQ(getsockopt(socket, level, option, reinterpret_cast<char*>(&value), &length), 0);
+    return value;
+}
+
+// Accept one loopback connection on a listener created with the given profile
+SOCKET accept_with_profile(SocketProfile profile, AsyncSocket& listener, AsyncSocket& client) {
+    listener.set_options(SocketOptions::for_profile(profile));
+    EXPECT_TRUE(listener.create_listening_socket("127.0.0.1", 0));
+    EXPECT_TRUE(client.connect("127.0.0.1", listener.get_local_port()));
+
+    SOCKET accepted = INVALID_SOCKET;
+    PeerAddress peer;
+    EXPECT_TRUE(retry_for([&]() {
+        accepted = listener.accept_connection(peer);
+        return accepted != INVALID_SOCKET;
+    }));
+    return accepted;
+}
+
+TEST(SocketOptionsTest, ProfilesSelectTheirOptions) {
+    EXPECT_TRUE(SocketOptions::for_profile(SocketProfile::DEFAULT).is_default());
+
+    const SocketOptions latency = SocketOptions::for_profile(SocketProfile::LATENCY);
+    EXPECT_TRUE(latency.no_delay);
+    EXPECT_GT(latency.busy_poll_us, 0);
+    EXPECT_EQ(latency.send_buffer_bytes, 0);
+
+    const SocketOptions throughput = SocketOptions::for_profile(SocketProfile::THROUGHPUT);
+    EXPECT_FALSE(throughput.no_delay);
+    EXPECT_EQ(throughput.cork_flushes, cork_supported());
+    EXPECT_GT(throughput.send_buffer_bytes, 0);
+    EXPECT_GT(throughput.receive_buffer_bytes, 0);
+}
+
+TEST(SocketOptionsTest, AcceptedSocketsGetListenerProfile) {
+    AsyncSocket latency_listener("127.0.0.1", 0);
+    AsyncSocket latency_client("127.0.0.1", 0);
+    SOCKET latency = accept_with_profile(SocketProfile::LATENCY, latency_listener, latency_client);
+    ASSERT_NE(latency, INVALID_SOCKET);
+    EXPECT_NE(get_int_option(latency, IPPROTO_TCP, TCP_NODELAY), 0);
+
+    AsyncSocket default_listener("127.0.0.1", 0);
+    AsyncSocket default_client("127.0.0.1", 0);
+    SOCKET plain = accept_with_profile(SocketProfile::DEFAULT, default_listener, default_client);
+    ASSERT_NE(plain, INVALID_SOCKET);
+    EXPECT_EQ(get_int_option(plain, IPPROTO_TCP, TCP_NODELAY), 0);
+
+    AsyncSocket throughput_listener("127.0.0.1", 0);
+    AsyncSocket throughput_client("127.0.0.1", 0);
+    SOCKET bulk = accept_with_profile(SocketProfile::THROUGHPUT, throughput_listener, throughput_client);
+    ASSERT_NE(bulk, INVALID_SOCKET);
+    EXPECT_GT(get_int_option(bulk, SOL_SOCKET, SO_RCVBUF), get_int_option(plain, SOL_SOCKET, SO_RCVBUF));
+
+    close_socket(latency);
+    close_socket(plain);
+    close_socket(bulk);
+}
+
+TEST(SocketOptionsTest, CorkedFlushStillDeliversTheTail) {
+    if (!cork_supported()) {
+        GTEST_SKIP() << "TCP_CORK not supported";
+    }
+
+    AsyncSocket listener("127.0.0.1", 0);
+    AsyncSocket client("127.0.0.1", 0);
+    SOCKET server_side = accept_with_profile(SocketProfile::THROUGHPUT, listener, client);
+    ASSERT_NE(server_side, INVALID_SOCKET);
+
+    // Far less than a segment: without the uncork at the end of the flush it would sit in the kernel
+    ConnectionHandler handler(server_side, "127.0.0.1", 0);
+    handler.set_cork_flushes(true);
+    const std::string message = "tail";
+    ASSERT_TRUE(handler.send_data(reinterpret_cast<const uint8_t*>(message.data()), message.size()));
+#ifdef TCP_CORK
+    EXPECT_EQ(get_int_option(server_side, IPPROTO_TCP, TCP_CORK), 0);
+#endif
+
+    char buffer[16] = {};
+    int received = 0;
+    EXPECT_TRUE(retry_for([&]() {
+        received = client.recv_data(client.get_socket(), reinterpret_cast<uint8_t*>(buffer), sizeof(buffer));
+        return received > 0;
+    }, std::chrono::milliseconds(100)));
+    EXPECT_EQ(std::string(buffer, received > 0 ? static_cast<size_t>(received) : 0), message);
+}
+
+TEST(AsyncServerTest, SocketProfilesEchoBulkPayload) {
+    std::vector<uint8_t> payload(1024 * 1024);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    for (SocketProfile profile : {SocketProfile::LATENCY, SocketProfile::THROUGHPUT}) {
+        SCOPED_TRACE(to_string(profile));
+        ServerConfig config;
+        config.num_worker_threads = 1;
+        config.socket_profile = profile;
+
+        AsyncServer server(config);
+        ASSERT_TRUE(server.start("127.0.0.1", 0));
+        std::thread loop([&server]() { server.run(20); });
+
+        AsyncSocket client("127.0.0.1", server.get_listen_port());
+        ASSERT_TRUE(client.connect("127.0.0.1", server.get_listen_port()));
+        expect_round_trip(client, "small");
+        echo_bulk(client, payload);
+
+        server.stop();
+        loop.join();
+    }
+}
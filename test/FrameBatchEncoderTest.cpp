@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include "FrameBatchEncoder.h"
+#include "FrameDecoder.h"
+#include "MessageSerializer.h"
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace core::protocol;
+using core::net::IoSlice;
+
+namespace {
+
+FrameHeader make_header(MessageType type, uint8_t flags = 0, uint16_t reserved = 0) {
+    return FrameHeader{PROTOCOL_MAGIC, PROTOCOL_VERSION, static_cast<uint8_t>(type), flags, 0, reserved};
+}
+
+std::span<const uint8_t> bytes_of(const std::string& text) {
+    return std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+std::vector<uint8_t> serialize(FrameHeader header, const std::string& text) {
+    header.payload_length = static_cast<uint16_t>(text.size());
+    core::net::NetworkBuffer buffer(MIN_FRAME_SIZE + text.size());
+    EXPECT_TRUE(MessageSerializer::serialize_frame(header, reinterpret_cast<const uint8_t*>(text.data()),
+                                                   header.payload_length, buffer));
+    return std::vector<uint8_t>(buffer.data(), buffer.data() + buffer.write_pos());
+}
+
+std::vector<uint8_t> flatten(std::span<const IoSlice> slices) {
+    std::vector<uint8_t> bytes;
+    for (const IoSlice& slice : slices) {
+        const uint8_t* data = core::net::io_slice_data(slice);
+        bytes.insert(bytes.end(), data, data + core::net::io_slice_length(slice));
+    }
+    return bytes;
+}
+
+} // namespace
+
+TEST(FrameBatchEncoderTest, MatchesSerializeFrame) {
+    const std::vector<std::string> payloads = {"first", "", "third frame", std::string(5000, 'z')};
+    FrameBatchEncoder encoder;
+    std::vector<uint8_t> expected;
+
+    for (size_t i = 0; i < payloads.size(); ++i) {
+        const uint8_t flags = (i % 2) ? static_cast<uint8_t>(FrameFlags::CRC32C) : 0;
+        const FrameHeader header = make_header(MessageType::DATA, flags, static_cast<uint16_t>(i));
+        ASSERT_TRUE(encoder.add(header, bytes_of(payloads[i])));
+
+        const std::vector<uint8_t> frame = serialize(header, payloads[i]);
+        expected.insert(expected.end(), frame.begin(), frame.end());
+    }
+
+    EXPECT_EQ(encoder.get_frame_count(), payloads.size());
+    EXPECT_EQ(encoder.get_pending_bytes(), expected.size());
+    EXPECT_EQ(flatten(encoder.slices()), expected);
+}
+
+TEST(FrameBatchEncoderTest, PayloadsAreNotCopied) {
+    const std::string one = "payload one";
+    const std::string two = "payload two";
+    FrameBatchEncoder encoder;
+    ASSERT_TRUE(encoder.add(make_header(MessageType::ECHO), bytes_of(one)));
+    ASSERT_TRUE(encoder.add(make_header(MessageType::ECHO), bytes_of(two)));
+
+    // header | one | checksum+header | two | checksum
+    const auto slices = encoder.slices();
+    ASSERT_EQ(slices.size(), 5u);
+    EXPECT_EQ(core::net::io_slice_data(slices[1]), reinterpret_cast<const uint8_t*>(one.data()));
+    EXPECT_EQ(core::net::io_slice_data(slices[3]), reinterpret_cast<const uint8_t*>(two.data()));
+    EXPECT_EQ(core::net::io_slice_length(slices[2]), sizeof(uint32_t) + FRAME_HEADER_SIZE);
+}
+
+TEST(FrameBatchEncoderTest, EmptyPayloadsMergeIntoOneSlice) {
+    FrameBatchEncoder encoder;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(encoder.add(make_header(MessageType::PING), {}));
+    }
+    ASSERT_EQ(encoder.slices().size(), 1u);
+    EXPECT_EQ(encoder.get_pending_bytes(), 10 * MIN_FRAME_SIZE);
+}
+
+TEST(FrameBatchEncoderTest, RefusesWhenFullOrInvalid) {
+    FrameBatchEncoder encoder(2);
+    const std::string text = "x";
+    EXPECT_TRUE(encoder.add(make_header(MessageType::DATA), bytes_of(text)));
+
+    FrameHeader bad = make_header(MessageType::DATA);
+    bad.magic = 0;
+    EXPECT_FALSE(encoder.add(bad, bytes_of(text)));
+    EXPECT_FALSE(encoder.add(make_header(MessageType::DATA), bytes_of(std::string(MAX_PAYLOAD_SIZE + 1, 'x'))));
+
+    EXPECT_TRUE(encoder.add(make_header(MessageType::DATA), bytes_of(text)));
+    EXPECT_TRUE(encoder.full());
+    EXPECT_FALSE(encoder.add(make_header(MessageType::DATA), bytes_of(text)));
+    EXPECT_EQ(encoder.get_frame_count(), 2u);
+
+    encoder.clear();
+    EXPECT_TRUE(encoder.empty());
+    EXPECT_TRUE(encoder.add(make_header(MessageType::DATA), bytes_of(text)));
+}
+
+TEST(FrameBatchEncoderTest, MaxFramesFitsOneSend) {
+    FrameBatchEncoder encoder(1u << 20);
+    EXPECT_LE(2 * encoder.get_max_frames() + 1, core::net::MAX_IO_SLICES);
+}
+
+TEST(FrameBatchEncoderTest, ConsumeResumesPartialSends) {
+    const std::vector<std::string> payloads = {"alpha", "bravo charlie", "", "delta"};
+    FrameBatchEncoder encoder;
+    for (const std::string& text : payloads) {
+        ASSERT_TRUE(encoder.add(make_header(MessageType::DATA), bytes_of(text)));
+    }
+    const std::vector<uint8_t> all = flatten(encoder.slices());
+
+    // Send in odd-sized pieces, cutting through slices at every kind of boundary
+    std::vector<uint8_t> sent;
+    while (!encoder.empty()) {
+        const std::vector<uint8_t> rest = flatten(encoder.slices());
+        ASSERT_EQ(rest.size(), encoder.get_pending_bytes());
+        const size_t piece = std::min<size_t>(7, rest.size());
+        sent.insert(sent.end(), rest.begin(), rest.begin() + piece);
+        encoder.consume(piece);
+        // A batch being sent takes no more frames
+        if (!encoder.empty()) {
+            EXPECT_FALSE(encoder.add(make_header(MessageType::DATA), {}));
+        }
+    }
+    EXPECT_EQ(sent, all);
+    EXPECT_EQ(encoder.get_frame_count(), 0u);
+    EXPECT_TRUE(encoder.slices().empty());
+}
+
+#ifndef _WIN32
+TEST(FrameBatchEncoderTest, WholeBatchGoesOutInOneSend) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    std::vector<std::string> payloads;
+    FrameBatchEncoder encoder;
+    for (size_t i = 0; i < encoder.get_max_frames(); ++i) {
+        payloads.push_back("frame " + std::to_string(i));
+    }
+    for (const std::string& text : payloads) {
+        ASSERT_TRUE(encoder.add(make_header(MessageType::DATA), bytes_of(text)));
+    }
+
+    const auto slices = encoder.slices();
+    const int64_t sent = core::net::send_slices(fds[0], slices.data(), slices.size());
+    ASSERT_EQ(static_cast<size_t>(sent), encoder.get_pending_bytes());
+    encoder.consume(static_cast<size_t>(sent));
+    EXPECT_TRUE(encoder.empty());
+
+    FrameDecoder decoder;
+    FrameView frame;
+    size_t received = 0;
+    while (received < payloads.size()) {
+        uint8_t* space = decoder.prepare(4096);
+        ASSERT_NE(space, nullptr);
+        const ssize_t n = ::recv(fds[1], space, decoder.get_writable(), 0);
+        ASSERT_GT(n, 0);
+        decoder.commit(static_cast<size_t>(n));
+        while (decoder.next(frame) == DecodeStatus::FRAME) {
+            ASSERT_LT(received, payloads.size());
+            EXPECT_EQ(std::string(frame.payload.begin(), frame.payload.end()), payloads[received]);
+            ++received;
+        }
+        ASSERT_FALSE(decoder.is_failed());
+    }
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+#endif
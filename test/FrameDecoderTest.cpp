@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "FrameDecoder.h"
+#include "MessageSerializer.h"
+#include <string>
+#include <vector>
+
+using namespace core::protocol;
+
+namespace {
+
+std::vector<uint8_t> make_frame(MessageType type, const std::string& text, uint16_t reserved = 0,
+                                uint8_t flags = 0) {
+    FrameHeader header{PROTOCOL_MAGIC, PROTOCOL_VERSION, static_cast<uint8_t>(type), flags,
+                       static_cast<uint16_t>(text.size()), reserved};
+    core::net::NetworkBuffer buffer(MIN_FRAME_SIZE + text.size());
+    EXPECT_TRUE(MessageSerializer::serialize_frame(header, reinterpret_cast<const uint8_t*>(text.data()),
+                                                   static_cast<uint16_t>(text.size()), buffer));
+    return std::vector<uint8_t>(buffer.data(), buffer.data() + buffer.write_pos());
+}
+
+std::string payload_of(const FrameView& frame) {
+    return std::string(frame.payload.begin(), frame.payload.end());
+}
+
+} // namespace
+
+TEST(FrameDecoderTest, EmptyDecoderNeedsMore) {
+    FrameDecoder decoder;
+    FrameView frame;
+    EXPECT_EQ(decoder.next(frame), DecodeStatus::NEED_MORE);
+    EXPECT_EQ(decoder.get_buffered(), 0u);
+}
+
+TEST(FrameDecoderTest, FrameFedByteByByte) {
+    const std::vector<uint8_t> bytes = make_frame(MessageType::ECHO, "split across reads", 7);
+    FrameDecoder decoder;
+    FrameView frame;
+
+    for (size_t i = 0; i + 1 < bytes.size(); ++i) {
+        ASSERT_TRUE(decoder.feed(&bytes[i], 1));
+        ASSERT_EQ(decoder.next(frame), DecodeStatus::NEED_MORE) << i;
+    }
+    ASSERT_TRUE(decoder.feed(&bytes.back(), 1));
+
+    ASSERT_EQ(decoder.next(frame), DecodeStatus::FRAME);
+    EXPECT_EQ(frame.header.message_type, static_cast<uint8_t>(MessageType::ECHO));
+    EXPECT_EQ(frame.header.reserved, 7u);
+    EXPECT_EQ(payload_of(frame), "split across reads");
+    EXPECT_EQ(decoder.next(frame), DecodeStatus::NEED_MORE);
+    EXPECT_EQ(decoder.get_buffered(), 0u);
+}
+
+TEST(FrameDecoderTest, SeveralFramesInOneRead) {
+    std::vector<uint8_t> bytes;
+    for (const char* text : {"one", "", "three"}) {
+        const std::vector<uint8_t> frame = make_frame(MessageType::DATA, text);
+        bytes.insert(bytes.end(), frame.begin(), frame.end());
+    }
+    // Plus the start of a fourth
+    const std::vector<uint8_t> fourth = make_frame(MessageType::DATA, "four");
+    bytes.insert(bytes.end(), fourth.begin(), fourth.begin() + 5);
+
+    FrameDecoder decoder;
+    ASSERT_TRUE(decoder.feed(bytes.data(), bytes.size()));
+
+    FrameView frame;
+    std::vector<std::string> payloads;
+    while (decoder.next(frame) == DecodeStatus::FRAME) {
+        payloads.push_back(payload_of(frame));
+    }
+    EXPECT_EQ(payloads, (std::vector<std::string>{"one", "", "three"}));
+    EXPECT_EQ(decoder.get_buffered(), 5u);
+
+    ASSERT_TRUE(decoder.feed(fourth.data() + 5, fourth.size() - 5));
+    ASSERT_EQ(decoder.next(frame), DecodeStatus::FRAME);
+    EXPECT_EQ(payload_of(frame), "four");
+    EXPECT_EQ(decoder.get_frame_count(), 4u);
+}
+
+TEST(FrameDecoderTest, PayloadIsViewIntoBuffer) {
+    const std::vector<uint8_t> bytes = make_frame(MessageType::DATA, "in place");
+    FrameDecoder decoder;
+    uint8_t* space = decoder.prepare(bytes.size());
+    ASSERT_NE(space, nullptr);
+    ASSERT_GE(decoder.get_writable(), bytes.size());
+    std::copy(bytes.begin(), bytes.end(), space);
+    decoder.commit(bytes.size());
+
+    FrameView frame;
+    ASSERT_EQ(decoder.next(frame), DecodeStatus::FRAME);
+    EXPECT_EQ(frame.payload.data(), space + FRAME_HEADER_SIZE);
+}
+
+TEST(FrameDecoderTest, LargestFrameIsReassembled) {
+    const std::string text(MAX_PAYLOAD_SIZE, 'x');
+    const std::vector<uint8_t> bytes = make_frame(MessageType::DATA, text);
+    FrameDecoder decoder;
+    FrameView frame;
+
+    for (size_t offset = 0; offset < bytes.size(); offset += 1000) {
+        ASSERT_EQ(decoder.next(frame), DecodeStatus::NEED_MORE);
+        ASSERT_TRUE(decoder.feed(bytes.data() + offset, std::min<size_t>(1000, bytes.size() - offset)));
+    }
+    ASSERT_EQ(decoder.next(frame), DecodeStatus::FRAME);
+    EXPECT_EQ(frame.payload.size(), MAX_PAYLOAD_SIZE);
+}
+
+TEST(FrameDecoderTest, Crc32cFramesAreVerifiedWithCrc32c) {
+    std::vector<uint8_t> bytes = make_frame(MessageType::DATA, "castagnoli", 0,
+                                            static_cast<uint8_t>(FrameFlags::CRC32C));
+    const std::vector<uint8_t> plain = make_frame(MessageType::DATA, "castagnoli");
+    bytes.insert(bytes.end(), plain.begin(), plain.end());
+
+    FrameDecoder decoder;
+    ASSERT_TRUE(decoder.feed(bytes.data(), bytes.size()));
+
+    FrameView frame;
+    ASSERT_EQ(decoder.next(frame), DecodeStatus::FRAME);
+    EXPECT_TRUE(frame.header.has_flag(FrameFlags::CRC32C));
+    ASSERT_EQ(decoder.next(frame), DecodeStatus::FRAME);
+    EXPECT_FALSE(frame.header.has_flag(FrameFlags::CRC32C));
+}
+
+TEST(FrameDecoderTest, BadMagicIsCorruptNotIncomplete) {
+    std::vector<uint8_t> bytes = make_frame(MessageType::PING, "");
+    bytes[0] = 0x00;
+
+    FrameDecoder decoder(CorruptionPolicy::DISCONNECT);
+    ASSERT_TRUE(decoder.feed(bytes.data(), bytes.size()));
+
+    FrameView frame;
+    EXPECT_EQ(decoder.next(frame), DecodeStatus::CORRUPT);
+    EXPECT_TRUE(decoder.is_failed());
+
+    // Stays failed even when a good frame follows
+    const std::vector<uint8_t> good = make_frame(MessageType::PING, "");
+    ASSERT_TRUE(decoder.feed(good.data(), good.size()));
+    EXPECT_EQ(decoder.next(frame), DecodeStatus::CORRUPT);
+    EXPECT_EQ(decoder.get_corrupt_count(), 1u);
+
+    decoder.reset();
+    ASSERT_TRUE(decoder.feed(good.data(), good.size()));
+    EXPECT_EQ(decoder.next(frame), DecodeStatus::FRAME);
+}
+
+TEST(FrameDecoderTest, BadChecksumIsReportedOnceComplete) {
+    std::vector<uint8_t> bytes = make_frame(MessageType::DATA, "flipped");
+    bytes[FRAME_HEADER_SIZE] ^= 0x01;
+
+    FrameDecoder decoder;
+    FrameView frame;
+    ASSERT_TRUE(decoder.feed(bytes.data(), bytes.size() - 1));
+    EXPECT_EQ(decoder.next(frame), DecodeStatus::NEED_MORE);
+    ASSERT_TRUE(decoder.feed(&bytes.back(), 1));
+    EXPECT_EQ(decoder.next(frame), DecodeStatus::CORRUPT);
+}
+
+TEST(FrameDecoderTest, ResyncSkipsGarbageToNextFrame) {
+    const std::vector<uint8_t> garbage = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09};
+    std::vector<uint8_t> bad = make_frame(MessageType::DATA, "bad checksum");
+    bad[FRAME_HEADER_SIZE + 1] ^= 0xFF;
+    const std::vector<uint8_t> good = make_frame(MessageType::ECHO, "good");
+
+    std::vector<uint8_t> bytes = garbage;
+    bytes.insert(bytes.end(), bad.begin(), bad.end());
+    bytes.insert(bytes.end(), good.begin(), good.end());
+
+    FrameDecoder decoder(CorruptionPolicy::RESYNC);
+    ASSERT_TRUE(decoder.feed(bytes.data(), bytes.size()));
+
+    FrameView frame;
+    ASSERT_EQ(decoder.next(frame), DecodeStatus::FRAME);
+    EXPECT_EQ(payload_of(frame), "good");
+    EXPECT_FALSE(decoder.is_failed());
+    EXPECT_GE(decoder.get_corrupt_count(), 2u);     // A magic byte inside the bad frame costs one more
+    EXPECT_EQ(decoder.get_skipped_bytes(), garbage.size() + bad.size());
+    EXPECT_EQ(decoder.next(frame), DecodeStatus::NEED_MORE);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "LatencyHistogram.h"
+#include <cstdint>
+
+using namespace core;
+
+TEST(LatencyHistogramTest, EmptyHistogramReportsZero) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.get_count(), 0u);
+    EXPECT_EQ(histogram.percentile(50), 0u);
+    EXPECT_EQ(histogram.get_min(), 0u);
+    EXPECT_EQ(histogram.get_max(), 0u);
+    EXPECT_EQ(histogram.get_mean(), 0.0);
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 100; ++value) {
+        histogram.record(value);
+    }
+
+    EXPECT_EQ(histogram.get_count(), 100u);
+    EXPECT_EQ(histogram.percentile(50), 50u);
+    EXPECT_EQ(histogram.percentile(99), 99u);
+    EXPECT_EQ(histogram.percentile(100), 100u);
+    EXPECT_EQ(histogram.get_min(), 1u);
+    EXPECT_DOUBLE_EQ(histogram.get_mean(), 50.5);
+}
+
+TEST(LatencyHistogramTest, LargeValuesStayWithinRelativeError) {
+    for (uint64_t value : {uint64_t{1000}, uint64_t{123456}, uint64_t{987654321}, uint64_t{1} << 40, UINT64_MAX / 3}) {
+        LatencyHistogram histogram;
+        histogram.record(value);
+        histogram.record(value + value / 1000);   // Keeps max above the value's bucket in most cases
+
+        const uint64_t reported = histogram.percentile(50);
+        EXPECT_GE(reported, value);
+        EXPECT_LE(reported - value, value / 64) << value;
+    }
+}
+
+TEST(LatencyHistogramTest, PercentilesFollowTheTail) {
+    LatencyHistogram histogram;
+    histogram.record(1000, 990);
+    histogram.record(1000000, 10);
+
+    EXPECT_LE(histogram.percentile(50), 1000u + 1000 / 64);
+    EXPECT_LE(histogram.percentile(99), 1000u + 1000 / 64);
+    EXPECT_GE(histogram.percentile(99.5), 1000000u);
+    EXPECT_EQ(histogram.percentile(100), 1000000u);
+}
+
+TEST(LatencyHistogramTest, CorrectionAddsTheSamplesAStallHid) {
+    // A 100 ms stall while sending every 10 ms hides 9 requests of 90, 80, ... 10 ms
+    LatencyHistogram histogram;
+    histogram.record_corrected(100, 10);
+
+    EXPECT_EQ(histogram.get_count(), 10u);
+    EXPECT_EQ(histogram.get_min(), 10u);
+    EXPECT_EQ(histogram.get_max(), 100u);
+    EXPECT_EQ(histogram.percentile(50), 50u);
+
+    // Fast responses need no correction
+    LatencyHistogram fast;
+    fast.record_corrected(5, 10);
+    EXPECT_EQ(fast.get_count(), 1u);
+}
+
+TEST(LatencyHistogramTest, CorrectedCopyMatchesCorrectedRecording) {
+    LatencyHistogram raw;
+    LatencyHistogram live;
+    for (uint64_t value : {3u, 7u, 40u, 95u}) {
+        raw.record(value);
+        live.record_corrected(value, 10);
+    }
+
+    const LatencyHistogram copy = raw.corrected(10);
+    EXPECT_EQ(copy.get_count(), live.get_count());
+    EXPECT_EQ(copy.percentile(50), live.percentile(50));
+    EXPECT_EQ(copy.percentile(90), live.percentile(90));
+    EXPECT_EQ(raw.get_count(), 4u);
+}
+
+TEST(LatencyHistogramTest, MergeCombinesSamples) {
+    LatencyHistogram a;
+    LatencyHistogram b;
+    a.record(10, 3);
+    b.record(20, 1);
+    b.record(5, 1);
+
+    a.merge(b);
+    EXPECT_EQ(a.get_count(), 5u);
+    EXPECT_EQ(a.get_min(), 5u);
+    EXPECT_EQ(a.get_max(), 20u);
+    EXPECT_DOUBLE_EQ(a.get_mean(), (30.0 + 20.0 + 5.0) / 5.0);
+
+    a.reset();
+    EXPECT_EQ(a.get_count(), 0u);
+    EXPECT_EQ(a.percentile(50), 0u);
+}
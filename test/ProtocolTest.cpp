@@ -5,6 +5,10 @@
 #include "EndianUtils.h"
 #include "HandlerRegistry.h"
 #include "ProtocolMessages.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace core::protocol;
 
@@ -52,6 +56,214 @@ TEST_F(BinaryProtocolTest, CRC32Calculation) {
     EXPECT_NE(crc1, 0);
 }
 
+namespace {
+
+// Bit-at-a-time definitions, as reference
+uint32_t reference_crc(const uint8_t* data, size_t length, uint32_t poly) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+uint32_t reference_crc32(const uint8_t* data, size_t length) {
+    return reference_crc(data, length, 0xEDB88320);
+}
+
+uint32_t reference_crc32c(const uint8_t* data, size_t length) {
+    return reference_crc(data, length, 0x82F63B78);
+}
+
+std::vector<uint8_t> pseudo_random_bytes(size_t size) {
+    std::vector<uint8_t> data(size);
+    uint32_t seed = 12345;
+    for (auto& byte : data) {
+        seed = seed * 1103515245 + 12345;
+        byte = static_cast<uint8_t>(seed >> 16);
+    }
+    return data;
+}
+
+} // namespace
+
+TEST_F(BinaryProtocolTest, CRC32KnownVectors) {
+    const char* check = "123456789";
+    const auto* bytes = reinterpret_cast<const uint8_t*>(check);
+    EXPECT_EQ(crc32::calculate(bytes, 9), 0xCBF43926u);
+    EXPECT_EQ(crc32::calculate_portable(bytes, 9), 0xCBF43926u);
+    EXPECT_EQ(crc32::calculate(bytes, 0), 0u);
+}
+
+TEST_F(BinaryProtocolTest, CRC32ImplementationsAgree) {
+    const std::vector<uint8_t> data = pseudo_random_bytes(MAX_PAYLOAD_SIZE + 64);
+
+    // Every length around the 16- and 64-byte block edges, at every alignment
+    std::vector<size_t> lengths;
+    for (size_t length = 0; length <= 300; ++length) {
+        lengths.push_back(length);
+    }
+    for (size_t length : {size_t{1023}, size_t{4096}, size_t{32 * 1024 + 7}, size_t{MAX_PAYLOAD_SIZE}}) {
+        lengths.push_back(length);
+    }
+
+    for (size_t offset = 0; offset < 16; ++offset) {
+        for (size_t length : lengths) {
+            const uint8_t* start = data.data() + offset;
+            const uint32_t expected = reference_crc32(start, length);
+            ASSERT_EQ(crc32::calculate(start, length), expected) << offset << "+" << length;
+            ASSERT_EQ(crc32::calculate_portable(start, length), expected) << offset << "+" << length;
+            if (crc32::has_hardware_support()) {
+                ASSERT_EQ(crc32::calculate_hardware(start, length), expected) << offset << "+" << length;
+            }
+        }
+    }
+}
+
+TEST_F(BinaryProtocolTest, CRC32CKnownVector) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>("123456789");
+    EXPECT_EQ(crc32c::calculate(bytes, 9), 0xE3069283u);
+    EXPECT_EQ(crc32c::calculate_portable(bytes, 9), 0xE3069283u);
+    EXPECT_EQ(crc32c::calculate(bytes, 0), 0u);
+}
+
+TEST_F(BinaryProtocolTest, CRC32CImplementationsAgree) {
+    const std::vector<uint8_t> data = pseudo_random_bytes(MAX_PAYLOAD_SIZE + 64);
+
+    // Around the 8-byte steps and the 3 x 256 / 3 x 8192 interleaved blocks
+    std::vector<size_t> lengths;
+    for (size_t length = 0; length <= 100; ++length) {
+        lengths.push_back(length);
+    }
+    for (size_t base : {size_t{3 * 256}, size_t{3 * 8192}, size_t{6 * 8192}}) {
+        for (size_t length = base - 9; length <= base + 9; ++length) {
+            lengths.push_back(length);
+        }
+    }
+    lengths.push_back(MAX_PAYLOAD_SIZE);
+
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t length : lengths) {
+            const uint8_t* start = data.data() + offset;
+            const uint32_t expected = reference_crc32c(start, length);
+            ASSERT_EQ(crc32c::calculate(start, length), expected) << offset << "+" << length;
+            ASSERT_EQ(crc32c::calculate_portable(start, length), expected) << offset << "+" << length;
+            if (crc32c::has_hardware_support()) {
+                ASSERT_EQ(crc32c::calculate_hardware(start, length), expected) << offset << "+" << length;
+            }
+        }
+    }
+}
+
+TEST_F(BinaryProtocolTest, FrameFlagSelectsChecksum) {
+    const uint8_t payload[] = {'c', 'a', 's', 't', 'a', 'g', 'n', 'o', 'l', 'i'};
+    FrameHeader header{PROTOCOL_MAGIC, PROTOCOL_VERSION, static_cast<uint8_t>(MessageType::DATA), 0,
+                       sizeof(payload), 0};
+    EXPECT_EQ(frame_checksum(header, payload, sizeof(payload)), crc32::calculate(payload, sizeof(payload)));
+
+    header.set_flag(FrameFlags::CRC32C);
+    EXPECT_EQ(frame_checksum(header, payload, sizeof(payload)), crc32c::calculate(payload, sizeof(payload)));
+
+    core::net::NetworkBuffer buffer(MIN_FRAME_SIZE + sizeof(payload));
+    ASSERT_TRUE(MessageSerializer::serialize_frame(header, payload, sizeof(payload), buffer));
+    EXPECT_TRUE(MessageSerializer::validate_frame(buffer.data(), buffer.write_pos()));
+
+    // With the flag cleared in transit the CRC32 check fails
+    std::vector<uint8_t> frame(buffer.data(), buffer.data() + buffer.write_pos());
+    frame[3] &= static_cast<uint8_t>(~static_cast<uint8_t>(FrameFlags::CRC32C));
+    EXPECT_FALSE(MessageSerializer::validate_frame(frame.data(), frame.size()));
+}
+
+TEST_F(BinaryProtocolTest, CRC32ConcurrentCallsAgree) {
+    const uint8_t data[] = {'f', 'r', 'a', 'm', 'e'};
+    const uint32_t expected = reference_crc32(data, sizeof(data));
+
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches{0};
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&]() {
+            for (int round = 0; round < 1000; ++round) {
+                mismatches += crc32::calculate(data, sizeof(data)) != expected;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+// ============ MessageSerializer Tests ============
+
+class MessageSerializerTest : public ::testing::Test {
+protected:
+    std::vector<uint8_t> serialize(const std::string& text, uint16_t reserved = 0) {
+        FrameHeader header{PROTOCOL_MAGIC, PROTOCOL_VERSION, static_cast<uint8_t>(MessageType::ECHO),
+                           static_cast<uint8_t>(FrameFlags::ACK_REQUIRED), static_cast<uint16_t>(text.size()), reserved};
+        core::net::NetworkBuffer buffer(MIN_FRAME_SIZE + text.size());
+        EXPECT_TRUE(MessageSerializer::serialize_frame(header, reinterpret_cast<const uint8_t*>(text.data()),
+                                                       static_cast<uint16_t>(text.size()), buffer));
+        return std::vector<uint8_t>(buffer.data(), buffer.data() + buffer.write_pos());
+    }
+};
+
+TEST_F(MessageSerializerTest, LoadHeaderReadsEveryField) {
+    const uint8_t bytes[] = {PROTOCOL_MAGIC, PROTOCOL_VERSION, 0x04, 0x09, 0x34, 0x12, 0xCD, 0xAB};
+    const FrameHeader header = MessageSerializer::load_header(bytes);
+    EXPECT_EQ(header.magic, PROTOCOL_MAGIC);
+    EXPECT_EQ(header.version, PROTOCOL_VERSION);
+    EXPECT_EQ(header.message_type, 0x04);
+    EXPECT_EQ(header.flags, 0x09);
+    EXPECT_EQ(header.payload_length, 0x1234);
+    EXPECT_EQ(header.reserved, 0xABCD);
+}
+
+TEST_F(MessageSerializerTest, ViewFramePointsIntoBuffer) {
+    // Odd offset: the header load must not assume alignment
+    std::vector<uint8_t> bytes(1, 0x00);
+    const std::vector<uint8_t> frame = serialize("no copies here", 42);
+    bytes.insert(bytes.end(), frame.begin(), frame.end());
+
+    FrameView view;
+    ASSERT_EQ(MessageSerializer::view_frame(bytes.data() + 1, frame.size(), view), DecodeStatus::FRAME);
+    EXPECT_EQ(view.header.message_type, static_cast<uint8_t>(MessageType::ECHO));
+    EXPECT_TRUE(view.header.has_flag(FrameFlags::ACK_REQUIRED));
+    EXPECT_EQ(view.header.reserved, 42);
+    EXPECT_EQ(view.payload.data(), bytes.data() + 1 + FRAME_HEADER_SIZE);
+    EXPECT_EQ(std::string(view.payload.begin(), view.payload.end()), "no copies here");
+    EXPECT_EQ(view.frame_size(), frame.size());
+}
+
+TEST_F(MessageSerializerTest, ViewFrameSeparatesIncompleteFromCorrupt) {
+    const std::vector<uint8_t> frame = serialize("payload");
+    FrameView view;
+
+    for (size_t length = 0; length < frame.size(); ++length) {
+        EXPECT_EQ(MessageSerializer::view_frame(frame.data(), length, view), DecodeStatus::NEED_MORE) << length;
+    }
+
+    std::vector<uint8_t> bad_magic = frame;
+    bad_magic[0] = 0x00;
+    EXPECT_EQ(MessageSerializer::view_frame(bad_magic.data(), bad_magic.size(), view), DecodeStatus::CORRUPT);
+
+    std::vector<uint8_t> bad_checksum = frame;
+    bad_checksum.back() ^= 0x01;
+    EXPECT_EQ(MessageSerializer::view_frame(bad_checksum.data(), bad_checksum.size(), view), DecodeStatus::CORRUPT);
+}
+
+TEST_F(MessageSerializerTest, DeserializeFrameStillCopies) {
+    const std::vector<uint8_t> frame = serialize("copied");
+    FrameHeader header;
+    std::vector<uint8_t> payload;
+    EXPECT_EQ(MessageSerializer::deserialize_frame(frame.data(), frame.size(), header, payload), frame.size());
+    EXPECT_EQ(std::string(payload.begin(), payload.end()), "copied");
+    EXPECT_TRUE(MessageSerializer::validate_frame(frame.data(), frame.size()));
+    EXPECT_FALSE(MessageSerializer::validate_frame(frame.data(), frame.size() - 1));
+}
+
 // ============ EndianUtils Tests ============
 
 class EndianUtilsTest : public ::testing::Test {
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include "RateLimiter.h"
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace core::net;
+
+namespace {
+
+constexpr uint64_t MS = 1000000;    // Nanoseconds per millisecond
+constexpr uint64_t START = 1000 * TokenBucket::BURST_NS;
+
+PeerAddress ipv4_peer(const char* address, uint16_t port)
+{
+    sockaddr_in in4{};
+    in4.sin_family = AF_INET;
+    in4.sin_port = htons(port);
+    inet_pton(AF_INET, address, &in4.sin_addr);
+
+    PeerAddress peer;
+    std::memcpy(&peer.storage, &in4, sizeof(in4));
+    peer.length = sizeof(in4);
+    return peer;
+}
+
+} // namespace
+
+// ============ TokenBucket Tests ============
+
+TEST(TokenBucketTest, FullBucketAllowsOneSecondBurst) {
+    TokenBucket bucket;
+    constexpr uint64_t RATE = 100;
+
+    for (uint64_t i = 0; i < RATE; ++i) {
+        ASSERT_TRUE(bucket.has_tokens(RATE, START));
+        bucket.take(1, RATE, START);
+    }
+    EXPECT_FALSE(bucket.has_tokens(RATE, START));
+    EXPECT_EQ(bucket.wait_ns(RATE, START), 10 * MS);
+}
+
+TEST(TokenBucketTest, RefillsWithTime) {
+    TokenBucket bucket;
+    constexpr uint64_t RATE = 1000;
+
+    bucket.take(RATE, RATE, START);
+    EXPECT_FALSE(bucket.has_tokens(RATE, START));
+    EXPECT_TRUE(bucket.has_tokens(RATE, START + MS));
+
+    // A long pause refills to capacity, never beyond
+    const uint64_t later = START + 10 * TokenBucket::BURST_NS;
+    bucket.take(RATE, RATE, later);
+    EXPECT_FALSE(bucket.has_tokens(RATE, later));
+}
+
+TEST(TokenBucketTest, OverdraftDelaysUntilRepaid) {
+    TokenBucket bucket;
+    constexpr uint64_t RATE = 1000;
+
+    // Three seconds' worth taken at once: two seconds of debt beyond the burst
+    bucket.take(3 * RATE, RATE, START);
+    EXPECT_FALSE(bucket.has_tokens(RATE, START + TokenBucket::BURST_NS));
+    EXPECT_EQ(bucket.wait_ns(RATE, START), 2 * TokenBucket::BURST_NS + MS);
+    EXPECT_TRUE(bucket.has_tokens(RATE, START + 2 * TokenBucket::BURST_NS + MS));
+}
+
+TEST(TokenBucketTest, ZeroRateIsUnlimited) {
+    TokenBucket bucket;
+
+    bucket.take(1000000, 0, START);
+    EXPECT_TRUE(bucket.has_tokens(0, START));
+    EXPECT_EQ(bucket.wait_ns(0, START), 0u);
+
+    // Limits can change at runtime: the bucket then starts full
+    EXPECT_TRUE(bucket.has_tokens(10, START));
+}
+
+TEST(TokenBucketTest, ConcurrentTakesAreAllCounted) {
+    TokenBucket bucket;
+    constexpr uint64_t RATE = 1000;
+    constexpr int NUM_THREADS = 4;
+    constexpr int TAKES_PER_THREAD = 10000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&bucket]() {
+            for (int i = 0; i < TAKES_PER_THREAD; ++i) {
+                bucket.take(1, RATE, START);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // 40000 tokens at 1000/s, minus the one-second burst
+    EXPECT_EQ(bucket.wait_ns(RATE, START), 39 * TokenBucket::BURST_NS + MS);
+}
+
+// ============ RateLimitRegistry Tests ============
+
+TEST(RateLimitRegistryTest, ConnectionsFromOneAddressShareBuckets) {
+    RateLimitRegistry registry;
+
+    auto a = registry.acquire_address(ipv4_peer("10.0.0.1", 1000));
+    auto b = registry.acquire_address(ipv4_peer("10.0.0.1", 2000));
+    auto c = registry.acquire_address(ipv4_peer("10.0.0.2", 1000));
+
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(registry.get_tracked_address_count(), 2u);
+
+    a.reset();
+    b.reset();
+    EXPECT_EQ(registry.get_tracked_address_count(), 1u);
+}
+
+TEST(RateLimitRegistryTest, NonIpPeersHaveNoAddressBuckets) {
+    RateLimitRegistry registry;
+
+    PeerAddress unix_peer;
+    unix_peer.storage.ss_family = AF_UNIX;
+    unix_peer.length = sizeof(sa_family_t);
+    EXPECT_EQ(registry.acquire_address(unix_peer), nullptr);
+    EXPECT_EQ(registry.acquire_address(PeerAddress{}), nullptr);
+}
+
+// ============ RateLimiter Tests ============
+
+TEST(RateLimiterTest, MessageLimitPausesUntilRefill) {
+    RateLimitRegistry registry;
+    registry.set_connection_limits({10, 0});
+    auto limiter = registry.make_limiter(INVALID_SOCKET, ipv4_peer("10.0.0.1", 1000));
+    ASSERT_NE(limiter, nullptr);
+
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(limiter->admit(START));
+        limiter->charge(1, START);
+    }
+    EXPECT_FALSE(limiter->admit(START));
+    EXPECT_EQ(limiter->wait_ns(START), 100 * MS);
+    EXPECT_TRUE(limiter->admit(START + 100 * MS));
+}
+
+TEST(RateLimiterTest, ByteLimitCountsPayloadSize) {
+    RateLimitRegistry registry;
+    registry.set_connection_limits({0, 1000});
+    auto limiter = registry.make_limiter(INVALID_SOCKET, ipv4_peer("10.0.0.1", 1000));
+
+    limiter->charge(1500, START);
+    EXPECT_FALSE(limiter->admit(START));
+    EXPECT_FALSE(limiter->admit(START + 500 * MS));
+    EXPECT_TRUE(limiter->admit(START + 501 * MS));
+}
+
+TEST(RateLimiterTest, AddressLimitIsSharedAcrossConnections) {
+    RateLimitRegistry registry;
+    registry.set_address_limits({4, 0});
+    auto first = registry.make_limiter(INVALID_SOCKET, ipv4_peer("10.0.0.1", 1000));
+    auto second = registry.make_limiter(INVALID_SOCKET, ipv4_peer("10.0.0.1", 1001));
+    auto other_host = registry.make_limiter(INVALID_SOCKET, ipv4_peer("10.0.0.9", 1000));
+
+    for (int i = 0; i < 2; ++i) {
+        first->charge(1, START);
+        second->charge(1, START);
+    }
+
+    // Neither connection reached a limit of its own, but together they used the address's share
+    EXPECT_FALSE(first->admit(START));
+    EXPECT_FALSE(second->admit(START));
+    EXPECT_TRUE(other_host->admit(START));
+}
+
+TEST(RateLimiterTest, LimitsChangeAtRuntime) {
+    RateLimitRegistry registry;
+    auto limiter = registry.make_limiter(INVALID_SOCKET, ipv4_peer("10.0.0.1", 1000));
+
+    registry.set_connection_limits({1, 0});
+    limiter->charge(1, START);
+    EXPECT_FALSE(limiter->admit(START));
+
+    registry.set_connection_limits({0, 0});
+    EXPECT_TRUE(limiter->admit(START));
+    EXPECT_EQ(limiter->wait_ns(START), 0u);
+}
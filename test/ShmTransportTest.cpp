@@ -0,0 +1,270 @@
+#include <gtest/gtest.h>
+#include "ShmTransport.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace core::net;
+
+class ShmRingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ShmRing::initialize(&header, CAPACITY);
+        ring = ShmRing(&header, data.data());
+    }
+
+    static constexpr size_t CAPACITY = 16;
+    ShmRing::Header header;
+    std::vector<uint8_t> data = std::vector<uint8_t>(CAPACITY);
+    ShmRing ring;
+};
+
+TEST_F(ShmRingTest, WritesStopWhenFullAndReadsWhenEmpty) {
+    const std::vector<uint8_t> input(20, 0xAB);
+    EXPECT_EQ(ring.write(input.data(), input.size()), CAPACITY);
+    EXPECT_EQ(ring.writable(), 0u);
+    EXPECT_EQ(ring.write(input.data(), 1), 0u);
+
+    uint8_t output[32];
+    EXPECT_EQ(ring.read(output, sizeof(output)), CAPACITY);
+    EXPECT_EQ(ring.readable(), 0u);
+    EXPECT_EQ(ring.read(output, sizeof(output)), 0u);
+}
+
+TEST_F(ShmRingTest, WrapsAroundWithoutLosingBytes) {
+    uint8_t next_in = 0;
+    uint8_t next_out = 0;
+
+    // Odd chunk sizes land the positions all over the buffer
+    for (int round = 0; round < 100; ++round) {
+        uint8_t chunk[11];
+        for (auto& byte : chunk) {
+            byte = next_in++;
+        }
+        ASSERT_EQ(ring.write(chunk, sizeof(chunk)), sizeof(chunk));
+
+        uint8_t output[11];
+        ASSERT_EQ(ring.read(output, sizeof(output)), sizeof(output));
+        for (uint8_t byte : output) {
+            ASSERT_EQ(byte, next_out++);
+        }
+    }
+}
+
+TEST_F(ShmRingTest, ScribbledPositionsAreCorruptNotCopied) {
+    uint8_t output[64];
+
+    // The producer claims more bytes than the ring holds
+    header.tail.store(header.head.load() + 1000);
+    EXPECT_EQ(ring.read(output, sizeof(output)), 0u);
+    EXPECT_TRUE(ring.is_corrupt());
+    EXPECT_LE(ring.readable(), CAPACITY);
+    EXPECT_EQ(ring.writable(), 0u);
+
+    // Sticky, even once the positions look sane again
+    header.tail.store(header.head.load() + 1);
+    EXPECT_EQ(ring.read(output, sizeof(output)), 0u);
+}
+
+TEST_F(ShmRingTest, ScribbledHeadStopsWrites) {
+    // The consumer moves head past tail: free space would underflow to "huge"
+    header.head.store(header.tail.load() + 5);
+    const std::vector<uint8_t> input(CAPACITY * 4, 0xCD);
+    EXPECT_EQ(ring.write(input.data(), input.size()), 0u);
+    EXPECT_TRUE(ring.is_corrupt());
+}
+
+TEST_F(ShmRingTest, CapacityIsFixedAtAttach) {
+    header.capacity = CAPACITY * 1024;
+    EXPECT_EQ(ring.capacity(), CAPACITY);
+    EXPECT_EQ(ring.writable(), CAPACITY);
+
+    const std::vector<uint8_t> input(CAPACITY * 4, 0xEF);
+    EXPECT_EQ(ring.write(input.data(), input.size()), CAPACITY);
+    EXPECT_FALSE(ring.is_corrupt());
+}
+
+TEST_F(ShmRingTest, ConsumerIsOnlyRungWhenIdle) {
+    const uint8_t byte = 1;
+    uint8_t output[CAPACITY];
+
+    // A fresh ring starts with an idle consumer
+    ASSERT_EQ(ring.write(&byte, 1), 1u);
+    EXPECT_TRUE(ring.take_consumer_wakeup());
+
+    // Busy consumer: nobody asked to be woken
+    ASSERT_EQ(ring.write(&byte, 1), 1u);
+    EXPECT_FALSE(ring.take_consumer_wakeup());
+
+    // Input still waiting: the consumer must not go to sleep
+    EXPECT_FALSE(ring.prepare_consumer_wait());
+    ring.read(output, sizeof(output));
+
+    EXPECT_TRUE(ring.prepare_consumer_wait());
+    ASSERT_EQ(ring.write(&byte, 1), 1u);
+    EXPECT_TRUE(ring.take_consumer_wakeup());
+    EXPECT_FALSE(ring.take_consumer_wakeup());
+}
+
+TEST_F(ShmRingTest, ProducerIsRungOnceSpaceFrees) {
+    const std::vector<uint8_t> input(CAPACITY, 7);
+    uint8_t output[4];
+
+    EXPECT_FALSE(ring.prepare_producer_wait());
+    ASSERT_EQ(ring.write(input.data(), input.size()), CAPACITY);
+
+    EXPECT_TRUE(ring.prepare_producer_wait());
+    ASSERT_EQ(ring.read(output, sizeof(output)), sizeof(output));
+    EXPECT_TRUE(ring.take_producer_wakeup());
+    EXPECT_FALSE(ring.take_producer_wakeup());
+}
+
+TEST(ShmRingStressTest, StreamsAcrossThreadsInOrder) {
+    constexpr size_t CAPACITY = 4096;
+    constexpr size_t TOTAL = 1024 * 1024;
+
+    ShmRing::Header header;
+    ShmRing::initialize(&header, CAPACITY);
+    std::vector<uint8_t> data(CAPACITY);
+    ShmRing producer(&header, data.data());
+    ShmRing consumer(&header, data.data());
+
+    std::thread writer([&producer]() {
+        uint8_t chunk[1500];
+        size_t sent = 0;
+        while (sent < TOTAL) {
+            const size_t length = std::min(sizeof(chunk), TOTAL - sent);
+            for (size_t i = 0; i < length; ++i) {
+                chunk[i] = static_cast<uint8_t>((sent + i) * 13);
+            }
+            size_t offset = 0;
+            while (offset < length) {
+                offset += producer.write(chunk + offset, length - offset);
+            }
+            sent += length;
+        }
+    });
+
+    size_t received = 0;
+    bool intact = true;
+    uint8_t buffer[1024];
+    while (received < TOTAL) {
+        const size_t count = consumer.read(buffer, sizeof(buffer));
+        for (size_t i = 0; i < count; ++i) {
+            intact = intact && buffer[i] == static_cast<uint8_t>((received + i) * 13);
+        }
+        received += count;
+    }
+
+    writer.join();
+    EXPECT_EQ(received, TOTAL);
+    EXPECT_TRUE(intact);
+}
+
+#ifdef __linux__
+class ShmChannelTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(listener.create_unix_listening_socket(name));
+
+        std::thread connector([this]() { client = ShmChannel::connect(name); });
+
+        // Accept and hand over a fresh channel, as AsyncServer does
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        PeerAddress peer;
+        while ((accepted = listener.accept_connection(peer)) == INVALID_SOCKET &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        if (accepted != INVALID_SOCKET) {
+            server = ShmChannel::create(8192);
+            if (server) {
+                server->send_handshake(accepted);
+            }
+        }
+        connector.join();
+
+        ASSERT_NE(accepted, INVALID_SOCKET);
+        ASSERT_TRUE(server);
+        ASSERT_TRUE(client);
+    }
+
+    void TearDown() override {
+        if (accepted != INVALID_SOCKET) {
+            close_socket(accepted);
+        }
+    }
+
+    const std::string name = "@hpams-shm-test-" + std::to_string(getpid());
+    AsyncSocket listener{name, 0};
+    SOCKET accepted{INVALID_SOCKET};
+    std::unique_ptr<ShmChannel> server;
+    std::unique_ptr<ShmChannel> client;
+};
+
+TEST_F(ShmChannelTest, HandshakeSharesRingsBothWays) {
+    EXPECT_EQ(server->ring_capacity(), 8192u);
+    EXPECT_EQ(client->ring_capacity(), 8192u);
+
+    const std::string request = "ping";
+    ASSERT_EQ(client->write(reinterpret_cast<const uint8_t*>(request.data()), request.size()), request.size());
+    ASSERT_TRUE(server->wait_readable(1000));
+
+    uint8_t buffer[64];
+    size_t received = server->read(buffer, sizeof(buffer));
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(buffer), received), request);
+
+    const std::string reply = "pong";
+    ASSERT_EQ(server->write(reinterpret_cast<const uint8_t*>(reply.data()), reply.size()), reply.size());
+    ASSERT_TRUE(client->wait_readable(1000));
+    received = client->read(buffer, sizeof(buffer));
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(buffer), received), reply);
+}
+
+TEST_F(ShmChannelTest, SleepingReaderIsWokenByDoorbell) {
+    std::atomic<bool> woke{false};
+    std::thread reader([&]() { woke = client->wait_readable(5000); });
+
+    // Long enough for the reader to stop spinning and sleep on its doorbell
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const uint8_t byte = 42;
+    ASSERT_EQ(server->write(&byte, 1), 1u);
+
+    reader.join();
+    EXPECT_TRUE(woke);
+}
+
+TEST_F(ShmChannelTest, FullRingWakesWriterAfterRead) {
+    std::vector<uint8_t> payload(server->ring_capacity(), 1);
+    ASSERT_EQ(client->write(payload.data(), payload.size()), payload.size());
+    EXPECT_EQ(client->writable(), 0u);
+
+    std::thread drainer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        uint8_t buffer[1024];
+        server->read(buffer, sizeof(buffer));
+    });
+
+    EXPECT_TRUE(client->wait_writable(5000));
+    EXPECT_EQ(client->writable(), 1024u);
+    drainer.join();
+}
+
+TEST_F(ShmChannelTest, WaitTimesOutWithoutInput) {
+    EXPECT_FALSE(client->wait_readable(20));
+    EXPECT_FALSE(client->wait_readable(0));
+}
+
+TEST_F(ShmChannelTest, ClientNoticesServerGoingAway) {
+    close_socket(accepted);
+    accepted = INVALID_SOCKET;
+    EXPECT_FALSE(client->wait_readable(5000));
+}
+#endif
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "SlotTable.h"
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace core::net;
+
+class SlotTableTest : public ::testing::Test {
+protected:
+    SlotTable<std::string> table;
+};
+
+TEST_F(SlotTableTest, InsertAndFind) {
+    auto a = table.insert("alpha");
+    auto b = table.insert("beta");
+
+    ASSERT_NE(a, SlotTable<std::string>::INVALID_ID);
+    ASSERT_NE(b, SlotTable<std::string>::INVALID_ID);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(table.size(), 2u);
+    ASSERT_NE(table.find(a), nullptr);
+    EXPECT_EQ(*table.find(a), "alpha");
+    EXPECT_EQ(*table.find(b), "beta");
+}
+
+TEST_F(SlotTableTest, InvalidAndUnknownIdsFindNothing) {
+    table.insert("alpha");
+
+    EXPECT_EQ(table.find(SlotTable<std::string>::INVALID_ID), nullptr);
+    EXPECT_EQ(table.find(uint64_t{1} << 32 | 7), nullptr);    // Slot never used
+    EXPECT_FALSE(table.erase(SlotTable<std::string>::INVALID_ID));
+}
+
+TEST_F(SlotTableTest, ErasedIdGoesStaleWhenSlotIsReused) {
+    auto old_id = table.insert("old");
+    ASSERT_TRUE(table.erase(old_id));
+    EXPECT_FALSE(table.contains(old_id));
+    EXPECT_FALSE(table.erase(old_id));
+
+    auto new_id = table.insert("new");
+
+    // Same slot index, different generation
+    EXPECT_EQ(new_id & 0xFFFFFFFFu, old_id & 0xFFFFFFFFu);
+    EXPECT_NE(new_id, old_id);
+    EXPECT_EQ(table.find(old_id), nullptr);
+    ASSERT_NE(table.find(new_id), nullptr);
+    EXPECT_EQ(*table.find(new_id), "new");
+}
+
+TEST_F(SlotTableTest, EraseKeepsRecordsDenseAndReachable) {
+    std::vector<uint64_t> ids;
+    for (int i = 0; i < 100; ++i) {
+        ids.push_back(table.insert(std::to_string(i)));
+    }
+
+    // Remove every third record; the survivors must keep answering to their ids
+    for (size_t i = 0; i < ids.size(); i += 3) {
+        ASSERT_TRUE(table.erase(ids[i]));
+    }
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i % 3 == 0) {
+            EXPECT_EQ(table.find(ids[i]), nullptr);
+        } else {
+            ASSERT_NE(table.find(ids[i]), nullptr);
+            EXPECT_EQ(*table.find(ids[i]), std::to_string(i));
+        }
+    }
+
+    size_t visited = 0;
+    table.for_each([&](uint64_t id, std::string& value) {
+        EXPECT_EQ(table.find(id), &value);
+        ++visited;
+    });
+    EXPECT_EQ(visited, table.size());
+    EXPECT_EQ(table.ids().size(), table.size());
+}
+
+TEST_F(SlotTableTest, TaggedIdsAreForeign) {
+    auto id = table.insert("alpha");
+    const uint64_t tagged = id | (uint64_t{3} << SlotTable<std::string>::TAG_SHIFT);
+
+    EXPECT_EQ(id & ~SlotTable<std::string>::ID_MASK, 0u);
+    EXPECT_EQ(table.find(tagged), nullptr);
+    EXPECT_NE(table.find(tagged & SlotTable<std::string>::ID_MASK), nullptr);
+}
+
+TEST_F(SlotTableTest, ClearStalesEveryId) {
+    auto a = table.insert("alpha");
+    auto b = table.insert("beta");
+    table.clear();
+
+    EXPECT_TRUE(table.empty());
+    EXPECT_FALSE(table.contains(a));
+    EXPECT_FALSE(table.contains(b));
+
+    // Freed slots are reused with fresh generations
+    std::set<uint64_t> fresh{table.insert("gamma"), table.insert("delta")};
+    EXPECT_EQ(fresh.count(a), 0u);
+    EXPECT_EQ(fresh.count(b), 0u);
+}
+
+TEST(SlotTableMoveOnlyTest, HoldsMoveOnlyRecords) {
+    SlotTable<std::unique_ptr<int>> table;
+    auto a = table.insert(std::make_unique<int>(1));
+    auto b = table.insert(std::make_unique<int>(2));
+
+    ASSERT_TRUE(table.erase(a));
+    ASSERT_NE(table.find(b), nullptr);
+    EXPECT_EQ(**table.find(b), 2);
+}
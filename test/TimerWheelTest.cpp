@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "TimerWheel.h"
+#include <vector>
+
+using namespace core::net;
+
+class TimerWheelTest : public ::testing::Test {
+protected:
+    TimerWheel wheel{0, 10};
+    std::vector<TimerWheel::Expiry> fired;
+
+    size_t advance_to(uint64_t now_ms) {
+        return wheel.advance(now_ms, [this](const TimerWheel::Expiry& expiry) { fired.push_back(expiry); });
+    }
+};
+
+TEST_F(TimerWheelTest, FiresAtDeadlineNotBefore) {
+    TimerWheel::TimerId id = wheel.schedule(95, 7, 3);
+    ASSERT_NE(id, TimerWheel::INVALID_TIMER);
+    EXPECT_EQ(wheel.size(), 1u);
+
+    // Rounded up to the 100 ms tick
+    EXPECT_EQ(advance_to(99), 0u);
+    EXPECT_EQ(advance_to(100), 1u);
+    ASSERT_EQ(fired.size(), 1u);
+    EXPECT_EQ(fired[0].id, id);
+    EXPECT_EQ(fired[0].token, 7u);
+    EXPECT_EQ(fired[0].tag, 3u);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST_F(TimerWheelTest, CancelledTimerNeverFires) {
+    TimerWheel::TimerId id = wheel.schedule(50, 1);
+    EXPECT_TRUE(wheel.cancel(id));
+    EXPECT_FALSE(wheel.cancel(id));
+    EXPECT_EQ(advance_to(1000), 0u);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST_F(TimerWheelTest, StaleIdDoesNotTouchRecycledTimer) {
+    TimerWheel::TimerId first = wheel.schedule(50, 1);
+    ASSERT_TRUE(wheel.cancel(first));
+
+    TimerWheel::TimerId second = wheel.schedule(50, 2);
+    EXPECT_NE(first, second);
+    EXPECT_FALSE(wheel.cancel(first));
+    EXPECT_FALSE(wheel.reschedule(first, 10));
+
+    EXPECT_EQ(advance_to(50), 1u);
+    EXPECT_EQ(fired[0].token, 2u);
+}
+
+TEST_F(TimerWheelTest, RescheduleMovesDeadlineBothWays) {
+    TimerWheel::TimerId later = wheel.schedule(100, 1);
+    TimerWheel::TimerId sooner = wheel.schedule(5000, 2);
+
+    EXPECT_TRUE(wheel.reschedule(later, 3000));
+    EXPECT_TRUE(wheel.reschedule(sooner, 200));
+
+    EXPECT_EQ(advance_to(200), 1u);
+    EXPECT_EQ(fired.back().token, 2u);
+
+    EXPECT_EQ(advance_to(2990), 0u);
+    EXPECT_EQ(advance_to(3000), 1u);
+    EXPECT_EQ(fired.back().token, 1u);
+}
+
+TEST_F(TimerWheelTest, LongTimersCascadeDownOnTime) {
+    // One per level, plus one beyond the top level's reach
+    const std::vector<uint64_t> deadlines = {
+        1000,                       // level 0
+        60 * 1000,                  // level 1
+        3 * 60 * 60 * 1000,         // level 2
+        30ull * 24 * 60 * 60 * 1000,  // level 3
+        600ull * 24 * 60 * 60 * 1000  // past 2^32 ticks
+    };
+    for (size_t i = 0; i < deadlines.size(); ++i) {
+        wheel.schedule(deadlines[i], i);
+    }
+
+    for (size_t i = 0; i < deadlines.size(); ++i) {
+        EXPECT_EQ(advance_to(deadlines[i] - 10), 0u) << "timer " << i << " fired early";
+        EXPECT_EQ(advance_to(deadlines[i]), 1u) << "timer " << i << " fired late";
+        EXPECT_EQ(fired.back().token, i);
+    }
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST_F(TimerWheelTest, HandlerCanRearmTimers) {
+    wheel.schedule(100, 1);
+
+    size_t count = 0;
+    const TimerWheel::ExpiryHandler periodic = [&](const TimerWheel::Expiry& expiry) {
+        ++count;
+        wheel.schedule(100 * (count + 1), expiry.token);
+    };
+
+    wheel.advance(1000, periodic);
+    EXPECT_EQ(count, 10u);
+    EXPECT_EQ(wheel.size(), 1u);
+}
+
+TEST_F(TimerWheelTest, NextTimeoutTracksEarliestTimer) {
+    EXPECT_EQ(wheel.next_timeout_ms(0), -1);
+
+    wheel.schedule(250, 1);
+    EXPECT_EQ(wheel.next_timeout_ms(0), 250);
+    EXPECT_EQ(wheel.next_timeout_ms(100), 150);
+
+    // Coarse timers wake the poller at their cascade point, not every tick
+    TimerWheel far{0, 10};
+    far.schedule(60 * 1000, 1);
+    EXPECT_GT(far.next_timeout_ms(0), 2560);
+    EXPECT_LE(far.next_timeout_ms(0), 60 * 1000);
+}
+
+TEST_F(TimerWheelTest, ManyIdleTimersAreCheapToRearm) {
+    constexpr size_t TIMERS = 1000000;
+    std::vector<TimerWheel::TimerId> ids(TIMERS);
+    for (size_t i = 0; i < TIMERS; ++i) {
+        ids[i] = wheel.schedule(30000, i);
+    }
+    EXPECT_EQ(wheel.size(), TIMERS);
+
+    // Every read pushes the idle deadline back
+    for (uint64_t now = 1000; now <= 5000; now += 1000) {
+        advance_to(now);
+        for (size_t i = 0; i < TIMERS; ++i) {
+            ASSERT_TRUE(wheel.reschedule(ids[i], now + 30000));
+        }
+    }
+    EXPECT_TRUE(fired.empty());
+
+    EXPECT_EQ(advance_to(34990), 0u);
+    EXPECT_EQ(advance_to(35000), TIMERS);
+    EXPECT_TRUE(wheel.empty());
+}
@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+#include "UdpListener.h"
+#include "MessageSerializer.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace core::net;
+using namespace core::protocol;
+
+namespace {
+
+// Counts frames of one type and the payload bytes they carried
+class CountingHandler : public IMessageHandler {
+public:
+    CountingHandler(MessageType type, std::atomic<size_t>& frames, std::atomic<size_t>& bytes)
+        : m_type(type)
+        , m_frames(frames)
+        , m_bytes(bytes)
+    {
+    }
+
+    [[nodiscard]] MessageType get_message_type() const noexcept override
+    {
+        return m_type;
+    }
+
+    bool handle(const uint8_t*, size_t length) noexcept override
+    {
+        m_frames.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_add(length, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    MessageType m_type;
+    std::atomic<size_t>& m_frames;
+    std::atomic<size_t>& m_bytes;
+};
+
+std::vector<uint8_t> make_frame(MessageType type, const std::string& payload)
+{
+    FrameHeader header{PROTOCOL_MAGIC, PROTOCOL_VERSION, static_cast<uint8_t>(type), 0,
+                       static_cast<uint16_t>(payload.size()), 0};
+    NetworkBuffer buffer(MIN_FRAME_SIZE + payload.size());
+    MessageSerializer::serialize_frame(header, reinterpret_cast<const uint8_t*>(payload.data()),
+                                       static_cast<uint16_t>(payload.size()), buffer);
+    return std::vector<uint8_t>(buffer.data(), buffer.data() + buffer.write_pos());
+}
+
+template<typename Op>
+bool retry_for(Op op, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000))
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (op()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return op();
+}
+
+} // namespace
+
+class UdpListenerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        registry.register_handler(std::make_unique<CountingHandler>(MessageType::STATUS, status_frames, status_bytes));
+        ASSERT_TRUE(listener.start("127.0.0.1", 0));
+        ASSERT_NE(listener.get_local_port(), 0u);
+
+        client = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        ASSERT_NE(client, INVALID_SOCKET);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(listener.get_local_port());
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    }
+
+    void TearDown() override {
+        if (client != INVALID_SOCKET) {
+            close_socket(client);
+        }
+    }
+
+    void send_datagram(const std::vector<uint8_t>& datagram) {
+        ASSERT_EQ(send(client, reinterpret_cast<const char*>(datagram.data()), static_cast<int>(datagram.size()), 0),
+                  static_cast<int>(datagram.size()));
+    }
+
+    // Process until count datagrams have arrived (loopback delivery is asynchronous)
+    void receive(size_t count) {
+        ASSERT_TRUE(retry_for([&]() {
+            listener.process_incoming();
+            return listener.get_received_count() >= count;
+        }));
+    }
+
+    HandlerRegistry registry;
+    UdpListener listener{registry};
+    SOCKET client{INVALID_SOCKET};
+    std::atomic<size_t> status_frames{0};
+    std::atomic<size_t> status_bytes{0};
+};
+
+TEST_F(UdpListenerTest, DispatchesEachDatagramAsOneFrame) {
+    const auto frame = make_frame(MessageType::STATUS, "cpu=42");
+    constexpr size_t NUM_FRAMES = 100;
+    for (size_t i = 0; i < NUM_FRAMES; ++i) {
+        send_datagram(frame);
+    }
+
+    receive(NUM_FRAMES);
+    EXPECT_EQ(status_frames.load(), NUM_FRAMES);
+    EXPECT_EQ(status_bytes.load(), NUM_FRAMES * 6);
+    EXPECT_EQ(listener.get_dispatched_count(), NUM_FRAMES);
+    EXPECT_EQ(listener.get_dropped_count(), 0u);
+
+#ifdef __linux__
+    // recvmmsg took them in batches, not one syscall each
+    EXPECT_LT(listener.get_receive_call_count(), NUM_FRAMES);
+#endif
+}
+
+TEST_F(UdpListenerTest, DropsMalformedDatagrams) {
+    auto corrupt = make_frame(MessageType::STATUS, "mem=17");
+    corrupt[FRAME_HEADER_SIZE] ^= 0xFF;
+
+    auto two_frames = make_frame(MessageType::STATUS, "a");
+    const auto second = make_frame(MessageType::STATUS, "b");
+    two_frames.insert(two_frames.end(), second.begin(), second.end());
+
+    send_datagram(corrupt);
+    send_datagram(two_frames);
+    send_datagram({0x01, 0x02, 0x03});
+    send_datagram(make_frame(MessageType::DATA, "no handler"));
+    send_datagram(make_frame(MessageType::STATUS, "ok"));
+
+    receive(5);
+    EXPECT_EQ(status_frames.load(), 1u);
+    EXPECT_EQ(listener.get_dispatched_count(), 1u);
+    EXPECT_EQ(listener.get_dropped_count(), 4u);
+}
+
+TEST_F(UdpListenerTest, DropsDatagramsLargerThanTheLimit) {
+    send_datagram(make_frame(MessageType::STATUS, std::string(UdpListener::DEFAULT_MAX_DATAGRAM_BYTES, 'x')));
+    send_datagram(make_frame(MessageType::STATUS, "fits"));
+
+    receive(2);
+    EXPECT_EQ(status_frames.load(), 1u);
+    EXPECT_EQ(listener.get_dropped_count(), 1u);
+}
+
+TEST_F(UdpListenerTest, AnswersPingsWithPongs) {
+    std::thread loop([this]() { listener.run(20); });
+
+    constexpr size_t NUM_PINGS = 50;
+    for (size_t i = 0; i < NUM_PINGS; ++i) {
+        send_datagram(make_frame(MessageType::PING, "seq " + std::to_string(i)));
+    }
+
+    size_t pongs = 0;
+    EXPECT_TRUE(retry_for([&]() {
+        uint8_t buffer[256];
+        int received = 0;
+        while ((received = recv(client, reinterpret_cast<char*>(buffer), sizeof(buffer), MSG_DONTWAIT)) > 0) {
+            FrameHeader header{};
+            std::vector<uint8_t> payload;
+            EXPECT_EQ(MessageSerializer::deserialize_frame(buffer, static_cast<size_t>(received), header, payload),
+                      static_cast<size_t>(received));
+            EXPECT_EQ(header.message_type, static_cast<uint8_t>(MessageType::PONG));
+            EXPECT_EQ(std::string(payload.begin(), payload.end()), "seq " + std::to_string(pongs));
+            ++pongs;
+        }
+        return pongs == NUM_PINGS;
+    }));
+    EXPECT_EQ(listener.get_sent_count(), NUM_PINGS);
+
+    listener.stop();
+    loop.join();
+    EXPECT_FALSE(listener.is_running());
+}
+
+TEST_F(UdpListenerTest, QueuedSendsGoOutOnFlush) {
+    sockaddr_in local{};
+    socklen_t local_length = sizeof(local);
+    ASSERT_EQ(getsockname(client, reinterpret_cast<sockaddr*>(&local), &local_length), 0);
+    PeerAddress to;
+    std::memcpy(&to.storage, &local, sizeof(local));
+    to.length = local_length;
+
+    // More than one batch: the first BATCH_SIZE go out when the batch fills
+    const auto frame = make_frame(MessageType::STATUS, "fan-out");
+    constexpr size_t NUM_DATAGRAMS = UdpListener::BATCH_SIZE + 8;
+    for (size_t i = 0; i < NUM_DATAGRAMS; ++i) {
+        ASSERT_TRUE(listener.queue_send(to, frame.data(), frame.size()));
+    }
+    EXPECT_EQ(listener.get_sent_count(), UdpListener::BATCH_SIZE);
+    EXPECT_EQ(listener.flush_sends(), 8u);
+    EXPECT_EQ(listener.flush_sends(), 0u);
+
+    std::vector<uint8_t> too_big(UdpListener::DEFAULT_MAX_DATAGRAM_BYTES + 1);
+    EXPECT_FALSE(listener.queue_send(to, too_big.data(), too_big.size()));
+    EXPECT_EQ(listener.get_send_dropped_count(), 0u);
+}
+
+TEST_F(UdpListenerTest, UnsendableDatagramsAreCountedApartFromInboundDrops) {
+    sockaddr_in local{};
+    socklen_t local_length = sizeof(local);
+    ASSERT_EQ(getsockname(client, reinterpret_cast<sockaddr*>(&local), &local_length), 0);
+    PeerAddress to;
+    std::memcpy(&to.storage, &local, sizeof(local));
+    to.length = local_length;
+
+    // Port 0 is no valid destination: the send fails and the rest of the batch still goes out
+    PeerAddress nowhere = to;
+    reinterpret_cast<sockaddr_in*>(&nowhere.storage)->sin_port = 0;
+
+    const auto frame = make_frame(MessageType::STATUS, "fan-out");
+    ASSERT_TRUE(listener.queue_send(nowhere, frame.data(), frame.size()));
+    ASSERT_TRUE(listener.queue_send(to, frame.data(), frame.size()));
+    EXPECT_EQ(listener.flush_sends(), 1u);
+    EXPECT_EQ(listener.get_send_dropped_count(), 1u);
+    EXPECT_EQ(listener.get_dropped_count(), 0u);
+}